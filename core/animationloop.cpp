@@ -0,0 +1,360 @@
+#include "animationloop.h"
+#include "decodepool.h"
+#include "options.h"
+
+#include <QDebug>
+#include <functional>
+
+extern Options opts;
+
+// decode tasks of the animation start after the segments of a composed image
+#define ANIMATION_PRIORITY -100
+
+// The segments of the cycle are decoded one after the other and averaged in blocks of factor x factor into the frame
+static void doAnimationFrame(AnimationLoop *loop, AnimationFrameJob job)
+{
+    if(loop->isCancelled(job))
+        return;
+
+    QVector<quint32> sum;
+    QVector<quint16> cnt;
+    int width = 0;
+    int height = 0;
+    int lines = 0;
+    int columns = 0;
+
+    QMap<int, QFileInfo>::const_iterator file = job.files.constBegin();
+    while(file != job.files.constEnd())
+    {
+        int segnr = file.key();
+        if(segnr < job.segfirst || segnr > job.seglast || loop->isCancelled(job))
+        {
+            ++file;
+            continue;
+        }
+
+        MosaicSegmentJob seg;
+        seg.sat = NULL;
+        seg.filesequence = segnr - 1;
+        seg.filepath = file.value().absoluteFilePath();
+        doMosaicSegment(seg);
+        if(!seg.ok)
+        {
+            ++file;
+            continue;
+        }
+
+        if(width == 0)
+        {
+            columns = seg.columns;
+            lines = seg.lines;
+            width = columns / job.factor;
+            height = (job.seglast - job.segfirst + 1) * lines / job.factor;
+            sum.fill(0, width * height);
+            cnt.fill(0, width * height);
+        }
+        if(seg.columns != columns || seg.lines != lines)
+        {
+            ++file;
+            continue;
+        }
+
+        for(int line = 0; line < lines; line++)
+        {
+            int framerow = job.flip ? (job.seglast - segnr) * lines + lines - 1 - line : (segnr - job.segfirst) * lines + line;
+            int y = framerow / job.factor;
+            if(y >= height)
+                continue;
+
+            const quint16 *samples = seg.data.constData() + line * columns;
+            quint32 *rowsum = sum.data() + y * width;
+            quint16 *rowcnt = cnt.data() + y * width;
+            for(int pixelx = 0; pixelx < columns; pixelx++)
+            {
+                int x = (job.flip ? columns - 1 - pixelx : pixelx) / job.factor;
+                if(x >= width || samples[pixelx] == 0)
+                    continue;
+                rowsum[x] += samples[pixelx];
+                rowcnt[x]++;
+            }
+        }
+        ++file;
+    }
+
+    if(loop->isCancelled(job))
+        return;
+
+    if(width == 0)
+    {
+        loop->failFrame(job);
+        return;
+    }
+
+    QImage *image = new QImage(width, height, QImage::Format_Indexed8);
+    QVector<QRgb> colortable;
+    for(int i = 0; i < 256; i++)
+        colortable.append(qRgb(i, i, i));
+    image->setColorTable(colortable);
+
+    for(int y = 0; y < height; y++)
+    {
+        uchar *row = image->scanLine(y);
+        for(int x = 0; x < width; x++)
+        {
+            int n = cnt.at(y * width + x);
+            if(n == 0)
+            {
+                row[x] = 0;
+                continue;
+            }
+            int val = qBound(0, (int)(sum.at(y * width + x) / n * 255 / job.maxcount), 255);
+            row[x] = (uchar)(job.inverse ? 255 - val : val);
+        }
+    }
+
+    loop->insertFrame(job, image);
+}
+
+AnimationLoop::AnimationLoop(AVHRRSatellite *seglist, QObject *parent) :
+    QObject(parent)
+{
+    segs = seglist;
+    satellites = GeoMosaic::xritSatellites(segs);
+    generation = 0;
+    cache.setMaxCost(opts.animationcache * 1024);
+}
+
+// the tasks that are still running have to finish before the cache goes
+AnimationLoop::~AnimationLoop()
+{
+    cancel();
+    for(int i = 0; i < futures.count(); i++)
+        futures[i].waitForFinished();
+}
+
+QStringList AnimationLoop::satelliteNames() const
+{
+    QStringList names;
+    for(int i = 0; i < satellites.count(); i++)
+    {
+        if(!satellites.at(i).map->isEmpty() || (satellites.at(i).altmap != NULL && !satellites.at(i).altmap->isEmpty()))
+            names << satellites.at(i).name;
+    }
+    return names;
+}
+
+const MosaicSatellite *AnimationLoop::satellite(const QString &name) const
+{
+    for(int i = 0; i < satellites.count(); i++)
+    {
+        if(satellites.at(i).name == name)
+            return &satellites.at(i);
+    }
+    return NULL;
+}
+
+// GOES comes in two disseminations, the second one is used when there is nothing in the first
+const GeoSegmentMap *AnimationLoop::cycles(const QString &name) const
+{
+    const MosaicSatellite *sat = satellite(name);
+    if(sat == NULL)
+        return NULL;
+    if(sat->map->isEmpty() && sat->altmap != NULL && !sat->altmap->isEmpty())
+        return sat->altmap;
+    return sat->map->isEmpty() ? NULL : sat->map;
+}
+
+// The channels of the latest cycle, without HRV that has an other size
+QStringList AnimationLoop::spectra(const QString &name) const
+{
+    const GeoSegmentMap *map = cycles(name);
+    if(map == NULL)
+        return QStringList();
+
+    QStringList list = map->last().keys();
+    list.removeAll("HRV___");
+    return list;
+}
+
+QDateTime AnimationLoop::latestCycle(const QString &name) const
+{
+    const GeoSegmentMap *map = cycles(name);
+    if(map == NULL)
+        return QDateTime();
+
+    QDateTime latest = QDateTime::fromString(map->lastKey(), "yyyyMMddhhmm");
+    latest.setTimeSpec(Qt::UTC);
+    return latest;
+}
+
+// Queues the frames of the cycles in the time range, returns the number of frames
+int AnimationLoop::setup(const QString &name, const QString &spectrum, const QDateTime &from, const QDateTime &to, int factor, bool inverse)
+{
+    cancel();
+
+    jobs.clear();
+    dates.clear();
+
+    mutex.lock();
+    cache.setMaxCost(opts.animationcache * 1024);
+    mutex.unlock();
+
+    const MosaicSatellite *sat = satellite(name);
+    const GeoSegmentMap *map = cycles(name);
+    if(sat == NULL || map == NULL)
+        return 0;
+
+    QDateTime fromutc = from.toUTC();
+    QDateTime toutc = to.toUTC();
+
+    // the frames hold the segments that are in any of the cycles
+    int segfirst = 0;
+    int seglast = 0;
+    GeoSegmentMap::const_iterator cycle = map->constBegin();
+    while(cycle != map->constEnd())
+    {
+        QDateTime time = QDateTime::fromString(cycle.key(), "yyyyMMddhhmm");
+        time.setTimeSpec(Qt::UTC);
+        if(time >= fromutc && time <= toutc && cycle.value().contains(spectrum) && !cycle.value().value(spectrum).isEmpty())
+        {
+            const QMap<int, QFileInfo> &files = cycle.value().value(spectrum);
+            segfirst = (segfirst == 0 ? files.firstKey() : qMin(segfirst, files.firstKey()));
+            seglast = qMax(seglast, files.lastKey());
+
+            AnimationFrameJob job;
+            job.index = jobs.count();
+            job.files = files;
+            job.flip = sat->flip;
+            job.maxcount = sat->maxcount;
+            job.factor = qMax(1, factor);
+            job.inverse = inverse;
+            jobs.append(job);
+            dates.append(cycle.key());
+        }
+        ++cycle;
+    }
+
+    for(int i = 0; i < jobs.count(); i++)
+    {
+        jobs[i].segfirst = segfirst;
+        jobs[i].seglast = seglast;
+        jobs[i].generation = generation.load();
+        jobs[i].key = QString("%1_%2_%3_%4_%5_%6_%7").arg(name).arg(spectrum).arg(dates.at(i))
+                .arg(segfirst).arg(seglast).arg(jobs.at(i).factor).arg(inverse ? 1 : 0);
+        queue(i);
+    }
+
+    qDebug() << QString("AnimationLoop::setup %1 %2 frames segments %3 to %4").arg(name).arg(jobs.count()).arg(segfirst).arg(seglast);
+
+    return jobs.count();
+}
+
+// The frames of an earlier setup are not made any more
+void AnimationLoop::cancel()
+{
+    generation.fetchAndAddOrdered(1);
+
+    mutex.lock();
+    pending.clear();
+    failed.clear();
+    mutex.unlock();
+
+    for(int i = futures.count() - 1; i >= 0; i--)
+    {
+        if(futures.at(i).isFinished())
+            futures.removeAt(i);
+    }
+}
+
+void AnimationLoop::queue(int index)
+{
+    const AnimationFrameJob &job = jobs.at(index);
+
+    mutex.lock();
+    bool cached = cache.contains(job.key) || failed.contains(job.key);
+    bool skip = cached || pending.contains(job.key);
+    if(!skip)
+        pending.insert(job.key);
+    mutex.unlock();
+
+    if(cached)
+        emit frameReady(index);
+    if(skip)
+        return;
+
+    futures.append(DecodePool::instance()->run(ANIMATION_PRIORITY - index, std::bind(doAnimationFrame, this, job)));
+}
+
+// Runs on the decode pool, the cache takes the image
+void AnimationLoop::insertFrame(const AnimationFrameJob &job, QImage *image)
+{
+    mutex.lock();
+    pending.remove(job.key);
+    cache.insert(job.key, image, qMax(1, image->byteCount() / 1024));
+    mutex.unlock();
+
+    if(!isCancelled(job))
+        emit frameReady(job.index);
+}
+
+// Runs on the decode pool, none of the segments of the cycle could be decoded
+void AnimationLoop::failFrame(const AnimationFrameJob &job)
+{
+    qDebug() << QString("AnimationLoop::failFrame %1 no segments decoded").arg(job.key);
+
+    mutex.lock();
+    pending.remove(job.key);
+    failed.insert(job.key);
+    mutex.unlock();
+
+    if(!isCancelled(job))
+        emit frameReady(job.index);
+}
+
+// A frame that has been dropped from the cache is decoded again, until then the image is null
+QImage AnimationLoop::frame(int index)
+{
+    if(index < 0 || index >= jobs.count())
+        return QImage();
+
+    mutex.lock();
+    QImage *image = cache.object(jobs.at(index).key);
+    QImage copy = (image != NULL ? *image : QImage());
+    mutex.unlock();
+
+    if(copy.isNull())
+        queue(index);
+    return copy;
+}
+
+bool AnimationLoop::isFailed(int index)
+{
+    if(index < 0 || index >= jobs.count())
+        return false;
+
+    mutex.lock();
+    bool fail = failed.contains(jobs.at(index).key);
+    mutex.unlock();
+    return fail;
+}
+
+int AnimationLoop::failedFrames()
+{
+    mutex.lock();
+    int count = failed.count();
+    mutex.unlock();
+    return count;
+}
+
+int AnimationLoop::cachedFrames()
+{
+    int count = 0;
+    mutex.lock();
+    for(int i = 0; i < jobs.count(); i++)
+    {
+        if(cache.contains(jobs.at(i).key))
+            count++;
+    }
+    mutex.unlock();
+    return count;
+}
@@ -0,0 +1,85 @@
+#ifndef ANIMATIONLOOP_H
+#define ANIMATIONLOOP_H
+
+#include <QObject>
+#include <QImage>
+#include <QCache>
+#include <QSet>
+#include <QMutex>
+#include <QFuture>
+#include <QAtomicInt>
+#include <QDateTime>
+#include <QStringList>
+
+#include "geomosaic.h"
+
+// Everything a frame is made of, copied into the decode task
+struct AnimationFrameJob {
+    QString key;
+    int index;
+    int generation;
+    QMap<int, QFileInfo> files;     // segment number, file
+    bool flip;
+    int maxcount;
+    int segfirst;                   // segments in the frame
+    int seglast;
+    int factor;                     // of the downsampling
+    bool inverse;
+};
+
+// Successive cycles of one channel of an xRIT geostationary satellite as frames of an animation.
+// The frames are decoded on the decode pool, below the priority of the composed images, straight
+// from the segment files : the image of the segment list is not touched. A frame holds the segments
+// that are present in the cycles, downsampled and stored with 8 bits per pixel.
+// The frames are kept in a cache of opts.animationcache MB, a frame that is played again is not
+// decoded again as long as it is in the cache. A cycle of which no segment can be decoded is a failed
+// frame, it is not decoded again until the next setup and the player skips it.
+class AnimationLoop : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AnimationLoop(AVHRRSatellite *seglist, QObject *parent = 0);
+    ~AnimationLoop();
+
+    QStringList satelliteNames() const;
+    QStringList spectra(const QString &name) const;
+    QDateTime latestCycle(const QString &name) const;
+
+    int setup(const QString &name, const QString &spectrum, const QDateTime &from, const QDateTime &to, int factor, bool inverse);
+    void cancel();
+
+    int frameCount() const { return dates.count(); }
+    QString frameDate(int index) const { return dates.at(index); }
+    QImage frame(int index);
+    bool isFailed(int index);
+    int cachedFrames();
+    int failedFrames();
+
+    void insertFrame(const AnimationFrameJob &job, QImage *image);
+    void failFrame(const AnimationFrameJob &job);
+    bool isCancelled(const AnimationFrameJob &job) const { return job.generation != generation.load(); }
+
+signals:
+    void frameReady(int index);
+
+private:
+    const MosaicSatellite *satellite(const QString &name) const;
+    const GeoSegmentMap *cycles(const QString &name) const;
+    void queue(int index);
+
+    AVHRRSatellite *segs;
+    QList<MosaicSatellite> satellites;
+
+    QList<AnimationFrameJob> jobs;  // one for every frame of the current setup
+    QStringList dates;
+
+    QMutex mutex;
+    QCache<QString, QImage> cache;
+    QSet<QString> pending;
+    QSet<QString> failed;
+    QList<QFuture<void> > futures;
+    QAtomicInt generation;
+};
+
+#endif // ANIMATIONLOOP_H
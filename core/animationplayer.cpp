@@ -0,0 +1,232 @@
+#include "animationplayer.h"
+
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QScrollArea>
+#include <QDebug>
+
+AnimationPlayer::AnimationPlayer(AVHRRSatellite *seglist, QWidget *parent) :
+    QDialog(parent)
+{
+    setWindowTitle(tr("Geostationary animation"));
+
+    loop = new AnimationLoop(seglist, this);
+    connect(loop, SIGNAL(frameReady(int)), this, SLOT(frameReady(int)));
+
+    timer = new QTimer(this);
+    connect(timer, SIGNAL(timeout()), this, SLOT(nextFrame()));
+    current = 0;
+
+    satellitecombo = new QComboBox(this);
+    spectrumcombo = new QComboBox(this);
+    fromedit = new QDateTimeEdit(this);
+    toedit = new QDateTimeEdit(this);
+    fromedit->setDisplayFormat("yyyy-MM-dd hh:mm");
+    toedit->setDisplayFormat("yyyy-MM-dd hh:mm");
+    fromedit->setTimeSpec(Qt::UTC);
+    toedit->setTimeSpec(Qt::UTC);
+    factorcombo = new QComboBox(this);
+    factorcombo->addItem("1:1", 1);
+    factorcombo->addItem("1:2", 2);
+    factorcombo->addItem("1:4", 4);
+    factorcombo->setCurrentIndex(1);
+    inversecheck = new QCheckBox(tr("Inverse"), this);
+    inversecheck->setChecked(true);
+    loadbutton = new QPushButton(tr("Load"), this);
+
+    QHBoxLayout *setuplayout = new QHBoxLayout;
+    setuplayout->addWidget(satellitecombo);
+    setuplayout->addWidget(spectrumcombo);
+    setuplayout->addWidget(new QLabel(tr("From (UTC)"), this));
+    setuplayout->addWidget(fromedit);
+    setuplayout->addWidget(new QLabel(tr("To"), this));
+    setuplayout->addWidget(toedit);
+    setuplayout->addWidget(factorcombo);
+    setuplayout->addWidget(inversecheck);
+    setuplayout->addWidget(loadbutton);
+    setuplayout->addStretch();
+
+    imagelabel = new QLabel(this);
+    imagelabel->setAlignment(Qt::AlignCenter);
+    QScrollArea *scrollarea = new QScrollArea(this);
+    scrollarea->setBackgroundRole(QPalette::Dark);
+    scrollarea->setWidget(imagelabel);
+    scrollarea->setWidgetResizable(true);
+
+    playbutton = new QPushButton(tr("Play"), this);
+    playbutton->setEnabled(false);
+    frameslider = new QSlider(Qt::Horizontal, this);
+    frameslider->setEnabled(false);
+    fpsspin = new QSpinBox(this);
+    fpsspin->setRange(1, 30);
+    fpsspin->setValue(8);
+    fpsspin->setSuffix(tr(" frames/s"));
+    statuslabel = new QLabel(this);
+
+    QHBoxLayout *playlayout = new QHBoxLayout;
+    playlayout->addWidget(playbutton);
+    playlayout->addWidget(frameslider, 1);
+    playlayout->addWidget(fpsspin);
+    playlayout->addWidget(statuslabel);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(setuplayout);
+    layout->addWidget(scrollarea, 1);
+    layout->addLayout(playlayout);
+
+    connect(satellitecombo, SIGNAL(currentIndexChanged(int)), this, SLOT(satelliteChanged(int)));
+    connect(loadbutton, SIGNAL(clicked()), this, SLOT(load()));
+    connect(playbutton, SIGNAL(clicked()), this, SLOT(playPause()));
+    connect(frameslider, SIGNAL(valueChanged(int)), this, SLOT(showFrame(int)));
+    connect(fpsspin, SIGNAL(valueChanged(int)), this, SLOT(speedChanged(int)));
+
+    refresh();
+
+    resize(1000, 700);
+}
+
+// the satellites of the segment directories as they are read now, the frames in the cache stay
+void AnimationPlayer::refresh()
+{
+    QString name = satellitecombo->currentText();
+    satellitecombo->blockSignals(true);
+    satellitecombo->clear();
+    satellitecombo->addItems(loop->satelliteNames());
+    satellitecombo->setCurrentIndex(qMax(0, satellitecombo->findText(name)));
+    satellitecombo->blockSignals(false);
+    satelliteChanged(satellitecombo->currentIndex());
+}
+
+// the last two hours of the satellite with its infrared channel
+void AnimationPlayer::satelliteChanged(int index)
+{
+    if(index < 0)
+        return;
+
+    QString name = satellitecombo->itemText(index);
+    QStringList spectra = loop->spectra(name);
+    spectrumcombo->clear();
+    spectrumcombo->addItems(spectra);
+    for(int i = 0; i < spectra.count(); i++)
+    {
+        if(spectra.at(i) == "IR_108" || spectra.at(i) == "11_5_0" || spectra.at(i).startsWith("10_7_"))
+            spectrumcombo->setCurrentIndex(i);
+    }
+
+    QDateTime latest = loop->latestCycle(name);
+    if(latest.isValid())
+    {
+        toedit->setDateTime(latest);
+        fromedit->setDateTime(latest.addSecs(-2 * 3600));
+    }
+}
+
+void AnimationPlayer::load()
+{
+    timer->stop();
+    playbutton->setText(tr("Play"));
+
+    int count = loop->setup(satellitecombo->currentText(), spectrumcombo->currentText(), fromedit->dateTime(), toedit->dateTime(),
+                            factorcombo->currentData().toInt(), inversecheck->isChecked());
+
+    current = 0;
+    frameslider->blockSignals(true);
+    frameslider->setRange(0, qMax(0, count - 1));
+    frameslider->setValue(0);
+    frameslider->blockSignals(false);
+    frameslider->setEnabled(count > 0);
+    playbutton->setEnabled(count > 0);
+
+    imagelabel->clear();
+    showFrame(0);
+}
+
+void AnimationPlayer::playPause()
+{
+    if(timer->isActive())
+    {
+        timer->stop();
+        playbutton->setText(tr("Play"));
+    }
+    else
+    {
+        timer->start(1000 / fpsspin->value());
+        playbutton->setText(tr("Pause"));
+    }
+}
+
+void AnimationPlayer::speedChanged(int fps)
+{
+    if(timer->isActive())
+        timer->start(1000 / fps);
+}
+
+// the next frame is only shown when it has been decoded, during the first pass the animation waits for the decoder.
+// The failed frames are skipped.
+void AnimationPlayer::nextFrame()
+{
+    if(loop->frameCount() == 0)
+        return;
+
+    int next = current;
+    QImage image;
+    for(int i = 0; i < loop->frameCount(); i++)
+    {
+        next = (next + 1) % loop->frameCount();
+        image = loop->frame(next);
+        if(!image.isNull() || !loop->isFailed(next))
+            break;
+    }
+    if(image.isNull())
+    {
+        updateStatus();
+        return;
+    }
+
+    current = next;
+    frameslider->blockSignals(true);
+    frameslider->setValue(current);
+    frameslider->blockSignals(false);
+    imagelabel->setPixmap(QPixmap::fromImage(image));
+    updateStatus();
+}
+
+void AnimationPlayer::showFrame(int index)
+{
+    if(index < 0 || index >= loop->frameCount())
+    {
+        updateStatus();
+        return;
+    }
+
+    current = index;
+    QImage image = loop->frame(index);
+    if(!image.isNull())
+        imagelabel->setPixmap(QPixmap::fromImage(image));
+    updateStatus();
+}
+
+void AnimationPlayer::frameReady(int index)
+{
+    if(index == current && !timer->isActive())
+        showFrame(index);
+    else
+        updateStatus();
+}
+
+void AnimationPlayer::updateStatus()
+{
+    if(loop->frameCount() == 0)
+    {
+        statuslabel->setText(tr("No cycles in the time range"));
+        return;
+    }
+
+    QString status = QString("%1 / %2  %3  (%4 decoded").arg(current + 1).arg(loop->frameCount())
+            .arg(QDateTime::fromString(loop->frameDate(current), "yyyyMMddhhmm").toString("yyyy-MM-dd hh:mm"))
+            .arg(loop->cachedFrames());
+    int failed = loop->failedFrames();
+    if(failed > 0)
+        status += QString(", %1 failed").arg(failed);
+    statuslabel->setText(status + ")");
+}
@@ -0,0 +1,58 @@
+#ifndef ANIMATIONPLAYER_H
+#define ANIMATIONPLAYER_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QComboBox>
+#include <QDateTimeEdit>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QSlider>
+#include <QSpinBox>
+#include <QTimer>
+
+#include "animationloop.h"
+
+// Plays the frames of an AnimationLoop in a loop. The frames that are not decoded yet are waited for
+// during the first pass, after that the frames come from the cache.
+class AnimationPlayer : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit AnimationPlayer(AVHRRSatellite *seglist, QWidget *parent = 0);
+    void refresh();
+
+private slots:
+    void satelliteChanged(int index);
+    void load();
+    void playPause();
+    void nextFrame();
+    void showFrame(int index);
+    void frameReady(int index);
+    void speedChanged(int fps);
+
+private:
+    void updateStatus();
+
+    AnimationLoop *loop;
+    QTimer *timer;
+
+    QComboBox *satellitecombo;
+    QComboBox *spectrumcombo;
+    QDateTimeEdit *fromedit;
+    QDateTimeEdit *toedit;
+    QComboBox *factorcombo;
+    QCheckBox *inversecheck;
+    QPushButton *loadbutton;
+
+    QLabel *imagelabel;
+    QPushButton *playbutton;
+    QSlider *frameslider;
+    QSpinBox *fpsspin;
+    QLabel *statuslabel;
+
+    int current;
+};
+
+#endif // ANIMATIONPLAYER_H
@@ -1,4 +1,5 @@
 #include "avhrrsatellite.h"
+#include "tracer.h"
 
 #include <QDebug>
 #include <QDate>
@@ -127,9 +128,28 @@ void AVHRRSatellite::emitProgressCounter(int counter)
  */
 void AVHRRSatellite::AddSegmentsToList(QFileInfoList fileinfolist)
 {
-    QFileInfo fileInfo;
-    QDir segmentdir;
+    QList<SegmentFileDescriptor> desclist;
+
+    for (int i = 0; i < fileinfolist.size(); ++i)
+    {
+        SegmentFileDescriptor desc = SegmentFileDescriptor::classify(fileinfolist.at(i).fileName());
+        desc.absolutepath = fileinfolist.at(i).absolutePath();
+        desc.size = fileinfolist.at(i).size();
+        desclist.append(desc);
+    }
+
+    AddSegmentsToList(desclist);
+}
 
+void AVHRRSatellite::InsertToGeostationaryMap(QMap<QString, QMap<QString, QMap< int, QFileInfo > > > &segmentlistmap,
+                                              SegmentListGeostationary *sl, const SegmentFileDescriptor &desc)
+{
+    sl->setImagePath(desc.absolutepath);
+    segmentlistmap[desc.strdate][desc.strspectrum].insert( desc.filenbr, desc.fileInfo() );
+}
+
+bool AVHRRSatellite::AddSegmentFile(const SegmentFileDescriptor &desc, bool segmentshow)
+{
     SegmentMetop *segmetop;
     SegmentNoaa *segnoaa;
     SegmentHRP *seghrp;
@@ -145,548 +165,179 @@ void AVHRRSatellite::AddSegmentsToList(QFileInfoList fileinfolist)
     QList<Segment*> *slviirsm = seglviirsm->GetSegmentlistptr();
     QList<Segment*> *slviirsdnb = seglviirsdnb->GetSegmentlistptr();
 
-    int counter = 0;
+    if (desc.size == 0)
+        return false;
 
-    for (int i = 0; i < fileinfolist.size(); ++i)
+    switch(desc.filetype)
     {
-        fileInfo = fileinfolist.at(i);
-        counter++;
-
-        if (fileInfo.size() == 0)
-            continue;
-
-        if (fileInfo.fileName().mid( 0, 8) == "AVHR_xxx" && fileInfo.fileName().mid( 67, 4) == ".bz2")   // EPS-10
-        {
-            seglmetop->SetDirectoryName(fileInfo.absolutePath());
-            QFile file( segmentdir.filePath(fileInfo.absoluteFilePath()));
-            segmetop = new SegmentMetop(&file,satlist);
-            if(segmetop->segmentok == true)
-            {
-                slmetop->append(segmetop);
-                countmetop++;
-            }
-            else
-                delete segmetop;
-        } else if (fileInfo.fileName().mid( 0, 6) == "avhrr_" && fileInfo.fileName().mid( 22, 6) == "noaa19")  // Data Channel 1
-        {
-            seglnoaa->SetDirectoryName(fileInfo.absolutePath());
-            if (satlist->SatExistInList(33591) )
-            {
-                QFile file( segmentdir.filePath(fileInfo.absoluteFilePath()));
-                segnoaa = new SegmentNoaa(&file, satlist);
-                if(segnoaa->segmentok == true)
-                {
-                    slnoaa->append(segnoaa);
-                    countnoaa++;
-                }
-                else
-                    delete segnoaa;
-            }
-        } else if (fileInfo.fileName().mid( 0, 8) == "AVHR_HRP" && fileInfo.fileName().mid( 67, 4) == ".bz2")   // Data Channel 1
-        {
-            seglhrp->SetDirectoryName(fileInfo.absolutePath());
-            QFile file( segmentdir.filePath(fileInfo.absoluteFilePath()));
-            seghrp = new SegmentHRP(&file,satlist);
-            if(seghrp->segmentok == true)
-            {
-                slhrp->append(seghrp);
-                counthrp++;
-            }
-            else
-                delete seghrp;
-
-        } else if (fileInfo.fileName().mid( 0, 8) == "AVHR_GAC") // EPS-15
-        {
-            seglgac->SetDirectoryName(fileInfo.absolutePath());
-            QFile file( segmentdir.filePath(fileInfo.absoluteFilePath()));
-            seggac = new SegmentGAC(&file, satlist);
-            if(seggac->segmentok == true)
-            {
-                slgac->append(seggac);
-                countgac++;
-            }
-            else
-                delete seggac;
-        } else if (fileInfo.fileName().mid( 0, 8) == "SVMC_npp" && fileInfo.fileName().mid( 77, 3) == "bz2") // NPP-2
+    case SegmentFileDescriptor::FILE_METOP:
+    {
+        seglmetop->SetDirectoryName(desc.absolutepath);
+        QFile file( desc.fileInfo().absoluteFilePath());
+        segmetop = new SegmentMetop(&file,satlist);
+        if(segmetop->segmentok == true)
         {
-            seglviirsm->SetDirectoryName(fileInfo.absolutePath());
-            QFile file( segmentdir.filePath(fileInfo.absoluteFilePath()));
-            segviirsm = new SegmentVIIRSM(&file, satlist);
-            if(segviirsm->segmentok == true)
-            {
-                slviirsm->append(segviirsm);
-                countviirsm++;
-            }
-            else
-                delete segviirsm;
-        } else if (fileInfo.fileName().mid( 0, 10) == "SVDNBC_npp" && fileInfo.fileName().mid( 79, 3) == "bz2") // NPP-2
+            segmetop->segmentshow = segmentshow;
+            slmetop->append(segmetop);
+            countmetop++;
+            return true;
+        }
+        else
+            delete segmetop;
+        break;
+    }
+    case SegmentFileDescriptor::FILE_NOAA:
+    {
+        seglnoaa->SetDirectoryName(desc.absolutepath);
+        if (satlist->SatExistInList(33591) )
         {
-            //SVDNBC_npp_d20150810_t0033443_e0035085_b19602_c20150824113128000166_eum_ops.h5.bz2
-            //0123456789012345678901234567890123456789012345678901234567890123456789012345678901
-            seglviirsdnb->SetDirectoryName(fileInfo.absolutePath());
-            QFile file( segmentdir.filePath(fileInfo.absoluteFilePath()));
-            segviirsdnb = new SegmentVIIRSDNB(&file, satlist);
-            if(segviirsdnb->segmentok == true)
+            QFile file( desc.fileInfo().absoluteFilePath());
+            segnoaa = new SegmentNoaa(&file, satlist);
+            if(segnoaa->segmentok == true)
             {
-                slviirsdnb->append(segviirsdnb);
-                countviirsdnb++;
+                segnoaa->segmentshow = segmentshow;
+                slnoaa->append(segnoaa);
+                countnoaa++;
+                return true;
             }
             else
-                delete segviirsdnb;
-        } else if (fileInfo.fileName().mid( 0, 9) == "H-000-MSG" && fileInfo.fileName().mid( 13, 3) == "MSG" &&
-                   fileInfo.fileName().mid( 18, 3) == "___" && fileInfo.fileName().mid( 59, 2) == "C_")
-        // Data Channel 2
-        {
-            //012345678901234567890123456789012345678901234567890123456789012
-            //H-000-MSG3__-MSG3________-HRV______-000001___-201310270845-C_
-            //H-000-MSG1__-MSG1________-IR_016___-000007___-201307011145-C_
-            //H-000-MSG1__-MSG1_IODC____-HRV______-000005___-201605091215-C_
-
-            int filenbr = fileInfo.fileName().mid(36, 6).toInt();
-            QString strspectrum = fileInfo.fileName().mid(26, 6);
-            QString strdate = fileInfo.fileName().mid(46, 12);
-            //qDebug() << strdate << strspectrum << QString("%1").arg(filenbr);
-
-            if (strspectrum != "______")
-            {
-                seglmeteosat->setImagePath(fileInfo.absolutePath());
-
-                QMap<int, QFileInfo> hashfile;
-                QMap<QString, QMap<int, QFileInfo> > hashspectrum;
-
-                if (segmentlistmapmeteosat.contains(strdate))
-                {
-                    hashspectrum = segmentlistmapmeteosat.value(strdate);
-                    if (hashspectrum.contains(strspectrum))
-                        hashfile = hashspectrum.value(strspectrum);
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert( strspectrum, hashfile);
-                    segmentlistmapmeteosat.insert(strdate, hashspectrum);
-                }
-                else
-                {
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert(strspectrum, hashfile);
-                    segmentlistmapmeteosat.insert( strdate, hashspectrum );
-                }
-
-            }
-        } else if (fileInfo.fileName().mid( 0, 9) == "H-000-MSG" && fileInfo.fileName().mid( 13, 3) == "MSG" &&
-                   fileInfo.fileName().mid( 18, 3) == "RSS" && fileInfo.fileName().mid( 59, 2) == "C_")
-            //   // Data Channel 5
-        {
-            //H-000-MSG1__-MSG1_RSS____-HRV______-000016___-201211210610-C_
-
-            int filenbr = fileInfo.fileName().mid(36, 6).toInt();
-            QString strspectrum = fileInfo.fileName().mid(26, 6);
-            QString strdate = fileInfo.fileName().mid(46, 12);
-            //qDebug() << strdate << strspectrum << QString("%1").arg(filenbr);
-
-            if (strspectrum != "______")
-            {
-                seglmeteosatrss->setImagePath(fileInfo.absolutePath());
-
-                QMap<int, QFileInfo> hashfile;
-                QMap<QString, QMap<int, QFileInfo> > hashspectrum;
-
-                if (segmentlistmapmeteosatrss.contains(strdate))
-                {
-                    hashspectrum = segmentlistmapmeteosatrss.value(strdate);
-                    if (hashspectrum.contains(strspectrum))
-                        hashfile = hashspectrum.value(strspectrum);
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert( strspectrum, hashfile);
-                    segmentlistmapmeteosatrss.insert(strdate, hashspectrum);
-                }
-                else
-                {
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert(strspectrum, hashfile);
-                    segmentlistmapmeteosatrss.insert( strdate, hashspectrum );
-                }
-
-            }
-        } else if (fileInfo.fileName().mid( 0, 9) == "H-000-MSG" && fileInfo.fileName().mid( 13, 3) == "MSG" &&
-                   fileInfo.fileName().mid( 18, 4) == "IODC" && fileInfo.fileName().mid( 59, 2) == "C_")
-            //   // E1B-GEO-1
-        {
-            //012345678901234567890123456789012345678901234567890123456789012
-            //H-000-MSG1__-MSG1_IODC___-HRV______-000001___-201610060845-C_
-            int filenbr = fileInfo.fileName().mid(36, 6).toInt();
-            QString strspectrum = fileInfo.fileName().mid(26, 6);
-            QString strdate = fileInfo.fileName().mid(46, 12);
-            //qDebug() << strdate << strspectrum << QString("%1").arg(filenbr);
-
-            if (strspectrum != "______")
-            {
-                seglmet8->setImagePath(fileInfo.absolutePath());
-
-                QMap<int, QFileInfo> hashfile;
-                QMap<QString, QMap<int, QFileInfo> > hashspectrum;
-
-                if (segmentlistmapmet8.contains(strdate))
-                {
-                    hashspectrum = segmentlistmapmet8.value(strdate);
-                    if (hashspectrum.contains(strspectrum))
-                        hashfile = hashspectrum.value(strspectrum);
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert( strspectrum, hashfile);
-                    segmentlistmapmet8.insert(strdate, hashspectrum);
-                }
-                else
-                {
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert(strspectrum, hashfile);
-                    segmentlistmapmet8.insert( strdate, hashspectrum );
-                }
-
-            }
-        } else if (fileInfo.fileName().mid( 0, 17) == "L-000-MTP___-MET7" && fileInfo.fileName().mid( 59, 2) == "C_") // Data Channel 3
-        {
-            //L-000-MTP___-MET7________-06_4_057E-000004___-201403300930-C_
-            //L-000-MTP___-MET7________-06_4_057E-PRO______-201404011600-__
-
-            int filenbr = fileInfo.fileName().mid(36, 6).toInt();
-            QString strspectrum = fileInfo.fileName().mid(26, 6);
-            QString strdate = fileInfo.fileName().mid(46, 12);
-            //qDebug() << strdate << strspectrum << QString("%1").arg(filenbr);
-
-            if (strspectrum != "______")
-            {
-                seglmet7->setImagePath(fileInfo.absolutePath());
-
-                QMap<int, QFileInfo> hashfile;
-                QMap<QString, QMap<int, QFileInfo> > hashspectrum;
-
-                if (segmentlistmapmet7.contains(strdate))
-                {
-                    hashspectrum = segmentlistmapmet7.value(strdate);
-                    if (hashspectrum.contains(strspectrum))
-                        hashfile = hashspectrum.value(strspectrum);
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert( strspectrum, hashfile);
-                    segmentlistmapmet7.insert(strdate, hashspectrum);
-                }
-                else
-                {
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert(strspectrum, hashfile);
-                    segmentlistmapmet7.insert( strdate, hashspectrum );
-                }
-
-            }
-        } else if (fileInfo.fileName().mid( 0, 19) == "L-000-MSG3__-GOES13" && fileInfo.fileName().mid( 59, 2) == "C_" &&
-           //        && fileInfo.absolutePath().contains("Data Channel 3", Qt::CaseInsensitive))  // Data Channel 3
-                   (fileInfo.fileName().mid(54, 4) == "0000" ||
-                    fileInfo.fileName().mid(54, 4) == "0300" ||
-                    fileInfo.fileName().mid(54, 4) == "0600" ||
-                    fileInfo.fileName().mid(54, 4) == "0900" ||
-                    fileInfo.fileName().mid(54, 4) == "1200" ||
-                    fileInfo.fileName().mid(54, 4) == "1500" ||
-                    fileInfo.fileName().mid(54, 4) == "1800" ||
-                    fileInfo.fileName().mid(54, 4) == "2100"))
-        {
-            //L-000-MSG3__-GOES13______-00_7_075W-000001___-201404031200-C_
-            //L-000-MSG3__-GOES13______-00_7_075W-PRO______-201404031200-__
-
-            int filenbr = fileInfo.fileName().mid(36, 6).toInt();
-            QString strspectrum = fileInfo.fileName().mid(26, 6);
-            QString strdate = fileInfo.fileName().mid(46, 12);
-            // qDebug() << "Data Channel 3 - GOES13 " << strdate << " " << strspectrum << " " << QString("%1").arg(filenbr);
-
-            if (strspectrum != "______")
-            {
-                seglgoes13dc3->setImagePath(fileInfo.absolutePath());
-
-                QMap<int, QFileInfo> hashfile;
-                QMap<QString, QMap<int, QFileInfo> > hashspectrum;
-
-                if (segmentlistmapgoes13dc3.contains(strdate))
-                {
-                    hashspectrum = segmentlistmapgoes13dc3.value(strdate);
-                    if (hashspectrum.contains(strspectrum))
-                        hashfile = hashspectrum.value(strspectrum);
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert( strspectrum, hashfile);
-                    segmentlistmapgoes13dc3.insert(strdate, hashspectrum);
-                }
-                else
-                {
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert(strspectrum, hashfile);
-                    segmentlistmapgoes13dc3.insert( strdate, hashspectrum );
-                }
-
-            }
+                delete segnoaa;
         }
-        else if (fileInfo.fileName().mid( 0, 19) == "L-000-MSG3__-GOES13" && fileInfo.fileName().mid( 59, 2) == "C_" &&
-              //     && fileInfo.absolutePath().contains("Data Channel 4", Qt::CaseInsensitive))  // Data Channel 4
-                 (fileInfo.fileName().mid(54, 4) == "0100" ||
-                  fileInfo.fileName().mid(54, 4) == "0200" ||
-                  fileInfo.fileName().mid(54, 4) == "0400" ||
-                  fileInfo.fileName().mid(54, 4) == "0500" ||
-                  fileInfo.fileName().mid(54, 4) == "0700" ||
-                  fileInfo.fileName().mid(54, 4) == "0800" ||
-                  fileInfo.fileName().mid(54, 4) == "1000" ||
-                  fileInfo.fileName().mid(54, 4) == "1100" ||
-                  fileInfo.fileName().mid(54, 4) == "1300" ||
-                  fileInfo.fileName().mid(54, 4) == "1400" ||
-                  fileInfo.fileName().mid(54, 4) == "1600" ||
-                  fileInfo.fileName().mid(54, 4) == "1700" ||
-                  fileInfo.fileName().mid(54, 4) == "1900" ||
-                  fileInfo.fileName().mid(54, 4) == "2000" ||
-                  fileInfo.fileName().mid(54, 4) == "2200" ||
-                  fileInfo.fileName().mid(54, 4) == "2300"))
-
+        break;
+    }
+    case SegmentFileDescriptor::FILE_HRP:
+    {
+        seglhrp->SetDirectoryName(desc.absolutepath);
+        QFile file( desc.fileInfo().absoluteFilePath());
+        seghrp = new SegmentHRP(&file,satlist);
+        if(seghrp->segmentok == true)
         {
-            //L-000-MSG3__-GOES13______-00_7_075W-000001___-201404031200-C_
-            //L-000-MSG3__-GOES13______-00_7_075W-PRO______-201404031200-__
-
-            int filenbr = fileInfo.fileName().mid(36, 6).toInt();
-            QString strspectrum = fileInfo.fileName().mid(26, 6);
-            QString strdate = fileInfo.fileName().mid(46, 12);
-
-            if (strspectrum != "______")
-            {
-                seglgoes13dc4->setImagePath(fileInfo.absolutePath());
-
-                QMap<int, QFileInfo> hashfile;
-                QMap<QString, QMap<int, QFileInfo> > hashspectrum;
-
-                if (segmentlistmapgoes13dc4.contains(strdate))
-                {
-                    hashspectrum = segmentlistmapgoes13dc4.value(strdate);
-                    if (hashspectrum.contains(strspectrum))
-                        hashfile = hashspectrum.value(strspectrum);
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert( strspectrum, hashfile);
-                    segmentlistmapgoes13dc4.insert(strdate, hashspectrum);
-                }
-                else
-                {
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert(strspectrum, hashfile);
-                    segmentlistmapgoes13dc4.insert( strdate, hashspectrum );
-                }
-
-            }
+            seghrp->segmentshow = segmentshow;
+            slhrp->append(seghrp);
+            counthrp++;
+            return true;
         }
-        else if (fileInfo.fileName().mid( 0, 19) == "L-000-MSG3__-GOES15" && fileInfo.fileName().mid( 59, 2) == "C_" &&
-              //     fileInfo.absolutePath().contains("Data Channel 3", Qt::CaseInsensitive))   // Data Channel 3
-                 (fileInfo.fileName().mid(54, 4) == "0000" ||
-                  fileInfo.fileName().mid(54, 4) == "0300" ||
-                  fileInfo.fileName().mid(54, 4) == "0600" ||
-                  fileInfo.fileName().mid(54, 4) == "0900" ||
-                  fileInfo.fileName().mid(54, 4) == "1200" ||
-                  fileInfo.fileName().mid(54, 4) == "1500" ||
-                  fileInfo.fileName().mid(54, 4) == "1800" ||
-                  fileInfo.fileName().mid(54, 4) == "2100"))
-
+        else
+            delete seghrp;
+        break;
+    }
+    case SegmentFileDescriptor::FILE_GAC:
+    {
+        seglgac->SetDirectoryName(desc.absolutepath);
+        QFile file( desc.fileInfo().absoluteFilePath());
+        seggac = new SegmentGAC(&file, satlist);
+        if(seggac->segmentok == true)
         {
-            //L-000-MSG3__-GOES15______-00_7_135W-000001___-201404031500-C_
-            //L-000-MSG3__-GOES15______-00_7_135W-PRO______-201404031500-__
-
-            int filenbr = fileInfo.fileName().mid(36, 6).toInt();
-            QString strspectrum = fileInfo.fileName().mid(26, 6);
-            QString strdate = fileInfo.fileName().mid(46, 12);
-            //qDebug() << "GOES15 " << strdate << " " << strspectrum << " " << QString("%1").arg(filenbr);
-
-            if (strspectrum != "______")
-            {
-                seglgoes15dc3->setImagePath(fileInfo.absolutePath());
-
-                QMap<int, QFileInfo> hashfile;
-                QMap<QString, QMap<int, QFileInfo> > hashspectrum;
-
-                if (segmentlistmapgoes15dc3.contains(strdate))
-                {
-                    hashspectrum = segmentlistmapgoes15dc3.value(strdate);
-                    if (hashspectrum.contains(strspectrum))
-                        hashfile = hashspectrum.value(strspectrum);
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert( strspectrum, hashfile);
-                    segmentlistmapgoes15dc3.insert(strdate, hashspectrum);
-                }
-                else
-                {
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert(strspectrum, hashfile);
-                    segmentlistmapgoes15dc3.insert( strdate, hashspectrum );
-                }
-
-            }
-        } else if (fileInfo.fileName().mid( 0, 19) == "L-000-MSG3__-GOES15" && fileInfo.fileName().mid( 59, 2) == "C_" &&
-                //   fileInfo.absolutePath().contains("Data Channel 4", Qt::CaseInsensitive))   // Data Channel 4
-                   (fileInfo.fileName().mid(54, 4) == "0100" ||
-                    fileInfo.fileName().mid(54, 4) == "0200" ||
-                    fileInfo.fileName().mid(54, 4) == "0400" ||
-                    fileInfo.fileName().mid(54, 4) == "0500" ||
-                    fileInfo.fileName().mid(54, 4) == "0700" ||
-                    fileInfo.fileName().mid(54, 4) == "0800" ||
-                    fileInfo.fileName().mid(54, 4) == "1000" ||
-                    fileInfo.fileName().mid(54, 4) == "1100" ||
-                    fileInfo.fileName().mid(54, 4) == "1300" ||
-                    fileInfo.fileName().mid(54, 4) == "1400" ||
-                    fileInfo.fileName().mid(54, 4) == "1600" ||
-                    fileInfo.fileName().mid(54, 4) == "1700" ||
-                    fileInfo.fileName().mid(54, 4) == "1900" ||
-                    fileInfo.fileName().mid(54, 4) == "2000" ||
-                    fileInfo.fileName().mid(54, 4) == "2200" ||
-                    fileInfo.fileName().mid(54, 4) == "2300"))
-
+            seggac->segmentshow = segmentshow;
+            slgac->append(seggac);
+            countgac++;
+            return true;
+        }
+        else
+            delete seggac;
+        break;
+    }
+    case SegmentFileDescriptor::FILE_VIIRSM:
+    {
+        seglviirsm->SetDirectoryName(desc.absolutepath);
+        QFile file( desc.fileInfo().absoluteFilePath());
+        segviirsm = new SegmentVIIRSM(&file, satlist);
+        if(segviirsm->segmentok == true)
         {
-            //L-000-MSG3__-GOES15______-00_7_135W-000001___-201404031500-C_
-            //L-000-MSG3__-GOES15______-00_7_135W-PRO______-201404031500-__
-
-            int filenbr = fileInfo.fileName().mid(36, 6).toInt();
-            QString strspectrum = fileInfo.fileName().mid(26, 6);
-            QString strdate = fileInfo.fileName().mid(46, 12);
-            //qDebug() << "GOES15 " << strdate << " " << strspectrum << " " << QString("%1").arg(filenbr);
-
-            if (strspectrum != "______")
-            {
-                seglgoes15dc4->setImagePath(fileInfo.absolutePath());
-
-                QMap<int, QFileInfo> hashfile;
-                QMap<QString, QMap<int, QFileInfo> > hashspectrum;
-
-                if (segmentlistmapgoes15dc4.contains(strdate))
-                {
-                    hashspectrum = segmentlistmapgoes15dc4.value(strdate);
-                    if (hashspectrum.contains(strspectrum))
-                        hashfile = hashspectrum.value(strspectrum);
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert( strspectrum, hashfile);
-                    segmentlistmapgoes15dc4.insert(strdate, hashspectrum);
-                }
-                else
-                {
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert(strspectrum, hashfile);
-                    segmentlistmapgoes15dc4.insert( strdate, hashspectrum );
-                }
-
-            }
-
-        } else if (fileInfo.fileName().mid( 0, 6) == "IMG_DK")
-            //IMG_DK01B04_201510090000_001.bz2
-            //0123456789012345678901234567890
-            //YYYYMMDDhhmm : YYYY=year, MM=month, DD=day of month, hh=hour, mm=minute
-            //nnnn : ‘_001’-‘_010’ for segmented full earth’s disk image data files
-            //Sequence number is set only for dissemination of the segment files.
+            segviirsm->segmentshow = segmentshow;
+            slviirsm->append(segviirsm);
+            countviirsm++;
+            return true;
+        }
+        else
+            delete segviirsm;
+        break;
+    }
+    case SegmentFileDescriptor::FILE_VIIRSDNB:
+    {
+        //SVDNBC_npp_d20150810_t0033443_e0035085_b19602_c20150824113128000166_eum_ops.h5.bz2
+        seglviirsdnb->SetDirectoryName(desc.absolutepath);
+        QFile file( desc.fileInfo().absoluteFilePath());
+        segviirsdnb = new SegmentVIIRSDNB(&file, satlist);
+        if(segviirsdnb->segmentok == true)
         {
-            int filenbr = fileInfo.fileName().mid(25, 3).toInt();
-            QString strspectrum = fileInfo.fileName().mid(8, 3);
-            QString strdate = fileInfo.fileName().mid(12, 11);
-            // qDebug() << "Himawari-8 " << strdate << " " << strspectrum << " " << QString("%1").arg(filenbr);
-
-            seglh8->setImagePath(fileInfo.absolutePath());
+            segviirsdnb->segmentshow = segmentshow;
+            slviirsdnb->append(segviirsdnb);
+            countviirsdnb++;
+            return true;
+        }
+        else
+            delete segviirsdnb;
+        break;
+    }
+    case SegmentFileDescriptor::FILE_MET10:     // Data Channel 2
+        InsertToGeostationaryMap(segmentlistmapmeteosat, seglmeteosat, desc);
+        return true;
+    case SegmentFileDescriptor::FILE_MET9:      // Data Channel 5
+        InsertToGeostationaryMap(segmentlistmapmeteosatrss, seglmeteosatrss, desc);
+        return true;
+    case SegmentFileDescriptor::FILE_MET8:      // E1B-GEO-1
+        InsertToGeostationaryMap(segmentlistmapmet8, seglmet8, desc);
+        return true;
+    case SegmentFileDescriptor::FILE_MET7:      // Data Channel 3
+        InsertToGeostationaryMap(segmentlistmapmet7, seglmet7, desc);
+        return true;
+    case SegmentFileDescriptor::FILE_GOES13DC3:
+        InsertToGeostationaryMap(segmentlistmapgoes13dc3, seglgoes13dc3, desc);
+        return true;
+    case SegmentFileDescriptor::FILE_GOES13DC4:
+        InsertToGeostationaryMap(segmentlistmapgoes13dc4, seglgoes13dc4, desc);
+        return true;
+    case SegmentFileDescriptor::FILE_GOES15DC3:
+        InsertToGeostationaryMap(segmentlistmapgoes15dc3, seglgoes15dc3, desc);
+        return true;
+    case SegmentFileDescriptor::FILE_GOES15DC4:
+        InsertToGeostationaryMap(segmentlistmapgoes15dc4, seglgoes15dc4, desc);
+        return true;
+    case SegmentFileDescriptor::FILE_H8:
+        InsertToGeostationaryMap(segmentlistmaph8, seglh8, desc);
+        return true;
+    case SegmentFileDescriptor::FILE_FY2E:      // Data Channel 12
+        InsertToGeostationaryMap(segmentlistmapfy2e, seglfy2e, desc);
+        return true;
+    case SegmentFileDescriptor::FILE_FY2G:      // Data Channel 12
+        InsertToGeostationaryMap(segmentlistmapfy2g, seglfy2g, desc);
+        return true;
+    default:
+        break;
+    }
 
-            QMap<int, QFileInfo> hashfile;
-            QMap<QString, QMap<int, QFileInfo> > hashspectrum;
+    return false;
+}
 
-            if (segmentlistmaph8.contains(strdate))
-            {
-                hashspectrum = segmentlistmaph8.value(strdate);
-                if (hashspectrum.contains(strspectrum))
-                    hashfile = hashspectrum.value(strspectrum);
-                hashfile.insert( filenbr, fileInfo );
-                hashspectrum.insert( strspectrum, hashfile);
-                segmentlistmaph8.insert(strdate, hashspectrum);
-            }
-            else
-            {
-                hashfile.insert( filenbr, fileInfo );
-                hashspectrum.insert(strspectrum, hashfile);
-                segmentlistmaph8.insert( strdate, hashspectrum );
-            }
-        } else if (fileInfo.fileName().mid( 0, 14) == "Z_SATE_C_BABJ_" && fileInfo.fileName().mid( 31, 8) == "FY2E_FDI") // Data Channel 12
-        {
-            //0123456789012345678901234567890123456789012345678901234567890
-            //Z_SATE_C_BABJ_20150623131500_O_FY2D_FDI_IR1_001_NOM.HDF.gz
-            //Z_SATE_C_BABJ_20150717080000_O_FY2G_FDI_VIS1KM_001_NOM.HDF.gz
-            int filenbr = fileInfo.fileName().mid(44, 3).toInt();
-            QString strspectrum = fileInfo.fileName().mid(40, 3);
-            if(fileInfo.fileName().mid(40, 6) == "VIS1KM")
-                strspectrum = "VIS1KM";
-
-            QString strdate = fileInfo.fileName().mid(14, 12);
-            //qDebug() << strdate << strspectrum << QString("%1").arg(filenbr);
-
-            if (strspectrum != "______")
-            {
-                seglfy2e->setImagePath(fileInfo.absolutePath());
+void AVHRRSatellite::AddSegmentsToList(QList<SegmentFileDescriptor> desclist)
+{
+    for (int i = 0; i < desclist.size(); ++i)
+    {
+        const SegmentFileDescriptor &desc = desclist.at(i);
 
-                QMap<int, QFileInfo> hashfile;
-                QMap<QString, QMap<int, QFileInfo> > hashspectrum;
+        AddSegmentFile(desc, false);
 
-                if (segmentlistmapfy2e.contains(strdate))
-                {
-                    hashspectrum = segmentlistmapfy2e.value(strdate);
-                    if (hashspectrum.contains(strspectrum))
-                        hashfile = hashspectrum.value(strspectrum);
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert( strspectrum, hashfile);
-                    segmentlistmapfy2e.insert(strdate, hashspectrum);
-                }
-                else
-                {
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert(strspectrum, hashfile);
-                    segmentlistmapfy2e.insert( strdate, hashspectrum );
-                }
-            }
-        }  else if (fileInfo.fileName().mid( 0, 14) == "Z_SATE_C_BABJ_" && fileInfo.fileName().mid( 31, 8) == "FY2G_FDI") // Data Channel 12
+        // The geostationary files are only a map insert, no need to process events for each of them
+        if (!desc.isGeostationary() || (i % 256) == 0)
         {
-            //0123456789012345678901234567890123456789012345678901234567890
-            //Z_SATE_C_BABJ_20150623131500_O_FY2D_FDI_IR1_001_NOM.HDF.gz
-            int filenbr = fileInfo.fileName().mid(44, 3).toInt();
-            QString strspectrum = fileInfo.fileName().mid(40, 3);
-            if(fileInfo.fileName().mid(40, 6) == "VIS1KM")
-                strspectrum = "VIS1KM";
-
-            QString strdate = fileInfo.fileName().mid(14, 12);
-            //qDebug() << strdate << strspectrum << QString("%1").arg(filenbr);
-
-            if (strspectrum != "______")
-            {
-                seglfy2g->setImagePath(fileInfo.absolutePath());
-
-                QMap<int, QFileInfo> hashfile;
-                QMap<QString, QMap<int, QFileInfo> > hashspectrum;
-
-                if (segmentlistmapfy2g.contains(strdate))
-                {
-                    hashspectrum = segmentlistmapfy2g.value(strdate);
-                    if (hashspectrum.contains(strspectrum))
-                        hashfile = hashspectrum.value(strspectrum);
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert( strspectrum, hashfile);
-                    segmentlistmapfy2g.insert(strdate, hashspectrum);
-                }
-                else
-                {
-                    hashfile.insert( filenbr, fileInfo );
-                    hashspectrum.insert(strspectrum, hashfile);
-                    segmentlistmapfy2g.insert( strdate, hashspectrum );
-                }
-
-            }
+            emit signalProgress(i);
+            QApplication::processEvents();
         }
-
-        emit signalProgress(i);
-        QApplication::processEvents();
     }
 }
 
 
 void AVHRRSatellite::ReadDirectories(QDate seldate, int hoursbefore)
 {
-    QFileInfoList fileinfolist; // QList<QFileInfo>
+    TraceSpan span("scan", "AVHRRSatellite::ReadDirectories");
+    QList<SegmentFileDescriptor> desclist;
 
 
     qDebug() << QString("in AVHRRSatellite:ReadDirectories(QDate, int) hoursbefore = %1").arg(hoursbefore);
 
+    selecteddate = seldate;
+
     QApplication::setOverrideCursor( Qt::WaitCursor ); // this might take time
 
     QList<Segment*> *slnoaa = seglnoaa->GetSegmentlistptr();
@@ -743,18 +394,15 @@ void AVHRRSatellite::ReadDirectories(QDate seldate, int hoursbefore)
         {
             if (*itc == "1")  //include checked
             {
-                segmentdir.cd( *its );
-                segmentdir.setFilter(QDir::Files | QDir::NoSymLinks);
-                segmentdir.setSorting(QDir::Name);
-                fileinfolist = segmentdir.entryInfoList();
+                desclist = DirectoryIndex::readDirectory( *its );
 
-                if (fileinfolist.size() > 0)
+                if (desclist.size() > 0)
                 {
-                    emit signalResetProgressbar(fileinfolist.size(), (*its));
+                    emit signalResetProgressbar(desclist.size(), (*its));
                     QApplication::processEvents();
                 }
 
-                qDebug() << QString("fileinfolist.size = %1 in subdir %2").arg(fileinfolist.size()).arg(*its);
+                qDebug() << QString("desclist.size = %1 in subdir %2").arg(desclist.size()).arg(*its);
 
                 QString yeardir = seldate.toString("yyyyMMdd").mid(0, 4);
                 QString monthdir = seldate.toString("yyyyMMdd").mid(4, 2);
@@ -763,17 +411,20 @@ void AVHRRSatellite::ReadDirectories(QDate seldate, int hoursbefore)
                 QString thepath = (*its) + "/" + yeardir + monthdir + daydir;
                 QString thepathYYYYMMDD = (*its) + "/" + yeardir + "/" + monthdir + "/" + daydir;
 
-                if(segmentdir.cd( thepath ) || segmentdir.cd( thepathYYYYMMDD ))
+                if(segmentdir.exists( thepath ))
+                {
+                    desclist.append(DirectoryIndex::readDirectory( thepath ));
+                    qDebug() << QString("desclist.size = %1 in subdir %2").arg(desclist.size()).arg(thepath);
+                }
+                else if(segmentdir.exists( thepathYYYYMMDD ))
                 {
-                    segmentdir.setFilter(QDir::Files | QDir::NoSymLinks);
-                    segmentdir.setSorting(QDir::Name); //::Time);
-                    fileinfolist.append(segmentdir.entryInfoList());
-                    qDebug() << QString("fileinfolist.size = %1 in subdir %2").arg(fileinfolist.size()).arg(thepath);
+                    desclist.append(DirectoryIndex::readDirectory( thepathYYYYMMDD ));
+                    qDebug() << QString("desclist.size = %1 in subdir %2").arg(desclist.size()).arg(thepathYYYYMMDD);
                 }
 
-                QMap<QString, QFileInfo> map;
+                QMap<QString, SegmentFileDescriptor> map;
 
-                InsertToMap(fileinfolist, &map, &noaaTle, &metopTle, &nppTle, 0);
+                InsertToMap(desclist, &map, &noaaTle, &metopTle, &nppTle, 0);
 
                 if(metopTle)
                 {
@@ -833,25 +484,23 @@ void AVHRRSatellite::ReadDirectories(QDate seldate, int hoursbefore)
                             "/" + datebefore.toString( "yyyyMMdd").mid(4, 2) + "/" + datebefore.toString( "yyyyMMdd").mid(6, 2);
                     qDebug() << QString("pathbefore = %1").arg(pathbefore);
 
-                    if(segmentdir.cd( pathbefore ))
+                    if(segmentdir.exists( pathbefore ))
                     {
-                        segmentdir.setFilter(QDir::Files | QDir::NoSymLinks);
-                        segmentdir.setSorting(QDir::Name); //::Time);
-                        fileinfolist = segmentdir.entryInfoList();
-                        qDebug() << QString("fileinfolist.size = %1 in subdir %2").arg(fileinfolist.size()).arg(pathbefore);
-                        InsertToMap(fileinfolist, &map, &noaaTle, &metopTle, &nppTle, hoursbefore);
+                        desclist = DirectoryIndex::readDirectory( pathbefore );
+                        qDebug() << QString("desclist.size = %1 in subdir %2").arg(desclist.size()).arg(pathbefore);
+                        InsertToMap(desclist, &map, &noaaTle, &metopTle, &nppTle, hoursbefore);
 
                     }
                 }
 
 
-                fileinfolist = map.values();
+                desclist = map.values();
 
-                emit signalResetProgressbar(fileinfolist.size(), (*its));
+                emit signalResetProgressbar(desclist.size(), (*its));
 
-                if( fileinfolist.count() > 0)
-                    AddSegmentsToList(fileinfolist);
-                qDebug() << QString("ReadDirectories count = %1").arg(fileinfolist.count());
+                if( desclist.count() > 0)
+                    AddSegmentsToList(desclist);
+                qDebug() << QString("ReadDirectories count = %1").arg(desclist.count());
             }
             ++its;
             ++itc;
@@ -896,166 +545,40 @@ void AVHRRSatellite::ReadDirectories(QDate seldate, int hoursbefore)
     emit signalNothingSelected();
 }
 
-void AVHRRSatellite::InsertToMap(QFileInfoList fileinfolist, QMap<QString, QFileInfo> *map, bool *noaaTle, bool *metopTle, bool *nppTle, int hoursbefore)
+void AVHRRSatellite::InsertToMap(QList<SegmentFileDescriptor> desclist, QMap<QString, SegmentFileDescriptor> *map, bool *noaaTle, bool *metopTle, bool *nppTle, int hoursbefore)
 {
 
-    QDateTime filedate;
     bool fileok = false;
 
-    foreach (const QFileInfo &fileinfo, fileinfolist)
+    foreach (const SegmentFileDescriptor &desc, desclist)
     {
         fileok = false;
 
-        //avhrr_20130701_151100_noaa19
-        if (fileinfo.fileName().mid( 0, 6) == "avhrr_" && fileinfo.fileName().mid( 22, 6) == "noaa19")
+        switch(desc.datekind)
         {
+        case SegmentFileDescriptor::DATE_NOAA:
             *noaaTle = true;
-            QDate d(fileinfo.fileName().mid( 6, 4).toInt(), fileinfo.fileName().mid( 10, 2).toInt(), fileinfo.fileName().mid( 12, 2).toInt());
-            filedate.setDate(d);
-            QTime t(fileinfo.fileName().mid( 15, 2).toInt(), fileinfo.fileName().mid( 17, 2).toInt(), fileinfo.fileName().mid( 19, 2).toInt());
-            filedate.setTime(t);
-            if(hoursbefore == 0)
-                fileok = true;
-            else if(t.hour() >= 24 - hoursbefore)
-                fileok = true;
-        }
-        //AVHR_xxx_1B_M01_20130701051903Z_20130701052203Z_N_O_20130701054640Z
-        //AVHR_GAC_1B_N19_20130701041003Z_20130701041303Z_N_O_20130701054958Z
-        //AVHR_HRP_00_M02_20130701060200Z_20130701060300Z_N_O_20130701061314Z
-        else if (fileinfo.fileName().mid( 0, 11) == "AVHR_GAC_1B" ||
-                 fileinfo.fileName().mid( 0, 11) == "AVHR_HRP_00" ||
-                 fileinfo.fileName().mid( 0, 11) == "AVHR_xxx_1B")
-        {
+            break;
+        case SegmentFileDescriptor::DATE_METOP:
             *metopTle = true;
-            QDate d(fileinfo.fileName().mid( 16, 4).toInt(), fileinfo.fileName().mid( 20, 2).toInt(), fileinfo.fileName().mid( 22, 2).toInt());
-            filedate.setDate(d);
-            QTime t(fileinfo.fileName().mid( 24, 2).toInt(), fileinfo.fileName().mid( 26, 2).toInt(), fileinfo.fileName().mid( 28, 2).toInt());
-            filedate.setTime(t);
-            if(hoursbefore == 0)
-                fileok = true;
-            else if(t.hour() >= 24 - hoursbefore)
-                fileok = true;
-//            if(fileok == true)
-//                qDebug() << fileinfo.fileName().mid( 12, 3) << " " << fileinfo.fileName().mid( 16, 8) << " " << fileinfo.fileName().mid( 24, 6);
-
-        }
-        //SVMC_npp_d20141117_t0837599_e0839241_b15833_c20141117084501709131_eum_ops
-        //SVDNBC_npp_d20151019_t0013359_e0015001_b20595_c20151019002104000944_eum_ops.h5
-        else if (fileinfo.fileName().mid( 0, 8) == "SVMC_npp")
-        {
-            *nppTle = true;
-            QDate d(fileinfo.fileName().mid( 10, 4).toInt(), fileinfo.fileName().mid( 14, 2).toInt(), fileinfo.fileName().mid( 16, 2).toInt());
-            filedate.setDate(d);
-            QTime t(fileinfo.fileName().mid( 20, 2).toInt(), fileinfo.fileName().mid( 22, 2).toInt(), fileinfo.fileName().mid( 24, 2).toInt());
-            filedate.setTime(t);
-            if(hoursbefore == 0)
-                fileok = true;
-            else if(t.hour() >= 24 - hoursbefore)
-                fileok = true;
-        }
-        else if (fileinfo.fileName().mid( 0, 10) == "SVDNBC_npp")
-        {
+            break;
+        case SegmentFileDescriptor::DATE_NPP:
             *nppTle = true;
-            QDate d(fileinfo.fileName().mid( 12, 4).toInt(), fileinfo.fileName().mid( 16, 2).toInt(), fileinfo.fileName().mid( 18, 2).toInt());
-            filedate.setDate(d);
-            QTime t(fileinfo.fileName().mid( 22, 2).toInt(), fileinfo.fileName().mid( 24, 2).toInt(), fileinfo.fileName().mid( 26, 2).toInt());
-            filedate.setTime(t);
-            if(hoursbefore == 0)
-                fileok = true;
-            else if(t.hour() >= 24 - hoursbefore)
-                fileok = true;
+            break;
+        default:
+            break;
         }
 
-        //H-000-MSG3__-MSG3________-HRV______-000001___-201310270845-C_
-        //H-000-MSG1__-MSG1_RSS____-HRV______-000016___-201211210610-C_
-        //H-000-GOMS1_-GOMS1_4_____-00_9_076E-000001___-201312231100-C_
-        //L-000-MTP___-MET7________-06_4_057E-000004___-201403300930-C_
-        //L-000-MSG3__-GOES13______-00_7_075W-000001___-201404031200-C_
-        //L-000-MSG3__-GOES15______-00_7_135W-000001___-201404031500-C_
-        //L-000-MSG3__-MTSAT2______-00_7_145E-000006___-201404032100-C_
-        else if (fileinfo.fileName().mid( 0, 9) == "H-000-MSG" && fileinfo.fileName().mid( 59, 2) == "C_")
-        {
-            QDate d(fileinfo.fileName().mid( 46, 4).toInt(), fileinfo.fileName().mid( 50, 2).toInt(), fileinfo.fileName().mid( 52, 2).toInt());
-            filedate.setDate(d);
-            QTime t(fileinfo.fileName().mid( 54, 2).toInt(), fileinfo.fileName().mid( 56, 2).toInt(), 0);
-            filedate.setTime(t);
-            if(hoursbefore == 0 )
-                fileok = true;
-        }
-        else if (fileinfo.fileName().mid( 0, 11) == "H-000-GOMS1" && fileinfo.fileName().mid( 59, 2) == "C_")
-        {
-            QDate d(fileinfo.fileName().mid( 46, 4).toInt(), fileinfo.fileName().mid( 50, 2).toInt(), fileinfo.fileName().mid( 52, 2).toInt());
-            filedate.setDate(d);
-            QTime t(fileinfo.fileName().mid( 54, 2).toInt(), fileinfo.fileName().mid( 56, 2).toInt(), 0);
-            filedate.setTime(t);
-            if(hoursbefore == 0)
-                fileok = true;
-        }
-        else if (fileinfo.fileName().mid( 0, 17) == "L-000-MTP___-MET7" && fileinfo.fileName().mid( 59, 2) == "C_")
-        {
-            QDate d(fileinfo.fileName().mid( 46, 4).toInt(), fileinfo.fileName().mid( 50, 2).toInt(), fileinfo.fileName().mid( 52, 2).toInt());
-            filedate.setDate(d);
-            QTime t(fileinfo.fileName().mid( 54, 2).toInt(), fileinfo.fileName().mid( 56, 2).toInt(), 0);
-            filedate.setTime(t);
-            if(hoursbefore == 0)
-                fileok = true;
-        }
-        else if (fileinfo.fileName().mid( 0, 19) == "L-000-MSG3__-GOES13" && fileinfo.fileName().mid( 59, 2) == "C_")
-        {
-            QDate d(fileinfo.fileName().mid( 46, 4).toInt(), fileinfo.fileName().mid( 50, 2).toInt(), fileinfo.fileName().mid( 52, 2).toInt());
-            filedate.setDate(d);
-            QTime t(fileinfo.fileName().mid( 54, 2).toInt(), fileinfo.fileName().mid( 56, 2).toInt(), 0);
-            filedate.setTime(t);
-            if(hoursbefore == 0)
-                fileok = true;
-        }
-        else if (fileinfo.fileName().mid( 0, 19) == "L-000-MSG3__-GOES15" && fileinfo.fileName().mid( 59, 2) == "C_")
-        {
-            QDate d(fileinfo.fileName().mid( 46, 4).toInt(), fileinfo.fileName().mid( 50, 2).toInt(), fileinfo.fileName().mid( 52, 2).toInt());
-            filedate.setDate(d);
-            QTime t(fileinfo.fileName().mid( 54, 2).toInt(), fileinfo.fileName().mid( 56, 2).toInt(), 0);
-            filedate.setTime(t);
-            if(hoursbefore == 0)
-                fileok = true;
-        }
-        //0123456789012345678901234567890123456789012345678901234567890
-        //Z_SATE_C_BABJ_20150624130000_O_FY2G_FDI_IR1_001_NOM.HDF.gz
-        else if (fileinfo.fileName().mid( 0, 14) == "Z_SATE_C_BABJ_" && fileinfo.fileName().mid( 31, 8) == "FY2E_FDI") // Data Channel 12
-        {
-            QDate d(fileinfo.fileName().mid( 14, 4).toInt(), fileinfo.fileName().mid( 18, 2).toInt(), fileinfo.fileName().mid( 20, 2).toInt());
-            filedate.setDate(d);
-            QTime t(fileinfo.fileName().mid( 22, 2).toInt(), fileinfo.fileName().mid( 24, 2).toInt(), 0);
-            filedate.setTime(t);
-            if(hoursbefore == 0)
-                fileok = true;
-        }
-        else if (fileinfo.fileName().mid( 0, 14) == "Z_SATE_C_BABJ_" && fileinfo.fileName().mid( 31, 8) == "FY2G_FDI") // Data Channel 12
-        {
-            QDate d(fileinfo.fileName().mid( 14, 4).toInt(), fileinfo.fileName().mid( 18, 2).toInt(), fileinfo.fileName().mid( 20, 2).toInt());
-            filedate.setDate(d);
-            QTime t(fileinfo.fileName().mid( 22, 2).toInt(), fileinfo.fileName().mid( 24, 2).toInt(), 0);
-            filedate.setTime(t);
-            if(hoursbefore == 0)
-                fileok = true;
-        }
-        //IMG_DK01B04_201510090000_001.bz2
-        //0123456789012345678901234567890
-        //YYYYMMDDhhmm : YYYY=year, MM=month, DD=day of month, hh=hour, mm=minute
-        //nnnn : ‘_001’-‘_010’ for segmented full earth’s disk image data files
-        //Sequence number is set only for dissemination of the segment files.
-        else if (fileinfo.fileName().mid( 0, 6) == "IMG_DK") //Data Channel 4
-        {
-            QDate d(fileinfo.fileName().mid( 12, 4).toInt(), fileinfo.fileName().mid( 16, 2).toInt(), fileinfo.fileName().mid( 18, 2).toInt());
-            filedate.setDate(d);
-            QTime t(fileinfo.fileName().mid( 20, 2).toInt(), fileinfo.fileName().mid( 22, 2).toInt(), 0);
-            filedate.setTime(t);
-            if(hoursbefore == 0)
-                fileok = true;
-        }
+        if(desc.datekind == SegmentFileDescriptor::DATE_NONE)
+            continue;
+        else if(hoursbefore == 0)
+            fileok = true;
+        else if(desc.datekind != SegmentFileDescriptor::DATE_GEO && desc.filedate.time().hour() >= 24 - hoursbefore)
+            fileok = true;
 
         if(fileok)
         {
-            *map->insert(fileinfo.fileName(), fileinfo);
+            map->insert(desc.filename, desc);
         }
 
     }
@@ -1183,6 +706,50 @@ void AVHRRSatellite::AddSegmentsToListFromUdp(QByteArray thefilepath)
 
 }
 
+/**
+ * @brief AVHRRSatellite::AddSegmentsToListFromWatcher
+ * @param desclist the files that SegmentDirectoryWatcher found complete
+ *
+ * New polar segments are shown at once, new geostationary segments are added to the timeslot maps.
+ * The watched directories are those of today, the files are left out when the calendar shows another date.
+ */
+void AVHRRSatellite::AddSegmentsToListFromWatcher(QList<SegmentFileDescriptor> desclist)
+{
+    bool added = false;
+    QList<SegmentFileDescriptor> addedgeo;
+
+    if (selecteddate != QDateTime::currentDateTimeUtc().date())
+    {
+        qDebug() << QString("AddSegmentsToListFromWatcher : %1 files not added, the selected date is %2").arg(desclist.size()).arg(selecteddate.toString("yyyy-MM-dd"));
+        return;
+    }
+
+    foreach (const SegmentFileDescriptor &desc, desclist)
+    {
+        if (AddSegmentFile(desc, true))
+        {
+            qDebug() << "AddSegmentsToListFromWatcher : " + desc.filename;
+            added = true;
+            if (desc.isGeostationary())
+                addedgeo.append(desc);
+        }
+    }
+
+    if (!added)
+        return;
+
+    seglmetop->SetTotalSegmentsInDirectory(seglmetop->GetSegmentlistptr()->count());
+    seglnoaa->SetTotalSegmentsInDirectory(seglnoaa->GetSegmentlistptr()->count());
+    seglhrp->SetTotalSegmentsInDirectory(seglhrp->GetSegmentlistptr()->count());
+    seglgac->SetTotalSegmentsInDirectory(seglgac->GetSegmentlistptr()->count());
+    seglviirsm->SetTotalSegmentsInDirectory(seglviirsm->GetSegmentlistptr()->count());
+    seglviirsdnb->SetTotalSegmentsInDirectory(seglviirsdnb->GetSegmentlistptr()->count());
+
+    emit signalAddedSegmentlist();
+    if (addedgeo.size() > 0)
+        emit signalAddedGeostationarySegments(addedgeo);
+}
+
 void AVHRRSatellite::RemoveAllSelectedAVHRR()
 {
     int countsel = 0;
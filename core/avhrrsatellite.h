@@ -22,6 +22,7 @@
 
 #include "segmentimage.h"
 #include "options.h"
+#include "directoryindex.h"
 
 class SegmentList;
 class SegmentListGeostationary;
@@ -40,6 +41,7 @@ public:
     AVHRRSatellite(QObject *parent = 0, SatelliteList *lst = 0);
     void ReadDirectories(QDate seldate, int hoursbefore);
     void AddSegmentsToList(QFileInfoList fileinfolist);
+    void AddSegmentsToList(QList<SegmentFileDescriptor> desclist);
     SegmentListGeostationary *getActiveSegmentList();
     bool SelectedAVHRRSegments();
     bool SelectedVIIRSMSegments();
@@ -110,7 +112,10 @@ public:
 
 private:
 
-    void InsertToMap(QFileInfoList fileinfolist, QMap<QString, QFileInfo> *map, bool *noaaTle, bool *metopTle, bool *nppTle, int hoursbefore);
+    void InsertToMap(QList<SegmentFileDescriptor> desclist, QMap<QString, SegmentFileDescriptor> *map, bool *noaaTle, bool *metopTle, bool *nppTle, int hoursbefore);
+    bool AddSegmentFile(const SegmentFileDescriptor &desc, bool segmentshow);
+    void InsertToGeostationaryMap(QMap<QString, QMap<QString, QMap< int, QFileInfo > > > &segmentlistmap,
+                                  SegmentListGeostationary *sl, const SegmentFileDescriptor &desc);
 
     SatelliteList *satlist;
     long nbrofpointsselected;
@@ -122,17 +127,20 @@ private:
     long countviirsdnb;
     long countviirsmdnb;
     bool showallsegments;
+    QDate selecteddate;     // of the last ReadDirectories, the watcher only adds files when it is today
 
 signals:
     void signalProgress(int progress); // in formephem
     void signalResetProgressbar(int max, const QString &text);
     void signalAddedSegmentlist(void);
+    void signalAddedGeostationarySegments(QList<SegmentFileDescriptor> desclist);
     void signalNothingSelected(void);
     //void signalMeteosatSegment(QString, QString, int);
     void progressCounter(int);
 
 public slots:
     void AddSegmentsToListFromUdp(QByteArray thefilepath);
+    void AddSegmentsToListFromWatcher(QList<SegmentFileDescriptor> desclist);
 
 };
 
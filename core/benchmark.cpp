@@ -0,0 +1,610 @@
+#include "benchmark.h"
+#include "avhrrsatellite.h"
+#include "segmentmetop.h"
+#include "segmentviirsm.h"
+#include "segmentlistgeostationary.h"
+#include "generalverticalperspective.h"
+#include "lambertconformalconic.h"
+#include "stereographic.h"
+#include "pixgeoconversion.h"
+#include "segmentimage.h"
+#include "options.h"
+#include "globals.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <QMutex>
+
+#include <hdf5/serial/hdf5.h>
+#include "bzlib.h"
+
+extern Options opts;
+extern SegmentImage *imageptrs;
+extern QMutex g_mutex;
+
+// Metop-A and Suomi NPP at the time of the synthetic input, 2015-10-11 12:00 UTC
+static const char *benchmarktle =
+        "METOP-A\n"
+        "1 29499U 06044A   15284.50000000  .00000000  00000-0  00000-0 0  9990\n"
+        "2 29499  98.7000 340.0000 0001000  90.0000 270.0000 14.21500000470000\n"
+        "SUOMI NPP\n"
+        "1 37849U 11061A   15284.50000000  .00000000  00000-0  00000-0 0  9990\n"
+        "2 37849  98.7000 340.0000 0001000  90.0000 270.0000 14.19500000200000\n";
+
+static const char *metopfile = "AVHR_xxx_1B_M02_20151011120000Z_20151011120300Z_N_O_20151011121500Z";
+static const char *viirsmfile = "SVMC_npp_d20151011_t1200000_e1201222_b20000_c20151011121500000000_eum_ops.h5.bz2";
+
+static const int metopmphrlength = 3307;        // record header included
+static const int metopmdrlength = 26660;
+static const int hritsegments = 8;
+static const int hritcolumns = 3712;
+static const int hritlines = 464;
+static const int projectionsize = 1024;
+
+static void putUInt16(char *buf, quint16 val)
+{
+    buf[0] = (char)(val >> 8);
+    buf[1] = (char)(val & 0xFF);
+}
+
+static void putUInt32(char *buf, quint32 val)
+{
+    buf[0] = (char)(val >> 24);
+    buf[1] = (char)((val >> 16) & 0xFF);
+    buf[2] = (char)((val >> 8) & 0xFF);
+    buf[3] = (char)(val & 0xFF);
+}
+
+static void putUInt64(char *buf, quint64 val)
+{
+    putUInt32(buf, (quint32)(val >> 32));
+    putUInt32(buf + 4, (quint32)(val & 0xFFFFFFFF));
+}
+
+// the ASCII value of a MPHR field at its offset in the record
+static void putField(QByteArray &record, int pos, const QString &text)
+{
+    record.replace(pos, text.length(), text.toLatin1());
+}
+
+// AVHRR counts, different for every channel and never at the edge of the 10 bit range
+static quint16 avhrrCount(int channel, int line, int pixel)
+{
+    return (quint16)(12 + (pixel * 3 + line * 5 + channel * 97) % 1000);
+}
+
+Benchmark::Benchmark(const QStringList &arguments) :
+    out(stdout)
+{
+    runs = 3;
+    peakreset = false;
+    satlist = NULL;
+    segs = NULL;
+
+    int index = arguments.indexOf("--benchmark");
+    if(index >= 0 && index + 1 < arguments.count() && !arguments.at(index + 1).startsWith("-"))
+        workdir = arguments.at(index + 1);
+
+    index = arguments.indexOf("--runs");
+    if(index >= 0 && index + 1 < arguments.count())
+        runs = qMax(1, arguments.at(index + 1).toInt());
+}
+
+Benchmark::~Benchmark()
+{
+    delete segs;
+    delete satlist;
+}
+
+int Benchmark::run()
+{
+    QTemporaryDir tempdir;
+    if(workdir.isEmpty())
+    {
+        if(!tempdir.isValid())
+        {
+            qWarning() << "Benchmark : no temporary directory";
+            return 1;
+        }
+        workdir = tempdir.path();
+    }
+
+    QDir dir(workdir);
+    if(!dir.mkpath("."))
+    {
+        qWarning() << QString("Benchmark : can not create %1").arg(workdir);
+        return 1;
+    }
+
+    // the VIIRS granules are unpacked in the working directory
+    QString previousdir = QDir::currentPath();
+    QDir::setCurrent(dir.absolutePath());
+
+    // the same settings for every run, nothing is rendered on the globe
+    opts.tlelist = QStringList() << dir.absoluteFilePath("benchmark.tle");
+    opts.buttonMetop = true;
+    opts.buttonNoaa = false;
+    opts.buttonGAC = false;
+    opts.buttonHRP = false;
+    opts.channellistmetop = QStringList() << "3" << "2" << "1" << "0" << "0";
+    opts.metop_invlist = QStringList() << "0" << "0" << "0" << "0" << "0";
+    opts.imageontextureOnAVHRR = false;
+    opts.imageontextureOnVIIRS = false;
+    opts.imageontextureOnMet = false;
+    opts.sattrackinimage = false;
+    opts.regionofinterest = false;
+
+    out << QString("EUMETCastView benchmark, input in %1, best of %2 runs").arg(dir.absolutePath()).arg(runs) << endl;
+
+    QStringList hritpaths;
+    for(int i = 1; i <= hritsegments; i++)
+        hritpaths << dir.absoluteFilePath(QString("H-000-MSG3__-MSG3________-IR_108___-%1___-201510111200-__").arg(i, 6, 10, QChar('0')));
+
+    bool ok = writeTle(dir.absoluteFilePath("benchmark.tle")) && writeMetop(dir.absoluteFilePath(metopfile)) &&
+            writeVIIRSM(dir.absoluteFilePath(viirsmfile));
+    for(int i = 0; i < hritpaths.count() && ok; i++)
+        ok = writeHRIT(hritpaths.at(i), i + 1);
+
+    if(!ok)
+    {
+        qWarning() << "Benchmark : the input could not be written";
+        QDir::setCurrent(previousdir);
+        return 1;
+    }
+
+    satlist = new SatelliteList();
+    segs = new AVHRRSatellite(NULL, satlist);
+
+    out << QString("%1 %2 %3 %4 %5").arg("stage", -28).arg("size", -22).arg("ms", 10).arg("throughput", 20).arg("peak MB", 10) << endl;
+
+    benchMetop(dir.absoluteFilePath(metopfile));
+    benchVIIRSM(dir.absoluteFilePath(viirsmfile));
+    benchHRIT(hritpaths);
+    benchProjections();
+
+    QDir::setCurrent(previousdir);
+    return 0;
+}
+
+bool Benchmark::writeTle(const QString &path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+    file.write(benchmarktle);
+    return true;
+}
+
+// MPHR and 1080 MDR records of 2048 earth views, a pass from north to south over Europe
+bool Benchmark::writeMetop(const QString &path)
+{
+    BZFILE *b;
+    if((b = BZ2_bzopen(path.toLatin1(), "wb")) == NULL)
+        return false;
+
+    QByteArray mphr(metopmphrlength, 0);
+    mphr[0] = 0x01;
+    putUInt32(mphr.data() + 4, metopmphrlength);
+
+    QByteArray payload(metopmphrlength - 20, ' ');
+    putField(payload, 712, "20151011120000Z");
+    putField(payload, 760, "20151011120300Z");
+    putField(payload, 1389, "46000");
+    putField(payload, 1509, "20151011120000Z");
+    putField(payload, 1560, "07195000000");     // semi major axis, mm
+    putField(payload, 1604, "00000001000");     // eccentricity x 10^6
+    putField(payload, 1648, "00000098700");     // degrees x 1000
+    putField(payload, 1692, "00000090000");
+    putField(payload, 1736, "00000340000");
+    putField(payload, 1780, "00000270000");
+    putField(payload, 2396, "00000070000");
+    putField(payload, 2440, "00000020000");
+    putField(payload, 2484, "00000060000");
+    putField(payload, 2528, "00000017000");
+    mphr.replace(20, payload.length(), payload);
+
+    BZ2_bzwrite(b, mphr.data(), mphr.length());
+
+    QByteArray mdr(metopmdrlength, 0);
+    char *rec = mdr.data() + 20;        // the offsets are in the record without its header
+    mdr[0] = 0x08;
+    putUInt32(mdr.data() + 4, metopmdrlength);
+
+    for(int line = 0; line < 1080; line++)
+    {
+        double lat = 70.0 - 30.0 * line / 1080.0;
+
+        putUInt16(rec + 2, 2048);
+        for(int k = 0; k < 5; k++)
+            for(int pixel = 0; pixel < 2048; pixel++)
+                putUInt16(rec + 4 + k * 4096 + pixel * 2, avhrrCount(k, line, pixel));
+
+        putUInt32(rec + 20498, 8170);
+        putUInt32(rec + 20518, (quint32)(lat * 10000));
+        putUInt32(rec + 20522, (quint32)(2.0 * 10000));
+        putUInt32(rec + 20526, (quint32)(lat * 10000));
+        putUInt32(rec + 20530, (quint32)(38.0 * 10000));
+        putUInt16(rec + 20534, 103);
+        for(int i = 0; i < 103; i++)
+        {
+            putUInt16(rec + 20536 + i * 8, 5000 + i * 10);
+            putUInt32(rec + 21360 + i * 8, (quint32)(lat * 10000));
+            putUInt32(rec + 21364 + i * 8, (quint32)((2.0 + 36.0 * i / 102.0) * 10000));
+        }
+        rec[26591] = (char)0x80;        // channel 3a
+
+        BZ2_bzwrite(b, mdr.data(), mdr.length());
+    }
+
+    BZ2_bzclose(b);
+    return true;
+}
+
+// One uncompressed segment of the full disc, samples in the order meteosatlib copies them
+bool Benchmark::writeHRIT(const QString &path, int segment)
+{
+    const int headerlength = 16 + 9 + 13;
+    const qint64 datalength = (qint64)hritcolumns * hritlines * sizeof(quint16);
+
+    QByteArray header(headerlength, 0);
+    char *pnt = header.data();
+
+    pnt[0] = 0;                                 // primary header
+    putUInt16(pnt + 1, 16);
+    pnt[3] = 0;                                 // image data
+    putUInt32(pnt + 4, headerlength);
+    putUInt64(pnt + 8, datalength * 8);
+    pnt += 16;
+
+    pnt[0] = 1;                                 // image structure
+    putUInt16(pnt + 1, 9);
+    pnt[3] = 10;
+    putUInt16(pnt + 4, hritcolumns);
+    putUInt16(pnt + 6, hritlines);
+    pnt[8] = 0;                                 // no compression
+    pnt += 9;
+
+    pnt[0] = (char)128;                         // segment identification
+    putUInt16(pnt + 1, 13);
+    putUInt16(pnt + 3, 324);                    // MSG3
+    pnt[5] = 9;                                 // IR_108
+    putUInt16(pnt + 6, segment);
+    putUInt16(pnt + 8, 1);
+    putUInt16(pnt + 10, hritsegments);
+    pnt[12] = 3;
+
+    QVector<quint16> samples(hritcolumns * hritlines);
+    for(int line = 0; line < hritlines; line++)
+    {
+        int y = (segment - 1) * hritlines + line;
+        for(int x = 0; x < hritcolumns; x++)
+            samples[line * hritcolumns + x] = (quint16)(100 + (x * 7 + y * 3) % 900);
+    }
+
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(header);
+    file.write((const char *)samples.constData(), datalength);
+    return true;
+}
+
+static void writeDataset(hid_t group, const char *name, hid_t type, int rows, int cols, const void *data)
+{
+    hsize_t dims[2] = { (hsize_t)rows, (hsize_t)cols };
+    hid_t space = H5Screate_simple(cols > 0 ? 2 : 1, dims, NULL);
+    hid_t dataset = H5Dcreate2(group, name, type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    H5Dwrite(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+    H5Dclose(dataset);
+    H5Sclose(space);
+}
+
+static void writeAttribute(hid_t dataset, const char *name, hid_t type, const void *value)
+{
+    hid_t space = H5Screate(H5S_SCALAR);
+    hid_t attribute = H5Acreate2(dataset, name, type, space, H5P_DEFAULT, H5P_DEFAULT);
+    H5Awrite(attribute, type, value);
+    H5Aclose(attribute);
+    H5Sclose(space);
+}
+
+// The geolocation and the M15 radiances of one granule, compressed as on EUMETCast
+bool Benchmark::writeVIIRSM(const QString &path)
+{
+    QString h5path = QFileInfo(path).absolutePath() + "/benchmark_viirsm.h5";
+
+    hid_t file = H5Fcreate(h5path.toLatin1(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    if(file < 0)
+        return false;
+
+    hid_t alldata = H5Gcreate2(file, "/All_Data", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    hid_t geo = H5Gcreate2(file, "/All_Data/VIIRS-MOD-GEO_All", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    hid_t sdr = H5Gcreate2(file, "/All_Data/VIIRS-M15-SDR_All", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+    QVector<float> lat(96 * 201), lon(96 * 201), coef(200, 0.0f);
+    for(int i = 0; i < 96; i++)
+    {
+        for(int j = 0; j < 201; j++)
+        {
+            lat[i * 201 + j] = 55.0f - 10.0f * i / 95.0f;
+            lon[i * 201 + j] = -10.0f + 30.0f * j / 200.0f;
+        }
+    }
+    writeDataset(geo, "Latitude", H5T_NATIVE_FLOAT, 96, 201, lat.constData());
+    writeDataset(geo, "Longitude", H5T_NATIVE_FLOAT, 96, 201, lon.constData());
+    writeDataset(geo, "AlignmentCoefficient", H5T_NATIVE_FLOAT, 200, 0, coef.constData());
+    writeDataset(geo, "ExpansionCoefficient", H5T_NATIVE_FLOAT, 200, 0, coef.constData());
+
+    QVector<quint16> radiance(768 * 3200);
+    for(int j = 0; j < 768; j++)
+        for(int i = 0; i < 3200; i++)
+            radiance[j * 3200 + i] = (quint16)(1000 + (i * 11 + j * 17) % 30000);
+    writeDataset(sdr, "Radiance", H5T_NATIVE_USHORT, 768, 3200, radiance.constData());
+
+    hid_t dataset = H5Dopen2(sdr, "Radiance", H5P_DEFAULT);
+    int threshold = 65528;
+    float offset = 0.0f;
+    float scale = 0.0002f;
+    writeAttribute(dataset, "Threshold", H5T_NATIVE_INT, &threshold);
+    writeAttribute(dataset, "RadianceOffsetHigh", H5T_NATIVE_FLOAT, &offset);
+    writeAttribute(dataset, "RadianceOffsetLow", H5T_NATIVE_FLOAT, &offset);
+    writeAttribute(dataset, "RadianceScaleHigh", H5T_NATIVE_FLOAT, &scale);
+    writeAttribute(dataset, "RadianceScaleLow", H5T_NATIVE_FLOAT, &scale);
+    H5Dclose(dataset);
+
+    H5Gclose(sdr);
+    H5Gclose(geo);
+    H5Gclose(alldata);
+    H5Fclose(file);
+
+    bool ok = compressBz2(h5path, path);
+    QFile::remove(h5path);
+    return ok;
+}
+
+bool Benchmark::compressBz2(const QString &in, const QString &outpath)
+{
+    QFile filein(in);
+    if(!filein.open(QIODevice::ReadOnly))
+        return false;
+
+    BZFILE *b;
+    if((b = BZ2_bzopen(outpath.toLatin1(), "wb")) == NULL)
+        return false;
+
+    while(!filein.atEnd())
+    {
+        QByteArray buf = filein.read(32768);
+        BZ2_bzwrite(b, buf.data(), buf.length());
+    }
+
+    BZ2_bzclose(b);
+    return true;
+}
+
+void Benchmark::benchMetop(const QString &path)
+{
+    double bytes = metopmphrlength + 1080.0 * metopmdrlength;
+    double pixels = 2048.0 * 1080;
+    double readbest = -1, normalizebest = -1, composebest = -1;
+    double readpeak = -1, normalizepeak = -1, composepeak = -1;
+    QElapsedTimer timer;
+
+    for(int run = 0; run < runs; run++)
+    {
+        QFile file(path);
+        SegmentMetop *segm = new SegmentMetop(&file, satlist);
+        segm->setStartLineNbr(0);
+        segm->initializeMemory();
+
+        startStage(timer);
+        segm->ReadSegmentInMemory();
+        double msecs = timer.nsecsElapsed() / 1.0e6;
+        readbest = (readbest < 0 ? msecs : qMin(readbest, msecs));
+        readpeak = qMax(readpeak, stagePeakMB());
+
+        // as SegmentList::readfinished for a single segment
+        startStage(timer);
+        for(int k = 0; k < 5; k++)
+        {
+            segm->list_stat_min_ch[k] = segm->stat_min_ch[k];
+            segm->list_stat_max_ch[k] = segm->stat_max_ch[k];
+        }
+        segm->NormalizeSegment(false);
+        msecs = timer.nsecsElapsed() / 1.0e6;
+        normalizebest = (normalizebest < 0 ? msecs : qMin(normalizebest, msecs));
+        normalizepeak = qMax(normalizepeak, stagePeakMB());
+
+        for(int k = 0; k < 5; k++)
+            for(int i = 0; i < 1024; i++)
+                imageptrs->lut_ch[k][i] = segm->lut_ch[k][i];
+
+        startStage(timer);
+        imageptrs->InitializeAVHRRImages(2048, 1080);
+        imageptrs->SetupChannelInverse();
+        imageptrs->SetupChannelLUT();
+        segm->ComposeSegmentImage();
+        msecs = timer.nsecsElapsed() / 1.0e6;
+        composebest = (composebest < 0 ? msecs : qMin(composebest, msecs));
+        composepeak = qMax(composepeak, stagePeakMB());
+
+        delete segm;
+    }
+
+    report("Metop ReadSegmentInMemory", "2048 x 1080 x 5", readbest, bytes / 1.0e6, "MB/s", readpeak);
+    report("Metop NormalizeSegment", "2048 x 1080 x 5", normalizebest, pixels / 1.0e6, "Mpixel/s", normalizepeak);
+    report("Metop ComposeSegmentImage", "2048 x 1080", composebest, pixels / 1.0e6, "Mpixel/s", composepeak);
+}
+
+void Benchmark::benchVIIRSM(const QString &path)
+{
+    QList<bool> band;
+    QList<int> color;
+    QList<bool> invert;
+    for(int i = 0; i <= 16; i++)
+        band << (i == 15);
+    for(int i = 0; i < 16; i++)
+    {
+        color << 0;
+        invert << false;
+    }
+
+    double bytes = 2.0 * 768 * 3200 + 2 * 4.0 * 96 * 201;
+    double best = -1, peak = -1;
+    QElapsedTimer timer;
+
+    for(int run = 0; run < runs; run++)
+    {
+        QFile file(path);
+        SegmentVIIRSM *segm = new SegmentVIIRSM(&file, satlist);
+        segm->setBandandColor(band, color, invert);
+        segm->setStartLineNbr(0);
+        segm->initializeMemory();
+
+        startStage(timer);
+        segm->ReadSegmentInMemory();
+        double msecs = timer.nsecsElapsed() / 1.0e6;
+        best = (best < 0 ? msecs : qMin(best, msecs));
+        peak = qMax(peak, stagePeakMB());
+
+        delete segm;
+    }
+
+    QFile::remove(QFileInfo(path).baseName() + ".h5");
+
+    report("VIIRS M ReadSegmentInMemory", "3200 x 768 M15", best, bytes / 1.0e6, "MB/s", peak);
+}
+
+// The segments are decoded on the decode pool, as when a cycle is chosen in FormGeostationary
+void Benchmark::benchHRIT(const QStringList &paths)
+{
+    SegmentListGeostationary *sl = segs->seglmeteosat;
+    sl->setKindofImage("VIS_IR");
+    sl->setGeoSatellite(SegmentListGeostationary::MET_10);
+    sl->COFF = COFF_NONHRV;
+    sl->LOFF = LOFF_NONHRV;
+    sl->CFAC = CFAC_NONHRV;
+    sl->LFAC = LFAC_NONHRV;
+
+    QVector<QString> spectrumvector(3);
+    spectrumvector[0] = "IR_108";
+    QVector<bool> inversevector(3, false);
+    inversevector[0] = true;
+
+    double pixels = (double)hritcolumns * hritlines * paths.count();
+    double best = -1, peak = -1;
+    QElapsedTimer timer;
+
+    for(int run = 0; run < runs; run++)
+    {
+        sl->ResetSegments();
+        imageptrs->ResetPtrImage();
+        imageptrs->InitializeImageGeostationary(hritcolumns, hritlines * hritsegments);
+
+        startStage(timer);
+        for(int i = 0; i < paths.count(); i++)
+            sl->ComposeImageXRIT(QFileInfo(paths.at(i)), spectrumvector, inversevector);
+        for(int i = 0; i < paths.count(); i++)
+            sl->watcherRed[i].waitForFinished();
+        double msecs = timer.nsecsElapsed() / 1.0e6;
+        best = (best < 0 ? msecs : qMin(best, msecs));
+        peak = qMax(peak, stagePeakMB());
+    }
+
+    report("HRIT ComposeImageXRIT", QString("%1 x %2").arg(hritcolumns).arg(hritlines * hritsegments), best, pixels / 1.0e6, "Mpixel/s", peak);
+}
+
+// The full disc of benchHRIT on the three projections at a fixed size
+void Benchmark::benchProjections()
+{
+    imageptrs->gvp = new GeneralVerticalPerspective(NULL, segs);
+    imageptrs->lcc = new LambertConformalConic(NULL, segs);
+    imageptrs->sg = new StereoGraphic(NULL, segs);
+
+    QString size = QString("%1 x %1").arg(projectionsize);
+    double pixels = (double)projectionsize * projectionsize;
+    double gvpbest = -1, lccbest = -1, sgbest = -1;
+    double gvppeak = -1, lccpeak = -1, sgpeak = -1;
+    QElapsedTimer timer;
+
+    for(int run = 0; run < runs; run++)
+    {
+        imageptrs->gvp->Initialize(0.0, 30.0, 36000, 1.0, projectionsize, projectionsize);
+        startStage(timer);
+        imageptrs->gvp->CreateMapFromGeoStationary();
+        double msecs = timer.nsecsElapsed() / 1.0e6;
+        gvpbest = (gvpbest < 0 ? msecs : qMin(gvpbest, msecs));
+        gvppeak = qMax(gvppeak, stagePeakMB());
+
+        imageptrs->lcc->Initialize(R_MAJOR_A_WGS84, R_MAJOR_B_WGS84, 20, 60, 0, 45, projectionsize, projectionsize, 0, 0);
+        startStage(timer);
+        imageptrs->lcc->CreateMapFromGeostationary();
+        msecs = timer.nsecsElapsed() / 1.0e6;
+        lccbest = (lccbest < 0 ? msecs : qMin(lccbest, msecs));
+        lccpeak = qMax(lccpeak, stagePeakMB());
+
+        imageptrs->sg->Initialize(0.0, 50.0, 1.0, projectionsize, projectionsize, 0, 0);
+        startStage(timer);
+        imageptrs->sg->CreateMapFromGeostationary();
+        msecs = timer.nsecsElapsed() / 1.0e6;
+        sgbest = (sgbest < 0 ? msecs : qMin(sgbest, msecs));
+        sgpeak = qMax(sgpeak, stagePeakMB());
+    }
+
+    report("GVP CreateMapFromGeoStationary", size, gvpbest, pixels / 1.0e6, "Mpixel/s", gvppeak);
+    report("LCC CreateMapFromGeostationary", size, lccbest, pixels / 1.0e6, "Mpixel/s", lccpeak);
+    report("SG CreateMapFromGeostationary", size, sgbest, pixels / 1.0e6, "Mpixel/s", sgpeak);
+
+    delete imageptrs->gvp;
+    delete imageptrs->lcc;
+    delete imageptrs->sg;
+    imageptrs->gvp = NULL;
+    imageptrs->lcc = NULL;
+    imageptrs->sg = NULL;
+}
+
+// VmHWM is the high water mark of the whole process. Writing 5 to clear_refs sets it back to the
+// resident memory of now, so the peak read after a stage belongs to that stage.
+void Benchmark::startStage(QElapsedTimer &timer)
+{
+    QFile file("/proc/self/clear_refs");
+    peakreset = file.open(QIODevice::WriteOnly) && file.write("5") == 1;
+    file.close();
+    timer.start();
+}
+
+// The peak of the stage, -1 when the high water mark could not be reset
+double Benchmark::stagePeakMB() const
+{
+    return peakreset ? peakMemoryMB() : -1;
+}
+
+void Benchmark::report(const QString &stage, const QString &size, double msecs, double amount, const QString &unit, double peak)
+{
+    out << QString("%1 %2 %3 %4 %5")
+           .arg(stage, -28)
+           .arg(size, -22)
+           .arg(msecs, 10, 'f', 1)
+           .arg(QString("%1 %2").arg(msecs > 0 ? amount * 1000.0 / msecs : 0.0, 0, 'f', 1).arg(unit), 20)
+           .arg(peak < 0 ? QString("n/a") : QString::number(peak, 'f', 1), 10) << endl;
+}
+
+// The high water mark of the resident memory of the process, -1 when it is not known
+double Benchmark::peakMemoryMB()
+{
+    QFile file("/proc/self/status");
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return -1;
+
+    QByteArray line;
+    while(!(line = file.readLine()).isEmpty())
+    {
+        if(line.startsWith("VmHWM:"))
+            return line.mid(6).trimmed().split(' ').first().toDouble() / 1024.0;
+    }
+    return -1;
+}
@@ -0,0 +1,56 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QElapsedTimer>
+
+class SatelliteList;
+class AVHRRSatellite;
+
+// Timing of the decode, compose and projection stages on synthetic input, without the main window.
+// The input is written once by the generators : a Metop AVHRR EPS bz2 file, a full disc of uncompressed
+// MSG IR_108 HRIT segments and a VIIRS M band granule. The data is the same on every run, so the results
+// of two releases on the same machine can be compared.
+//
+//   EUMETCastView --benchmark [directory] [--runs n]
+//
+// The offscreen platform is used, no display is needed. Without a directory the input is written
+// in a temporary directory that is removed afterwards. The results go to stdout.
+// The options are changed for the run only and are not saved.
+class Benchmark
+{
+public:
+    Benchmark(const QStringList &arguments);
+    ~Benchmark();
+
+    int run();
+
+private:
+    bool writeTle(const QString &path);
+    bool writeMetop(const QString &path);
+    bool writeHRIT(const QString &path, int segment);
+    bool writeVIIRSM(const QString &path);
+    bool compressBz2(const QString &in, const QString &outpath);
+
+    void benchMetop(const QString &path);
+    void benchVIIRSM(const QString &path);
+    void benchHRIT(const QStringList &paths);
+    void benchProjections();
+
+    void startStage(QElapsedTimer &timer);
+    double stagePeakMB() const;
+    void report(const QString &stage, const QString &size, double msecs, double amount, const QString &unit, double peak);
+    static double peakMemoryMB();
+
+    QString workdir;
+    int runs;
+    bool peakreset;     // the high water mark was reset when the stage started
+
+    SatelliteList *satlist;
+    AVHRRSatellite *segs;
+    QTextStream out;
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,63 @@
+#include "calibrationengine.h"
+#include "MSG_data_RadiometricProc.h"
+
+#include <QDebug>
+#include <cmath>
+
+CalibrationEngine::CalibrationEngine()
+{
+}
+
+// The prologue is the same for every image of a cycle, a second setup with the same file keeps the tables
+void CalibrationEngine::setup(MSG_data_RadiometricProc &radiometricproc, QString prologuefile)
+{
+    if(prologuefile == this->prologuefile && !tables[0].isEmpty())
+        return;
+
+    for(int channel = 4; channel <= 11; channel++)
+    {
+        float *calib = radiometricproc.get_calibration(channel, 10);
+        QVector<float> &lut = tables[channel - 4];
+        lut.resize(CALIBRATION_COUNTS);
+
+        lut[0] = -1.0;
+        for(int count = 1; count < CALIBRATION_COUNTS; count++)
+        {
+            float bt = calib[count];
+            lut[count] = (std::isfinite(bt) && bt > 0.0 ? bt : -1.0);
+        }
+        delete [] calib;
+
+        qDebug() << QString("CalibrationEngine::setup channel %1 slope = %2 offset = %3 BT(1) = %4 BT(1023) = %5")
+                    .arg(channel).arg(radiometricproc.ImageCalibration[channel - 1].Cal_Slope)
+                    .arg(radiometricproc.ImageCalibration[channel - 1].Cal_Offset).arg(lut[1]).arg(lut[CALIBRATION_COUNTS - 1]);
+    }
+
+    this->prologuefile = prologuefile;
+}
+
+void CalibrationEngine::invalidate()
+{
+    for(int i = 0; i < 8; i++)
+        tables[i].clear();
+    prologuefile.clear();
+}
+
+// NULL for the visible channels, HRV and without a prologue
+const float *CalibrationEngine::table(QString filespectrum) const
+{
+    int channel = channelFromSpectrum(filespectrum);
+    if(channel < 4 || channel > 11 || tables[channel - 4].isEmpty())
+        return NULL;
+    return tables[channel - 4].constData();
+}
+
+int CalibrationEngine::channelFromSpectrum(QString filespectrum)
+{
+    static const char *spectrums[12] = { "VIS006", "VIS008", "IR_016", "IR_039", "WV_062", "WV_073",
+                                         "IR_087", "IR_097", "IR_108", "IR_120", "IR_134", "HRV___" };
+    for(int i = 0; i < 12; i++)
+        if(filespectrum == spectrums[i])
+            return i + 1;
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef CALIBRATIONENGINE_H
+#define CALIBRATIONENGINE_H
+
+#include <QVector>
+#include <QString>
+
+class MSG_data_RadiometricProc;
+
+#define CALIBRATION_COUNTS 1024     // 10 bit counts of the MSG channels
+
+// Count to brightness temperature tables of the MSG infrared channels 4 to 11, built from the
+// Cal_Slope and Cal_Offset of the prologue and the Planck constants of MSG_data_RadiometricProc.
+// The tables are built once per prologue, composing a segment is then a lookup per pixel.
+// Counts without a valid radiance (space) get -1.0, the no data value of ptrProjectionBrightnessTemp.
+class CalibrationEngine
+{
+public:
+    CalibrationEngine();
+
+    void setup(MSG_data_RadiometricProc &radiometricproc, QString prologuefile);
+    void invalidate();
+    const float *table(QString filespectrum) const;
+
+    static int channelFromSpectrum(QString filespectrum);
+
+private:
+    QString prologuefile;
+    QVector<float> tables[8];   // channels 4 to 11, empty when not calibrated
+};
+
+#endif // CALIBRATIONENGINE_H
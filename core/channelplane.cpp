@@ -0,0 +1,88 @@
+#include "channelplane.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+
+struct PlaneImageJob {
+    const ChannelPlane *plane;
+    QImage *image;
+    const quint16 *lut;
+    int shift;
+    bool inverse;
+    int first;          // first row
+    int last;           // one past the last row
+};
+
+static void doPlaneImageRows(PlaneImageJob &job)
+{
+    for(int y = job.first; y < job.last; y++)
+        job.plane->toRgbLine(y, job.lut, job.shift, job.inverse, (QRgb *)job.image->scanLine(y));
+}
+
+ChannelPlane::ChannelPlane()
+{
+    w = 0;
+    h = 0;
+}
+
+void ChannelPlane::resize(int width, int height)
+{
+    w = width;
+    h = height;
+    samples.fill(0, width * height);
+}
+
+void ChannelPlane::clear()
+{
+    w = 0;
+    h = 0;
+    samples.clear();
+    samples.squeeze();
+}
+
+// Upside down and left to right, as SegmentImage::ReverseImageChannel
+void ChannelPlane::reverse()
+{
+    std::reverse(samples.begin(), samples.end());
+}
+
+// The grey values of a line, count -> lut[count] >> shift, inverted when asked
+void ChannelPlane::toRgbLine(int y, const quint16 *lut, int shift, bool inverse, QRgb *out) const
+{
+    const quint16 *row = constScanLine(y);
+    for(int x = 0; x < w; x++)
+    {
+        int val = lut[row[x]] >> shift;
+        if(inverse)
+            val = 255 - val;
+        out[x] = qRgb(val, val, val);
+    }
+}
+
+// The image is only allocated again when the size changes
+void ChannelPlane::toImage(QImage *image, const quint16 *lut, int shift, bool inverse) const
+{
+    if(image->width() != w || image->height() != h || image->format() != QImage::Format_ARGB32)
+        *image = QImage(w, h, QImage::Format_ARGB32);
+
+    if(isNull())
+        return;
+
+    QList<PlaneImageJob> jobs;
+    for(int first = 0; first < h; first += 64)
+    {
+        PlaneImageJob job;
+        job.plane = this;
+        job.image = image;
+        job.lut = lut;
+        job.shift = shift;
+        job.inverse = inverse;
+        job.first = first;
+        job.last = qMin(first + 64, h);
+        jobs.append(job);
+    }
+
+    // detach in this thread, the rows are written from the thread pool
+    image->bits();
+    QtConcurrent::blockingMap(jobs, doPlaneImageRows);
+}
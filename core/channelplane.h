@@ -0,0 +1,36 @@
+#ifndef CHANNELPLANE_H
+#define CHANNELPLANE_H
+
+#include <QVector>
+#include <QImage>
+
+// The raw counts of one channel, 16 bits per pixel. The grey values are only made when the
+// channel is shown : a plane is half the size of an ARGB32 image, and a new LUT or inversion
+// does not need the counts to be decoded again.
+class ChannelPlane
+{
+public:
+    ChannelPlane();
+
+    void resize(int width, int height);
+    void clear();
+    void reverse();
+
+    int width() const { return w; }
+    int height() const { return h; }
+    bool isNull() const { return samples.isEmpty(); }
+    qint64 byteCount() const { return (qint64)samples.size() * sizeof(quint16); }
+
+    quint16 *scanLine(int y) { return samples.data() + y * w; }
+    const quint16 *constScanLine(int y) const { return samples.constData() + y * w; }
+
+    void toRgbLine(int y, const quint16 *lut, int shift, bool inverse, QRgb *out) const;
+    void toImage(QImage *image, const quint16 *lut, int shift, bool inverse) const;
+
+private:
+    int w;
+    int h;
+    QVector<quint16> samples;
+};
+
+#endif // CHANNELPLANE_H
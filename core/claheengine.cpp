@@ -0,0 +1,394 @@
+#include "claheengine.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <QDebug>
+
+#define uiNR_OF_GREY (4096)
+
+const unsigned int uiMAX_REG_X = 16;	  /* max. # contextual regions in x-direction */
+const unsigned int uiMAX_REG_Y = 16;	  /* max. # contextual regions in y-direction */
+
+void doCLAHEHistograms(CLAHEJob &job)
+{
+    job.engine->histogramRegions(job.first, job.last);
+}
+
+void doCLAHEMappings(CLAHEJob &job)
+{
+    job.engine->mappingRegions(job.first, job.last);
+}
+
+void doCLAHEApply(CLAHEJob &job)
+{
+    job.engine->applyRows(job.first, job.last);
+}
+
+CLAHEEngine::CLAHEEngine()
+{
+    uiXRes = 0;
+    uiYRes = 0;
+    uiNrX = 0;
+    uiNrY = 0;
+    uiNrBins = 0;
+    uiXSize = 0;
+    uiYSize = 0;
+    Min = 0;
+    Max = 0;
+    ulClipLimit = 0;
+    fCliplimit = 0.0;
+    generation = 0;
+    histogramsvalid = false;
+    mappingsvalid = false;
+    identity = false;
+}
+
+void CLAHEEngine::invalidate()
+{
+    histogramsvalid = false;
+    mappingsvalid = false;
+    generation = 0;
+}
+
+int CLAHEEngine::makeHistograms(const QVector<const quint16 *> &rows, unsigned int uiXRes,
+                                unsigned short Min, unsigned short Max, unsigned int uiNrX, unsigned int uiNrY, unsigned int uiNrBins)
+{
+    unsigned int uiYRes = rows.count();
+
+    invalidate();
+
+    if (uiNrX > uiMAX_REG_X) return -1;	   /* # of regions x-direction too large */
+    if (uiNrY > uiMAX_REG_Y) return -2;	   /* # of regions y-direction too large */
+    if (uiXRes % uiNrX) return -3;	  /* x-resolution no multiple of uiNrX */
+    if (uiYRes % uiNrY) return -4;	  /* y-resolution no multiple of uiNrY */
+    if (Max >= uiNR_OF_GREY) return -5;	   /* maximum too large */
+    if (Min >= Max) return -6;		  /* minimum equal or larger than maximum */
+    if (uiNrX < 2 || uiNrY < 2) return -7;/* at least 4 contextual regions required */
+    if (uiNrBins == 0) uiNrBins = 128;	  /* default value when not specified */
+
+    this->uiXRes = uiXRes;
+    this->uiYRes = uiYRes;
+    this->Min = Min;
+    this->Max = Max;
+    this->uiNrX = uiNrX;
+    this->uiNrY = uiNrY;
+    this->uiNrBins = uiNrBins;
+    uiXSize = uiXRes/uiNrX;
+    uiYSize = uiYRes/uiNrY;
+
+    // Scale [Min,Max] down to [0,uiNrBins-1], values outside the range go to the first or last bin
+    const unsigned short BinSize = (unsigned short) (1 + (Max - Min) / uiNrBins);
+    greylut.resize(65536);
+    for (int i = 0; i < 65536; i++)
+    {
+        if (i < Min)
+            greylut[i] = 0;
+        else if (i > Max)
+            greylut[i] = (Max - Min) / BinSize;
+        else
+            greylut[i] = (i - Min) / BinSize;
+    }
+
+    histograms.resize(uiNrX * uiNrY * uiNrBins);
+    mappings.resize(uiNrX * uiNrY * uiNrBins);
+
+    rowsin = rows;
+
+    QVector<CLAHEJob> jobs;
+    for (unsigned int i = 0; i < uiNrX * uiNrY; i++)
+    {
+        CLAHEJob job;
+        job.engine = this;
+        job.first = i;
+        job.last = i + 1;
+        jobs.append(job);
+    }
+    QtConcurrent::blockingMap(jobs, doCLAHEHistograms);
+
+    rowsin.clear();
+    histogramsvalid = true;
+
+    return 0;
+}
+
+void CLAHEEngine::histogramRegions(int first, int last)
+{
+    for (int region = first; region < last; region++)
+    {
+        unsigned int uiX = region % uiNrX;
+        unsigned int uiY = region / uiNrX;
+        unsigned long *pulHist = &histograms[uiNrBins * region];
+
+        for (unsigned int i = 0; i < uiNrBins; i++)
+            pulHist[i] = 0L;
+
+        for (unsigned int line = uiY * uiYSize; line < (uiY + 1) * uiYSize; line++)
+        {
+            const quint16 *pImage = rowsin.at(line) + uiX * uiXSize;
+            for (unsigned int i = 0; i < uiXSize; i++)
+                pulHist[greylut.at(pImage[i])]++;
+        }
+    }
+}
+
+void CLAHEEngine::makeMappings(float fCliplimit)
+{
+    if (!histogramsvalid)
+        return;
+
+    this->fCliplimit = fCliplimit;
+    identity = (fCliplimit == 1.0);
+
+    if (fCliplimit > 0.0) {		  /* Calculate actual cliplimit	 */
+       ulClipLimit = (unsigned long) (fCliplimit * (uiXSize * uiYSize) / uiNrBins);
+       ulClipLimit = (ulClipLimit < 1UL) ? 1UL : ulClipLimit;
+    }
+    else ulClipLimit = 1UL<<14;		  /* Large value, do not clip (AHE) */
+
+    QVector<CLAHEJob> jobs;
+    for (unsigned int i = 0; i < uiNrX * uiNrY; i++)
+    {
+        CLAHEJob job;
+        job.engine = this;
+        job.first = i;
+        job.last = i + 1;
+        jobs.append(job);
+    }
+    QtConcurrent::blockingMap(jobs, doCLAHEMappings);
+
+    mappingsvalid = true;
+}
+
+void CLAHEEngine::mappingRegions(int first, int last)
+{
+    for (int region = first; region < last; region++)
+    {
+        unsigned long *pulMap = &mappings[uiNrBins * region];
+        memcpy(pulMap, &histograms.at(uiNrBins * region), uiNrBins * sizeof(unsigned long));
+        clipHistogram(pulMap, ulClipLimit);
+        mapHistogram(pulMap);
+    }
+}
+
+void CLAHEEngine::clipHistogram(unsigned long *pulHistogram, unsigned long ulClipLimit)
+/* This function performs clipping of the histogram and redistribution of bins.
+ * The histogram is clipped and the number of excess pixels is counted. Afterwards
+ * the excess pixels are equally redistributed across the whole histogram (providing
+ * the bin count is smaller than the cliplimit).
+ */
+{
+    unsigned long* pulBinPointer, *pulEndPointer, *pulHisto;
+    unsigned long ulNrExcess, ulUpper, ulBinIncr, ulStepSize, i;
+    long lBinExcess;
+
+    ulNrExcess = 0;  pulBinPointer = pulHistogram;
+    for (i = 0; i < uiNrBins; i++) { /* calculate total number of excess pixels */
+    lBinExcess = (long) pulBinPointer[i] - (long) ulClipLimit;
+    if (lBinExcess > 0) ulNrExcess += lBinExcess;	  /* excess in current bin */
+    };
+
+    /* Second part: clip histogram and redistribute excess pixels in each bin */
+    ulBinIncr = ulNrExcess / uiNrBins;		  /* average binincrement */
+    ulUpper =  ulClipLimit - ulBinIncr;	 /* Bins larger than ulUpper set to cliplimit */
+
+    for (i = 0; i < uiNrBins; i++)
+    {
+        if (pulHistogram[i] > ulClipLimit) pulHistogram[i] = ulClipLimit; /* clip bin */
+        else
+        {
+            if (pulHistogram[i] > ulUpper)		/* high bin count */
+            {
+                ulNrExcess -= pulHistogram[i] - ulUpper; pulHistogram[i]=ulClipLimit;
+            }
+            else
+            {					/* low bin count */
+                ulNrExcess -= ulBinIncr; pulHistogram[i] += ulBinIncr;
+            }
+        }
+    }
+
+    while (ulNrExcess)       /* Redistribute remaining excess  */
+    {
+        pulEndPointer = &pulHistogram[uiNrBins]; pulHisto = pulHistogram;
+
+        while (ulNrExcess && pulHisto < pulEndPointer)
+        {
+            ulStepSize = uiNrBins / ulNrExcess;
+            if (ulStepSize < 1) ulStepSize = 1;		  /* stepsize at least 1 */
+            for (pulBinPointer=pulHisto; pulBinPointer < pulEndPointer && ulNrExcess; pulBinPointer += ulStepSize)
+            {
+                if (*pulBinPointer < ulClipLimit)
+                {
+                    (*pulBinPointer)++;	 ulNrExcess--;	  /* reduce excess */
+                }
+            }
+            pulHisto++;		  /* restart redistributing on other bin location */
+        }
+    }
+}
+
+void CLAHEEngine::mapHistogram(unsigned long *pulHistogram)
+/* This function calculates the equalized lookup table (mapping) by
+ * cumulating the input histogram. Note: lookup table is rescaled in range [Min..Max].
+ */
+{
+    unsigned int i;  unsigned long ulSum = 0;
+    const unsigned long ulNrOfPixels = (unsigned long)uiXSize * (unsigned long)uiYSize;
+    const float fScale = ((float)(Max - Min)) / ulNrOfPixels;
+    const unsigned long ulMin = (unsigned long) Min;
+
+    for (i = 0; i < uiNrBins; i++) {
+    ulSum += pulHistogram[i]; pulHistogram[i]=(unsigned long)(ulMin+ulSum*fScale);
+    if (pulHistogram[i] > Max) pulHistogram[i] = Max;
+    }
+}
+
+void CLAHEEngine::mapRow(int y, const quint16 *in, quint16 *out) const
+/* Bilinear interpolation between the mappings of the four surrounding regions.
+ * The first and last half regions only use the nearest mappings, as in Interpolate of the
+ * original code. The last half region takes all remaining pixels, so odd region sizes are covered.
+ */
+{
+    unsigned int uiYU, uiYB, uiSubY, uiYCoef, uiYInvCoef;
+    const unsigned int uiYHalf = uiYSize >> 1;
+    const unsigned int uiYLast = uiYHalf + (uiNrY - 1) * uiYSize;
+
+    if (identity)
+    {
+        if (out != in)
+            memcpy(out, in, uiXRes * sizeof(quint16));
+        return;
+    }
+
+    if ((unsigned int)y < uiYHalf)
+    {
+        uiYU = 0; uiYB = 0; uiSubY = uiYHalf; uiYCoef = y;
+    }
+    else if ((unsigned int)y >= uiYLast)
+    {
+        uiYU = uiNrY - 1; uiYB = uiYU; uiSubY = uiYRes - uiYLast; uiYCoef = y - uiYLast;
+    }
+    else
+    {
+        uiYU = (y - uiYHalf) / uiYSize; uiYB = uiYU + 1; uiSubY = uiYSize; uiYCoef = (y - uiYHalf) - uiYU * uiYSize;
+    }
+    uiYInvCoef = uiSubY - uiYCoef;
+
+    const unsigned long *pulMapU = &mappings.at(uiNrBins * uiYU * uiNrX);
+    const unsigned long *pulMapB = &mappings.at(uiNrBins * uiYB * uiNrX);
+
+    unsigned int x = 0;
+    for (unsigned int uiX = 0; uiX <= uiNrX; uiX++)
+    {
+        unsigned int uiSubX, uiXL, uiXR;
+
+        if (uiX == 0)
+        {
+            uiSubX = uiXSize >> 1; uiXL = 0; uiXR = 0;
+        }
+        else if (uiX == uiNrX)
+        {
+            uiSubX = uiXRes - x; uiXL = uiNrX - 1; uiXR = uiXL;
+        }
+        else
+        {
+            uiSubX = uiXSize; uiXL = uiX - 1; uiXR = uiXL + 1;
+        }
+
+        if (uiSubX == 0)
+            continue;
+
+        const unsigned long *pulMapLU = pulMapU + uiNrBins * uiXL;
+        const unsigned long *pulMapRU = pulMapU + uiNrBins * uiXR;
+        const unsigned long *pulMapLB = pulMapB + uiNrBins * uiXL;
+        const unsigned long *pulMapRB = pulMapB + uiNrBins * uiXR;
+
+        unsigned int uiNum = uiSubX * uiSubY;
+        unsigned int uiShift = 0;
+        bool bShift = !(uiNum & (uiNum - 1));
+        if (bShift)
+            while (uiNum >> (uiShift + 1)) uiShift++;
+
+        unsigned short GreyValue;
+        unsigned int uiXCoef, uiXInvCoef;
+
+        for (uiXCoef = 0, uiXInvCoef = uiSubX; uiXCoef < uiSubX; uiXCoef++, uiXInvCoef--, x++)
+        {
+            GreyValue = greylut.at(in[x]);
+            unsigned long val = uiYInvCoef * (uiXInvCoef * pulMapLU[GreyValue] + uiXCoef * pulMapRU[GreyValue])
+                    + uiYCoef * (uiXInvCoef * pulMapLB[GreyValue] + uiXCoef * pulMapRB[GreyValue]);
+            out[x] = (unsigned short)(bShift ? val >> uiShift : val / uiNum);
+        }
+    }
+}
+
+void CLAHEEngine::apply(const QVector<const quint16 *> &rowsin, const QVector<quint16 *> &rowsout)
+{
+    if (!mappingsvalid)
+        return;
+
+    this->rowsin = rowsin;
+    this->rowsout = rowsout;
+
+    QVector<CLAHEJob> jobs;
+    for (unsigned int line = 0; line < uiYRes; line += 64)
+    {
+        CLAHEJob job;
+        job.engine = this;
+        job.first = line;
+        job.last = qMin(line + 64, uiYRes);
+        jobs.append(job);
+    }
+    QtConcurrent::blockingMap(jobs, doCLAHEApply);
+
+    this->rowsin.clear();
+    this->rowsout.clear();
+}
+
+void CLAHEEngine::applyRows(int first, int last)
+{
+    for (int line = first; line < last; line++)
+        mapRow(line, rowsin.at(line), rowsout.at(line));
+}
+
+int CLAHEEngine::equalize(quint16 *pImage, unsigned int uiXRes, unsigned int uiYRes,
+                          unsigned short Min, unsigned short Max, unsigned int uiNrX, unsigned int uiNrY,
+                          unsigned int uiNrBins, float fCliplimit, quint32 generation)
+/* In place CLAHE of a contiguous image. With a generation other than 0, the histograms of
+ * an earlier call with the same generation and parameters are reused.
+ */
+{
+    QVector<const quint16 *> rowsin(uiYRes);
+    QVector<quint16 *> rowsout(uiYRes);
+
+    for (unsigned int line = 0; line < uiYRes; line++)
+    {
+        rowsin[line] = pImage + line * uiXRes;
+        rowsout[line] = pImage + line * uiXRes;
+    }
+
+    if (uiNrBins == 0) uiNrBins = 128;
+
+    bool reuse = (histogramsvalid && generation != 0 && generation == this->generation &&
+                  uiXRes == this->uiXRes && uiYRes == this->uiYRes && Min == this->Min && Max == this->Max &&
+                  uiNrX == this->uiNrX && uiNrY == this->uiNrY && uiNrBins == this->uiNrBins);
+
+    if (!reuse)
+    {
+        int ret = makeHistograms(rowsin, uiXRes, Min, Max, uiNrX, uiNrY, uiNrBins);
+        if (ret != 0)
+            return ret;
+        this->generation = generation;
+    }
+    else
+        qDebug() << QString("CLAHEEngine::equalize reusing the histograms of generation %1").arg(generation);
+
+    if (!mappingsvalid || fCliplimit != this->fCliplimit)
+        makeMappings(fCliplimit);
+
+    if (identity)
+        return 0;
+
+    apply(rowsin, rowsout);
+
+    return 0;
+}
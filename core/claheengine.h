@@ -0,0 +1,62 @@
+#ifndef CLAHEENGINE_H
+#define CLAHEENGINE_H
+
+#include <QVector>
+
+class CLAHEEngine;
+
+struct CLAHEJob {
+    CLAHEEngine *engine;
+    int first;          // first region or row
+    int last;           // one past the last region or row
+};
+
+// Contrast Limited Adaptive Histogram Equalization after K. Zuiderveld, Graphics Gems IV.
+// The image is read through row pointers, so it can be a contiguous buffer or a list of segments.
+// The histograms of the contextual regions are kept : a new clip limit only redoes the clipping
+// and the mapping. Regions and rows are spread over the global thread pool.
+class CLAHEEngine
+{
+public:
+    CLAHEEngine();
+
+    int makeHistograms(const QVector<const quint16 *> &rows, unsigned int uiXRes,
+                       unsigned short Min, unsigned short Max, unsigned int uiNrX, unsigned int uiNrY, unsigned int uiNrBins);
+    void makeMappings(float fCliplimit);
+    void mapRow(int y, const quint16 *in, quint16 *out) const;
+    void apply(const QVector<const quint16 *> &rowsin, const QVector<quint16 *> &rowsout);
+
+    int equalize(quint16 *pImage, unsigned int uiXRes, unsigned int uiYRes,
+                 unsigned short Min, unsigned short Max, unsigned int uiNrX, unsigned int uiNrY,
+                 unsigned int uiNrBins, float fCliplimit, quint32 generation = 0);
+    void invalidate();
+
+    void histogramRegions(int first, int last);
+    void mappingRegions(int first, int last);
+    void applyRows(int first, int last);
+
+private:
+    void clipHistogram(unsigned long *pulHistogram, unsigned long ulClipLimit);
+    void mapHistogram(unsigned long *pulHistogram);
+
+    QVector<const quint16 *> rowsin;
+    QVector<quint16 *> rowsout;
+
+    unsigned int uiXRes, uiYRes;
+    unsigned int uiNrX, uiNrY, uiNrBins;
+    unsigned int uiXSize, uiYSize;
+    unsigned short Min, Max;
+    unsigned long ulClipLimit;
+    float fCliplimit;
+    quint32 generation;
+
+    bool histogramsvalid;
+    bool mappingsvalid;
+    bool identity;          // clip limit 1.0 leaves the image as it is
+
+    QVector<unsigned short> greylut;        // grey value to bin
+    QVector<unsigned long> histograms;      // uiNrBins per region
+    QVector<unsigned long> mappings;        // clipped and equalized histograms
+};
+
+#endif // CLAHEENGINE_H
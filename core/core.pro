@@ -72,6 +72,23 @@ SOURCES += main.cpp \
     equirectangular.cpp \
     infrascales.cpp \
     infrawidget.cpp \
+    directoryindex.cpp \
+    segmentdirectorywatcher.cpp \
+    claheengine.cpp \
+    projectionextent.cpp \
+    decodepool.cpp \
+    calibrationengine.cpp \
+    memorybudget.cpp \
+    imagepyramid.cpp \
+    projectionexport.cpp \
+    ephemmodels.cpp \
+    poiextractor.cpp \
+    geomosaic.cpp \
+    animationloop.cpp \
+    animationplayer.cpp \
+    channelplane.cpp \
+    benchmark.cpp \
+    tracer.cpp \
     forminfrascales.cpp \
     qcustomplot.cpp
 
@@ -133,6 +150,23 @@ HEADERS  += mainwindow.h \
     equirectangular.h \
     infrascales.h \
     infrawidget.h \
+    directoryindex.h \
+    segmentdirectorywatcher.h \
+    claheengine.h \
+    projectionextent.h \
+    decodepool.h \
+    calibrationengine.h \
+    memorybudget.h \
+    imagepyramid.h \
+    projectionexport.h \
+    ephemmodels.h \
+    poiextractor.h \
+    geomosaic.h \
+    animationloop.h \
+    animationplayer.h \
+    channelplane.h \
+    benchmark.h \
+    tracer.h \
     colormaps.h \
     forminfrascales.h \
     qcustomplot.h
@@ -157,20 +191,20 @@ else:win32:INCLUDEPATH += "C:\Program Files\HDF_Group\HDF5\1.8.15\include" ../bz
 CONFIG(release, debug|release) {
     #This is a release build
     unix:LIBS += -lpthread -lz -L/usr/ \
-        -L$$_PRO_FILE_PWD_/../libs/linux_gplusplus/release -lmeteosat -lDISE -lJPEG -lWT -lT4 -lCOMP -lqsgp4 -lbz2 -lhdf5_serial
+        -L$$_PRO_FILE_PWD_/../libs/linux_gplusplus/release -lmeteosat -lDISE -lJPEG -lWT -lT4 -lCOMP -lqsgp4 -lbz2 -lhdf5_serial -lhdf5_serial_hl
         #-L/usr/local/hdf5/lib -lhdf5
     else:win32:LIBS += \
         -L$$PWD/../../libs/win64_MSVC2012/release -lmeteosat -lDISE -lJPEG -lWT -lT4 -lCOMP -lqsgp4 -lbz2 -lzlib \
-        -L"C:\Program Files\HDF_Group\HDF5\1.8.15\lib" -lhdf5
+        -L"C:\Program Files\HDF_Group\HDF5\1.8.15\lib" -lhdf5 -lhdf5_hl
 
 } else {
     #This is a debug build
 unix:LIBS += -lpthread -lz -L/usr/ \
-    -L$$_PRO_FILE_PWD_/../libs/linux_gplusplus/debug -lmeteosat -lDISE -lJPEG -lWT -lT4 -lCOMP -lqsgp4 -lbz2 -lhdf5_serial
+    -L$$_PRO_FILE_PWD_/../libs/linux_gplusplus/debug -lmeteosat -lDISE -lJPEG -lWT -lT4 -lCOMP -lqsgp4 -lbz2 -lhdf5_serial -lhdf5_serial_hl
     #-L/usr/local/hdf5/lib -lhdf5
 else:win32:LIBS += \
     -L$$PWD/../../libs/win64_MSVC2012/debug -lmeteosat -lDISE -lJPEG -lWT -lT4 -lCOMP -lqsgp4 -lbz2 -lzlib \
-    -L"C:\Program Files\HDF_Group\HDF5\1.8.15\lib" -lhdf5
+    -L"C:\Program Files\HDF_Group\HDF5\1.8.15\lib" -lhdf5 -lhdf5_hl
 }
 
 CONFIG(release, debug|release): DEFINES += NDEBUG
@@ -0,0 +1,100 @@
+#include "decodepool.h"
+#include "options.h"
+
+#include <QThread>
+#include <QDebug>
+
+extern Options opts;
+
+DecodeTask::DecodeTask(std::function<void()> func, int priority, bool holdsbuffer) :
+    func(func), priority(priority), holdsbuffer(holdsbuffer)
+{
+    futureinterface.reportStarted();
+}
+
+void DecodeTask::run()
+{
+    if(!futureinterface.isCanceled())
+        func();
+    if(holdsbuffer)
+        DecodePool::instance()->releaseBuffer();
+    futureinterface.reportFinished();
+}
+
+DecodePool::DecodePool()
+{
+    buffersinuse = 0;
+    maxbuffers = 1;
+    setup();
+}
+
+DecodePool *DecodePool::instance()
+{
+    static DecodePool decodepool;
+    return &decodepool;
+}
+
+// Takes over opts.decodethreads and opts.decodebuffers, also while segments are decoded
+void DecodePool::setup()
+{
+    int threads = opts.decodethreads > 0 ? opts.decodethreads : QThread::idealThreadCount();
+    pool.setMaxThreadCount(qMax(1, threads));
+
+    buffermutex.lock();
+    maxbuffers = opts.decodebuffers > 0 ? opts.decodebuffers : pool.maxThreadCount();
+    startPending();
+    buffermutex.unlock();
+
+    qDebug() << QString("DecodePool::setup threads = %1 buffers = %2").arg(pool.maxThreadCount()).arg(maxbuffers);
+}
+
+QFuture<void> DecodePool::run(int priority, std::function<void()> func)
+{
+    DecodeTask *task = new DecodeTask(func, priority, false);
+    QFuture<void> future = task->future();
+    pool.start(task, priority);
+    return future;
+}
+
+// The task takes a decode buffer when it is started and gives it back when it ends
+QFuture<void> DecodePool::runDecode(int priority, std::function<void()> func)
+{
+    DecodeTask *task = new DecodeTask(func, priority, true);
+    QFuture<void> future = task->future();
+
+    buffermutex.lock();
+    int i = 0;
+    while(i < pending.size() && pending.at(i)->getPriority() >= priority)
+        i++;
+    pending.insert(i, task);
+    startPending();
+    buffermutex.unlock();
+
+    return future;
+}
+
+// buffermutex is locked
+void DecodePool::startPending()
+{
+    while(!pending.isEmpty() && buffersinuse < maxbuffers)
+    {
+        DecodeTask *task = pending.takeFirst();
+        buffersinuse++;
+        pool.start(task, task->getPriority());
+    }
+}
+
+void DecodePool::holdBuffer()
+{
+    buffermutex.lock();
+    buffersinuse++;
+    buffermutex.unlock();
+}
+
+void DecodePool::releaseBuffer()
+{
+    buffermutex.lock();
+    buffersinuse--;
+    startPending();
+    buffermutex.unlock();
+}
@@ -0,0 +1,66 @@
+#ifndef DECODEPOOL_H
+#define DECODEPOOL_H
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QMutex>
+#include <QList>
+#include <functional>
+
+// Runs a function on the decode pool and reports to a QFuture, like QtConcurrent::run
+class DecodeTask : public QRunnable
+{
+public:
+    DecodeTask(std::function<void()> func, int priority, bool holdsbuffer);
+    QFuture<void> future() { return futureinterface.future(); }
+    int getPriority() { return priority; }
+    void run();
+
+private:
+    std::function<void()> func;
+    QFutureInterface<void> futureinterface;
+    int priority;
+    bool holdsbuffer;
+};
+
+// Decompression of segment files : wavelet, JPEG and T4 HRIT, Himawari bz2 and FY2 gzip.
+// The decoders run on their own thread pool with opts.decodethreads workers (0 = one per core),
+// so a full cycle of segments does not start a thread per file. Waiting tasks start in order
+// of priority. At most opts.decodebuffers segments hold their encoded and decoded buffers at once :
+// runDecode keeps a task back until a buffer is free, so no worker sits waiting for one.
+class DecodePool
+{
+public:
+    static DecodePool *instance();
+    void setup();
+
+    QFuture<void> run(int priority, std::function<void()> func);
+    QFuture<void> runDecode(int priority, std::function<void()> func);
+
+    void holdBuffer();
+    void releaseBuffer();
+
+private:
+    DecodePool();
+    void startPending();
+
+    QThreadPool pool;
+    QList<DecodeTask *> pending;    // waiting for a buffer, highest priority first
+    QMutex buffermutex;
+    int buffersinuse;
+    int maxbuffers;
+};
+
+// Holds one of the decode buffers for the lifetime of a compose function that is not started by runDecode.
+// It is the serial FY2 compose on the GUI thread, that does not wait for the tasks to give a buffer back :
+// the buffer may go above opts.decodebuffers, the tasks that are kept back wait until it is released.
+class DecodeBuffer
+{
+public:
+    DecodeBuffer() { DecodePool::instance()->holdBuffer(); }
+    ~DecodeBuffer() { DecodePool::instance()->releaseBuffer(); }
+};
+
+#endif // DECODEPOOL_H
@@ -3,6 +3,9 @@
 #include <QDebug>
 #include <QFileDialog>
 #include "segmentimage.h"
+#include "decodepool.h"
+#include "memorybudget.h"
+#include "tracer.h"
 #include "poi.h"
 
 extern SegmentImage *imageptrs;
@@ -112,6 +115,7 @@ DialogPreferences::DialogPreferences(QWidget *parent) :
     ui->chkImageOnTextureVIIRS->setChecked(opts.imageontextureOnVIIRS);
     ui->chkWindowVectors->setChecked(opts.windowvectors);
     ui->chkUDPMessages->setChecked(opts.udpmessages);
+    ui->chkDirectoryWatcher->setChecked(opts.directorywatcher);
 
     ui->chkGshhs1->setChecked(opts.gshhsglobe1On);
     ui->chkGshhs2->setChecked(opts.gshhsglobe2On);
@@ -128,6 +132,13 @@ DialogPreferences::DialogPreferences(QWidget *parent) :
     ui->ledEquirectangularDirectory->setText(QString("%1").arg(opts.equirectangulardirectory));
 
     ui->rbSattrackOn->setChecked(opts.sattrackinimage);
+    ui->chkRegionOfInterest->setChecked(opts.regionofinterest);
+    ui->ledDecodeThreads->setText(QString("%1").arg(opts.decodethreads));
+    ui->ledDecodeBuffers->setText(QString("%1").arg(opts.decodebuffers));
+    ui->ledMemoryBudget->setText(QString("%1").arg(opts.memorybudget));
+    ui->ledAnimationCache->setText(QString("%1").arg(opts.animationcache));
+    ui->chkTracing->setChecked(opts.tracing);
+    ui->ledTraceFile->setText(opts.tracefile);
     if(opts.smoothprojectiontype == 0)
         ui->rbNoSmoothing->setChecked(true);
     else if(opts.smoothprojectiontype == 1)
@@ -435,8 +446,19 @@ void DialogPreferences::dialogaccept()
     opts.imageontextureOnVIIRS = ui->chkImageOnTextureVIIRS->isChecked();
     opts.windowvectors = ui->chkWindowVectors->isChecked();
     opts.udpmessages = ui->chkUDPMessages->isChecked();
+    opts.directorywatcher = ui->chkDirectoryWatcher->isChecked();
 
     opts.sattrackinimage = ui->rbSattrackOn->isChecked();
+    opts.regionofinterest = ui->chkRegionOfInterest->isChecked();
+    opts.decodethreads = qMax(0, ui->ledDecodeThreads->text().toInt());
+    opts.decodebuffers = qMax(0, ui->ledDecodeBuffers->text().toInt());
+    DecodePool::instance()->setup();
+    opts.memorybudget = qMax(0, ui->ledMemoryBudget->text().toInt());
+    MemoryBudget::instance()->setup();
+    opts.animationcache = qMax(16, ui->ledAnimationCache->text().toInt());
+    opts.tracefile = ui->ledTraceFile->text();
+    opts.tracing = ui->chkTracing->isChecked() && !opts.tracefile.isEmpty();
+    Tracer::instance()->setup();
     if(ui->rbNoSmoothing->isChecked())
         opts.smoothprojectiontype = 0;
     else if(ui->rbSmoothProjection->isChecked())
@@ -0,0 +1,363 @@
+#include "directoryindex.h"
+#include "tracer.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QDebug>
+
+#define DIRECTORYINDEX_MAGIC 0x45564449   // "EVDI"
+#define DIRECTORYINDEX_VERSION 3
+#define DIRECTORYINDEX_SETTLE 60000       // ms, files modified this long before the index was saved may still grow
+#define DIRECTORYINDEX_GRANULARITY 2000   // ms, coarsest modification time of the supported filesystems (FAT)
+
+static QString indexDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/dirindex";
+}
+
+static bool isGoesDataChannel3(const QString &hhmm)
+{
+    return (hhmm == "0000" || hhmm == "0300" || hhmm == "0600" || hhmm == "0900" ||
+            hhmm == "1200" || hhmm == "1500" || hhmm == "1800" || hhmm == "2100");
+}
+
+static bool isGoesDataChannel4(const QString &hhmm)
+{
+    return (hhmm == "0100" || hhmm == "0200" || hhmm == "0400" || hhmm == "0500" ||
+            hhmm == "0700" || hhmm == "0800" || hhmm == "1000" || hhmm == "1100" ||
+            hhmm == "1300" || hhmm == "1400" || hhmm == "1600" || hhmm == "1700" ||
+            hhmm == "1900" || hhmm == "2000" || hhmm == "2200" || hhmm == "2300");
+}
+
+static QDateTime parseFileDate(const QString &fn, int dpos, int tpos, bool withseconds)
+{
+    QDate d(fn.mid( dpos, 4).toInt(), fn.mid( dpos + 4, 2).toInt(), fn.mid( dpos + 6, 2).toInt());
+    QTime t(fn.mid( tpos, 2).toInt(), fn.mid( tpos + 2, 2).toInt(), withseconds ? fn.mid( tpos + 4, 2).toInt() : 0);
+    return QDateTime(d, t);
+}
+
+SegmentFileDescriptor SegmentFileDescriptor::classify(const QString &fn)
+{
+    SegmentFileDescriptor desc;
+    desc.filename = fn;
+    desc.size = 0;
+    desc.modified = 0;
+    desc.filetype = FILE_NONE;
+    desc.datekind = DATE_NONE;
+    desc.filenbr = 0;
+
+    //avhrr_20130701_151100_noaa19
+    //AVHR_xxx_1B_M01_20130701051903Z_20130701052203Z_N_O_20130701054640Z
+    //AVHR_GAC_1B_N19_20130701041003Z_20130701041303Z_N_O_20130701054958Z
+    //AVHR_HRP_00_M02_20130701060200Z_20130701060300Z_N_O_20130701061314Z
+    //SVMC_npp_d20141117_t0837599_e0839241_b15833_c20141117084501709131_eum_ops
+    //SVDNBC_npp_d20151019_t0013359_e0015001_b20595_c20151019002104000944_eum_ops.h5
+    if (fn.mid( 0, 6) == "avhrr_" && fn.mid( 22, 6) == "noaa19")
+    {
+        desc.datekind = DATE_NOAA;
+        desc.filedate = parseFileDate(fn, 6, 15, true);
+    }
+    else if (fn.mid( 0, 11) == "AVHR_GAC_1B" || fn.mid( 0, 11) == "AVHR_HRP_00" || fn.mid( 0, 11) == "AVHR_xxx_1B")
+    {
+        desc.datekind = DATE_METOP;
+        desc.filedate = parseFileDate(fn, 16, 24, true);
+    }
+    else if (fn.mid( 0, 8) == "SVMC_npp")
+    {
+        desc.datekind = DATE_NPP;
+        desc.filedate = parseFileDate(fn, 10, 20, true);
+    }
+    else if (fn.mid( 0, 10) == "SVDNBC_npp")
+    {
+        desc.datekind = DATE_NPP;
+        desc.filedate = parseFileDate(fn, 12, 22, true);
+    }
+    else if ((fn.mid( 0, 9) == "H-000-MSG" || fn.mid( 0, 11) == "H-000-GOMS1" || fn.mid( 0, 17) == "L-000-MTP___-MET7" ||
+              fn.mid( 0, 19) == "L-000-MSG3__-GOES13" || fn.mid( 0, 19) == "L-000-MSG3__-GOES15") && fn.mid( 59, 2) == "C_")
+    {
+        desc.datekind = DATE_GEO;
+        desc.filedate = parseFileDate(fn, 46, 54, false);
+    }
+    //Z_SATE_C_BABJ_20150624130000_O_FY2G_FDI_IR1_001_NOM.HDF.gz
+    else if (fn.mid( 0, 14) == "Z_SATE_C_BABJ_" && (fn.mid( 31, 8) == "FY2E_FDI" || fn.mid( 31, 8) == "FY2G_FDI"))
+    {
+        desc.datekind = DATE_GEO;
+        desc.filedate = parseFileDate(fn, 14, 22, false);
+    }
+    //IMG_DK01B04_201510090000_001.bz2
+    else if (fn.mid( 0, 6) == "IMG_DK")
+    {
+        desc.datekind = DATE_GEO;
+        desc.filedate = parseFileDate(fn, 12, 20, false);
+    }
+
+    if (fn.mid( 0, 8) == "AVHR_xxx" && fn.mid( 67, 4) == ".bz2")   // EPS-10
+        desc.filetype = FILE_METOP;
+    else if (fn.mid( 0, 6) == "avhrr_" && fn.mid( 22, 6) == "noaa19")  // Data Channel 1
+        desc.filetype = FILE_NOAA;
+    else if (fn.mid( 0, 8) == "AVHR_HRP" && fn.mid( 67, 4) == ".bz2")   // Data Channel 1
+        desc.filetype = FILE_HRP;
+    else if (fn.mid( 0, 8) == "AVHR_GAC") // EPS-15
+        desc.filetype = FILE_GAC;
+    else if (fn.mid( 0, 8) == "SVMC_npp" && fn.mid( 77, 3) == "bz2") // NPP-2
+        desc.filetype = FILE_VIIRSM;
+    else if (fn.mid( 0, 10) == "SVDNBC_npp" && fn.mid( 79, 3) == "bz2") // NPP-2
+        desc.filetype = FILE_VIIRSDNB;
+    else if (fn.mid( 59, 2) == "C_" && ((fn.mid( 0, 9) == "H-000-MSG" && fn.mid( 13, 3) == "MSG") ||
+                                        fn.mid( 0, 17) == "L-000-MTP___-MET7" ||
+                                        fn.mid( 0, 19) == "L-000-MSG3__-GOES13" || fn.mid( 0, 19) == "L-000-MSG3__-GOES15"))
+    {
+        //012345678901234567890123456789012345678901234567890123456789012
+        //H-000-MSG3__-MSG3________-HRV______-000001___-201310270845-C_
+        //H-000-MSG1__-MSG1_RSS____-HRV______-000016___-201211210610-C_
+        //H-000-MSG1__-MSG1_IODC___-HRV______-000001___-201610060845-C_
+        //L-000-MTP___-MET7________-06_4_057E-000004___-201403300930-C_
+        //L-000-MSG3__-GOES13______-00_7_075W-000001___-201404031200-C_
+        desc.filenbr = fn.mid(36, 6).toInt();
+        desc.strspectrum = fn.mid(26, 6);
+        desc.strdate = fn.mid(46, 12);
+        QString hhmm = fn.mid(54, 4);
+
+        if (desc.strspectrum == "______")
+            desc.filetype = FILE_NONE;
+        else if (fn.mid( 0, 9) == "H-000-MSG" && fn.mid( 18, 3) == "___")   // Data Channel 2
+            desc.filetype = FILE_MET10;
+        else if (fn.mid( 0, 9) == "H-000-MSG" && fn.mid( 18, 3) == "RSS")   // Data Channel 5
+            desc.filetype = FILE_MET9;
+        else if (fn.mid( 0, 9) == "H-000-MSG" && fn.mid( 18, 4) == "IODC")  // E1B-GEO-1
+            desc.filetype = FILE_MET8;
+        else if (fn.mid( 0, 17) == "L-000-MTP___-MET7")                      // Data Channel 3
+            desc.filetype = FILE_MET7;
+        else if (fn.mid( 0, 19) == "L-000-MSG3__-GOES13")
+            desc.filetype = isGoesDataChannel3(hhmm) ? FILE_GOES13DC3 : (isGoesDataChannel4(hhmm) ? FILE_GOES13DC4 : FILE_NONE);
+        else if (fn.mid( 0, 19) == "L-000-MSG3__-GOES15")
+            desc.filetype = isGoesDataChannel3(hhmm) ? FILE_GOES15DC3 : (isGoesDataChannel4(hhmm) ? FILE_GOES15DC4 : FILE_NONE);
+    }
+    else if (fn.mid( 0, 6) == "IMG_DK")
+    {
+        //IMG_DK01B04_201510090000_001.bz2
+        //0123456789012345678901234567890
+        desc.filetype = FILE_H8;
+        desc.filenbr = fn.mid(25, 3).toInt();
+        desc.strspectrum = fn.mid(8, 3);
+        desc.strdate = fn.mid(12, 11);
+    }
+    else if (fn.mid( 0, 14) == "Z_SATE_C_BABJ_" && (fn.mid( 31, 8) == "FY2E_FDI" || fn.mid( 31, 8) == "FY2G_FDI")) // Data Channel 12
+    {
+        //0123456789012345678901234567890123456789012345678901234567890
+        //Z_SATE_C_BABJ_20150623131500_O_FY2D_FDI_IR1_001_NOM.HDF.gz
+        //Z_SATE_C_BABJ_20150717080000_O_FY2G_FDI_VIS1KM_001_NOM.HDF.gz
+        desc.filetype = (fn.mid( 31, 8) == "FY2E_FDI" ? FILE_FY2E : FILE_FY2G);
+        desc.filenbr = fn.mid(44, 3).toInt();
+        desc.strspectrum = fn.mid(40, 3);
+        if(fn.mid(40, 6) == "VIS1KM")
+            desc.strspectrum = "VIS1KM";
+        desc.strdate = fn.mid(14, 12);
+    }
+
+    return desc;
+}
+
+QDataStream &operator<<(QDataStream &out, const SegmentFileDescriptor &desc)
+{
+    out << desc.filename << desc.size << desc.modified << (qint32)desc.filetype << (qint32)desc.datekind
+        << desc.filedate << desc.strdate << desc.strspectrum << (qint32)desc.filenbr;
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, SegmentFileDescriptor &desc)
+{
+    qint32 filetype, datekind, filenbr;
+    in >> desc.filename >> desc.size >> desc.modified >> filetype >> datekind
+       >> desc.filedate >> desc.strdate >> desc.strspectrum >> filenbr;
+    desc.filetype = (SegmentFileDescriptor::eFileType)filetype;
+    desc.datekind = (SegmentFileDescriptor::eDateKind)datekind;
+    desc.filenbr = filenbr;
+    return in;
+}
+
+
+DirectoryIndex::DirectoryIndex(QString path)
+{
+    QFileInfo dirinfo(path);
+
+    dirpath = dirinfo.absoluteFilePath();
+    direxists = dirinfo.isDir();
+    dirmodified = 0;
+    dirsize = 0;
+    savedtime = 0;
+
+    if (!direxists)
+        return;
+
+    qint64 currentmodified = dirinfo.lastModified().toMSecsSinceEpoch();
+    qint64 currentsize = dirinfo.size();
+
+    bool loaded = load();
+    if (!loaded || dirmodified != currentmodified || dirsize != currentsize || isRecent())
+    {
+        update(currentmodified, currentsize);
+        save();
+    }
+    else if (restatGrowing() > 0)
+        save();
+}
+
+// A file added in the same tick of the directory time as the listing does not change that time,
+// so a directory modified within DIRECTORYINDEX_GRANULARITY of the save is listed again
+bool DirectoryIndex::isRecent() const
+{
+    return dirmodified + DIRECTORYINDEX_GRANULARITY > savedtime;
+}
+
+bool DirectoryIndex::mayGrow(const SegmentFileDescriptor &desc) const
+{
+    return desc.size == 0 || desc.modified > savedtime - DIRECTORYINDEX_SETTLE;
+}
+
+// Writing to a file does not change the directory time, the files that were
+// still being written when the index was saved are stat'ed again.
+int DirectoryIndex::restatGrowing()
+{
+    int countchanged = 0;
+
+    for (int i = 0; i < entrylist.size(); i++)
+    {
+        if (!mayGrow(entrylist.at(i)))
+            continue;
+
+        QFileInfo fileinfo(dirpath + "/" + entrylist.at(i).filename);
+        qint64 size = fileinfo.size();
+        qint64 modified = fileinfo.lastModified().toMSecsSinceEpoch();
+        if (size != entrylist.at(i).size || modified != entrylist.at(i).modified)
+        {
+            entrylist[i].size = size;
+            entrylist[i].modified = modified;
+            countchanged++;
+        }
+    }
+
+    if (countchanged > 0)
+        qDebug() << QString("DirectoryIndex %1 : %2 files still growing").arg(dirpath).arg(countchanged);
+
+    return countchanged;
+}
+
+QList<SegmentFileDescriptor> DirectoryIndex::readDirectory(QString dirpath)
+{
+    TraceSpan span("scan", "DirectoryIndex::readDirectory", dirpath);
+    DirectoryIndex index(dirpath);
+    return index.entries();
+}
+
+QString DirectoryIndex::indexFileName()
+{
+    QByteArray hash = QCryptographicHash::hash(dirpath.toUtf8(), QCryptographicHash::Md5).toHex();
+    return indexDirectory() + "/" + QString(hash) + ".idx";
+}
+
+bool DirectoryIndex::load()
+{
+    QFile file(indexFileName());
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic;
+    qint32 version;
+    QString path;
+    qint32 count;
+
+    in >> magic >> version;
+    if (magic != DIRECTORYINDEX_MAGIC || version != DIRECTORYINDEX_VERSION)
+        return false;
+
+    in >> path >> dirmodified >> dirsize >> savedtime >> count;
+    if (magic != DIRECTORYINDEX_MAGIC || version != DIRECTORYINDEX_VERSION || path != dirpath || count < 0)
+        return false;
+
+    entrylist.clear();
+    entrylist.reserve(count);
+    for (int i = 0; i < count; i++)
+    {
+        SegmentFileDescriptor desc;
+        in >> desc;
+        desc.absolutepath = dirpath;
+        entrylist.append(desc);
+    }
+
+    if (in.status() != QDataStream::Ok)
+    {
+        entrylist.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void DirectoryIndex::save()
+{
+    QDir().mkpath(indexDirectory());
+
+    QSaveFile file(indexFileName());
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << QString("DirectoryIndex: could not write index for %1").arg(dirpath);
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    savedtime = QDateTime::currentMSecsSinceEpoch();
+    out << (quint32)DIRECTORYINDEX_MAGIC << (qint32)DIRECTORYINDEX_VERSION << dirpath << dirmodified << dirsize << savedtime << (qint32)entrylist.size();
+    foreach (const SegmentFileDescriptor &desc, entrylist)
+        out << desc;
+
+    if (!file.commit())
+        qDebug() << QString("DirectoryIndex: could not write index for %1").arg(dirpath);
+}
+
+void DirectoryIndex::update(qint64 currentmodified, qint64 currentsize)
+{
+    QHash<QString, int> known;
+    for (int i = 0; i < entrylist.size(); i++)
+        known.insert(entrylist.at(i).filename, i);
+
+    // Only the names are listed, stat is done for new files and for files that were still being written
+    QDir dir(dirpath);
+    QStringList names = dir.entryList(QDir::Files | QDir::NoSymLinks, QDir::Name);
+
+    QList<SegmentFileDescriptor> newlist;
+    newlist.reserve(names.size());
+
+    int countnew = 0;
+
+    foreach (const QString &name, names)
+    {
+        QHash<QString, int>::const_iterator it = known.constFind(name);
+        if (it != known.constEnd() && !mayGrow(entrylist.at(it.value())))
+        {
+            newlist.append(entrylist.at(it.value()));
+            continue;
+        }
+
+        SegmentFileDescriptor desc = SegmentFileDescriptor::classify(name);
+        QFileInfo fileinfo(dir, name);
+        desc.absolutepath = dirpath;
+        desc.size = fileinfo.size();
+        desc.modified = fileinfo.lastModified().toMSecsSinceEpoch();
+        newlist.append(desc);
+        countnew++;
+    }
+
+    qDebug() << QString("DirectoryIndex %1 : %2 files, %3 new or changed").arg(dirpath).arg(newlist.size()).arg(countnew);
+
+    entrylist = newlist;
+    dirmodified = currentmodified;
+    dirsize = currentsize;
+}
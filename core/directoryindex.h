@@ -0,0 +1,96 @@
+#ifndef DIRECTORYINDEX_H
+#define DIRECTORYINDEX_H
+
+#include <QString>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QList>
+#include <QHash>
+#include <QDataStream>
+
+// Parsed EUMETCast filename, the same rules as AVHRRSatellite::AddSegmentsToList
+struct SegmentFileDescriptor
+{
+    enum eFileType {
+        FILE_NONE = 0,
+        FILE_METOP,
+        FILE_NOAA,
+        FILE_HRP,
+        FILE_GAC,
+        FILE_VIIRSM,
+        FILE_VIIRSDNB,
+        FILE_MET10,
+        FILE_MET9,
+        FILE_MET8,
+        FILE_MET7,
+        FILE_GOES13DC3,
+        FILE_GOES13DC4,
+        FILE_GOES15DC3,
+        FILE_GOES15DC4,
+        FILE_FY2E,
+        FILE_FY2G,
+        FILE_H8
+    };
+
+    // Selection used by ReadDirectories, the rules of the former InsertToMap
+    enum eDateKind {
+        DATE_NONE = 0,
+        DATE_NOAA,      // needs the Noaa TLE
+        DATE_METOP,     // needs the Metop TLE
+        DATE_NPP,       // needs the Suomi TLE
+        DATE_GEO        // only taken from the selected date
+    };
+
+    QString filename;
+    QString absolutepath;
+    qint64 size;
+    qint64 modified;
+    eFileType filetype;
+    eDateKind datekind;
+    QDateTime filedate;
+    QString strdate;        // timeslot
+    QString strspectrum;    // channel
+    int filenbr;            // segment number
+
+    QFileInfo fileInfo() const { return QFileInfo(absolutepath + "/" + filename); }
+    bool isGeostationary() const { return filetype >= FILE_MET10; }
+
+    static SegmentFileDescriptor classify(const QString &filename);
+};
+
+QDataStream &operator<<(QDataStream &out, const SegmentFileDescriptor &desc);
+QDataStream &operator>>(QDataStream &in, SegmentFileDescriptor &desc);
+
+// On-disk index of the segment files in one directory.
+// The index is brought up to date when the modification time or the size of the directory changed,
+// or when the directory was modified just before the index was saved, then only the new or still
+// growing files are stat'ed and parsed. Otherwise only the files that were still
+// being written when the index was saved are stat'ed again. The index files are kept in the cache
+// location of the application.
+class DirectoryIndex
+{
+public:
+    DirectoryIndex(QString dirpath);
+    bool exists() { return direxists; }
+    QList<SegmentFileDescriptor> entries() { return entrylist; }
+
+    static QList<SegmentFileDescriptor> readDirectory(QString dirpath);
+
+private:
+    bool load();
+    void save();
+    void update(qint64 dirmodified, qint64 dirsize);
+    int restatGrowing();
+    bool isRecent() const;
+    bool mayGrow(const SegmentFileDescriptor &desc) const;
+    QString indexFileName();
+
+    QString dirpath;
+    bool direxists;
+    qint64 dirmodified;
+    qint64 dirsize;         // size of the directory file, changes with the entries on most filesystems
+    qint64 savedtime;       // ms since epoch, when the index was written
+    QList<SegmentFileDescriptor> entrylist;
+};
+
+#endif // DIRECTORYINDEX_H
@@ -0,0 +1,281 @@
+#include "ephemmodels.h"
+#include "options.h"
+
+#include <QHash>
+#include <QDebug>
+
+extern Options opts;
+
+TleCatalogueModel::TleCatalogueModel(SatelliteList *satlist, QObject *parent) :
+    QAbstractItemModel(parent)
+{
+    sats = satlist;
+}
+
+// One pass over the satellite list, the checked catalogue numbers are those of opts.catnbrlist that are in a file
+void TleCatalogueModel::reload()
+{
+    beginResetModel();
+
+    files.clear();
+    QHash<QString, int> filerow;
+    for (int i = 0; i < opts.tlelist.count(); i++)
+    {
+        TleFile file;
+        file.name = opts.tlelist.at(i);
+        file.fetched = 0;
+        filerow.insert(file.name, files.count());
+        files.append(file);
+    }
+
+    QSet<int> wanted;
+    for (int i = 0; i < opts.catnbrlist.count(); i++)
+        wanted.insert(opts.catnbrlist.at(i).toInt());
+
+    checked.clear();
+    QList<Satellite> *satlist = sats->GetSatlist();
+    for (int i = 0; i < satlist->count(); i++)
+    {
+        Satellite &sat = (*satlist)[i];
+        QHash<QString, int>::const_iterator it = filerow.constFind(sat.tlefile);
+        if(it == filerow.constEnd())
+            continue;
+
+        TleEntry entry;
+        entry.catnr = sat.GetCatalogueNbr();
+        entry.name = sat.sat_name;
+        files[it.value()].entries.append(entry);
+        if(wanted.contains(entry.catnr))
+            checked.insert(entry.catnr);
+    }
+
+    endResetModel();
+
+    qDebug() << QString("TleCatalogueModel::reload %1 files %2 satellites %3 checked").arg(files.count()).arg(satlist->count()).arg(checked.count());
+}
+
+// the file of a top level index, empty for a satellite
+QString TleCatalogueModel::fileName(const QModelIndex &index) const
+{
+    if(!index.isValid() || index.internalId() != 0)
+        return QString();
+    return files.at(index.row()).name;
+}
+
+QStringList TleCatalogueModel::checkedCatalogueNumbers() const
+{
+    QStringList list;
+    QSet<int>::const_iterator it = checked.constBegin();
+    while (it != checked.constEnd())
+    {
+        list << QString("%1").arg(*it, 5, 10, QChar('0'));
+        ++it;
+    }
+    return list;
+}
+
+// internalId is 0 for a file and the row of the file + 1 for a satellite
+QModelIndex TleCatalogueModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if(column != 0 || row < 0)
+        return QModelIndex();
+
+    if(!parent.isValid())
+        return row < files.count() ? createIndex(row, 0, (quintptr)0) : QModelIndex();
+
+    if(parent.internalId() != 0 || row >= files.at(parent.row()).fetched)
+        return QModelIndex();
+    return createIndex(row, 0, (quintptr)(parent.row() + 1));
+}
+
+QModelIndex TleCatalogueModel::parent(const QModelIndex &child) const
+{
+    if(!child.isValid() || child.internalId() == 0)
+        return QModelIndex();
+    return createIndex(child.internalId() - 1, 0, (quintptr)0);
+}
+
+int TleCatalogueModel::rowCount(const QModelIndex &parent) const
+{
+    if(!parent.isValid())
+        return files.count();
+    if(parent.internalId() == 0)
+        return files.at(parent.row()).fetched;
+    return 0;
+}
+
+int TleCatalogueModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return 1;
+}
+
+bool TleCatalogueModel::hasChildren(const QModelIndex &parent) const
+{
+    if(!parent.isValid())
+        return !files.isEmpty();
+    return parent.internalId() == 0 && !files.at(parent.row()).entries.isEmpty();
+}
+
+bool TleCatalogueModel::canFetchMore(const QModelIndex &parent) const
+{
+    if(!parent.isValid() || parent.internalId() != 0)
+        return false;
+    return files.at(parent.row()).fetched < files.at(parent.row()).entries.count();
+}
+
+void TleCatalogueModel::fetchMore(const QModelIndex &parent)
+{
+    if(!canFetchMore(parent))
+        return;
+
+    TleFile &file = files[parent.row()];
+    int count = qMin(EPHEM_FETCH_SIZE, file.entries.count() - file.fetched);
+    beginInsertRows(parent, file.fetched, file.fetched + count - 1);
+    file.fetched += count;
+    endInsertRows();
+}
+
+QVariant TleCatalogueModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid())
+        return QVariant();
+
+    if(index.internalId() == 0)
+    {
+        if(role == Qt::DisplayRole)
+            return files.at(index.row()).name;
+        return QVariant();
+    }
+
+    const TleEntry &entry = files.at(index.internalId() - 1).entries.at(index.row());
+    if(role == Qt::DisplayRole)
+        return QString("%1 | %2").arg(entry.catnr, 5, 10, QChar('0')).arg(entry.name);
+    else if(role == Qt::CheckStateRole)
+        return checked.contains(entry.catnr) ? Qt::Checked : Qt::Unchecked;
+    return QVariant();
+}
+
+// A satellite that is in more than one file changes in all of them
+bool TleCatalogueModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if(!index.isValid() || index.internalId() == 0 || role != Qt::CheckStateRole)
+        return false;
+
+    int catnr = files.at(index.internalId() - 1).entries.at(index.row()).catnr;
+    if(value.toInt() == Qt::Checked)
+        checked.insert(catnr);
+    else
+        checked.remove(catnr);
+
+    for (int i = 0; i < files.count(); i++)
+    {
+        if(files.at(i).fetched > 0)
+        {
+            QModelIndex parent = createIndex(i, 0, (quintptr)0);
+            emit dataChanged(this->index(0, 0, parent), this->index(files.at(i).fetched - 1, 0, parent));
+        }
+    }
+
+    emit checkedChanged();
+    return true;
+}
+
+QVariant TleCatalogueModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(section == 0 && orientation == Qt::Horizontal && role == Qt::DisplayRole)
+        return tr("TLE Files");
+    return QVariant();
+}
+
+Qt::ItemFlags TleCatalogueModel::flags(const QModelIndex &index) const
+{
+    if(!index.isValid())
+        return Qt::NoItemFlags;
+    if(index.internalId() == 0)
+        return Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+    return Qt::ItemIsSelectable | Qt::ItemIsUserCheckable | Qt::ItemIsEnabled;
+}
+
+SelectedSegmentModel::SelectedSegmentModel(QObject *parent) :
+    QAbstractTableModel(parent)
+{
+    fetched = 0;
+}
+
+// list NULL shows no segments
+void SelectedSegmentModel::setSegmentList(QList<Segment *> *list)
+{
+    beginResetModel();
+
+    selected.clear();
+    fetched = 0;
+    directory.clear();
+
+    if(list != NULL)
+    {
+        for (int i = 0; i < list->count(); i++)
+        {
+            if(list->at(i)->IsSelected())
+                selected.append(list->at(i));
+        }
+        if(!selected.isEmpty())
+            directory = selected.last()->fileInfo.absolutePath();
+    }
+
+    endResetModel();
+}
+
+void SelectedSegmentModel::clear()
+{
+    setSegmentList(NULL);
+}
+
+int SelectedSegmentModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : fetched;
+}
+
+int SelectedSegmentModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 2;
+}
+
+bool SelectedSegmentModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && fetched < selected.count();
+}
+
+void SelectedSegmentModel::fetchMore(const QModelIndex &parent)
+{
+    if(!canFetchMore(parent))
+        return;
+
+    int count = qMin(EPHEM_FETCH_SIZE, selected.count() - fetched);
+    beginInsertRows(QModelIndex(), fetched, fetched + count - 1);
+    fetched += count;
+    endInsertRows();
+}
+
+QVariant SelectedSegmentModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || role != Qt::DisplayRole)
+        return QVariant();
+
+    Segment *segment = selected.at(index.row());
+    if(index.column() == 0)
+        return segment->fileInfo.fileName();
+    return QString("%1").arg(segment->GetNbrOfLines());
+}
+
+QVariant SelectedSegmentModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+
+    if(section == 0)
+        return directory.isEmpty() ? tr("Selected Segments") : directory;
+    else if(section == 1)
+        return tr("#Lines");
+    return QVariant();
+}
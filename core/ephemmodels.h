@@ -0,0 +1,89 @@
+#ifndef EPHEMMODELS_H
+#define EPHEMMODELS_H
+
+#include <QAbstractItemModel>
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QSet>
+
+#include "satellite.h"
+#include "segment.h"
+
+// rows that are handed to a view in one fetchMore
+#define EPHEM_FETCH_SIZE 256
+
+// The TLE files of opts.tlelist with their satellites, taken from the SatelliteList that has read them.
+// The satellites of a file are handed to the view in batches while it is scrolled. A satellite is
+// checked when its catalogue number is in the checked set, whatever file it is in.
+class TleCatalogueModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    explicit TleCatalogueModel(SatelliteList *satlist, QObject *parent = 0);
+
+    void reload();
+    QString fileName(const QModelIndex &index) const;
+    QStringList checkedCatalogueNumbers() const;
+    QSet<int> checkedSet() const { return checked; }
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+    QModelIndex parent(const QModelIndex &child) const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    Qt::ItemFlags flags(const QModelIndex &index) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
+
+signals:
+    void checkedChanged();
+
+private:
+    struct TleEntry {
+        int catnr;
+        QString name;
+    };
+
+    struct TleFile {
+        QString name;
+        QVector<TleEntry> entries;
+        int fetched;            // rows known to the view
+    };
+
+    SatelliteList *sats;
+    QList<TleFile> files;
+    QSet<int> checked;
+};
+
+// The selected segments of one segment list. The rows point to the segments of the list,
+// the text is made when a row is shown. Cleared before the segment lists are read again.
+class SelectedSegmentModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit SelectedSegmentModel(QObject *parent = 0);
+
+    void setSegmentList(QList<Segment *> *list);
+    void clear();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
+
+private:
+    QList<Segment *> selected;
+    int fetched;
+    QString directory;
+};
+
+#endif // EPHEMMODELS_H
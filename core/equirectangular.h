@@ -15,25 +15,14 @@ public:
     void Initialize(int imwidth, int imheight);
     void map_forward(float lon_deg, float lat_deg, int &map_x, int &map_y);
     void map_inverse(int map_x, int map_y, float &lon_deg, float &lat_deg);
-    void initializeProjectionCoord();
-    qint32 getProjectionX(int line, int pixelx);
-    qint32 getProjectionY(int line, int pixelx);
-    QRgb getProjectionValue(int line, int pixelx);
-    void setProjectionX(int line, int pixelx, int projX);
-    void setProjectionY(int line, int pixelx, int projY);
-    void setProjectionValue(int line, int pixelx, QRgb val);
-    void SmoothProjectionImageBilinear();
 
 private:
 
     AVHRRSatellite *segs;
-    QScopedArrayPointer<float> lon_array;
-    QScopedArrayPointer<float> lat_array;
     int imagewidth;
     int imageheight;
-    QScopedArrayPointer<int> projectionCoordX;
-    QScopedArrayPointer<int> projectionCoordY;
-    QScopedArrayPointer<QRgb> projectionCoordValue;
+    float lon_del;      // degrees per column
+    float lat_del;      // degrees per row
 
 
 };
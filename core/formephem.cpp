@@ -6,15 +6,6 @@
 extern Options opts;
 
 
-QTreeWidgetItem *item(QString name, QTreeWidgetItem* parent=0) {
-     QTreeWidgetItem *retval = new QTreeWidgetItem(parent);
-     retval->setFlags(Qt::ItemIsSelectable |
-         Qt::ItemIsDragEnabled | Qt::ItemIsDropEnabled | Qt::ItemIsUserCheckable |
-         Qt::ItemIsEnabled);
-     retval->setText(0, name);
-     return retval;
-}
-
 FormEphem::FormEphem(QWidget *parent, SatelliteList *satlist, AVHRRSatellite *seglist):
     QWidget(parent),
     ui(new Ui::FormEphem)
@@ -73,8 +64,9 @@ FormEphem::FormEphem(QWidget *parent, SatelliteList *satlist, AVHRRSatellite *se
     ui->calendar->setMaximumDate(QDate(3000, 1, 1));
     ui->calendar->setGridVisible(true);
 
-    ui->tletreewidget->setColumnCount(1);
-    ui->tletreewidget->setHeaderLabels( QStringList() << tr("TLE Files") );
+    tlemodel = new TleCatalogueModel(sats, this);
+    ui->tletreeview->setModel(tlemodel);
+    connect(tlemodel, SIGNAL(checkedChanged()), this, SLOT(tleCheckedChanged()));
 
     ui->satlisttreewidget->setColumnCount(10);
     ui->satlisttreewidget->setHeaderLabels( QStringList() << tr("name") << tr("Catnbr" ) << tr("Days Old")
@@ -95,13 +87,11 @@ FormEphem::FormEphem(QWidget *parent, SatelliteList *satlist, AVHRRSatellite *se
     ui->segmentdirectorywidget->header()->setStretchLastSection(true);
     ui->segmentdirectorywidget->setMinimumHeight(100);
 
-    ui->selectedsegmentwidget->clear();
-    ui->selectedsegmentwidget->setEnabled(true);
-    ui->selectedsegmentwidget->setColumnCount(2);
-    ui->selectedsegmentwidget->setRootIsDecorated(false);
-    ui->selectedsegmentwidget->setHeaderLabels(QStringList() << tr("Selected Segments") << tr("#Lines"));
-    ui->selectedsegmentwidget->header()->setStretchLastSection(true);
-    ui->selectedsegmentwidget->setColumnWidth(0, 300);
+    selectedsegmentmodel = new SelectedSegmentModel(this);
+    ui->selectedsegmentview->setModel(selectedsegmentmodel);
+    ui->selectedsegmentview->setEnabled(true);
+    ui->selectedsegmentview->header()->setStretchLastSection(true);
+    ui->selectedsegmentview->setColumnWidth(0, 300);
 
 /*    QDate now =QDate::currentDate();
     ui->calendar->setSelectedDate(now);
@@ -180,23 +170,15 @@ void FormEphem::on_btnAdd_clicked()
 void FormEphem::on_btnDel_clicked()
 {
     QString sel;
+    QModelIndex index = ui->tletreeview->currentIndex();
 
-    QTreeWidgetItemIterator it1( ui->tletreewidget );
-
-    while (*it1)
+    if ( index.isValid() )
     {
-
-        if ( (*it1)->isSelected() )
-        {
-            if( (*it1)->parent() )
-                QMessageBox::information( this, "QtTrack",
-            "Only Tle files can be removed !" );
-            else
-                sel = (*it1)->text( 0 );
-            break;
-
-        }
-        ++it1;
+        if( index.parent().isValid() )
+            QMessageBox::information( this, "QtTrack",
+        "Only Tle files can be removed !" );
+        else
+            sel = tlemodel->fileName(index);
     }
 
     opts.deleteTleFile( sel);
@@ -228,6 +210,8 @@ void FormEphem::getSegmentsForCalendar()
 {
     QTreeWidgetItem *newitem;
 
+    // the rows point to the segments, that are deleted when the directories are read
+    selectedsegmentmodel->clear();
     segs->ReadDirectories(ui->calendar->selectedDate(), ui->sliNbrOfHours->value());
 
     ui->segmentoverview->clear();
@@ -283,18 +267,8 @@ void FormEphem::setNbrOfHours()
 
 void FormEphem::showAvailSat()
 {
-    QString lleft;
-    QStringList catout;
-
-    ui->tletreewidget->clear();
-    ui->satlisttreewidget->clear();
-
-    ui->tletreewidget->setColumnCount(1);
-
-    QList<QTreeWidgetItem *> tleItemList;
-    QStringList::Iterator its = opts.tlelist.begin();
-
     QStringList outtle;
+    QStringList::Iterator its = opts.tlelist.begin();
 
     while( its != opts.tlelist.end() )
     {
@@ -305,63 +279,11 @@ void FormEphem::showAvailSat()
     }
     opts.tlelist = outtle;
 
-    its = opts.tlelist.begin();
-    while( its != opts.tlelist.end() )
-    {
-        tleItemList.append( item(*its) );
-        qDebug() << "showavailsat : " << *its;
-        ++its;
-    }
-
-    QTreeWidgetItem *titem = 0;
-    unsigned int num = 1;
-    QString line, line1, line2;
-
-    bool ok;
-
-    // go through the list of parent items...
-
-    for ( QList<QTreeWidgetItem*>::Iterator it = tleItemList.begin(); it != tleItemList.end();
-          ++it, num++ )
-    {
-        titem = *it;
-        QFile file( titem->text(0) );
-        //qDebug() << titem->text(0);
-
-        if ( file.open( QIODevice::ReadOnly | QIODevice::Text ) )
-        {
-            QTextStream stream( &file );
-            while ( !stream.atEnd() )
-            {
-                line = stream.readLine(); // line of text excluding '\n'
-                lleft = line.left(1);
-                if ((lleft!=QString("1")) && (lleft!=QString("2")))
-                {
-                    line1 = stream.readLine();
-                    lleft = line1.left(1);
-                    if (lleft!=QString("1")) break;
-                    //qDebug() << line1;
-                    // checkitem = new QCheckListItem( item, line1.mid(2, 5) + QString(" | ") + line.stripWhiteSpace() , QCheckListItem::CheckBox );
-                    QTreeWidgetItem *det = item( line1.mid(2, 5) + QString(" | ") + line.trimmed(), titem );
-                    det->setCheckState(0, Qt::Unchecked );
-                    for ( QStringList::Iterator itc = opts.catnbrlist.begin(); itc != opts.catnbrlist.end(); ++itc )
-                    {
-                        if ( (*itc).toInt( &ok, 10) == line1.mid(2, 5).toInt( &ok, 10 ) )
-                        {
-                            det->setCheckState(0, Qt::Checked);
-                            catout << line1.mid(2, 5);
-                        }
-                    }
-                }
-            }
-            ui->tletreewidget->addTopLevelItem(titem);
-            file.close();
-        }
-        ui->tletreewidget->expandAll();
-
-    }
+    // the satellites come from the list that SatelliteList has read, the files are not read again
+    tlemodel->reload();
+    ui->tletreeview->expandAll();
 
-    opts.catnbrlist = catout;
+    opts.catnbrlist = tlemodel->checkedCatalogueNumbers();
     showActiveSatellites();
 
 }
@@ -485,29 +407,13 @@ void FormEphem::updateSatelliteEphem(void)
 
 }
 
-void FormEphem::on_tletreewidget_itemChanged(QTreeWidgetItem *item, int column)
+void FormEphem::tleCheckedChanged()
 {
-    bool ok;
-
     ui->satlisttreewidget->clear();
     sats->ClearActive();
+    sats->SetActive(tlemodel->checkedSet());
 
-    QStringList fcatnbrs;
-    QTreeWidgetItemIterator it1( ui->tletreewidget );
-
-    while (*it1)
-    {
-
-        if ( (*it1)->checkState(0) == Qt::Checked )
-        {
-          sats->SetActive(((*it1)->text(0)).mid(0,5).toInt(&ok,10));
-          fcatnbrs << ((*it1)->text(0)).mid(0,5);
-          qDebug() << ((*it1)->text(0)).mid(0,5);
-        }
-        ++it1;
-    }
-
-    opts.catnbrlist = fcatnbrs;
+    opts.catnbrlist = tlemodel->checkedCatalogueNumbers();
 
     qDebug() << "addEntry";
 
@@ -624,127 +530,20 @@ void FormEphem::AddRootDirectoryWidgetItem(QString segname, Qt::CheckState check
 
 void FormEphem::showSelectedSegmentList(void)
 {
-
-
-    QList<Segment*> *slmetop = segs->seglmetop->GetSegmentlistptr();
-    QList<Segment*> *slnoaa = segs->seglnoaa->GetSegmentlistptr();
-    QList<Segment*> *slgac = segs->seglgac->GetSegmentlistptr();
-    QList<Segment*> *slhrp = segs->seglhrp->GetSegmentlistptr();
-    QList<Segment*> *slviirsm = segs->seglviirsm->GetSegmentlistptr();
-    QList<Segment*> *slviirsdnb = segs->seglviirsdnb->GetSegmentlistptr();
-    QList<QTreeWidgetItem *> items;
-
-    ui->selectedsegmentwidget->clear();
-
     if (opts.buttonMetop)
-    {
-        QList<Segment*>::iterator segitmetop = slmetop->begin();
-        while ( segitmetop != slmetop->end() )
-        {
-            if((*segitmetop)->IsSelected())
-            {
-                QStringList nl;
-                nl << (*segitmetop)->fileInfo.fileName() << QString("%1").arg((*segitmetop)->GetNbrOfLines());
-                items.append(new QTreeWidgetItem( (QTreeWidget*)0 , nl));
-                ui->selectedsegmentwidget->setHeaderLabel((*segitmetop)->fileInfo.absolutePath());
-            }
-            ++segitmetop;
-        }
-    }
-    else
-    if (opts.buttonNoaa)
-    {
-        QList<Segment*>::iterator segitnoaa = slnoaa->begin();
-        while ( segitnoaa != slnoaa->end() )
-        {
-            if((*segitnoaa)->IsSelected())
-            {
-                QStringList nl;
-                nl << (*segitnoaa)->fileInfo.fileName() << QString("%1").arg((*segitnoaa)->GetNbrOfLines());
-
-                items.append(new QTreeWidgetItem( (QTreeWidget*)0 , nl));
-                ui->selectedsegmentwidget->setHeaderLabel((*segitnoaa)->fileInfo.absolutePath());
-
-            }
-            ++segitnoaa;
-        }
-    }
-    else
-    if (opts.buttonGAC)
-    {
-        QList<Segment*>::iterator segitgac = slgac->begin();
-        while ( segitgac != slgac->end() )
-        {
-            if((*segitgac)->IsSelected())
-            {
-                QStringList nl;
-                nl << (*segitgac)->fileInfo.fileName() << QString("%1").arg((*segitgac)->GetNbrOfLines());
-
-                items.append(new QTreeWidgetItem( (QTreeWidget*)0 , nl));
-                ui->selectedsegmentwidget->setHeaderLabel((*segitgac)->fileInfo.absolutePath());
-
-            }
-            ++segitgac;
-        }
-    }
-    else
-    if (opts.buttonHRP)
-    {
-        QList<Segment*>::iterator segithrp = slhrp->begin();
-        while ( segithrp != slhrp->end() )
-        {
-            if((*segithrp)->IsSelected())
-            {
-                QStringList nl;
-                nl << (*segithrp)->fileInfo.fileName() << QString("%1").arg((*segithrp)->GetNbrOfLines());
-
-                items.append(new QTreeWidgetItem( (QTreeWidget*)0 , nl));
-                ui->selectedsegmentwidget->setHeaderLabel((*segithrp)->fileInfo.absolutePath());
-            }
-            ++segithrp;
-        }
-
-    }
-    else
-    if (opts.buttonVIIRSM)
-    {
-        QList<Segment*>::iterator segitviirsm = slviirsm->begin();
-        while ( segitviirsm != slviirsm->end() )
-        {
-            if((*segitviirsm)->IsSelected())
-            {
-                QStringList nl;
-                nl << (*segitviirsm)->fileInfo.fileName() << QString("%1").arg((*segitviirsm)->GetNbrOfLines());
-
-                items.append(new QTreeWidgetItem( (QTreeWidget*)0 , nl));
-                ui->selectedsegmentwidget->setHeaderLabel((*segitviirsm)->fileInfo.absolutePath());
-            }
-            ++segitviirsm;
-        }
-
-    }
+        selectedsegmentmodel->setSegmentList(segs->seglmetop->GetSegmentlistptr());
+    else if (opts.buttonNoaa)
+        selectedsegmentmodel->setSegmentList(segs->seglnoaa->GetSegmentlistptr());
+    else if (opts.buttonGAC)
+        selectedsegmentmodel->setSegmentList(segs->seglgac->GetSegmentlistptr());
+    else if (opts.buttonHRP)
+        selectedsegmentmodel->setSegmentList(segs->seglhrp->GetSegmentlistptr());
+    else if (opts.buttonVIIRSM)
+        selectedsegmentmodel->setSegmentList(segs->seglviirsm->GetSegmentlistptr());
+    else if (opts.buttonVIIRSDNB)
+        selectedsegmentmodel->setSegmentList(segs->seglviirsdnb->GetSegmentlistptr());
     else
-    if (opts.buttonVIIRSDNB)
-    {
-        QList<Segment*>::iterator segitviirsdnb = slviirsdnb->begin();
-        while ( segitviirsdnb != slviirsdnb->end() )
-        {
-            if((*segitviirsdnb)->IsSelected())
-            {
-                QStringList nl;
-                nl << (*segitviirsdnb)->fileInfo.fileName() << QString("%1").arg((*segitviirsdnb)->GetNbrOfLines());
-
-                items.append(new QTreeWidgetItem( (QTreeWidget*)0 , nl));
-                ui->selectedsegmentwidget->setHeaderLabel((*segitviirsdnb)->fileInfo.absolutePath());
-            }
-            ++segitviirsdnb;
-        }
-
-    }
-
-    ui->selectedsegmentwidget->insertTopLevelItems(0, items);
-
-
+        selectedsegmentmodel->clear();
 }
 
 void FormEphem::on_btnUpdateTLE_clicked()
@@ -12,6 +12,7 @@
 #include "satellite.h"
 #include "avhrrsatellite.h"
 #include "downloadmanager.h"
+#include "ephemmodels.h"
 
 namespace Ui {
     class FormEphem;
@@ -44,6 +45,8 @@ private:
 
     DownloadManager downloadmanager;
     QUdpSocket *udpSocket;
+    TleCatalogueModel *tlemodel;
+    SelectedSegmentModel *selectedsegmentmodel;
 
 
 
@@ -52,7 +55,7 @@ private slots:
     void on_btnAdd_clicked();
     void on_btnDel_clicked();
     void on_btnUpdateTLE_clicked();
-    void on_tletreewidget_itemChanged(QTreeWidgetItem *item, int column);
+    void tleCheckedChanged();
     void itemSelectedtreewidget( QTreeWidgetItem* );
     void itemSelectedsegmentdirectory( QTreeWidgetItem *item);
     void tlefilesread(QString str);
@@ -339,7 +339,7 @@ int FormGeostationary::wildcmp(const char *wild, const char *string)
   return !*wild;
 }
 
-void FormGeostationary::PopulateTreeGeo(SegmentListGeostationary::eGeoSatellite whichgeo, QMap<QString, QMap<QString, QMap< int, QFileInfo > > > map, QTreeWidget *widget)
+void FormGeostationary::PopulateTreeGeo(SegmentListGeostationary::eGeoSatellite whichgeo, QMap<QString, QMap<QString, QMap< int, QFileInfo > > > map, QTreeWidget *widget, const QSet<QString> *dates)
 {
     QStringList strlist;
     QString strnbrlist;
@@ -378,12 +378,19 @@ void FormGeostationary::PopulateTreeGeo(SegmentListGeostationary::eGeoSatellite
     int cnt_B14 = 0;
     int cnt_B16 = 0;
 
-    widget->clear();
+    if(dates == NULL)
+        widget->clear();
 
     QMap<QString, QMap<QString, QMap< int, QFileInfo > > >::const_iterator citdate = map.constBegin();
 
      while (citdate != map.constEnd())
     {
+        if(dates != NULL && !dates->contains(citdate.key()))
+        {
+            ++citdate;
+            continue;
+        }
+
         cnt_hrv = 0;
         cnt_ir016 = 0;
         cnt_ir039 = 0;
@@ -676,7 +683,11 @@ void FormGeostationary::PopulateTreeGeo(SegmentListGeostationary::eGeoSatellite
                        << QString("%1").arg(cnt_B14) << QString("%1").arg(cnt_B16) << QString("%1").arg(cnt_VIS);
         }
 
-        newitem = new QTreeWidgetItem( widget, strlist, 0  );
+        if(dates == NULL)
+            newitem = new QTreeWidgetItem( widget, strlist, 0  );
+        else
+            newitem = UpdateTreeItemGeo(widget, strdate, strlist);
+        newitem->setData(0, Qt::UserRole, strdate);
         if(whichgeo == SegmentListGeostationary::MET_10 || whichgeo == SegmentListGeostationary::MET_8)
         {
             if (cnt_hrv == 24 && cnt_ir016 == 8 && cnt_ir039 == 8 && cnt_ir087 == 8 && cnt_ir097 == 8 && cnt_ir108 == 8 && cnt_ir120 == 8 && cnt_ir134 == 8 && cnt_vis006 == 8
@@ -746,6 +757,37 @@ void FormGeostationary::PopulateTreeGeo(SegmentListGeostationary::eGeoSatellite
 
 }
 
+// The item of timeslot strdate gets the texts of strlist, a new timeslot is inserted in date order
+QTreeWidgetItem *FormGeostationary::UpdateTreeItemGeo(QTreeWidget *widget, const QString &strdate, const QStringList &strlist)
+{
+    QTreeWidgetItem *item = NULL;
+    int insertat = widget->topLevelItemCount();
+    for(int i = 0; i < widget->topLevelItemCount(); i++)
+    {
+        QString itemdate = widget->topLevelItem(i)->data(0, Qt::UserRole).toString();
+        if(itemdate == strdate)
+        {
+            item = widget->topLevelItem(i);
+            break;
+        }
+        if(itemdate > strdate && insertat == widget->topLevelItemCount())
+            insertat = i;
+    }
+
+    if(item == NULL)
+    {
+        item = new QTreeWidgetItem( strlist, 0 );
+        widget->insertTopLevelItem(insertat, item);
+    }
+    else
+    {
+        for(int i = 0; i < strlist.count(); i++)
+            item->setText(i, strlist.at(i));
+    }
+
+    return item;
+}
+
 void FormGeostationary::PopulateTree()
 {
 
@@ -764,6 +806,60 @@ void FormGeostationary::PopulateTree()
 
 }
 
+// Only the timeslots of the files from SegmentDirectoryWatcher are shown again
+void FormGeostationary::UpdateTree(QList<SegmentFileDescriptor> desclist)
+{
+    QHash<int, QSet<QString> > dates;
+    foreach (const SegmentFileDescriptor &desc, desclist)
+        dates[desc.filetype].insert(desc.strdate);
+
+    qDebug() << QString("FormGeostationary::UpdateTree() %1 files").arg(desclist.size());
+
+    QHash<int, QSet<QString> >::const_iterator it = dates.constBegin();
+    while (it != dates.constEnd())
+    {
+        switch(it.key())
+        {
+        case SegmentFileDescriptor::FILE_MET10:
+            PopulateTreeGeo(SegmentListGeostationary::MET_10, segs->segmentlistmapmeteosat, ui->SegmenttreeWidget, &it.value());
+            break;
+        case SegmentFileDescriptor::FILE_MET9:
+            PopulateTreeGeo(SegmentListGeostationary::MET_9, segs->segmentlistmapmeteosatrss, ui->SegmenttreeWidgetRSS, &it.value());
+            break;
+        case SegmentFileDescriptor::FILE_MET8:
+            PopulateTreeGeo(SegmentListGeostationary::MET_8, segs->segmentlistmapmet8, ui->SegmenttreeWidgetMet8, &it.value());
+            break;
+        case SegmentFileDescriptor::FILE_MET7:
+            PopulateTreeGeo(SegmentListGeostationary::MET_7, segs->segmentlistmapmet7, ui->SegmenttreeWidgetMet7, &it.value());
+            break;
+        case SegmentFileDescriptor::FILE_GOES13DC3:
+            PopulateTreeGeo(SegmentListGeostationary::GOES_13, segs->segmentlistmapgoes13dc3, ui->SegmenttreeWidgetGOES13dc3, &it.value());
+            break;
+        case SegmentFileDescriptor::FILE_GOES13DC4:
+            PopulateTreeGeo(SegmentListGeostationary::GOES_13, segs->segmentlistmapgoes13dc4, ui->SegmenttreeWidgetGOES13dc4, &it.value());
+            break;
+        case SegmentFileDescriptor::FILE_GOES15DC3:
+            PopulateTreeGeo(SegmentListGeostationary::GOES_15, segs->segmentlistmapgoes15dc3, ui->SegmenttreeWidgetGOES15dc3, &it.value());
+            break;
+        case SegmentFileDescriptor::FILE_GOES15DC4:
+            PopulateTreeGeo(SegmentListGeostationary::GOES_15, segs->segmentlistmapgoes15dc4, ui->SegmenttreeWidgetGOES15dc4, &it.value());
+            break;
+        case SegmentFileDescriptor::FILE_FY2E:
+            PopulateTreeGeo(SegmentListGeostationary::FY2E, segs->segmentlistmapfy2e, ui->SegmenttreeWidgetFY2E, &it.value());
+            break;
+        case SegmentFileDescriptor::FILE_FY2G:
+            PopulateTreeGeo(SegmentListGeostationary::FY2G, segs->segmentlistmapfy2g, ui->SegmenttreeWidgetFY2G, &it.value());
+            break;
+        case SegmentFileDescriptor::FILE_H8:
+            PopulateTreeGeo(SegmentListGeostationary::H8, segs->segmentlistmaph8, ui->SegmenttreeWidgetH8, &it.value());
+            break;
+        default:
+            break;
+        }
+        ++it;
+    }
+}
+
 FormGeostationary::~FormGeostationary()
 {
     delete ui;
@@ -1196,6 +1292,12 @@ void FormGeostationary::CreateGeoImageXRIT(SegmentListGeostationary *sl, QString
                 }
             }
 
+            if(pro.prologue != 0 && (whichgeo == SegmentListGeostationary::MET_10 || whichgeo == SegmentListGeostationary::MET_9 ||
+                                     whichgeo == SegmentListGeostationary::MET_8))
+                imageptrs->calibrationgeo.setup(pro.prologue->radiometric_proc, prologuefile);
+            else
+                imageptrs->calibrationgeo.invalidate();
+
             // Read epilogue
 
             epiloguefile = fa.epilogueFile();
@@ -1320,6 +1422,8 @@ void FormGeostationary::CreateGeoImageXRIT(SegmentListGeostationary *sl, QString
             sl->LFAC = LFAC_NONHRV_H8;
         }
 
+        sl->SetupProjectionRegion(spectrumvector, inversevector);
+
         if(type == "VIS_IR" || type == "VIS_IR Color" || type == "HRV Color")
         {
             for (int j =  0; j < llVIS_IR.size(); ++j)
@@ -1342,6 +1446,12 @@ void FormGeostationary::CreateGeoImageXRIT(SegmentListGeostationary *sl, QString
                     filedate = fileinfo.fileName().mid(46, 12);
 
                 }
+                if(!sl->isSegmentInProjection(filesequence))
+                {
+                    qDebug() << QString("ComposeImageXRIT VIS_IR outside projection ----> %1").arg(fileinfo.filePath());
+                    sl->DeferSegment(fileinfo.filePath());
+                    continue;
+                }
                 sl->InsertPresent( spectrumvector, filespectrum, filesequence);
                 if(sl->getGeoSatellite() == SegmentListGeostationary::MET_9)
                 {
@@ -1364,6 +1474,12 @@ void FormGeostationary::CreateGeoImageXRIT(SegmentListGeostationary *sl, QString
                 filesequence = fileinfo.fileName().mid(36, 6).toInt()-1;
                 filespectrum = fileinfo.fileName().mid(26, 6);
                 filedate = fileinfo.fileName().mid(46, 12);
+                if(!sl->isSegmentInProjection(filesequence))
+                {
+                    qDebug() << QString("ComposeImageXRIT HRV outside projection ----> %1").arg(fileinfo.filePath());
+                    sl->DeferSegment(fileinfo.filePath());
+                    continue;
+                }
                 sl->InsertPresent( spectrumvector, filespectrum, filesequence);
                 if(sl->getGeoSatellite() == SegmentListGeostationary::MET_9)
                 {
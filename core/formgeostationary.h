@@ -3,6 +3,7 @@
 
 #include <QWidget>
 #include <QTreeWidget>
+#include <QSet>
 #include "satellite.h"
 #include "avhrrsatellite.h"
 #include "msgfileaccess.h"
@@ -35,7 +36,8 @@ public:
 private:
     QStringList getGeostationarySegments(SegmentListGeostationary::eGeoSatellite whichgeo, const QString imagetype, const QString filepath, QVector<QString> spectrumvector, QString filepattern);
     QStringList getGeostationarySegmentsFengYun(SegmentListGeostationary::eGeoSatellite whichgeo, const QString imagetype, const QString filepath, QVector<QString> spectrumvector, QString filepattern);
-    void PopulateTreeGeo(SegmentListGeostationary::eGeoSatellite whichgeo, QMap<QString, QMap<QString, QMap<int, QFileInfo> > > map, QTreeWidget *widget);
+    void PopulateTreeGeo(SegmentListGeostationary::eGeoSatellite whichgeo, QMap<QString, QMap<QString, QMap<int, QFileInfo> > > map, QTreeWidget *widget, const QSet<QString> *dates = NULL);
+    QTreeWidgetItem *UpdateTreeItemGeo(QTreeWidget *widget, const QString &strdate, const QStringList &strlist);
     void CreateGeoImageXRIT(SegmentListGeostationary *sl, QString type, QString tex, QVector<QString> spectrumvector, QVector<bool> inversevector);
     void CreateGeoImageHDF(SegmentListGeostationary *sl, QString type, QString tex, QVector<QString> spectrumvector, QVector<bool> inversevector);
 
@@ -48,6 +50,7 @@ private:
 
 public slots:
     void PopulateTree();
+    void UpdateTree(QList<SegmentFileDescriptor> desclist);
     void CreateGeoImage(QString type, QVector<QString> spectrumvector, QVector<bool> inversevector);
 
 
@@ -1,8 +1,10 @@
 #include "formimage.h"
+#include "tracer.h"
 #include "segmentimage.h"
 #include "options.h"
 #include "gshhsdata.h"
 #include "pixgeoconversion.h"
+#include "memorybudget.h"
 
 #include <qtconcurrentrun.h>
 
@@ -52,8 +54,6 @@ FormImage::FormImage(QWidget *parent, SatelliteList *satlist, AVHRRSatellite *se
     qDebug() << QString("FormImage::FormImage scalefactor = %1").arg(scaleFactor);
     imageLabel = new MyImageLabel;
 
-    imageLabel->setScaledContents(true);
-
     mainLayout = new QVBoxLayout;
     mainLayout->addWidget(imageLabel);
     this->setLayout(mainLayout);
@@ -65,6 +65,9 @@ FormImage::FormImage(QWidget *parent, SatelliteList *satlist, AVHRRSatellite *se
     refreshoverlay = true;
     changeinfraprojection = false;
 
+    connect(&watchergshhs, SIGNAL(finished()), this, SLOT(slotGshhsLoaded()));
+    watchergshhs.setFuture(gshhsdata->loadFuture());
+
     this->setSegmentType(SEG_NONE);
 
     metopcount = 0;
@@ -77,7 +80,7 @@ FormImage::FormImage(QWidget *parent, SatelliteList *satlist, AVHRRSatellite *se
 
 }
 
-QLabel *FormImage::returnimageLabelptr()
+MyImageLabel *FormImage::returnimageLabelptr()
 {
     return imageLabel;
 }
@@ -114,40 +117,45 @@ void FormImage::setPixmapToLabel(bool settoolboxbuttons)
     switch(channelshown)
     {
     case IMAGE_AVHRR_CH1:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimagecomp_ch[0]) ));
+        imageptrs->ComposeChannelImage(0);
+        imageLabel->setImage(&imageptrs->ptrimagechannel);
         break;
     case IMAGE_AVHRR_CH2:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimagecomp_ch[1]) ));
+        imageptrs->ComposeChannelImage(1);
+        imageLabel->setImage(&imageptrs->ptrimagechannel);
         break;
     case IMAGE_AVHRR_CH3:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimagecomp_ch[2]) ));
+        imageptrs->ComposeChannelImage(2);
+        imageLabel->setImage(&imageptrs->ptrimagechannel);
         break;
     case IMAGE_AVHRR_CH4:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimagecomp_ch[3]) ));
+        imageptrs->ComposeChannelImage(3);
+        imageLabel->setImage(&imageptrs->ptrimagechannel);
         break;
     case IMAGE_AVHRR_CH5:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimagecomp_ch[4]) ));
+        imageptrs->ComposeChannelImage(4);
+        imageLabel->setImage(&imageptrs->ptrimagechannel);
         break;
     case IMAGE_AVHRR_COL:
-        imageLabel->setPixmap(QPixmap::fromImage(*(imageptrs->ptrimagecomp_col)));
+        imageLabel->setImage(&imageptrs->ptrimagecomp_col);
         break;
     case IMAGE_AVHRR_EXPAND:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrexpand_col)));
+        imageLabel->setImage(&imageptrs->ptrexpand_col);
         break;
     case IMAGE_GEOSTATIONARY:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimageGeostationary)));
+        imageLabel->setImage(&imageptrs->ptrimageGeostationary);
         break;
     case IMAGE_PROJECTION:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimageProjection)));
+        imageLabel->setImage(&imageptrs->ptrimageProjection);
         break;
     case IMAGE_VIIRS_M:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimageViirsM)));
+        imageLabel->setImage(&imageptrs->ptrimageViirsM);
         break;
     case IMAGE_VIIRS_DNB:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimageViirsDNB)));
+        imageLabel->setImage(&imageptrs->ptrimageViirsDNB);
         break;
     case IMAGE_EQUIRECTANGLE:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimageEquirectangle)));
+        imageLabel->setImage(&imageptrs->ptrimageEquirectangle);
         break;
 
     }
@@ -162,7 +170,7 @@ void FormImage::setPixmapToLabel(bool settoolboxbuttons)
 void FormImage::setPixmapToLabelDNB(bool settoolboxbuttons)
 {
     refreshoverlay = true;
-    imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimageViirsDNB)));
+    imageLabel->setImage(&imageptrs->ptrimageViirsDNB);
     this->update();
 
 }
@@ -178,40 +186,45 @@ void FormImage::displayImage(eImageType channel)
     switch(channelshown)
     {
     case IMAGE_AVHRR_CH1:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimagecomp_ch[0]) ));
+        imageptrs->ComposeChannelImage(0);
+        imageLabel->setImage(&imageptrs->ptrimagechannel);
         break;
     case IMAGE_AVHRR_CH2:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimagecomp_ch[1]) ));
+        imageptrs->ComposeChannelImage(1);
+        imageLabel->setImage(&imageptrs->ptrimagechannel);
         break;
     case IMAGE_AVHRR_CH3:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimagecomp_ch[2]) ));
+        imageptrs->ComposeChannelImage(2);
+        imageLabel->setImage(&imageptrs->ptrimagechannel);
         break;
     case IMAGE_AVHRR_CH4:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimagecomp_ch[3]) ));
+        imageptrs->ComposeChannelImage(3);
+        imageLabel->setImage(&imageptrs->ptrimagechannel);
         break;
     case IMAGE_AVHRR_CH5:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimagecomp_ch[4]) ));
+        imageptrs->ComposeChannelImage(4);
+        imageLabel->setImage(&imageptrs->ptrimagechannel);
         break;
     case IMAGE_AVHRR_COL:
-        imageLabel->setPixmap(QPixmap::fromImage(*(imageptrs->ptrimagecomp_col)));
+        imageLabel->setImage(&imageptrs->ptrimagecomp_col);
         break;
     case IMAGE_AVHRR_EXPAND:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrexpand_col)));
+        imageLabel->setImage(&imageptrs->ptrexpand_col);
         break;
     case IMAGE_GEOSTATIONARY:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimageGeostationary)));
+        imageLabel->setImage(&imageptrs->ptrimageGeostationary);
         break;
     case IMAGE_PROJECTION:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimageProjection)));
+        imageLabel->setImage(&imageptrs->ptrimageProjection);
         break;
     case IMAGE_VIIRS_M:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimageViirsM)));
+        imageLabel->setImage(&imageptrs->ptrimageViirsM);
         break;
     case IMAGE_VIIRS_DNB:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimageViirsDNB)));
+        imageLabel->setImage(&imageptrs->ptrimageViirsDNB);
         break;
     case IMAGE_EQUIRECTANGLE:
-        imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimageEquirectangle)));
+        imageLabel->setImage(&imageptrs->ptrimageEquirectangle);
         break;
 
     }
@@ -542,28 +555,17 @@ void FormImage::zoomOverlaySwitch()
 }
 */
 
+// The image itself is painted by the label, here the caption and the overlay
+// are handed to it. The overlay is recorded once in image coordinates.
 void FormImage::paintEvent( QPaintEvent * )
 {
-    if (imageLabel->pixmap() == 0)
-        return;
-
-    QPixmap *pix;
-    pix=(QPixmap *)imageLabel->pixmap();
-
-    if(pix->height() == 0)
+    if (imageLabel->isEmpty())
         return;
 
-    //pix=imageLabel->pixmap();
-    //pix=QPixmap::fromImage(*(imageptrs->ptrimageMeteosat));
-    QPainter painter(pix);
-
     if(channelshown >= 1 && channelshown <= 8)
-    {
-        QFont f("Courier", 40, QFont::Bold);
-        painter.setFont(f);
-        painter.setPen(Qt::yellow);
-        painter.drawText(10, 50, kindofimage);
-    }
+        imageLabel->setCaption(kindofimage);
+    else
+        imageLabel->setCaption(QString());
 
 
     SegmentListGeostationary *sl = NULL;
@@ -626,14 +628,25 @@ void FormImage::paintEvent( QPaintEvent * )
         displayGeoImageInfo();
 
 
-    if (channelshown == IMAGE_GEOSTATIONARY && overlaymeteosat && refreshoverlay)
+    // without the coastlines the overlay waits for slotGshhsLoaded, the GUI thread does not block on the load
+    bool gshhsloaded = gshhsdata->isDataLoaded();
+
+    if (channelshown == IMAGE_GEOSTATIONARY && overlaymeteosat && refreshoverlay && gshhsloaded)
     {
+        QPicture overlay;
+        QPainter painter(&overlay);
         this->OverlayGeostationary(&painter, sl);
+        painter.end();
+        imageLabel->setOverlay(overlay);
         refreshoverlay = false;
     }
-    if(channelshown == IMAGE_PROJECTION && overlayprojection && refreshoverlay)
+    if(channelshown == IMAGE_PROJECTION && overlayprojection && refreshoverlay && gshhsloaded)
     {
+        QPicture overlay;
+        QPainter painter(&overlay);
         this->OverlayProjection(&painter, sl);
+        painter.end();
+        imageLabel->setOverlay(overlay);
         refreshoverlay = false;
     }
 
@@ -642,8 +655,6 @@ void FormImage::paintEvent( QPaintEvent * )
         changeinfraprojection = false;
     }
 
-    this->adjustImage();
-
 }
 
 void FormImage::displayAVHRRImageInfo()
@@ -826,8 +837,8 @@ void FormImage::adjustPicSize(bool setwidth)
     double w,h,mw,mh,rw,rh,g=1;
     if(channelshown >= 1 && channelshown <= 6)
     {
-        w=imageptrs->ptrimagecomp_ch[0]->width();
-        h=imageptrs->ptrimagecomp_ch[0]->height();
+        w=imageptrs->ptrimagecomp_col->width();
+        h=imageptrs->ptrimagecomp_col->height();
     }
     else if(channelshown == 7)
     {
@@ -903,16 +914,9 @@ void FormImage::adjustImage()
 {
 
     scaleFactor = (double)getZoomValue()/100;
-    if(scaleFactor==1)
-    {
-        imageLabel->adjustSize();
-        this->adjustSize();
-    }
-    else
-    {
-        imageLabel->resize(imageLabel->pixmap()->size() * scaleFactor);
-        this->resize(imageLabel->pixmap()->size() * scaleFactor);
-    }
+    imageLabel->setScale(scaleFactor);
+    imageLabel->adjustSize();
+    this->adjustSize();
 
     QString windowTitleFormat = QString("EUMETCastView zoomLevel");
     windowTitleFormat.replace("zoomLevel", QString("%1%").arg((int)(getZoomValue())));
@@ -925,11 +929,6 @@ void FormImage::slotUpdateMeteosat()
 
     qDebug() << "start FormImage::slotUpdateMeteosat()";
 
-    refreshoverlay = true;
-
-    imageLabel->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimageGeostationary)));
-    this->adjustImage();
-
     SegmentListGeostationary *sl;
     if(segs->seglmeteosat->bActiveSegmentList == true)
     {
@@ -976,13 +975,28 @@ void FormImage::slotUpdateMeteosat()
         sl = segs->seglh8;
     }
     else
+    {
+        refreshoverlay = true;
+        imageLabel->setImage(&imageptrs->ptrimageGeostationary);
+        this->adjustImage();
         return;
+    }
 
+    // The XRIT segments are already on screen through slotSegmentComposed,
+    // the whole image is only taken over again when all segments are in (HRV Color and
+    // Himawari change it at the end) or for FY2, that is composed in one go.
+    bool fengyun = (sl->getGeoSatellite() == SegmentListGeostationary::FY2E || sl->getGeoSatellite() == SegmentListGeostationary::FY2G);
 
     if(sl->allSegmentsReceived())
     {
+        refreshoverlay = true;
+        imageLabel->setImage(&imageptrs->ptrimageGeostationary);
+        this->adjustImage();
+
         QApplication::restoreOverrideCursor();
 
+        MemoryBudget::instance()->update(sl);
+
         if(opts.imageontextureOnMet)
         {
             if(sl->getKindofImage() == "HRV" || sl->getKindofImage() == "HRV Color")
@@ -990,21 +1004,59 @@ void FormImage::slotUpdateMeteosat()
                 qDebug() << "all HRV received !!!!!!!!!!!!!!";
                 emit allsegmentsreceivedbuttons(true);
             }
-            else
+            else if(fengyun || sl->getGeoSatellite() == SegmentListGeostationary::H8)
             {
                 qDebug() << "all VIS_IR received !!!!!!!!!!!!!!";
                 emit render3dgeo(sl->getGeoSatellite());
             }
+            else
+            {
+                qDebug() << "all VIS_IR received, segments already on the globe";
+                emit allsegmentsreceivedbuttons(true);
+            }
         }
         else
             emit allsegmentsreceivedbuttons(true);
     }
+    else if(fengyun)
+    {
+        refreshoverlay = true;
+        imageLabel->setImage(&imageptrs->ptrimageGeostationary);
+        this->adjustImage();
+
+        MemoryBudget::instance()->update(sl);
+    }
 
     qDebug() << "FormImage::slotUpdateMeteosat()";
     this->update();
 
 }
 
+void FormImage::slotSegmentComposed(int firstline, int nbroflines, bool complete)
+{
+    SegmentListGeostationary *sl = qobject_cast<SegmentListGeostationary *>(sender());
+
+    if(sl == NULL || sl->bActiveSegmentList == false || channelshown != IMAGE_GEOSTATIONARY || imageLabel->isEmpty())
+        return;
+
+    QImage *im = imageptrs->ptrimageGeostationary;
+
+    if(imageLabel->imageSize() != im->size())
+        return;
+
+    QRect rows = QRect(0, firstline, im->width(), nbroflines).intersected(im->rect());
+    if(rows.isEmpty())
+        return;
+
+    // only the tiles of this segment are uploaded again
+    imageLabel->updateRows(rows.top(), rows.height());
+
+    // Himawari is stretched again when all segments are in, it goes on the globe in one go
+    if(complete && opts.imageontextureOnMet && sl->getKindofImage() != "HRV" && sl->getKindofImage() != "HRV Color" &&
+            sl->getGeoSatellite() != SegmentListGeostationary::H8)
+        emit render3dgeosegment(sl->getGeoSatellite(), rows.top(), rows.height());
+}
+
 //void FormImage::slotUpdateHimawari()
 //{
 
@@ -1059,8 +1111,8 @@ void FormImage::slotUpdateProjection()
 QSize FormImage::getPictureSize() const
 {
     QSize g;
-    if(!imageLabel->pixmap()->isNull())
-        g = imageLabel->pixmap()->size();
+    if(!imageLabel->isEmpty())
+        g = imageLabel->imageSize();
     else
         g = QSize(-1,-1);
 
@@ -1149,6 +1201,9 @@ void FormImage::recalculateCLAHE(QVector<QString> spectrumvector, QVector<bool>
     if (sl->getKindofImage() == "HRV Color")
         return;
 
+    // the channel buffers may have been given back to the memory budget
+    sl->ReloadReleasedBuffers();
+
     size_t npix;
     size_t npixHRV;
     if(sl->getGeoSatellite() == SegmentListGeostationary::MET_10 || sl->getGeoSatellite() == SegmentListGeostationary::MET_8)
@@ -1327,17 +1382,17 @@ void FormImage::recalculateCLAHE(QVector<QString> spectrumvector, QVector<bool>
 
     if(sl->getKindofImage() == "VIS_IR Color" && (sl->getGeoSatellite() == SegmentListGeostationary::MET_10 || sl->getGeoSatellite() == SegmentListGeostationary::MET_9 || sl->getGeoSatellite() == SegmentListGeostationary::MET_8 ))
     {
-        imageptrs->CLAHE(pixelsRed, 3712, (sl->bisRSS ? 3*464 : 3712), 0, 1023, 16, 16, 256, opts.clahecliplimit);
-        imageptrs->CLAHE(pixelsGreen, 3712, (sl->bisRSS ? 3*464 : 3712), 0, 1023, 16, 16, 256, opts.clahecliplimit);
-        imageptrs->CLAHE(pixelsBlue, 3712, (sl->bisRSS ? 3*464 : 3712), 0, 1023, 16, 16, 256, opts.clahecliplimit);
+        imageptrs->clahegeo[0].equalize(pixelsRed, 3712, (sl->bisRSS ? 3*464 : 3712), 0, 1023, 16, 16, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
+        imageptrs->clahegeo[1].equalize(pixelsGreen, 3712, (sl->bisRSS ? 3*464 : 3712), 0, 1023, 16, 16, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
+        imageptrs->clahegeo[2].equalize(pixelsBlue, 3712, (sl->bisRSS ? 3*464 : 3712), 0, 1023, 16, 16, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
     }
     else if(sl->getKindofImage() == "VIS_IR Color" && sl->getGeoSatellite() == SegmentListGeostationary::H8 )
     {
-        ret = imageptrs->CLAHE(pixelsRed, 5500, 5500, 0, 1023, 10, 10, 256, opts.clahecliplimit);
+        ret = imageptrs->clahegeo[0].equalize(pixelsRed, 5500, 5500, 0, 1023, 10, 10, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
         qDebug() << QString("CLAHE return code = %1").arg(ret);
-        imageptrs->CLAHE(pixelsGreen, 5500, 5500, 0, 1023, 10, 10, 256, opts.clahecliplimit);
+        imageptrs->clahegeo[1].equalize(pixelsGreen, 5500, 5500, 0, 1023, 10, 10, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
         qDebug() << QString("CLAHE return code = %1").arg(ret);
-        imageptrs->CLAHE(pixelsBlue, 5500, 5500, 0, 1023, 10, 10, 256, opts.clahecliplimit);
+        imageptrs->clahegeo[2].equalize(pixelsBlue, 5500, 5500, 0, 1023, 10, 10, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
         qDebug() << QString("CLAHE return code = %1").arg(ret);
     }
     else if(sl->getKindofImage() == "HRV" && (sl->getGeoSatellite() == SegmentListGeostationary::MET_10 || sl->getGeoSatellite() == SegmentListGeostationary::MET_9 || sl->getGeoSatellite() == SegmentListGeostationary::MET_8))
@@ -1345,7 +1400,7 @@ void FormImage::recalculateCLAHE(QVector<QString> spectrumvector, QVector<bool>
         if(sl->bisRSS)
         {
             qDebug() << "recalculateCLAHE() ; isRSS = true";
-            imageptrs->CLAHE(pixelsHRV, 5568, 5*464, 0, 1023, 16, 16, 256, opts.clahecliplimit);
+            imageptrs->clahegeo[0].equalize(pixelsHRV, 5568, 5*464, 0, 1023, 16, 16, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
 
         }
         else
@@ -1353,40 +1408,40 @@ void FormImage::recalculateCLAHE(QVector<QString> spectrumvector, QVector<bool>
             if(sl->areatype == 1)
             {
                 qDebug() << "recalculateCLAHE() ; areatype == 1";
-                imageptrs->CLAHE(pixelsHRV, 5568, 11136, 0, 1023, 16, 16, 256, opts.clahecliplimit);
+                imageptrs->clahegeo[0].equalize(pixelsHRV, 5568, 11136, 0, 1023, 16, 16, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
             }
             else
             {
                 qDebug() << "recalculateCLAHE() ; areatype == 0";
-                imageptrs->CLAHE(pixelsHRV, 5568, 5*464, 0, 1023, 16, 16, 256, opts.clahecliplimit);
+                imageptrs->clahegeo[0].equalize(pixelsHRV, 5568, 5*464, 0, 1023, 16, 16, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
             }
         }
     }
     else if(sl->getKindofImage() == "HRV" && (sl->getGeoSatellite() == SegmentListGeostationary::FY2E || sl->getGeoSatellite() == SegmentListGeostationary::FY2G ))
     {
-        imageptrs->CLAHE(pixelsHRV, 9152, 9152, 0, 255, 16, 16, 256, opts.clahecliplimit);
+        imageptrs->clahegeo[0].equalize(pixelsHRV, 9152, 9152, 0, 255, 16, 16, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
     }
     else if(sl->getKindofImage() == "VIS_IR")
     {
         if(sl->getGeoSatellite() == SegmentListGeostationary::MET_10 || sl->getGeoSatellite() == SegmentListGeostationary::MET_8)
-            imageptrs->CLAHE(pixelsRed, 3712, 3712, 0, 1023, 16, 16, 256, opts.clahecliplimit);
+            imageptrs->clahegeo[0].equalize(pixelsRed, 3712, 3712, 0, 1023, 16, 16, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
         else if(sl->getGeoSatellite() == SegmentListGeostationary::MET_9)
-            imageptrs->CLAHE(pixelsRed, 3712, 3*464, 0, 1023, 16, 16, 256, opts.clahecliplimit);
+            imageptrs->clahegeo[0].equalize(pixelsRed, 3712, 3*464, 0, 1023, 16, 16, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
         else if(sl->getGeoSatellite() == SegmentListGeostationary::MET_7)
         {
             qDebug() << "SegmentListMeteosat::MET_7";
 
             if(spectrumvector.at(0) == "00_7_0")
-                imageptrs->CLAHE(pixelsRed, 5032, 5000, 0, 255, 8, 10, 256, opts.clahecliplimit);
+                imageptrs->clahegeo[0].equalize(pixelsRed, 5032, 5000, 0, 255, 8, 10, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
             else
-                imageptrs->CLAHE(pixelsRed, 2532, 5*500, 0, 255, 12, 10, 256, opts.clahecliplimit);
+                imageptrs->clahegeo[0].equalize(pixelsRed, 2532, 5*500, 0, 255, 12, 10, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
         }
         else if(sl->getGeoSatellite() == SegmentListGeostationary::GOES_13 || sl->getGeoSatellite() == SegmentListGeostationary::GOES_15)
-            imageptrs->CLAHE(pixelsRed, 2816, 464*7, 0, 1023, 16, 16, 256, opts.clahecliplimit);
+            imageptrs->clahegeo[0].equalize(pixelsRed, 2816, 464*7, 0, 1023, 16, 16, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
         else if(sl->getGeoSatellite() == SegmentListGeostationary::FY2E || sl->getGeoSatellite() == SegmentListGeostationary::FY2G)
-            imageptrs->CLAHE(pixelsRed, 2288, 2288, 0, 255, 16, 16, 256, opts.clahecliplimit);
+            imageptrs->clahegeo[0].equalize(pixelsRed, 2288, 2288, 0, 255, 16, 16, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
         else if(sl->getGeoSatellite() == SegmentListGeostationary::H8)
-            imageptrs->CLAHE(pixelsRed, 5500, 5500, 0, 1023, 10, 10, 256, opts.clahecliplimit);
+            imageptrs->clahegeo[0].equalize(pixelsRed, 5500, 5500, 0, 1023, 10, 10, 256, opts.clahecliplimit, imageptrs->geostationarygeneration.load());
     }
 
     //g_mutex.lock();
@@ -1747,11 +1802,16 @@ void FormImage::fillptrimageHRV(quint16 *pixHRV)
 
 void FormImage::OverlayGeostationary(QPainter *paint, SegmentListGeostationary *sl)
 {
+    TraceSpan span("overlay", "FormImage::OverlayGeostationary");
 
     qDebug() << "FormImage::OverlayGeostationary(QPainter *paint, SegmentListGeostationary *sl)";
 
-    if (imageLabel->pixmap() == 0)
+    if (imageLabel->isEmpty())
         return;
+
+    if(!gshhsdata->isDataLoaded())
+        return;
+
     pixgeoConversion pixconv;
 
     long coff;
@@ -2153,6 +2213,7 @@ void FormImage::OverlayAVHRRImage(QPainter *paint)
 
 void FormImage::OverlayProjection(QPainter *paint, SegmentListGeostationary *sl)
 {
+    TraceSpan span("overlay", "FormImage::OverlayProjection");
     qDebug() << QString("FormImage::OverlayProjection(QPainter *paint, SegmentListGeostationary *sl) opts.currenttoolbox = %1").arg(opts.currenttoolbox);
 
     bool first = true;
@@ -2163,6 +2224,9 @@ void FormImage::OverlayProjection(QPainter *paint, SegmentListGeostationary *sl)
     double map_x, map_y;
     double save_map_x, save_map_y;
 
+    if(!gshhsdata->isDataLoaded())
+        return;
+
     lat_deg = opts.obslat;
     lon_deg = opts.obslon;
     if (lon_deg > 180.0)
@@ -2550,71 +2614,25 @@ void FormImage::OverlayProjection(QPainter *paint, SegmentListGeostationary *sl)
 
 void FormImage::ToInfraColorProjection()
 {
-    QRgb *row;
-    float btemp;
-
     float mintemp;
     float maxtemp;
 
-    int height = imageptrs->ptrimageProjection->height();
-    int width = imageptrs->ptrimageProjection->width();
-
     dockinfrascales->getMinMaxTemp(&mintemp, &maxtemp);
 
     qDebug() << QString("FormImage::ToInfraColorProjection() min temp = %1 max temp = %2").arg(mintemp).arg(maxtemp);
 
-    float delta = maxtemp - mintemp;
-
-    float min = 9999999.0;
-    float max = 0.0;
-    int valcount = 0;
+    float min;
+    float max;
 
-    for(int y = 0; y < height; y++)
-    {
-        for(int x = 0; x < width; x++)
-        {
-            if(imageptrs->ptrProjectionBrightnessTemp.isNull())
-                return;
-            btemp = imageptrs->ptrProjectionBrightnessTemp[y * width + x];
-            float fval = (btemp - mintemp)/delta;
-            int val = qRound(fval*255.0);
-            if(btemp > 0)
-            {
-                if(btemp>=max)
-                    max=btemp;
-                if(btemp<=min)
-                    min=btemp;
-            }
-
-        }
-    }
-
-    delta = max - min;
-
-    qDebug() << QString("----> ToInfraColorProjection() min = %1 max = %2 valcount = %3").arg(min).arg(max).arg(valcount);
-
-
-    for(int y = 0; y < height; y++)
-    {
-        row = (QRgb*)imageptrs->ptrimageProjection->scanLine(y);
-
-        for(int x = 0; x < width; x++)
-        {
-            //quint8 greyval = imageptrs->ptrProjectionInfra[y * width + x];
+    if(!InfraScales::getProjectionMinMax(&min, &max))
+        return;
 
-            if(imageptrs->ptrProjectionBrightnessTemp.isNull())
-                return;
-            btemp = imageptrs->ptrProjectionBrightnessTemp[y * width + x];
-            float fval = (btemp - min)/delta;
-            if(btemp > 0)
-            {
-                row[x] = dockinfrascales->getColor(fval).rgb();
-            }
+    qDebug() << QString("----> ToInfraColorProjection() min = %1 max = %2").arg(min).arg(max);
 
-        }
-    }
+    dockinfrascales->colorProjection(min, max - min, false);
 
     changeinfraprojection = true;
+    imageChanged(imageptrs->ptrimageProjection);
 }
 
 void FormImage::FromInfraColorProjection()
@@ -2636,6 +2654,7 @@ void FormImage::FromInfraColorProjection()
     }
 
     changeinfraprojection = true;
+    imageChanged(imageptrs->ptrimageProjection);
 
 }
 
@@ -2698,10 +2717,29 @@ void FormImage::slotRefreshOverlay()
     this->displayImage(this->channelshown);
 }
 
+void FormImage::slotGshhsLoaded()
+{
+    qDebug() << "FormImage::slotGshhsLoaded()";
+    refreshoverlay = true;
+    if(channelshown == IMAGE_GEOSTATIONARY || channelshown == IMAGE_PROJECTION)
+        this->displayImage(this->channelshown);
+    this->update();
+}
+
 void FormImage::slotRepaintProjectionImage()
 {
     changeinfraprojection = true;
-    this->displayImage(this->channelshown);
+    if(channelshown == IMAGE_PROJECTION && imageLabel->shows(imageptrs->ptrimageProjection))
+        imageChanged(imageptrs->ptrimageProjection);
+    else
+        this->displayImage(this->channelshown);
+}
+
+// image was written in place, the tiles of the label that shows it are made again
+void FormImage::imageChanged(const QImage *image)
+{
+    if(imageLabel->shows(image))
+        imageLabel->updateRows(0, image->height());
 }
 
 FormImage::~FormImage()
@@ -2709,14 +2747,113 @@ FormImage::~FormImage()
 
 }
 
-MyImageLabel::MyImageLabel(QLabel *parent ) :  QLabel(parent)
+MyImageLabel::MyImageLabel(QWidget *parent ) :  QWidget(parent)
 {
     //setMouseTracking(true);
+    imageslot = NULL;
+    scale = 1.0;
+}
+
+// slot is the member of SegmentImage that holds the image, the image it points to
+// is taken over again when it is replaced
+void MyImageLabel::setImage(QImage **slot)
+{
+    imageslot = slot;
+    pyramid.setImage(slot == NULL ? NULL : *slot);
+    overlay = QPicture();
+    updateGeometry();
+    update();
+}
+
+void MyImageLabel::updateRows(int first, int count)
+{
+    pyramid.updateRows(first, count);
+    update(QRect(0, (int)floor(first * scale), width(), (int)ceil(count * scale) + 2));
+}
+
+void MyImageLabel::setScale(double s)
+{
+    if(s == scale)
+        return;
+    scale = s;
+    updateGeometry();
+    update();
+}
+
+void MyImageLabel::setOverlay(const QPicture &picture)
+{
+    overlay = picture;
+    update();
+}
+
+void MyImageLabel::setCaption(QString text)
+{
+    if(text == caption)
+        return;
+    caption = text;
+    update();
+}
+
+QSize MyImageLabel::sizeHint() const
+{
+    return pyramid.size() * scale;
+}
+
+// The image at full size with the overlay and the caption, for saving
+QImage MyImageLabel::toImage()
+{
+    if(pyramid.isEmpty())
+        return QImage();
+
+    g_mutex.lock();
+    QImage im = pyramid.image()->copy().convertToFormat(QImage::Format_ARGB32);
+    g_mutex.unlock();
+
+    QPainter painter(&im);
+    paintDecoration(&painter);
+    painter.end();
+
+    return im;
+}
+
+// The overlay of the AVHRR, VIIRS and geostationary images and of the projections, with the caption
+void MyImageLabel::paintDecoration(QPainter *painter)
+{
+    TraceSpan span("overlay", "MyImageLabel::paintDecoration");
+
+    if(!overlay.isNull())
+        painter->drawPicture(0, 0, overlay);
+
+    if(!caption.isEmpty())
+    {
+        QFont f("Courier", 40, QFont::Bold);
+        painter->setFont(f);
+        painter->setPen(Qt::yellow);
+        painter->drawText(10, 50, caption);
+    }
+}
+
+void MyImageLabel::paintEvent(QPaintEvent *event)
+{
+    QImage *current = (imageslot == NULL ? NULL : *imageslot);
+    if(current != pyramid.image() || (current != NULL && current->size() != pyramid.size()))
+    {
+        pyramid.setImage(current);
+        updateGeometry();
+    }
+
+    if(pyramid.isEmpty())
+        return;
+
+    QPainter painter(this);
+    pyramid.paint(&painter, event->rect(), scale);
+    painter.scale(scale, scale);
+    paintDecoration(&painter);
 }
 
 void MyImageLabel::mouseMoveEvent(QMouseEvent *event)
 {
     //qDebug() << QString("myimagelabel mousemoveevent pos.x = %1 pos.y = %2").arg(event->pos().x()).arg(event->pos().y());
 
-    QLabel::mouseMoveEvent(event);
+    QWidget::mouseMoveEvent(event);
 }
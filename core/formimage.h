@@ -3,12 +3,15 @@
 
 #include <QWidget>
 #include <QHBoxLayout>
+#include <QPicture>
+#include <QFutureWatcher>
 
 #include "satellite.h"
 #include "avhrrsatellite.h"
 #include "generalverticalperspective.h"
 #include "formtoolbox.h"
 #include "forminfrascales.h"
+#include "imagepyramid.h"
 
 class FormToolbox;
 class FormInfraScales;
@@ -20,7 +23,7 @@ class FormImage : public QWidget
 
 public:
     explicit FormImage(QWidget *parent = 0, SatelliteList *satlist=0, AVHRRSatellite *seglist=0);
-    QLabel *returnimageLabelptr();
+    MyImageLabel *returnimageLabelptr();
     void ComposeImage();
     bool ShowVIIRSMImage();
     bool ShowVIIRSDNBImage();
@@ -42,6 +45,7 @@ public:
     void showInfraScales() { changeinfraprojection = true; }
 
     void displayImage(eImageType channel);
+    void imageChanged(const QImage *image);
     void test();
     void setKindOfImage(QString koi) { kindofimage = koi; }
     QString getKindOfImage() { return kindofimage; }
@@ -101,6 +105,8 @@ private:
     bool overlayprojection;
     bool changeinfraprojection;
 
+    QFutureWatcher<void> watchergshhs;  // the overlays are drawn once the coastlines are loaded
+
     QString kindofimage;
     eSegmentType segmenttype;
 
@@ -122,6 +128,7 @@ signals:
     void pixmapChanged();
     void wheelZoom(int);
     void render3dgeo(SegmentListGeostationary::eGeoSatellite);
+    void render3dgeosegment(SegmentListGeostationary::eGeoSatellite, int, int);
     void allsegmentsreceivedbuttons(bool);
 
 public slots:
@@ -130,9 +137,11 @@ public slots:
     void setPixmapToLabel(bool settoolboxbuttons);
     void setPixmapToLabelDNB(bool settoolboxbuttons);
     void slotUpdateMeteosat();
+    void slotSegmentComposed(int firstline, int nbroflines, bool complete);
     // void slotUpdateHimawari();
     void slotUpdateProjection();
     void slotRefreshOverlay();
+    void slotGshhsLoaded();
     void slotRepaintProjectionImage();
 
 protected:
@@ -144,16 +153,38 @@ protected:
 
 };
 
-class MyImageLabel : public QLabel
+// Shows the image at the zoom of FormImage. Only the visible tiles of the level that
+// fits the zoom are painted, the overlay and the caption are drawn on top in image coordinates.
+class MyImageLabel : public QWidget
 {
     Q_OBJECT
 public:
-    explicit MyImageLabel(QLabel *parent = 0);
+    explicit MyImageLabel(QWidget *parent = 0);
+
+    void setImage(QImage **slot);
+    void updateRows(int first, int count);
+    bool shows(const QImage *image) const { return image != NULL && pyramid.image() == image; }
+    void setScale(double s);
+    void setOverlay(const QPicture &picture);
+    void setCaption(QString text);
+    bool isEmpty() const { return pyramid.isEmpty(); }
+    QSize imageSize() const { return pyramid.size(); }
+    QImage toImage();
+    QSize sizeHint() const;
 
-public:
 protected:
+    void paintEvent(QPaintEvent *);
     void mouseMoveEvent(QMouseEvent *);
 
+private:
+    void paintDecoration(QPainter *painter);
+
+    QImage **imageslot;
+    ImagePyramid pyramid;
+    QPicture overlay;
+    QString caption;
+    double scale;
+
 };
 
 #endif // FORMIMAGE_H
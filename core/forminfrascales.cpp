@@ -52,3 +52,7 @@ QColor FormInfraScales::getColor(float value)
     return this->infrascales->getColor(value);
 }
 
+void FormInfraScales::colorProjection(float mintemp, float deltatemp, bool uselimits)
+{
+    this->infrascales->colorProjection(mintemp, deltatemp, uselimits);
+}
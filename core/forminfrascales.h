@@ -19,6 +19,7 @@ public:
     void getMinMaxTemp(float *mintemp, float *maxtemp);
     void setInverse(bool inverse);
     QColor getColor(float value);
+    void colorProjection(float mintemp, float deltatemp, bool uselimits);
     void setFormImage(FormImage *ptr);
 
 private:
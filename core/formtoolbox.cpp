@@ -1171,13 +1171,14 @@ void FormToolbox::on_btnExpandImage_clicked()
         return;
     formimage->setKindOfImage("Expanded " + formimage->getKindOfImage());
     imageptrs->ExpandImage(formimage->channelshown);
+    formimage->imageChanged(imageptrs->ptrexpand_col);
     formimage->displayImage(IMAGE_AVHRR_EXPAND);
 }
 
 void FormToolbox::on_btnRotate180_clicked()
 {
     imageptrs->RotateImage();
-    formimage->returnimageLabelptr()->setPixmap(QPixmap::fromImage( *(imageptrs->ptrimagecomp_col)));
+    formimage->returnimageLabelptr()->setImage(&imageptrs->ptrimagecomp_col);
     formimage->adjustImage();
 }
 
@@ -2467,7 +2468,10 @@ void FormToolbox::on_btnCreatePerspective_clicked()
     else if(ui->rdbVIIRSDNBin->isChecked())
         imageptrs->gvp->CreateMapFromVIIRS(eSegmentType::SEG_VIIRSDNB, ui->rdbCombine->isChecked());
     else if(ui->rdbMeteosatin->isChecked())
+    {
         imageptrs->gvp->CreateMapFromGeoStationary();
+        initializeScalesGeostationary();
+    }
     else if(ui->rdbEquirectin->isChecked())
         imageptrs->gvp->CreateMapFromEquirectangular();
 
@@ -2506,6 +2510,41 @@ void FormToolbox::initializeScales()
 
 }
 
+// A projection of a calibrated MSG infrared channel has brightness temperatures for the false colours
+void FormToolbox::initializeScalesGeostationary()
+{
+    if(imageptrs->ptrProjectionBrightnessTemp.isNull())
+    {
+        imageptrs->ptrProjectionInfra.reset();
+        return;
+    }
+
+    copyProjectionImage();
+
+    float mintemp, maxtemp;
+    InfraScales::getProjectionMinMax(&mintemp, &maxtemp);
+
+    forminfrascales->initializeLowHigh();
+    forminfrascales->setMinMaxTemp(mintemp, maxtemp);
+    forminfrascales->setInverse(false);
+
+    qDebug() << QString("initializeScalesGeostationary setMinMaxTemp %1 %2").arg(mintemp).arg(maxtemp);
+}
+
+// VIIRS M12 to M16 or a calibrated MSG infrared channel
+bool FormToolbox::isInfraProjection()
+{
+    if(imageptrs->ptrProjectionInfra.isNull())
+        return false;
+
+    if(ui->rdbMeteosatin->isChecked())
+        return !imageptrs->ptrProjectionBrightnessTemp.isNull();
+
+    QList<bool> blist = this->getVIIRSMBandList();
+    return ui->rdbVIIRSMin->isChecked() &&
+            (blist.at(12) == true || blist.at(13) == true || blist.at(14) == true || blist.at(15) == true || blist.at(16) == true );
+}
+
 void FormToolbox::copyProjectionImage()
 {
     int width = imageptrs->ptrimageProjection->width();
@@ -2609,7 +2648,10 @@ void FormToolbox::on_btnCreateLambert_clicked()
     else if(ui->rdbVIIRSDNBin->isChecked())
         imageptrs->lcc->CreateMapFromVIIRS(eSegmentType::SEG_VIIRSDNB, ui->rdbCombine->isChecked());
     else
+    {
         imageptrs->lcc->CreateMapFromGeostationary();
+        initializeScalesGeostationary();
+    }
 
     if(ui->rdbCombine->isChecked())
         delete imageptrs->ptrimageProjectionCopy;
@@ -2697,7 +2739,10 @@ void FormToolbox::on_btnCreateStereo_clicked()
     else if(ui->rdbVIIRSDNBin->isChecked())
         imageptrs->sg->CreateMapFromVIIRS(eSegmentType::SEG_VIIRSDNB, ui->rdbCombine->isChecked());
     else
+    {
         imageptrs->sg->CreateMapFromGeostationary();
+        initializeScalesGeostationary();
+    }
 
     if(ui->rdbCombine->isChecked())
         delete imageptrs->ptrimageProjectionCopy;
@@ -3953,7 +3998,7 @@ void FormToolbox::on_btnGVPFalseColor_clicked()
     if(imageptrs->ptrProjectionInfra.isNull())
     {
         QMessageBox msgBox;
-        msgBox.setText("Only for VIIRS channels M12 to M16.");
+        msgBox.setText("Only for VIIRS channels M12 to M16 and MSG infrared channels.");
         msgBox.exec();
 
         ui->btnGVPFalseColor->setChecked(false);
@@ -3962,10 +4007,7 @@ void FormToolbox::on_btnGVPFalseColor_clicked()
 
     if(forminfrascales->isHidden())
     {
-        QList<bool> blist = this->getVIIRSMBandList();
-//        if(formimage->getSegmentType() == eSegmentType::SEG_VIIRSM &&
-        if(ui->rdbVIIRSMin->isChecked() &&
-                (blist.at(12) == true || blist.at(13) == true || blist.at(14) == true || blist.at(15) == true || blist.at(16) == true ))
+        if(isInfraProjection())
         {
             ui->btnGVPFalseColor->setChecked(true);
             forminfrascales->show();
@@ -3976,7 +4018,7 @@ void FormToolbox::on_btnGVPFalseColor_clicked()
         else
         {
             QMessageBox msgBox;
-            msgBox.setText("Only for VIIRS channels M12 to M16.");
+            msgBox.setText("Only for VIIRS channels M12 to M16 and MSG infrared channels.");
             msgBox.exec();
             ui->btnGVPFalseColor->setChecked(false);
         }
@@ -4006,10 +4048,7 @@ void FormToolbox::on_btnLCCFalseColor_clicked()
 
     if(forminfrascales->isHidden())
     {
-        QList<bool> blist = this->getVIIRSMBandList();
-//        if(formimage->getSegmentType() == eSegmentType::SEG_VIIRSM &&
-        if(ui->rdbVIIRSMin->isChecked() &&
-                (blist.at(12) == true || blist.at(13) == true || blist.at(14) == true || blist.at(15) == true || blist.at(16) == true ))
+        if(isInfraProjection())
         {
             ui->btnLCCFalseColor->setChecked(true);
             forminfrascales->show();
@@ -4020,7 +4059,7 @@ void FormToolbox::on_btnLCCFalseColor_clicked()
         else
         {
             QMessageBox msgBox;
-            msgBox.setText("Only for VIIRS channels M12 to M16.");
+            msgBox.setText("Only for VIIRS channels M12 to M16 and MSG infrared channels.");
             msgBox.exec();
             ui->btnLCCFalseColor->setChecked(false);
         }
@@ -4050,10 +4089,7 @@ void FormToolbox::on_btnSGFalseColor_clicked()
 
     if(forminfrascales->isHidden())
     {
-        QList<bool> blist = this->getVIIRSMBandList();
-//        if(formimage->getSegmentType() == eSegmentType::SEG_VIIRSM &&
-        if(ui->rdbVIIRSMin->isChecked() &&
-                (blist.at(12) == true || blist.at(13) == true || blist.at(14) == true || blist.at(15) == true || blist.at(16) == true ))
+        if(isInfraProjection())
         {
             ui->btnSGFalseColor->setChecked(true);
             forminfrascales->show();
@@ -4064,7 +4100,7 @@ void FormToolbox::on_btnSGFalseColor_clicked()
         else
         {
             QMessageBox msgBox;
-            msgBox.setText("Only for VIIRS channels M12 to M16.");
+            msgBox.setText("Only for VIIRS channels M12 to M16 and MSG infrared channels.");
             msgBox.exec();
             ui->btnSGFalseColor->setChecked(false);
         }
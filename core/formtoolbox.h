@@ -80,6 +80,8 @@ private:
     void copyProjectionImage();
     void checkSegmentDateTime();
     void initializeScales();
+    void initializeScalesGeostationary();
+    bool isInfraProjection();
     void setLogValue(int deg, double rad);
     void fitCurve();
 
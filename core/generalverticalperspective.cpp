@@ -1,9 +1,11 @@
 #include "generalverticalperspective.h"
+#include "tracer.h"
 #include "globals.h"
 #include "options.h"
 #include "pixgeoconversion.h"
 #include <QtConcurrent/QtConcurrent>
 #include "equirectangular.h"
+#include "projectionexport.h"
 
 #include <QDebug>
 
@@ -91,6 +93,7 @@ double GeneralVerticalPerspective::Initialize(double lonmapdeg, double latmapdeg
 
 void GeneralVerticalPerspective::CreateMapFromAVHRR(int inputchannel, eSegmentType type)
 {
+    TraceSpan span("projection", "GeneralVerticalPerspective::CreateMapFromAVHRR");
 
     if (type == SEG_NOAA)
         segs->seglnoaa->ComposeGVProjection(inputchannel);
@@ -120,6 +123,7 @@ void GeneralVerticalPerspective::CreateMapFromAVHRR(int inputchannel, eSegmentTy
 
 void GeneralVerticalPerspective::CreateMapFromVIIRS(eSegmentType type, bool combine)
 {
+    TraceSpan span("projection", "GeneralVerticalPerspective::CreateMapFromVIIRS");
     if (type == SEG_VIIRSM)
     {
         segs->seglviirsm->ComposeGVProjection(0);
@@ -144,6 +148,7 @@ void GeneralVerticalPerspective::CreateMapFromVIIRS(eSegmentType type, bool comb
 
 void GeneralVerticalPerspective::CreateMapFromGeoStationary()
 {
+    TraceSpan span("projection", "GeneralVerticalPerspective::CreateMapFromGeoStationary");
     QApplication::setOverrideCursor( Qt::WaitCursor ); // this might take time
 
     QRgb *scanl;
@@ -172,6 +177,8 @@ void GeneralVerticalPerspective::CreateMapFromGeoStationary()
     if(sl == NULL)
         return;
 
+    sl->ComposeForProjection();
+
     sub_lon = sl->geosatlon;
 
     if(sl->getKindofImage() == "HRV" || sl->getKindofImage() == "HRV Color")
@@ -218,6 +225,11 @@ void GeneralVerticalPerspective::CreateMapFromGeoStationary()
     qDebug() << QString("ptrimage projection height = %1 width = %2").arg(imageptrs->ptrimageProjection->height()).arg(imageptrs->ptrimageProjection->width());
     qDebug() << QString("ptrimage meteosat height = %1 width = %2").arg(imageptrs->ptrimageGeostationary->height()).arg(imageptrs->ptrimageGeostationary->width());
 
+    // brightness temperatures of a calibrated MSG infrared image
+    int projwidth = imageptrs->ptrimageProjection->width();
+    int geowidth = imageptrs->ptrimageGeostationary->width();
+    const float *btgeo = (imageptrs->InitializeProjectionBrightnessTemp() && hrvmap == 0 ? imageptrs->ptrBrightnessTempGeostationary.data() : NULL);
+
     for (int j = 0; j < imageptrs->ptrimageProjection->height(); j++)
     {
         for (int i = 0; i < imageptrs->ptrimageProjection->width(); i++)
@@ -237,6 +249,8 @@ void GeneralVerticalPerspective::CreateMapFromGeoStationary()
                                 rgbval = scanl[col];
                                 fb_painter.setPen(rgbval);
                                 fb_painter.drawPoint(i,j);
+                                if(btgeo != NULL)
+                                    imageptrs->ptrProjectionBrightnessTemp[j * projwidth + i] = btgeo[picrow * geowidth + col];
                             }
                         }
                         else
@@ -305,6 +319,8 @@ void GeneralVerticalPerspective::CreateMapFromGeoStationary()
                             rgbval = scanl[col];
                             fb_painter.setPen(rgbval);
                             fb_painter.drawPoint(i,j);
+                            if(btgeo != NULL)
+                                imageptrs->ptrProjectionBrightnessTemp[j * projwidth + i] = btgeo[picrow * geowidth + col];
                             if(picrow == 1000)
                                 piccnt++;
                         }
@@ -320,82 +336,69 @@ void GeneralVerticalPerspective::CreateMapFromGeoStationary()
     QApplication::restoreOverrideCursor();
 }
 
-void GeneralVerticalPerspective::CreateMapFromEquirectangular()
+struct EquirectangularJob {
+    GeneralVerticalPerspective *gvp;
+    Equirectangular *equi;
+    const QImage *in;
+    QImage *out;
+    int first;          // first row of the projection
+    int last;           // one past the last row
+};
+
+// Every pixel of the projection takes the equirectangular pixel under it, so no holes are left to smooth
+static void doEquirectangularRows(EquirectangularJob &job)
 {
+    double lon_rad, lat_rad;
+    int col, row;
+    int width = job.out->width();
 
-    Equirectangular equi;
-    double map_x, map_y;
-    float lon_deg, lat_deg;
-
-    QRgb *row_col;
-    QRgb rgbval;
-
-    equi.Initialize(imageptrs->ptrimageEquirectangle->width(), imageptrs->ptrimageEquirectangle->height());
-
-    qDebug() << QString("GeneralVerticalPerspective::CreateMapFromEquirectangular() width = %1 height = %2")
-                .arg(imageptrs->ptrimageEquirectangle->width()).arg(imageptrs->ptrimageEquirectangle->height());
-
-    if(imageptrs->ptrimageEquirectangle->width() == 0)
-        return;
-
-    for (int j = 0; j < imageptrs->ptrimageEquirectangle->height(); j++)
+    for (int j = job.first; j < job.last; j++)
     {
-        for (int i = 0; i < imageptrs->ptrimageEquirectangle->width(); i++)
+        QRgb *row_proj = (QRgb *)job.out->scanLine(j);
+        for (int i = 0; i < width; i++)
         {
-            equi.map_inverse(i, j, lon_deg, lat_deg);
-
-            if(this->map_forward_neg_coord(lon_deg*PI/180.0, lat_deg*PI/180.0, map_x, map_y))
+            if (job.gvp->map_inverse(i, j, lon_rad, lat_rad))
             {
-                row_col = (QRgb*)imageptrs->ptrimageEquirectangle->scanLine(j);
-                rgbval = row_col[i];
-
-                equi.setProjectionX(j, i, map_x);
-                equi.setProjectionY(j, i, map_y);
-                equi.setProjectionValue(j, i, rgbval);
-
-                if (map_x >= 0 && map_x < imageptrs->ptrimageProjection->width() && map_y >= 0 && map_y < imageptrs->ptrimageProjection->height())
-                {
-                    imageptrs->ptrimageProjection->setPixel((int)map_x, (int)map_y, rgbval);
-                }
+                job.equi->map_forward(lon_rad*180.0/PI, lat_rad*180.0/PI, col, row);
+                row_proj[i] = ((const QRgb *)job.in->constScanLine(row))[col];
             }
         }
     }
-
-    equi.SmoothProjectionImageBilinear();
-
 }
 
-void GeneralVerticalPerspective::CreateMapFromEquirectangular1()
+void GeneralVerticalPerspective::CreateMapFromEquirectangular()
 {
+    TraceSpan span("projection", "GeneralVerticalPerspective::CreateMapFromEquirectangular");
 
     Equirectangular equi;
-    int col, row;
-    double lon_rad, lat_rad;
-    QRgb *row_col;
-    QRgb rgbval;
 
-    equi.Initialize(imageptrs->ptrimageEquirectangle->width(), imageptrs->ptrimageEquirectangle->height());
-
-    qDebug() << QString("GeneralVerticalPerspective1::CreateMapFromEquirectangular() width = %1 height = %2")
+    qDebug() << QString("GeneralVerticalPerspective::CreateMapFromEquirectangular() width = %1 height = %2")
                 .arg(imageptrs->ptrimageEquirectangle->width()).arg(imageptrs->ptrimageEquirectangle->height());
 
     if(imageptrs->ptrimageEquirectangle->width() == 0)
         return;
 
-    for (int j = 0; j < imageptrs->ptrimageProjection->height(); j++)
+    equi.Initialize(imageptrs->ptrimageEquirectangle->width(), imageptrs->ptrimageEquirectangle->height());
+
+    int height = imageptrs->ptrimageProjection->height();
+
+    QList<EquirectangularJob> jobs;
+    for (int first = 0; first < height; first += 16)
     {
-        for (int i = 0; i < imageptrs->ptrimageProjection->width(); i++)
-        {
-            if (this->map_inverse(i, j, lon_rad, lat_rad))
-            {
-                equi.map_forward(lon_rad*180.0/PI, lat_rad*180.0/PI, col, row);
-                row_col = (QRgb*)imageptrs->ptrimageEquirectangle->scanLine(row);
-                rgbval = row_col[col];
-                imageptrs->ptrimageProjection->setPixel(i, j, rgbval);
-            }
-        }
+        EquirectangularJob job;
+        job.gvp = this;
+        job.equi = &equi;
+        job.in = imageptrs->ptrimageEquirectangle;
+        job.out = imageptrs->ptrimageProjection;
+        job.first = first;
+        job.last = qMin(first + 16, height);
+        jobs.append(job);
     }
 
+    // detach in this thread, the rows are written from the thread pool
+    imageptrs->ptrimageProjection->bits();
+    QtConcurrent::blockingMap(jobs, doEquirectangularRows);
+
 }
 
 bool GeneralVerticalPerspective::map_forward(double lon_rad, double lat_rad, double &map_x, double &map_y)
@@ -465,6 +468,27 @@ bool GeneralVerticalPerspective::genpersfor(double lon, double lat, double *x, d
     return(true);
 }
 
+// There is no GeoTIFF coordinate transformation for the vertical perspective, proj4 holds the definition
+void GeneralVerticalPerspective::georeference(ProjectionGeoreference &geo)
+{
+    geo.pixelx = 2 * map_radius * scale / map_width;
+    geo.pixely = 2 * map_radius * scale / map_height;
+    geo.originx = - map_radius * scale * (2*mapdeltax + map_width) / map_width;
+    geo.originy = map_radius * scale * (2*mapdeltay + map_height) / map_height;
+    geo.semimajor = R;
+    geo.semiminor = R;
+    geo.lon0 = lon_center * 180.0/PI;
+    geo.lat0 = lat_center * 180.0/PI;
+    geo.stdlat1 = 0.0;
+    geo.stdlat2 = 0.0;
+    geo.height = (p - 1.0) * R;
+    geo.falseeasting = false_easting;
+    geo.falsenorthing = false_northing;
+    geo.proj4 = QString("+proj=nsper +h=%1 +lat_0=%2 +lon_0=%3 +x_0=%4 +y_0=%5 +R=%6 +units=m +no_defs")
+            .arg(geo.height, 0, 'f', 1).arg(geo.lat0, 0, 'f', 6).arg(geo.lon0, 0, 'f', 6)
+            .arg(geo.falseeasting, 0, 'f', 3).arg(geo.falsenorthing, 0, 'f', 3).arg(geo.semimajor, 0, 'f', 3);
+}
+
 bool GeneralVerticalPerspective::map_inverse(double map_x, double map_y, double &lon_rad, double &lat_rad)
 {
     double x, y;
@@ -9,6 +9,7 @@
 #define EPSLN	1.0e-3
 class AVHRRSatellite;
 class GenVertNSP;
+struct ProjectionGeoreference;
 
 class GeneralVerticalPerspective : public QObject
 {
@@ -24,7 +25,6 @@ public:
     void CreateMapFromVIIRS(eSegmentType type, bool combine);
     void CreateMapFromGeoStationary();
     void CreateMapFromEquirectangular();
-    void CreateMapFromEquirectangular1();
 
     bool map_forward(double lon_rad, double lat_rad, double &map_x, double &map_y);
     bool map_forward_neg_coord(double lon_rad, double lat_rad, double &map_x, double &map_y);
@@ -32,6 +32,7 @@ public:
     bool genpersfor(double lon, double lat, double *x, double *y);
     bool genpersinv(double x, double y, double *lon, double *lat);
     double asinz(double con);
+    void georeference(ProjectionGeoreference &geo);
     int getProjectionWidth() { return image_width; }
     int getProjectionHeight() { return image_height; }
 
@@ -0,0 +1,565 @@
+#include "geomosaic.h"
+#include "segmentimage.h"
+#include "pixgeoconversion.h"
+#include "options.h"
+#include "MSG_HRIT.h"
+#include "calibrationengine.h"
+#include "msgfileaccess.h"
+#include "msgdataaccess.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <QDateTime>
+#include <QMutex>
+#include <QDebug>
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <math.h>
+
+extern Options opts;
+extern SegmentImage *imageptrs;
+extern QMutex g_mutex;
+
+// Decodes one segment file of a disc, the samples are kept in the order of the file
+void doMosaicSegment(MosaicSegmentJob &job)
+{
+    job.ok = false;
+    if (job.mosaic->isCanceled())
+        return;
+
+    QByteArray ba = job.filepath.toLatin1();
+    std::ifstream hrit(ba.data(), (std::ios::binary | std::ios::in) );
+    if (hrit.fail())
+    {
+        qDebug() << QString("doMosaicSegment cannot open %1").arg(job.filepath);
+        return;
+    }
+
+    MSG_header header;
+    MSG_data msgdat;
+    try
+    {
+        header.read_from(hrit);
+        msgdat.read_from(hrit, header);
+    }
+    catch( std::runtime_error &run )
+    {
+        qDebug() << QString("Error : runtime error in reading segment file %1 : %2").arg(job.filepath).arg(run.what());
+        return;
+    }
+    hrit.close();
+
+    if (header.segment_id->data_field_format == MSG_NO_FORMAT)
+        return;
+
+    job.columns = header.image_structure->number_of_columns;
+    job.lines = header.image_structure->number_of_lines;
+    job.planned = header.segment_id->planned_end_segment_sequence_number;
+
+    size_t npixperseg = (size_t)job.columns * job.lines;
+    job.data.resize(npixperseg);
+    for (size_t i = 0; i < npixperseg; i++)
+        job.data[i] = msgdat.image->data[i];
+    job.ok = true;
+}
+
+// Every pixel is the weighted mean of the discs that see it
+static void doMosaicRows(MosaicRowJob &job)
+{
+    if (job.mosaic->isCanceled())
+        return;
+
+    int width = job.out->width();
+    int height = job.out->height();
+    const QList<MosaicSatellite *> &discs = job.mosaic->discs();
+
+    for (int j = job.first; j < job.last; j++)
+    {
+        QRgb *row = (QRgb *)job.out->scanLine(j);
+        double lat_deg = 90.0 - (j + 0.5) * 180.0 / height;
+
+        for (int i = 0; i < width; i++)
+        {
+            double lon_deg = (i + 0.5) * 360.0 / width - 180.0;
+            double sum = 0.0;
+            double sumweight = 0.0;
+
+            for (int k = 0; k < discs.count(); k++)
+            {
+                double value, weight;
+                if (job.mosaic->sample(*discs.at(k), lat_deg, lon_deg, value, weight))
+                {
+                    sum += value * weight;
+                    sumweight += weight;
+                }
+            }
+
+            if (sumweight > 0.0)
+            {
+                double value = sum / sumweight;
+                if (job.mosaic->isInverse())
+                    value = 1.0 - value;
+                int gray = qBound(0, (int)(value * 255.0 + 0.5), 255);
+                row[i] = qRgb(gray, gray, gray);
+            }
+            else
+                row[i] = qRgb(0, 0, 0);
+        }
+    }
+}
+
+GeoMosaic::GeoMosaic(AVHRRSatellite *seglist)
+{
+    segs = seglist;
+    inverse = true;
+
+    // the rapid scan covers the north of the MET-10 disc only
+    QList<MosaicSatellite> discs = xritSatellites(segs);
+    for (int i = 0; i < discs.count(); i++)
+    {
+        if (discs.at(i).geo != SegmentListGeostationary::MET_9)
+            satellites.append(discs.at(i));
+    }
+}
+
+// The infrared channel of the xRIT satellites, with the scaling of their full disc
+QList<MosaicSatellite> GeoMosaic::xritSatellites(AVHRRSatellite *segs)
+{
+    QList<MosaicSatellite> satellites;
+    MosaicSatellite sat;
+    sat.columns = 0;
+    sat.lines = 0;
+    sat.segments = 0;
+
+    sat.geo = SegmentListGeostationary::MET_10;
+    sat.name = "MET-10";
+    sat.spectrum = "IR_108";
+    sat.map = &segs->segmentlistmapmeteosat;
+    sat.altmap = NULL;
+    sat.coff = COFF_NONHRV;
+    sat.loff = LOFF_NONHRV;
+    sat.cfac = CFAC_NONHRV;
+    sat.lfac = LFAC_NONHRV;
+    sat.flip = true;
+    sat.maxcount = 1023;
+    sat.gain = 1.0;
+    sat.offset = 0.0;
+    satellites.append(sat);
+
+    sat.geo = SegmentListGeostationary::MET_9;
+    sat.name = "MET-9";
+    sat.map = &segs->segmentlistmapmeteosatrss;
+    satellites.append(sat);
+
+    sat.geo = SegmentListGeostationary::MET_8;
+    sat.name = "MET-8";
+    sat.map = &segs->segmentlistmapmet8;
+    satellites.append(sat);
+
+    sat.geo = SegmentListGeostationary::MET_7;
+    sat.name = "MET-7";
+    sat.spectrum = "11_5_0";
+    sat.map = &segs->segmentlistmapmet7;
+    sat.coff = COFF_NONHRV_MET7/2;
+    sat.loff = LOFF_NONHRV_MET7/2;
+    sat.cfac = CFAC_NONHRV_MET7/2;
+    sat.lfac = LFAC_NONHRV_MET7/2;
+    sat.maxcount = 255;
+    satellites.append(sat);
+
+    sat.geo = SegmentListGeostationary::GOES_13;
+    sat.name = "GOES-13";
+    sat.spectrum = "10_7_0";
+    sat.map = &segs->segmentlistmapgoes13dc3;
+    sat.altmap = &segs->segmentlistmapgoes13dc4;
+    sat.coff = COFF_NONHRV_GOES;
+    sat.loff = LOFF_NONHRV_GOES;
+    sat.cfac = CFAC_NONHRV_GOES;
+    sat.lfac = LFAC_NONHRV_GOES;
+    sat.flip = false;
+    sat.maxcount = 1023;
+    satellites.append(sat);
+
+    sat.geo = SegmentListGeostationary::GOES_15;
+    sat.name = "GOES-15";
+    sat.spectrum = "10_7_1";
+    sat.map = &segs->segmentlistmapgoes15dc3;
+    sat.altmap = &segs->segmentlistmapgoes15dc4;
+    satellites.append(sat);
+
+    for (int i = 0; i < satellites.count(); i++)
+        satellites[i].sublon = opts.geostationarylistlon.at(satellites.at(i).geo).toDouble();
+
+    return satellites;
+}
+
+QStringList GeoMosaic::satelliteNames() const
+{
+    QStringList names;
+    for (int i = 0; i < satellites.count(); i++)
+        names << satellites.at(i).name;
+    return names;
+}
+
+// The cycles of all discs, the latest first
+QStringList GeoMosaic::nominalTimes() const
+{
+    QStringList dates;
+    for (int i = 0; i < satellites.count(); i++)
+    {
+        dates << satellites.at(i).map->keys();
+        if (satellites.at(i).altmap != NULL)
+            dates << satellites.at(i).altmap->keys();
+    }
+    dates.removeDuplicates();
+    dates.sort();
+    std::reverse(dates.begin(), dates.end());
+    return dates;
+}
+
+QStringList GeoMosaic::availableSatellites(const QString &date) const
+{
+    QStringList names;
+    for (int i = 0; i < satellites.count(); i++)
+    {
+        GeoSegmentMap *map;
+        if (!nearestCycle(satellites.at(i), date, &map).isEmpty())
+            names << satellites.at(i).name;
+    }
+    return names;
+}
+
+// The cycle of the disc with the infrared channel that is closest to date and within MOSAIC_MAX_MINUTES
+QString GeoMosaic::nearestCycle(const MosaicSatellite &sat, const QString &date, GeoSegmentMap **map) const
+{
+    QDateTime nominal = QDateTime::fromString(date, "yyyyMMddhhmm");
+    QString best;
+    qint64 bestsecs = MOSAIC_MAX_MINUTES * 60 + 1;
+
+    GeoSegmentMap *maps[2] = { sat.map, sat.altmap };
+    for (int m = 0; m < 2; m++)
+    {
+        if (maps[m] == NULL)
+            continue;
+
+        GeoSegmentMap::const_iterator cycle = maps[m]->constBegin();
+        while (cycle != maps[m]->constEnd())
+        {
+            if (cycle.value().contains(sat.spectrum))
+            {
+                qint64 secs = qAbs(nominal.secsTo(QDateTime::fromString(cycle.key(), "yyyyMMddhhmm")));
+                if (secs < bestsecs)
+                {
+                    bestsecs = secs;
+                    best = cycle.key();
+                    *map = maps[m];
+                }
+            }
+            ++cycle;
+        }
+    }
+
+    return best;
+}
+
+// The line and column of the full disc are those of ptrimageGeostationary, the sample is looked up in its segment
+bool GeoMosaic::sample(const MosaicSatellite &sat, double lat_deg, double lon_deg, double &value, double &weight) const
+{
+    double cosgamma = cos(lat_deg * PI / 180.0) * cos((lon_deg - sat.sublon) * PI / 180.0);
+    double dist = sqrt(SAT_HEIGHT * SAT_HEIGHT + R_EQ * R_EQ - 2.0 * SAT_HEIGHT * R_EQ * cosgamma);
+    double coszenith = (SAT_HEIGHT * cosgamma - R_EQ) / dist;
+    weight = coszenith - cos(MOSAIC_MAX_ZENITH * PI / 180.0);
+    if (weight <= 0.0)
+        return false;
+
+    pixgeoConversion pixconv;
+    int col, row;
+    if (pixconv.geocoord2pixcoord(sat.sublon, lat_deg, lon_deg, sat.coff, sat.loff, sat.cfac, sat.lfac, &col, &row) != 0)
+        return false;
+
+    int totallines = sat.lines * sat.segments;
+    if (col < 0 || col >= sat.columns || row < 0 || row >= totallines)
+        return false;
+
+    int k = sat.flip ? totallines - 1 - row : row;
+    int pixelx = sat.flip ? sat.columns - 1 - col : col;
+    const QVector<quint16> &data = sat.segmentdata.at(k / sat.lines);
+    if (data.isEmpty())
+        return false;
+
+    quint16 count = data.at((k % sat.lines) * sat.columns + pixelx);
+    if (count == 0)
+        return false;
+
+    if (sat.bttable.isEmpty())
+    {
+        value = sat.offset + sat.gain * count / sat.maxcount;
+        return true;
+    }
+
+    float bt = sat.bttable.at(count & (CALIBRATION_COUNTS - 1));
+    if (bt <= 0.0)
+        return false;
+
+    value = (bt - MOSAIC_MIN_BT) / (MOSAIC_MAX_BT - MOSAIC_MIN_BT);
+    return true;
+}
+
+// The brightness temperatures of the infrared channel of an MSG disc, from the prologue of its cycle
+static void calibrateDisc(MosaicSatellite &sat)
+{
+    sat.bttable.clear();
+    if (sat.geo != SegmentListGeostationary::MET_10 && sat.geo != SegmentListGeostationary::MET_9 &&
+            sat.geo != SegmentListGeostationary::MET_8)
+        return;
+    if (sat.files.isEmpty())
+        return;
+
+    MsgFileAccess fa(sat.files.constBegin().value().absoluteFilePath());
+    QString prologuefile = fa.prologueFile();
+    MsgDataAccess da;
+    MSG_header PRO_head;
+    MSG_data pro;
+    try
+    {
+        da.read_file(fa.directory + "/" + prologuefile, PRO_head, pro);
+    }
+    catch( std::runtime_error &run )
+    {
+        qDebug() << QString("Error : runtime error in reading prologue file : %1").arg(run.what());
+        return;
+    }
+    if (pro.prologue == 0)
+        return;
+
+    CalibrationEngine calibration;
+    calibration.setup(pro.prologue->radiometric_proc, prologuefile);
+    const float *table = calibration.table(sat.spectrum);
+    if (table == NULL)
+        return;
+
+    sat.bttable.resize(CALIBRATION_COUNTS);
+    for (int i = 0; i < CALIBRATION_COUNTS; i++)
+        sat.bttable[i] = table[i];
+}
+
+// Linear fit of the uncalibrated discs onto the brightness temperature scale. In the overlap with the discs
+// that are on the scale, the mean and standard deviation of count / maxcount are matched to those of the
+// weighted mean of these discs. A matched disc is a reference for the discs that are left.
+void GeoMosaic::matchUncalibrated()
+{
+    QVector<bool> matched(used.count());
+    for (int k = 0; k < used.count(); k++)
+    {
+        used.at(k)->gain = 1.0;
+        used.at(k)->offset = 0.0;
+        matched[k] = !used.at(k)->bttable.isEmpty();
+    }
+
+    bool progress = true;
+    while (progress && !isCanceled())
+    {
+        progress = false;
+        for (int k = 0; k < used.count(); k++)
+        {
+            if (matched.at(k))
+                continue;
+
+            double n = 0.0, sumraw = 0.0, sumraw2 = 0.0, sumref = 0.0, sumref2 = 0.0;
+            for (int j = 0; j < MOSAIC_HEIGHT; j += MOSAIC_MATCH_STEP)
+            {
+                double lat_deg = 90.0 - (j + 0.5) * 180.0 / MOSAIC_HEIGHT;
+                for (int i = 0; i < MOSAIC_WIDTH; i += MOSAIC_MATCH_STEP)
+                {
+                    double lon_deg = (i + 0.5) * 360.0 / MOSAIC_WIDTH - 180.0;
+                    double raw, weight;
+                    if (!sample(*used.at(k), lat_deg, lon_deg, raw, weight))
+                        continue;
+
+                    double sum = 0.0;
+                    double sumweight = 0.0;
+                    for (int m = 0; m < used.count(); m++)
+                    {
+                        double value;
+                        if (matched.at(m) && sample(*used.at(m), lat_deg, lon_deg, value, weight))
+                        {
+                            sum += value * weight;
+                            sumweight += weight;
+                        }
+                    }
+                    if (sumweight <= 0.0)
+                        continue;
+
+                    double ref = sum / sumweight;
+                    n += 1.0;
+                    sumraw += raw;
+                    sumraw2 += raw * raw;
+                    sumref += ref;
+                    sumref2 += ref * ref;
+                }
+            }
+
+            if (n < MOSAIC_MATCH_MIN)
+                continue;
+
+            double meanraw = sumraw / n;
+            double meanref = sumref / n;
+            double varraw = sumraw2 / n - meanraw * meanraw;
+            double varref = sumref2 / n - meanref * meanref;
+            if (varraw <= 0.0 || varref <= 0.0)
+                continue;
+
+            used.at(k)->gain = sqrt(varref / varraw);
+            used.at(k)->offset = meanref - used.at(k)->gain * meanraw;
+            matched[k] = true;
+            progress = true;
+            qDebug() << QString("GeoMosaic::matchUncalibrated %1 gain = %2 offset = %3 from %4 pixels").arg(used.at(k)->name)
+                        .arg(used.at(k)->gain).arg(used.at(k)->offset).arg((int)n);
+        }
+    }
+
+    for (int k = 0; k < used.count(); k++)
+    {
+        if (!matched.at(k))
+            qDebug() << QString("GeoMosaic::matchUncalibrated %1 has no overlap, the counts are used").arg(used.at(k)->name);
+    }
+}
+
+// Picks the cycle and the segment files of every disc, the segment directories are not read by compose()
+bool GeoMosaic::prepare(const QString &date, const QStringList &names, bool inverse)
+{
+    this->inverse = inverse;
+    used.clear();
+    segmentjobs.clear();
+    error.clear();
+    canceled.store(0);
+
+    for (int i = 0; i < satellites.count(); i++)
+    {
+        MosaicSatellite &sat = satellites[i];
+        if (!names.contains(sat.name))
+            continue;
+
+        GeoSegmentMap *map = NULL;
+        sat.date = nearestCycle(sat, date, &map);
+        if (sat.date.isEmpty())
+            continue;
+
+        sat.files = map->value(sat.date).value(sat.spectrum);
+        sat.columns = 0;
+        sat.lines = 0;
+        sat.segments = 0;
+        sat.segmentdata.clear();
+        used.append(&sat);
+
+        QMap<int, QFileInfo>::const_iterator file = sat.files.constBegin();
+        while (file != sat.files.constEnd())
+        {
+            MosaicSegmentJob job;
+            job.mosaic = this;
+            job.sat = &sat;
+            job.filesequence = file.key() - 1;
+            job.filepath = file.value().absoluteFilePath();
+            job.ok = false;
+            segmentjobs.append(job);
+            ++file;
+        }
+    }
+
+    if (used.isEmpty())
+    {
+        error = QString("No infrared images within %1 minutes of %2").arg(MOSAIC_MAX_MINUTES).arg(date);
+        return false;
+    }
+
+    return true;
+}
+
+bool GeoMosaic::compose()
+{
+    qDebug() << QString("GeoMosaic::compose %1 discs %2 segment files").arg(used.count()).arg(segmentjobs.count());
+
+    QtConcurrent::blockingMap(segmentjobs, doMosaicSegment);
+
+    // the first segment of a disc gives its size, segments of another size are left out
+    for (int i = 0; i < segmentjobs.count(); i++)
+    {
+        MosaicSegmentJob &job = segmentjobs[i];
+        MosaicSatellite *sat = job.sat;
+        if (!job.ok || job.planned <= 0)
+            continue;
+
+        if (sat->segments == 0)
+        {
+            sat->columns = job.columns;
+            sat->lines = job.lines;
+            sat->segments = job.planned;
+            sat->segmentdata.resize(job.planned);
+        }
+        if (job.columns != sat->columns || job.lines != sat->lines || job.filesequence < 0 || job.filesequence >= sat->segments)
+            continue;
+        sat->segmentdata[job.filesequence] = job.data;
+    }
+
+    for (int i = used.count() - 1; i >= 0; i--)
+    {
+        qDebug() << QString("GeoMosaic::compose %1 cycle %2 columns = %3 lines = %4 segments = %5").arg(used.at(i)->name)
+                    .arg(used.at(i)->date).arg(used.at(i)->columns).arg(used.at(i)->lines).arg(used.at(i)->segments);
+        if (used.at(i)->segments == 0)
+            used.removeAt(i);
+    }
+
+    if (isCanceled())
+    {
+        error = "The mosaic was canceled";
+        return false;
+    }
+
+    if (used.isEmpty())
+    {
+        error = "None of the segment files could be read";
+        return false;
+    }
+
+    for (int i = 0; i < used.count(); i++)
+    {
+        calibrateDisc(*used.at(i));
+        qDebug() << QString("GeoMosaic::compose %1 %2").arg(used.at(i)->name).arg(used.at(i)->bttable.isEmpty() ? "not calibrated" : "calibrated");
+    }
+    matchUncalibrated();
+
+    QImage *out = new QImage(MOSAIC_WIDTH, MOSAIC_HEIGHT, QImage::Format_ARGB32);
+
+    QList<MosaicRowJob> rowjobs;
+    for (int first = 0; first < MOSAIC_HEIGHT; first += 16)
+    {
+        MosaicRowJob job;
+        job.mosaic = this;
+        job.out = out;
+        job.first = first;
+        job.last = qMin(first + 16, MOSAIC_HEIGHT);
+        rowjobs.append(job);
+    }
+    QtConcurrent::blockingMap(rowjobs, doMosaicRows);
+
+    segmentjobs.clear();
+    if (isCanceled())
+    {
+        delete out;
+        for (int i = 0; i < used.count(); i++)
+            used.at(i)->segmentdata.clear();
+        error = "The mosaic was canceled";
+        return false;
+    }
+
+    g_mutex.lock();
+    delete imageptrs->ptrimageEquirectangle;
+    imageptrs->ptrimageEquirectangle = out;
+    g_mutex.unlock();
+
+    // the decoded segments are not needed any more
+    for (int i = 0; i < used.count(); i++)
+        used.at(i)->segmentdata.clear();
+
+    return true;
+}
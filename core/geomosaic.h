@@ -0,0 +1,129 @@
+#ifndef GEOMOSAIC_H
+#define GEOMOSAIC_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QMap>
+#include <QFileInfo>
+#include <QImage>
+#include <QAtomicInt>
+
+#include "avhrrsatellite.h"
+#include "segmentlistgeostationary.h"
+
+// size of the equirectangular mosaic, 0.1 degree
+#define MOSAIC_WIDTH 3600
+#define MOSAIC_HEIGHT 1800
+
+// satellite zenith angle beyond which a disc is not used
+#define MOSAIC_MAX_ZENITH 80.0
+
+// a cycle of another satellite is used when it is this close to the nominal time
+#define MOSAIC_MAX_MINUTES 30
+
+// brightness temperatures in Kelvin that go from black to white
+#define MOSAIC_MIN_BT 180.0
+#define MOSAIC_MAX_BT 330.0
+
+// every MOSAIC_MATCH_STEP pixel of the overlap is used to match an uncalibrated disc, at least MOSAIC_MATCH_MIN of them
+#define MOSAIC_MATCH_STEP 4
+#define MOSAIC_MATCH_MIN 1000
+
+typedef QMap<QString, QMap<QString, QMap<int, QFileInfo> > > GeoSegmentMap;
+
+// One disc of the mosaic, the infrared channel of an xRIT geostationary satellite
+struct MosaicSatellite {
+    SegmentListGeostationary::eGeoSatellite geo;
+    QString name;
+    QString spectrum;
+    GeoSegmentMap *map;
+    GeoSegmentMap *altmap;      // other dissemination of the same satellite, or NULL
+    double sublon;              // degrees
+    long coff;
+    long loff;
+    double cfac;
+    double lfac;
+    bool flip;                  // lines are stored south to north and columns east to west
+    int maxcount;
+    QVector<float> bttable;     // count to brightness temperature from the prologue, empty without calibration
+    double gain;                // count / maxcount to the brightness temperature scale, without calibration
+    double offset;
+
+    QString date;               // cycle that is used
+    QMap<int, QFileInfo> files; // segment number, file
+    int columns;                // of the full disc, from the segment headers
+    int lines;                  // of a segment
+    int segments;
+    QVector<QVector<quint16> > segmentdata;     // indexed by segment number - 1, empty when missing
+};
+
+class GeoMosaic;
+
+struct MosaicSegmentJob {
+    const GeoMosaic *mosaic;
+    MosaicSatellite *sat;
+    int filesequence;
+    QString filepath;
+    bool ok;
+    int columns;
+    int lines;
+    int planned;
+    QVector<quint16> data;
+};
+
+void doMosaicSegment(MosaicSegmentJob &job);
+
+struct MosaicRowJob {
+    const GeoMosaic *mosaic;
+    QImage *out;
+    int first;
+    int last;
+};
+
+// Infrared mosaic of several geostationary discs of the same nominal time, in the equirectangular
+// image of imageptrs. The segment files of all discs are decoded together in the thread pool,
+// so a mosaic takes about as long as its largest disc.
+// The MSG discs are calibrated with the prologue of their cycle. MET-7 and GOES have no calibration, their
+// counts are brought onto the same brightness temperature scale with a linear fit : the mean and spread of
+// the counts in the overlap are matched to those of the discs that are already on the scale. GOES-15 only
+// overlaps GOES-13, that is matched first. A disc without enough overlap keeps its counts.
+// Where discs overlap every disc is weighted with the cosine of its satellite zenith angle above that of
+// MOSAIC_MAX_ZENITH, the seams fade from one satellite to the other.
+// prepare() picks the cycles on the GUI thread, compose() can then run in another thread.
+// The equirectangular image can be shown as it is or projected with the General Vertical Perspective.
+class GeoMosaic
+{
+public:
+    explicit GeoMosaic(AVHRRSatellite *seglist);
+
+    static QList<MosaicSatellite> xritSatellites(AVHRRSatellite *segs);
+    QStringList nominalTimes() const;
+    QStringList satelliteNames() const;
+    QStringList availableSatellites(const QString &date) const;
+
+    bool prepare(const QString &date, const QStringList &names, bool inverse);
+    bool compose();
+    void cancel() { canceled.store(1); }
+    bool isCanceled() const { return canceled.load() != 0; }
+    QString errorString() const { return error; }
+
+    bool sample(const MosaicSatellite &sat, double lat_deg, double lon_deg, double &value, double &weight) const;
+    const QList<MosaicSatellite *> &discs() const { return used; }
+    bool isInverse() const { return inverse; }
+
+private:
+    QString nearestCycle(const MosaicSatellite &sat, const QString &date, GeoSegmentMap **map) const;
+    void matchUncalibrated();
+
+    AVHRRSatellite *segs;
+    QList<MosaicSatellite> satellites;
+    QList<MosaicSatellite *> used;
+    QList<MosaicSegmentJob> segmentjobs;
+    QAtomicInt canceled;
+    bool inverse;
+    QString error;
+};
+
+#endif // GEOMOSAIC_H
@@ -24,6 +24,11 @@ void Render3DColorTexture(Globe *gl, SegmentListGeostationary::eGeoSatellite sat
       gl->Render3DGeoSegment( sat );
 }
 
+void Render3DColorTextureRows(Globe *gl, SegmentListGeostationary::eGeoSatellite sat, int firstline, int nbroflines)
+{
+      gl->Render3DGeoSegmentRows( sat, firstline, nbroflines );
+}
+
 void Render3DColorFBO(Globe *gl, SegmentListGeostationary::eGeoSatellite sat)
 {
       gl->Render3DGeoSegmentFBO( sat );
@@ -48,6 +53,7 @@ Globe::Globe(QWidget *parent, SatelliteList *satlist, AVHRRSatellite *seglist ):
 
     imageptrs->pmOriginal = new QPixmap(QPixmap::fromImage(qim));
     imageptrs->pmOut = new QPixmap(QPixmap::fromImage(qim));
+    pendingsat = SegmentListGeostationary::NOGEO;
     connect(&watcher, SIGNAL(finished()), this, SLOT(slotRender3DGeoFinished()));
 
 }
@@ -1153,19 +1159,43 @@ QSize Globe::sizeHint() const
 void Globe::Render3DGeo(SegmentListGeostationary::eGeoSatellite sat)
 {
 
-    if(futureRender3DGeo.isRunning())
-        return;
-
     if (segs->seglmeteosat->getKindofImage() != "HRV" && segs->seglmeteosat->getKindofImage() != "HRV Color")
     {
-        futureRender3DGeo = QtConcurrent::run(Render3DColorTexture, this, sat);
-        watcher.setFuture(futureRender3DGeo);
+        // the whole image replaces the segments that are still waiting
+        pendingrows.clear();
+        pendingrows.append(qMakePair(-1, 0));
+        pendingsat = sat;
+        startRender3DGeo();
     }
 }
 
+void Globe::Render3DGeoRows(SegmentListGeostationary::eGeoSatellite sat, int firstline, int nbroflines)
+{
+    if(pendingsat != sat)
+        pendingrows.clear();
+    pendingrows.append(qMakePair(firstline, nbroflines));
+    pendingsat = sat;
+    startRender3DGeo();
+}
+
+void Globe::startRender3DGeo()
+{
+    if(futureRender3DGeo.isRunning() || pendingrows.isEmpty())
+        return;
+
+    QPair<int, int> rows = pendingrows.takeFirst();
+
+    if(rows.first < 0)
+        futureRender3DGeo = QtConcurrent::run(Render3DColorTexture, this, pendingsat);
+    else
+        futureRender3DGeo = QtConcurrent::run(Render3DColorTextureRows, this, pendingsat, rows.first, rows.second);
+    watcher.setFuture(futureRender3DGeo);
+}
+
 void Globe::slotRender3DGeoFinished()
 {
     qDebug() << "=======> futureRender3DGeo is finished";
+    startRender3DGeo();
 }
 
 void Globe::Render3DGeoSegment(SegmentListGeostationary::eGeoSatellite sat)
@@ -1185,6 +1215,22 @@ void Globe::Render3DGeoSegment(SegmentListGeostationary::eGeoSatellite sat)
     emit renderingglobefinished(true);
 }
 
+void Globe::Render3DGeoSegmentRows(SegmentListGeostationary::eGeoSatellite sat, int firstline, int nbroflines)
+{
+
+    qDebug() << QString("Globe::Render3DGeoSegmentRows firstline = %1 nbroflines = %2").arg(firstline).arg(nbroflines);
+
+    g_mutex.lock();
+
+    int lastline = qMin(firstline + nbroflines, imageptrs->ptrimageGeostationary->height());
+    for (int i = firstline; i < lastline; i++)
+        Render3DGeoSegmentLine( i, sat);
+
+    g_mutex.unlock();
+
+    opts.texture_changed = true;
+}
+
 
 void Globe::Render3DGeoSegmentLine(int heightinimage, SegmentListGeostationary::eGeoSatellite sat)
 {
@@ -38,6 +38,7 @@ class Globe  : public QOpenGLWidget, protected QOpenGLFunctions_4_3_Core
 public:
     Globe(QWidget *parent = NULL, SatelliteList *satlist=0, AVHRRSatellite *seglist=0 );
     void Render3DGeoSegment(SegmentListGeostationary::eGeoSatellite sat);
+    void Render3DGeoSegmentRows(SegmentListGeostationary::eGeoSatellite sat, int firstline, int nbroflines);
     void Render3DGeoSegmentFBO(SegmentListGeostationary::eGeoSatellite sat);
     void drawSatelliteNames(QPainter *painter, QMatrix4x4 modelview);
     void drawStationNames(QPainter *painter, QMatrix4x4 modelview);
@@ -56,6 +57,7 @@ public:
 
 public slots:
     void Render3DGeo(SegmentListGeostationary::eGeoSatellite sat);
+    void Render3DGeoRows(SegmentListGeostationary::eGeoSatellite sat, int firstline, int nbroflines);
 private slots:
     void slotRender3DGeoFinished();
 
@@ -93,6 +95,7 @@ private:
     void TestForSegmentGL( int x, int realy, float distance, const QMatrix4x4 &m);
     void Render3DGeoSegmentLine(int heightinimage, SegmentListGeostationary::eGeoSatellite);
     void Render3DGeoSegmentLineFBO(int heightinimage, SegmentListGeostationary::eGeoSatellite);
+    void startRender3DGeo();
 
 
     void toggleBorder();
@@ -154,6 +157,8 @@ private:
     bool bSegmentNames;
     QFutureWatcher<void> watcher;
     QFuture<void> futureRender3DGeo;
+    QList<QPair<int, int> > pendingrows;   // first line, nbr of lines ; -1 for the whole image
+    SegmentListGeostationary::eGeoSatellite pendingsat;
 
     QString segmentnameselected;
 
@@ -1,4 +1,7 @@
 #include <QDebug>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrent>
 #include "gshhsdata.h"
 #include "options.h"
 
@@ -11,20 +14,34 @@ extern Options opts;
 // f = full
 
 
+static const char gshhscachemagic[8] = { 'E', 'V', 'G', 'S', 'H', 'H', 'S', '1' };
+
+Q_STATIC_ASSERT(sizeof(QVector3D) == 3 * sizeof(float));
+Q_STATIC_ASSERT(sizeof(LonLatPair) == sizeof(struct POINT_GSHHS));
+
+void doLoadGshhs(GshhsJob &job)
+{
+    job.gshhs->load_gshhs(job.filename, job.vxp);
+}
+
 gshhsData::gshhsData()
 {
 
+    buffersuploaded = false;
+    program = NULL;
 
     for(int i = 0; i < 3; i++)
     {
         vxp_data[i] = new Vxp;
         vxp_data[i]->nFeatures = 0;
+        vxp_data[i]->pFeatures = NULL;
     }
 
     for(int i = 0; i < 3; i++)
     {
         vxp_data_overlay[i] = new Vxp;
         vxp_data_overlay[i]->nFeatures = 0;
+        vxp_data_overlay[i]->pFeatures = NULL;
     }
 
     Initialize(opts.gshhsglobe1, opts.gshhsglobe2, opts.gshhsglobe3, opts.gshhsoverlay1, opts.gshhsoverlay2, opts.gshhsoverlay3);
@@ -38,27 +55,21 @@ void gshhsData::initializegshhsData(QOpenGLShaderProgram *prog)
 
     initializeOpenGLFunctions();
 
-    QVector<GLfloat> positions[3];
-    int totalverts = 0;
+    // The files are still loading in the background, the buffers are uploaded on the first render after that.
+    if(isDataLoaded())
+        uploadBuffers();
 
+}
+
+void gshhsData::uploadBuffers()
+{
 
     for( int k = 0; k < 3; k++)
     {
-        featurevertsindex[k].append(0);
-
-        for( int i = 0; i < vxp_data[k]->nFeatures; i++)
-        {
-            for (int j = 0; j < vxp_data[k]->pFeatures[i].nVerts; j++)
-            {
-                positions[k].append((float)vxp_data[k]->pFeatures[i].pVerts[j].x());
-                positions[k].append((float)vxp_data[k]->pFeatures[i].pVerts[j].y());
-                positions[k].append((float)vxp_data[k]->pFeatures[i].pVerts[j].z());
-            }
-            totalverts += vxp_data[k]->pFeatures[i].nVerts;
-            featurevertsindex[k].append(totalverts);
-        }
-
-        totalverts = 0;
+        featurevertsindex[k].clear();
+        featurevertsindex[k].reserve(vxp_data[k]->featureoffset.size());
+        for( int i = 0; i < vxp_data[k]->featureoffset.size(); i++)
+            featurevertsindex[k].append((GLuint)vxp_data[k]->featureoffset.at(i));
     }
 
     // Bind shader pipeline for use
@@ -70,7 +81,7 @@ void gshhsData::initializegshhsData(QOpenGLShaderProgram *prog)
     positionsBuf1.create();
     positionsBuf1.setUsagePattern(QOpenGLBuffer::StaticDraw);
     positionsBuf1.bind();
-    positionsBuf1.allocate(positions[0].data(), positions[0].size() * sizeof(GLfloat));
+    positionsBuf1.allocate(vxp_data[0]->verts.constData(), vxp_data[0]->verts.size() * sizeof(QVector3D));
 
     vertexPosition = program->attributeLocation("VertexPosition");
     program->enableAttributeArray(vertexPosition);
@@ -83,7 +94,7 @@ void gshhsData::initializegshhsData(QOpenGLShaderProgram *prog)
     positionsBuf2.create();
     positionsBuf2.setUsagePattern(QOpenGLBuffer::StaticDraw);
     positionsBuf2.bind();
-    positionsBuf2.allocate(positions[1].data(), positions[1].size() * sizeof(GLfloat));
+    positionsBuf2.allocate(vxp_data[1]->verts.constData(), vxp_data[1]->verts.size() * sizeof(QVector3D));
 
     vertexPosition = program->attributeLocation("VertexPosition");
     program->enableAttributeArray(vertexPosition);
@@ -95,36 +106,47 @@ void gshhsData::initializegshhsData(QOpenGLShaderProgram *prog)
     positionsBuf3.create();
     positionsBuf3.setUsagePattern(QOpenGLBuffer::StaticDraw);
     positionsBuf3.bind();
-    positionsBuf3.allocate(positions[2].data(), positions[2].size() * sizeof(GLfloat));
+    positionsBuf3.allocate(vxp_data[2]->verts.constData(), vxp_data[2]->verts.size() * sizeof(QVector3D));
 
     vertexPosition = program->attributeLocation("VertexPosition");
     program->enableAttributeArray(vertexPosition);
     program->setAttributeBuffer(vertexPosition, GL_FLOAT, 0, 3);
 
-    qDebug() << QString("gshhsdata positions.size() = %1").arg(positions[0].size());
-    qDebug() << QString("gshhsdata totalverts = %1").arg(totalverts);
-
-
-    delete [] vxp_data[0];
-    delete [] vxp_data[1];
-    delete [] vxp_data[2];
-
+    qDebug() << QString("gshhsdata verts = %1 %2 %3").arg(vxp_data[0]->verts.size()).arg(vxp_data[1]->verts.size()).arg(vxp_data[2]->verts.size());
 
+    buffersuploaded = true;
 
 }
 
 gshhsData::~gshhsData()
 {
+    futureload.waitForFinished();
+
     vao1.destroy();
     positionsBuf1.destroy();
     vao2.destroy();
     positionsBuf2.destroy();
     vao3.destroy();
     positionsBuf3.destroy();
+
+    for(int i = 0; i < 3; i++)
+    {
+        delete [] vxp_data[i]->pFeatures;
+        delete vxp_data[i];
+        delete [] vxp_data_overlay[i]->pFeatures;
+        delete vxp_data_overlay[i];
+    }
  }
 
 void gshhsData::render(QMatrix4x4 projection, QMatrix4x4 modelview, int bBorders)
 {
+    if(!buffersuploaded)
+    {
+        if(program == NULL || !isDataLoaded())
+            return;
+        uploadBuffers();
+    }
+
     if(bBorders)
     {
 
@@ -168,212 +190,223 @@ void gshhsData::render(QMatrix4x4 projection, QMatrix4x4 modelview, int bBorders
 void gshhsData::Initialize(QString data1, QString data2, QString data3, QString dataoverlay1, QString dataoverlay2, QString dataoverlay3)
 {
 
-    QByteArray baglobe1 = data1.toUtf8();
-    QByteArray baglobe2 = data2.toUtf8();
-    QByteArray baglobe3 = data3.toUtf8();
-    QByteArray baoverlay1 = dataoverlay1.toUtf8();
-    QByteArray baoverlay2 = dataoverlay2.toUtf8();
-    QByteArray baoverlay3 = dataoverlay3.toUtf8();
+    QString filenames[6] = { data1, data2, data3, dataoverlay1, dataoverlay2, dataoverlay3 };
+    Vxp *vxps[6] = { vxp_data[0], vxp_data[1], vxp_data[2], vxp_data_overlay[0], vxp_data_overlay[1], vxp_data_overlay[2] };
 
-    if (baglobe1.length() > 0)
+    for(int i = 0; i < 6; i++)
     {
-        int nFeatures = check_gshhs(baglobe1.data());
-        load_gshhs(baglobe1.data(), nFeatures, vxp_data[0]);
-        qDebug() << QString("gshhs 1 file loaded nFeatures = %1").arg(nFeatures);
+        if(filenames[i].length() > 0)
+        {
+            GshhsJob job;
+            job.gshhs = this;
+            job.filename = filenames[i];
+            job.vxp = vxps[i];
+            jobs.append(job);
+        }
     }
 
-    if (baglobe2.length() > 0)
-    {
-        int nFeatures = check_gshhs(baglobe2.data());
-        load_gshhs(baglobe2.data(), nFeatures, vxp_data[1]);
-        qDebug() << QString("gshhs 2 file loaded nFeatures = %1").arg(nFeatures);
-    }
+    // Every file is loaded in its own task, the main window does not wait for the coastlines.
+    futureload = QtConcurrent::map(jobs, doLoadGshhs);
 
-    if (baglobe3.length() > 0)
-    {
-        int nFeatures = check_gshhs(baglobe3.data());
-        load_gshhs(baglobe3.data(), nFeatures, vxp_data[2]);
-        qDebug() << QString("gshhs 3 file loaded nFeatures = %1").arg(nFeatures);
-    }
+}
+
+bool gshhsData::load_gshhs(QString filename, Vxp *vxp)
+{
+
+    QFileInfo fileinfo(filename);
+    QString cachename = filename + ".evcache";
 
-    if (baoverlay1.length() > 0)
+    if(load_cache(cachename, fileinfo, vxp))
     {
-        int nFeatures = check_gshhs(baoverlay1.data());
-        load_gshhs(baoverlay1.data(), nFeatures, vxp_data_overlay[0]);
-        qDebug() << QString("gshhs overlay 1 file loaded nFeatures = %1").arg(nFeatures);
+        qDebug() << QString("gshhs file %1 loaded from cache nFeatures = %2").arg(filename).arg(vxp->nFeatures);
+        return true;
     }
 
-    if (baoverlay2.length() > 0)
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
     {
-        int nFeatures = check_gshhs(baoverlay2.data());
-        load_gshhs(baoverlay2.data(), nFeatures, vxp_data_overlay[1]);
-        qDebug() << QString("gshhs overlay 2 file loaded nFeatures = %1").arg(nFeatures);
+        qDebug() << QString( "gshhs:  Could not find file %1.").arg(filename);
+        return false;
     }
 
-    if (baoverlay3.length() > 0)
+    qint64 filesize = file.size();
+    uchar *pfile = file.map(0, filesize);
+    if (pfile == NULL)
     {
-        int nFeatures = check_gshhs(baoverlay3.data());
-        load_gshhs(baoverlay3.data(), nFeatures, vxp_data_overlay[2]);
-        qDebug() << QString("gshhs overlay 3 file loaded nFeatures = %1").arg(nFeatures);
+        qDebug() << QString( "gshhs:  Could not map file %1.").arg(filename);
+        return false;
     }
 
-}
-
-int gshhsData::check_gshhs(char *pFileName)
-{
-
-    double w, e, s, n, area, f_area, lon, lat;
-    //char source, kind[2] = {'P', 'L'}, c = '>', *file = NULL;
-    //char *name[2] = {"polygon", "line"};
-    FILE *fp = NULL;
-    int k, line, max_east = 270000000, info, single, error, ID, flip;
-    int  OK, level, version, greenwich, river, src, msformat = 0, first = 1;
-    size_t n_read;
+    int max_east = 270000000, version, greenwich, flip = 0;
     struct POINT_GSHHS p;
     struct GSHHS h;
+    qint64 pos = 0;
 
-    int nFeatures = 0;
-
+    vxp->featureoffset.clear();
+    vxp->lonlat.clear();
+    vxp->verts.clear();
+    vxp->featureoffset.append(0);
 
-    if ((fp = fopen (pFileName, "rb")) == NULL ) {
-            qDebug() << QString( "gshhs:  Could not find file %1.").arg(pFileName);
-            return 0; //exit (EXIT_FAILURE);
+    if (filesize >= (qint64)sizeof(struct GSHHS))
+    {
+        memcpy(&h, pfile, sizeof(struct GSHHS));
+        version = (h.flag >> 8) & 255;
+        flip = (version != GSHHS_DATA_RELEASE);	/* Take as sign that byte-swabbing is needed */
     }
 
-    n_read = fread ((void *)&h, (size_t)sizeof (struct GSHHS), (size_t)1, fp);
-    version = (h.flag >> 8) & 255;
-    flip = (version != GSHHS_DATA_RELEASE);	/* Take as sign that byte-swabbing is needed */
+    // One pass over the mapped file : headers and points are read in place
+    while (pos + (qint64)sizeof(struct GSHHS) <= filesize)
+    {
+        memcpy(&h, pfile + pos, sizeof(struct GSHHS));
+        pos += sizeof(struct GSHHS);
 
+        if (flip)
+        {
+            h.n  = swabi4 ((unsigned int)h.n);
+            h.west  = swabi4 ((unsigned int)h.west);
+            h.flag  = swabi4 ((unsigned int)h.flag);
+        }
 
-    while (n_read == 1)
-    {
+        if (h.n < 0 || pos + (qint64)h.n * (qint64)sizeof(struct POINT_GSHHS) > filesize)
+        {
+            qDebug() << QString( "gshhs:  Error reading file %1 for feature %2.").arg(filename).arg(vxp->featureoffset.size() - 1);
+            break;
+        }
+
+        greenwich = (h.flag >> 16) & 1;			/* Greenwich is 0 or 1 */
+
+        const uchar *ppoints = pfile + pos;
+        for (int k = 0; k < h.n; k++)
+        {
+            memcpy(&p, ppoints + k * sizeof(struct POINT_GSHHS), sizeof(struct POINT_GSHHS));
             if (flip)
             {
-                    h.id = swabi4 ((unsigned int)h.id);
-                    h.n  = swabi4 ((unsigned int)h.n);
-                    h.west  = swabi4 ((unsigned int)h.west);
-                    h.east  = swabi4 ((unsigned int)h.east);
-                    h.south = swabi4 ((unsigned int)h.south);
-                    h.north = swabi4 ((unsigned int)h.north);
-                    h.area  = swabi4 ((unsigned int)h.area);
-                    h.area_full  = swabi4 ((unsigned int)h.area_full);
-                    h.flag  = swabi4 ((unsigned int)h.flag);
-                    h.container  = swabi4 ((unsigned int)h.container);
-                    h.ancestor  = swabi4 ((unsigned int)h.ancestor);
+                p.x = swabi4 ((unsigned int)p.x);
+                p.y = swabi4 ((unsigned int)p.y);
             }
 
-            fseek (fp, (long)(h.n * sizeof(struct POINT_GSHHS)), SEEK_CUR);
-            max_east = 180000000;	/* Only Eurasia needs 270 */
-            n_read = fread((void *)&h, (size_t)sizeof (struct GSHHS), (size_t)1, fp);
-            if (n_read > 0)
-                nFeatures++;
+            LonLatPair ll;
+            ll.lonmicro = p.x;
+            ll.latmicro = p.y;
+            vxp->lonlat.append(ll);
+
+            double lon = p.x * GSHHS_SCL;
+            if ((greenwich && p.x > max_east) || (h.west > 180000000)) lon -= 360.0;
+            double lat = p.y * GSHHS_SCL;
+            QVector3D vert;
+            LonLat2Point(lat, lon, &vert, 1.0f);
+            vxp->verts.append(vert);
+        }
+
+        pos += (qint64)h.n * sizeof(struct POINT_GSHHS);
+        vxp->featureoffset.append(vxp->lonlat.size());
+        max_east = 180000000;	/* Only Eurasia needs 270 */
     }
 
-    fclose (fp);
-    return (nFeatures + 1);
+    file.unmap(pfile);
+    file.close();
+
+    setupFeatures(vxp);
+    write_cache(cachename, fileinfo, vxp);
+
+    qDebug() << QString("gshhs file %1 loaded nFeatures = %2").arg(filename).arg(vxp->nFeatures);
+
+    return true;
+
 }
 
-void gshhsData::load_gshhs(char *pFileName, int nTotFeatures, Vxp *vxp)
+bool gshhsData::load_cache(QString cachename, QFileInfo sourceinfo, Vxp *vxp)
 {
 
-    double w, e, s, n, area, f_area, lon, lat;
-    char source, kind[2] = {'P', 'L'}, c = '>'; //, *file = NULL;
-    //char *name[2] = {"polygon", "line"};
-    FILE *fp = NULL;
-    int k, line, max_east = 270000000, info, single, error, ID, flip;
-    int  OK, level, version, greenwich, river, src, msformat = 0, first = 1;
-    size_t n_read;
-    struct POINT_GSHHS p;
-    struct GSHHS h;
-    //Vxp *vxp = new Vxp;
+    QFile file(cachename);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
 
-    int nFeatures = 0;
+    qint64 filesize = file.size();
+    if (filesize < (qint64)sizeof(GshhsCacheHeader))
+        return false;
 
-    info = single = error = ID = 0;
+    uchar *pfile = file.map(0, filesize);
+    if (pfile == NULL)
+        return false;
 
+    GshhsCacheHeader header;
+    memcpy(&header, pfile, sizeof(GshhsCacheHeader));
 
-    if ((fp = fopen (pFileName, "rb")) == NULL ) {
-            qDebug() << QString( "gshhs:  Could not find file %1.").arg(pFileName);
-            return; // exit (EXIT_FAILURE);
+    qint64 expectedsize = sizeof(GshhsCacheHeader) + (qint64)(header.nFeatures + 1) * sizeof(qint32) +
+            (qint64)header.nVertsTotal * (sizeof(LonLatPair) + sizeof(QVector3D));
+
+    if (memcmp(header.magic, gshhscachemagic, sizeof(gshhscachemagic)) != 0 || header.byteorder != 0x01020304 ||
+            header.nFeatures < 0 || header.nVertsTotal < 0 || filesize != expectedsize ||
+            header.sourcesize != sourceinfo.size() || header.sourcemodified != sourceinfo.lastModified().toMSecsSinceEpoch())
+    {
+        file.unmap(pfile);
+        return false;
     }
 
-    n_read = fread ((void *)&h, (size_t)sizeof (struct GSHHS), (size_t)1, fp);
-    version = (h.flag >> 8) & 255;
-    flip = (version != GSHHS_DATA_RELEASE);	/* Take as sign that byte-swabbing is needed */
+    const uchar *pdata = pfile + sizeof(GshhsCacheHeader);
 
-    vxp->nFeatures = nTotFeatures;
-    vxp->pFeatures = new VxpFeature[nTotFeatures];
+    vxp->featureoffset.resize(header.nFeatures + 1);
+    memcpy(vxp->featureoffset.data(), pdata, (header.nFeatures + 1) * sizeof(qint32));
+    pdata += (header.nFeatures + 1) * sizeof(qint32);
 
-    while (n_read == 1)
-    {
-            if (flip)
-            {
-                    h.id = swabi4 ((unsigned int)h.id);
-                    h.n  = swabi4 ((unsigned int)h.n);
-                    h.west  = swabi4 ((unsigned int)h.west);
-                    h.east  = swabi4 ((unsigned int)h.east);
-                    h.south = swabi4 ((unsigned int)h.south);
-                    h.north = swabi4 ((unsigned int)h.north);
-                    h.area  = swabi4 ((unsigned int)h.area);
-                    h.area_full  = swabi4 ((unsigned int)h.area_full);
-                    h.flag  = swabi4 ((unsigned int)h.flag);
-                    h.container  = swabi4 ((unsigned int)h.container);
-                    h.ancestor  = swabi4 ((unsigned int)h.ancestor);
-            }
-            level = h.flag & 255;				/* Level is 1-4 */
-            version = (h.flag >> 8) & 255;			/* Version is 1-7 */
-            //if (first) fprintf (stderr, "gshhs %s - Found GSHHS version %d in file %s\n", GSHHS_PROG_VERSION, version, file);
-            greenwich = (h.flag >> 16) & 1;			/* Greenwich is 0 or 1 */
-            src = (h.flag >> 24) & 1;			/* Greenwich is 0 (WDBII) or 1 (WVS) */
-            river = (h.flag >> 25) & 1;			/* River is 0 (not river) or 1 (is river) */
-            w = h.west  * GSHHS_SCL;			/* Convert from microdegrees to degrees */
-            e = h.east  * GSHHS_SCL;
-            s = h.south * GSHHS_SCL;
-            n = h.north * GSHHS_SCL;
-            source = (src == 1) ? 'W' : 'C';		/* Either WVS or CIA (WDBII) pedigree */
-            if (river) source = tolower ((int)source);	/* Lower case c means river-lake */
-            line = (h.area) ? 0 : 1;			/* Either Polygon (0) or Line (1) (if no area) */
-            area = 0.1 * h.area;				/* Now im km^2 */
-            f_area = 0.1 * h.area_full;			/* Now im km^2 */
-
-            //OK = (!single || h.id == ID);
-            first = 0;
-
-            if (!msformat) c = kind[line];
-
-            vxp->pFeatures[nFeatures].nVerts = h.n;
-            vxp->pFeatures[nFeatures].pVerts = new QVector3D[ h.n ];
-            vxp->pFeatures[nFeatures].pLonLat = new LonLatPair[ h.n ];
-
-
-            for (int k = 0; k < h.n; k++)
-            {
-                if (fread ((void *)&p, (size_t)sizeof(struct POINT_GSHHS), (size_t)1, fp) != 1)
-                {
-                    //fprintf (stderr, "gshhs:  Error reading file %s for %s %d, point %d.\n", argv[1], name[line], h.id, k);
-                    exit (EXIT_FAILURE);
-                }
-                if (flip)
-                {
-                    p.x = swabi4 ((unsigned int)p.x);
-                    p.y = swabi4 ((unsigned int)p.y);
-                }
-                lon = p.x * GSHHS_SCL;
-                if ((greenwich && p.x > max_east) || (h.west > 180000000)) lon -= 360.0;
-                lat = p.y * GSHHS_SCL;
-                LonLat2Point(lat, lon, &vxp->pFeatures[nFeatures].pVerts[k], 1.0f);
-                vxp->pFeatures[nFeatures].pLonLat[k].lonmicro = p.x;
-                vxp->pFeatures[nFeatures].pLonLat[k].latmicro = p.y;
+    vxp->lonlat.resize(header.nVertsTotal);
+    memcpy(vxp->lonlat.data(), pdata, header.nVertsTotal * sizeof(LonLatPair));
+    pdata += header.nVertsTotal * sizeof(LonLatPair);
 
-            }
+    vxp->verts.resize(header.nVertsTotal);
+    memcpy(vxp->verts.data(), pdata, header.nVertsTotal * sizeof(QVector3D));
+
+    file.unmap(pfile);
+    file.close();
+
+    setupFeatures(vxp);
+
+    return true;
+}
 
-            max_east = 180000000;	/* Only Eurasia needs 270 */
-            n_read = fread((void *)&h, (size_t)sizeof (struct GSHHS), (size_t)1, fp);
-            nFeatures++;
+void gshhsData::write_cache(QString cachename, QFileInfo sourceinfo, Vxp *vxp)
+{
+
+    GshhsCacheHeader header;
+    memcpy(header.magic, gshhscachemagic, sizeof(gshhscachemagic));
+    header.byteorder = 0x01020304;
+    header.nFeatures = vxp->nFeatures;
+    header.nVertsTotal = vxp->lonlat.size();
+    header.reserved = 0;
+    header.sourcesize = sourceinfo.size();
+    header.sourcemodified = sourceinfo.lastModified().toMSecsSinceEpoch();
+
+    // QSaveFile only replaces the cache when everything is written, a read-only data directory is not an error
+    QSaveFile file(cachename);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << QString("gshhs: could not write cache %1").arg(cachename);
+        return;
     }
 
-    fclose (fp);
+    file.write((const char *)&header, sizeof(GshhsCacheHeader));
+    file.write((const char *)vxp->featureoffset.constData(), vxp->featureoffset.size() * sizeof(qint32));
+    file.write((const char *)vxp->lonlat.constData(), vxp->lonlat.size() * sizeof(LonLatPair));
+    file.write((const char *)vxp->verts.constData(), vxp->verts.size() * sizeof(QVector3D));
+
+    if (!file.commit())
+        qDebug() << QString("gshhs: could not write cache %1").arg(cachename);
+}
+
+void gshhsData::setupFeatures(Vxp *vxp)
+{
+
+    vxp->nFeatures = vxp->featureoffset.size() - 1;
+    vxp->pFeatures = new VxpFeature[vxp->nFeatures > 0 ? vxp->nFeatures : 1];
 
+    for (int i = 0; i < vxp->nFeatures; i++)
+    {
+        int first = vxp->featureoffset.at(i);
+        vxp->pFeatures[i].nVerts = vxp->featureoffset.at(i+1) - first;
+        vxp->pFeatures[i].pVerts = vxp->verts.data() + first;
+        vxp->pFeatures[i].pLonLat = vxp->lonlat.data() + first;
+    }
 }
 
 void gshhsData::LonLat2Point(float lat, float lon, QVector3D *pos, float radius)
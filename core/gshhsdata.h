@@ -7,6 +7,8 @@
 #include <QOpenGLBuffer>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLTexture>
+#include <QFuture>
+#include <QFileInfo>
 
 
 struct LonLatPair {
@@ -15,6 +17,7 @@ struct LonLatPair {
 };
 
 // vector-file
+// pVerts and pLonLat point into the contiguous verts/lonlat arrays of the owning Vxp
 struct VxpFeature {
         int	 nVerts;
         QVector3D *pVerts;
@@ -24,6 +27,29 @@ struct VxpFeature {
 struct Vxp {
         int         nFeatures;
         VxpFeature  *pFeatures;
+        QVector<qint32>     featureoffset;  // nFeatures + 1 entries, start vertex of each feature
+        QVector<QVector3D>  verts;          // xyz on the unit sphere, uploaded to GL as is
+        QVector<LonLatPair> lonlat;         // lon/lat in micro-degrees, used by the 2D overlays
+};
+
+// Header of the binary cache written next to a GSHHS file.
+// Layout : header | qint32 featureoffset[nFeatures+1] | LonLatPair[nVertsTotal] | float xyz[3*nVertsTotal]
+struct GshhsCacheHeader {
+        char    magic[8];
+        qint32  byteorder;
+        qint32  nFeatures;
+        qint32  nVertsTotal;
+        qint32  reserved;
+        qint64  sourcesize;
+        qint64  sourcemodified;
+};
+
+class gshhsData;
+
+struct GshhsJob {
+        gshhsData   *gshhs;
+        QString     filename;
+        Vxp         *vxp;
 };
 
 class gshhsData : protected QOpenGLFunctions
@@ -34,6 +60,10 @@ public:
     ~gshhsData();
 
     void render(QMatrix4x4 projection, QMatrix4x4 modelview, int bBorders);
+    bool isDataLoaded() { return futureload.isFinished(); }
+    void waitForData() { futureload.waitForFinished(); }
+    QFuture<void> loadFuture() const { return futureload; }
+    bool load_gshhs(QString filename, Vxp *vxp);
 
     Vxp	*vxp_data[3];
     Vxp *vxp_data_overlay[3];
@@ -41,8 +71,10 @@ public:
 private:
 
     void Initialize(QString data1, QString data2, QString data3, QString dataoverlay1, QString dataoverlay2, QString dataoverlay3);
-    void load_gshhs(char *pFileName, int nTotFeatures, Vxp *vxp);
-    int check_gshhs(char *pFileName);
+    bool load_cache(QString cachename, QFileInfo sourceinfo, Vxp *vxp);
+    void write_cache(QString cachename, QFileInfo sourceinfo, Vxp *vxp);
+    void setupFeatures(Vxp *vxp);
+    void uploadBuffers();
     void LonLat2Point(float lat, float lon, QVector3D *pos, float radius);
     QOpenGLShaderProgram *program;
     QOpenGLVertexArrayObject vao1;
@@ -55,6 +87,10 @@ private:
     GLuint vertexPosition;
     QVector<GLuint> featurevertsindex[3];
 
+    QList<GshhsJob> jobs;
+    QFuture<void> futureload;
+    bool buffersuploaded;
+
 };
 
 #endif // GSHHSDATA_H
@@ -0,0 +1,215 @@
+#include "imagepyramid.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <QMutex>
+#include <QDebug>
+#include <math.h>
+#include <string.h>
+
+extern QMutex g_mutex;
+
+// Every pixel of out is the mean of a 2 x 2 block of in, the last row and column of an odd in are repeated
+static void doReduceRows(PyramidJob &job)
+{
+    int inwidth = job.in->width();
+    int inheight = job.in->height();
+    int width = job.out->width();
+
+    for (int y = job.first; y < job.last; y++)
+    {
+        const QRgb *row0 = (const QRgb *)job.in->constScanLine(2 * y);
+        const QRgb *row1 = (const QRgb *)job.in->constScanLine(qMin(2 * y + 1, inheight - 1));
+        QRgb *row_out = (QRgb *)job.out->scanLine(y);
+
+        for (int x = 0; x < width; x++)
+        {
+            int x0 = 2 * x;
+            int x1 = qMin(2 * x + 1, inwidth - 1);
+            QRgb p00 = row0[x0], p01 = row0[x1], p10 = row1[x0], p11 = row1[x1];
+
+            row_out[x] = qRgba((qRed(p00) + qRed(p01) + qRed(p10) + qRed(p11) + 2) / 4,
+                               (qGreen(p00) + qGreen(p01) + qGreen(p10) + qGreen(p11) + 2) / 4,
+                               (qBlue(p00) + qBlue(p01) + qBlue(p10) + qBlue(p11) + 2) / 4,
+                               (qAlpha(p00) + qAlpha(p01) + qAlpha(p10) + qAlpha(p11) + 2) / 4);
+        }
+    }
+}
+
+ImagePyramid::ImagePyramid()
+{
+    source = NULL;
+    tiles.setMaxCost(PYRAMID_TILE_CACHE);
+}
+
+void ImagePyramid::clear()
+{
+    source = NULL;
+    imagesize = QSize();
+    converted = QImage();
+    levels.clear();
+    tiles.clear();
+}
+
+// The image stays owned by the caller and has to live as long as it is shown
+void ImagePyramid::setImage(const QImage *image)
+{
+    clear();
+    source = image;
+    if(source != NULL)
+        imagesize = source->size();
+
+    if(!isEmpty() && source->depth() != 32)
+        converted = source->convertToFormat(QImage::Format_ARGB32);
+}
+
+int ImagePyramid::maxLevel() const
+{
+    int lvl = 0;
+    int w = size().width();
+    int h = size().height();
+
+    while(qMax(w, h) > PYRAMID_TILE_SIZE)
+    {
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+        lvl++;
+    }
+    return lvl;
+}
+
+const QImage *ImagePyramid::level(int lvl)
+{
+    if(lvl == 0)
+        return converted.isNull() ? source : &converted;
+
+    while(levels.count() < lvl)
+    {
+        const QImage *in = level(levels.count());
+        levels.append(QImage((in->width() + 1) / 2, (in->height() + 1) / 2, in->format()));
+        g_mutex.lock();
+        reduceRows(levels.count(), 0, levels.last().height());
+        g_mutex.unlock();
+        qDebug() << QString("ImagePyramid::level %1 width = %2 height = %3").arg(levels.count()).arg(levels.last().width()).arg(levels.last().height());
+    }
+
+    return &levels[lvl - 1];
+}
+
+// rows first up to last of level lvl from level lvl - 1, both levels have to exist
+void ImagePyramid::reduceRows(int lvl, int first, int last)
+{
+    const QImage *in = (lvl == 1) ? level(0) : &levels[lvl - 2];
+    QImage *out = &levels[lvl - 1];
+
+    QList<PyramidJob> jobs;
+    for (int row = first; row < last; row += 32)
+    {
+        PyramidJob job;
+        job.in = in;
+        job.out = out;
+        job.first = row;
+        job.last = qMin(row + 32, last);
+        jobs.append(job);
+    }
+
+    // detach in this thread, the rows are written from the thread pool
+    out->bits();
+    QtConcurrent::blockingMap(jobs, doReduceRows);
+}
+
+// Rows of the image have changed : the levels are made again for these rows and their tiles are dropped
+void ImagePyramid::updateRows(int first, int count)
+{
+    if(isEmpty())
+        return;
+
+    first = qMax(first, 0);
+    count = qMin(first + count, imagesize.height()) - first;
+    if(count <= 0)
+        return;
+
+    g_mutex.lock();
+
+    // only the dirty rows of a source that is not 32 bit are converted again
+    if(!converted.isNull())
+    {
+        QImage rows = source->copy(0, first, imagesize.width(), count).convertToFormat(QImage::Format_ARGB32);
+        for (int y = 0; y < rows.height(); y++)
+            memcpy(converted.scanLine(first + y), rows.constScanLine(y), qMin(rows.bytesPerLine(), converted.bytesPerLine()));
+    }
+
+    for (int lvl = 1; lvl <= levels.count(); lvl++)
+    {
+        int firstrow = first >> lvl;
+        int lastrow = qMin((first + count - 1) >> lvl, levels.at(lvl - 1).height() - 1);
+        reduceRows(lvl, firstrow, lastrow + 1);
+    }
+
+    g_mutex.unlock();
+
+    QList<quint64> keys = tiles.keys();
+    for (int i = 0; i < keys.count(); i++)
+    {
+        int lvl = keys.at(i) >> 48;
+        int ty = (keys.at(i) >> 24) & 0xFFFFFF;
+        int firstrow = first >> lvl;
+        int lastrow = (first + count - 1) >> lvl;
+        if(ty * PYRAMID_TILE_SIZE <= lastrow && (ty + 1) * PYRAMID_TILE_SIZE > firstrow)
+            tiles.remove(keys.at(i));
+    }
+}
+
+QPixmap ImagePyramid::tile(int lvl, int tx, int ty)
+{
+    quint64 key = ((quint64)lvl << 48) | ((quint64)ty << 24) | (quint64)tx;
+
+    QPixmap *cached = tiles.object(key);
+    if(cached != NULL)
+        return *cached;
+
+    const QImage *im = level(lvl);
+    QRect rect = QRect(tx * PYRAMID_TILE_SIZE, ty * PYRAMID_TILE_SIZE, PYRAMID_TILE_SIZE, PYRAMID_TILE_SIZE).intersected(im->rect());
+
+    g_mutex.lock();
+    QImage part = im->copy(rect);
+    g_mutex.unlock();
+
+    QPixmap pm = QPixmap::fromImage(part);
+    tiles.insert(key, new QPixmap(pm), qMax(1, rect.width() * rect.height() * 4 / 1024));
+    return pm;
+}
+
+// exposed is in the coordinates of the widget, that shows the image at scale
+void ImagePyramid::paint(QPainter *painter, const QRect &exposed, double scale)
+{
+    if(isEmpty() || scale <= 0.0)
+        return;
+
+    // the first level that is not smaller than the image on screen
+    int maxlvl = maxLevel();
+    int lvl = 0;
+    while(lvl < maxlvl && scale * (2 << lvl) <= 1.0)
+        lvl++;
+
+    const QImage *im = level(lvl);
+    double levelscale = scale * (1 << lvl);
+
+    QRect area = QRect(QPoint((int)floor(exposed.left() / levelscale), (int)floor(exposed.top() / levelscale)),
+                       QPoint((int)ceil((exposed.right() + 1) / levelscale), (int)ceil((exposed.bottom() + 1) / levelscale))).intersected(im->rect());
+    if(area.isEmpty())
+        return;
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+    painter->scale(levelscale, levelscale);
+
+    for (int ty = area.top() / PYRAMID_TILE_SIZE; ty <= area.bottom() / PYRAMID_TILE_SIZE; ty++)
+    {
+        for (int tx = area.left() / PYRAMID_TILE_SIZE; tx <= area.right() / PYRAMID_TILE_SIZE; tx++)
+        {
+            painter->drawPixmap(tx * PYRAMID_TILE_SIZE, ty * PYRAMID_TILE_SIZE, tile(lvl, tx, ty));
+        }
+    }
+
+    painter->restore();
+}
@@ -0,0 +1,54 @@
+#ifndef IMAGEPYRAMID_H
+#define IMAGEPYRAMID_H
+
+#include <QImage>
+#include <QPixmap>
+#include <QPainter>
+#include <QCache>
+#include <QList>
+
+// side of a tile in pixels of its level
+#define PYRAMID_TILE_SIZE 256
+// upper limit of the uploaded tiles in KB
+#define PYRAMID_TILE_CACHE (96 * 1024)
+
+struct PyramidJob {
+    const QImage *in;
+    QImage *out;
+    int first;          // first row of out
+    int last;           // one past the last row
+};
+
+// Multi-resolution view of an image owned by SegmentImage. Level 0 is the image itself,
+// every next level halves the width and height. Levels are made when a zoom needs them,
+// tiles of PYRAMID_TILE_SIZE are uploaded as pixmaps when they become visible and are kept
+// in a cache of PYRAMID_TILE_CACHE KB. No pixmap of the full image is made.
+class ImagePyramid
+{
+public:
+    ImagePyramid();
+
+    void setImage(const QImage *image);
+    void updateRows(int first, int count);
+    void clear();
+
+    bool isEmpty() const { return source == NULL || imagesize.isEmpty(); }
+    QSize size() const { return imagesize; }
+    const QImage *image() const { return source; }
+
+    void paint(QPainter *painter, const QRect &exposed, double scale);
+
+private:
+    const QImage *level(int lvl);
+    QPixmap tile(int lvl, int tx, int ty);
+    void reduceRows(int lvl, int first, int last);
+    int maxLevel() const;
+
+    const QImage *source;
+    QSize imagesize;            // size of source when it was set
+    QImage converted;           // source in 32 bit, only for other formats
+    QList<QImage> levels;       // levels[i] is level i + 1
+    QCache<quint64, QPixmap> tiles;
+};
+
+#endif // IMAGEPYRAMID_H
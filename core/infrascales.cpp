@@ -2,6 +2,32 @@
 #include <QBoxLayout>
 #include <QMouseEvent>
 #include <QDebug>
+#include <QtConcurrent/QtConcurrent>
+
+#define INFRA_ROWS_PER_JOB 64
+
+static void doInfraMinMax(InfraScalesJob &job)
+{
+    int width = imageptrs->ptrimageProjection->width();
+    const float *btemp = imageptrs->ptrProjectionBrightnessTemp.data() + job.first * width;
+    const float *end = imageptrs->ptrProjectionBrightnessTemp.data() + job.last * width;
+
+    for( ; btemp < end; btemp++)
+    {
+        if(*btemp > 0)
+        {
+            if(*btemp > job.maxtemp)
+                job.maxtemp = *btemp;
+            if(*btemp < job.mintemp)
+                job.mintemp = *btemp;
+        }
+    }
+}
+
+static void doInfraColorRows(InfraScalesJob &job)
+{
+    job.scales->colorProjectionRows(job.first, job.last);
+}
 
 
 InfraScales::InfraScales(QWidget *parent) : QWidget(parent)
@@ -143,54 +169,13 @@ void InfraScales::mousePressEvent( QMouseEvent *e )
 
 void InfraScales::mouseReleaseEvent( QMouseEvent *e )
 {
-
-    QRgb *row;
-    float btemp;
-
-    int height = imageptrs->ptrimageProjection->height();
-    int width = imageptrs->ptrimageProjection->width();
-
-    if(imageptrs->ptrProjectionInfra.isNull())
-        return;
-
-    int intlow = (int)((lowlimit) * 255.0);
-    int inthigh = (int)((highlimit) * 255.0);
-    //float delta = highlimittemp - lowlimittemp; //this->maxbtemp - this->minbtemp;
     qDebug() << QString("scales release x = %1 y = %2 lowlimit = %3 highlimit = %4").arg(e->x()).arg(e->y()).arg(lowlimit).arg(highlimit);
-    qDebug() << QString("scales release x = %1 y = %2 intlow = %3 inthigh = %4").arg(e->x()).arg(e->y()).arg(intlow).arg(inthigh);
-
-    for(int y = 0; y < height; y++)
-    {
-        row = (QRgb*)imageptrs->ptrimageProjection->scanLine(y);
 
-        for(int x = 0; x < width; x++)
-        {
-            quint8 greyval = imageptrs->ptrProjectionInfra[y * width + x];
-
-            if(imageptrs->ptrProjectionBrightnessTemp.isNull())
-                return;
-            btemp = imageptrs->ptrProjectionBrightnessTemp[y * width + x];
-            if(btemp > 0)
-            {
-                float fval = (btemp - minprojectiontemp)/deltaprojectiontemp ;
-
-                if(lowlimit <= fval && fval <= highlimit)
-                {
-                    row[x] = getColor(fval).rgb();
-                }
-                else
-                {
-                    row[x] = qRgb(greyval, greyval, greyval);
-                }
-            }
-
-        }
-    }
+    recolorProjection();
 
     grablowcursor = false;
     grabhighcursor = false;
 
-    emit repaintprojectionimage();
     update();
 }
 
@@ -228,9 +213,114 @@ void InfraScales::mouseMoveEvent( QMouseEvent *e )
         }
     }
 
+    if(grablowcursor || grabhighcursor)
+        recolorProjection();
+
     update();
 }
 
+void InfraScales::recolorProjection()
+{
+    if(imageptrs->ptrProjectionInfra.isNull() || imageptrs->ptrProjectionBrightnessTemp.isNull())
+        return;
+
+    colorProjection(minprojectiontemp, deltaprojectiontemp, true);
+
+    emit repaintprojectionimage();
+}
+
+QList<InfraScalesJob> InfraScales::projectionJobs(InfraScales *scales)
+{
+    QList<InfraScalesJob> jobs;
+    int height = imageptrs->ptrimageProjection->height();
+
+    for(int first = 0; first < height; first += INFRA_ROWS_PER_JOB)
+    {
+        InfraScalesJob job;
+        job.scales = scales;
+        job.first = first;
+        job.last = qMin(first + INFRA_ROWS_PER_JOB, height);
+        job.mintemp = 9999999.0;
+        job.maxtemp = 0.0;
+        jobs.append(job);
+    }
+    return jobs;
+}
+
+// Minimum and maximum of the brightness temperatures > 0 of the projection.
+// Returns false when the projection has no temperatures.
+bool InfraScales::getProjectionMinMax(float *mintemp, float *maxtemp)
+{
+    *mintemp = 9999999.0;
+    *maxtemp = 0.0;
+
+    if(imageptrs->ptrProjectionBrightnessTemp.isNull())
+        return false;
+
+    QList<InfraScalesJob> jobs = projectionJobs(0);
+    QtConcurrent::blockingMap(jobs, doInfraMinMax);
+
+    for(int i = 0; i < jobs.count(); i++)
+    {
+        *mintemp = qMin(*mintemp, jobs.at(i).mintemp);
+        *maxtemp = qMax(*maxtemp, jobs.at(i).maxtemp);
+    }
+    return true;
+}
+
+// Colours the pixels with a brightness temperature > 0 with the palette, fval = (btemp - mintemp)/deltatemp.
+// With uselimits, the pixels outside [lowlimit, highlimit] get their grey value from ptrProjectionInfra.
+void InfraScales::colorProjection(float mintemp, float deltatemp, bool uselimits)
+{
+    if(imageptrs->ptrProjectionBrightnessTemp.isNull())
+        return;
+
+    colortable = infrawidget->getColorTable();
+    colormintemp = mintemp;
+    colordeltatemp = deltatemp;
+    colorlimits = uselimits;
+
+    // detach here, the rows are written from the thread pool
+    imageptrs->ptrimageProjection->bits();
+
+    QList<InfraScalesJob> jobs = projectionJobs(this);
+    QtConcurrent::blockingMap(jobs, doInfraColorRows);
+}
+
+void InfraScales::colorProjectionRows(int first, int last)
+{
+    int width = imageptrs->ptrimageProjection->width();
+    int bytesperline = imageptrs->ptrimageProjection->bytesPerLine();
+    uchar *bits = imageptrs->ptrimageProjection->bits();
+    const float *btemps = imageptrs->ptrProjectionBrightnessTemp.data();
+    const quint8 *greyvals = imageptrs->ptrProjectionInfra.data();
+    const QRgb *table = colortable.constData();
+
+    for(int y = first; y < last; y++)
+    {
+        QRgb *row = (QRgb*)(bits + y * bytesperline);
+        const float *btemp = btemps + y * width;
+
+        for(int x = 0; x < width; x++)
+        {
+            if(btemp[x] > 0)
+            {
+                float fval = (btemp[x] - colormintemp)/colordeltatemp;
+                if(!colorlimits || (lowlimit <= fval && fval <= highlimit))
+                {
+                    int index = qRound(fval * 255.0);
+                    row[x] = table[qBound(0, index, 255)];
+                }
+                else
+                {
+                    quint8 greyval = greyvals[y * width + x];
+                    row[x] = qRgb(greyval, greyval, greyval);
+                }
+            }
+        }
+    }
+}
+
 void InfraScales::resizeEvent( QResizeEvent *e )
 {
 
@@ -8,6 +8,16 @@
 #include "formimage.h"
 extern SegmentImage *imageptrs;
 
+class InfraScales;
+
+struct InfraScalesJob {
+    InfraScales *scales;
+    int first;          // first projection row
+    int last;           // one past the last row
+    float mintemp;      // minimum and maximum brightness temperature > 0 in these rows
+    float maxtemp;
+};
+
 class InfraScales : public QWidget
 {
     Q_OBJECT
@@ -23,6 +33,9 @@ public:
     void initializeLowHigh();
     QImage getScalesImage(int width);
     void drawInfraScales(QPainter *paint, QPointF lowcursor, QPointF highcursor);
+    void colorProjection(float mintemp, float deltatemp, bool uselimits);
+    void colorProjectionRows(int first, int last);
+    static bool getProjectionMinMax(float *mintemp, float *maxtemp);
 
 
 protected:
@@ -36,6 +49,8 @@ public slots:
 
 private:
     void drawMinMaxTemp(QPainter *painter, QPointF lowcursor, QPointF highcursor);
+    void recolorProjection();
+    static QList<InfraScalesJob> projectionJobs(InfraScales *scales);
 
     InfraWidget *infrawidget;
     QWidget *scalewidget;
@@ -53,6 +68,12 @@ private:
     float maxprojectiontemp; // maximum temp. for this projection
     float deltaprojectiontemp; // = maxprojectiontemp - minprojectiontemp
     bool inverse;
+
+    // state of the colouring pass running in colorProjectionRows
+    QVector<QRgb> colortable;
+    float colormintemp;
+    float colordeltatemp;
+    bool colorlimits;
 signals:
     void repaintprojectionimage();
 
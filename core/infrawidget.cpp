@@ -16,6 +16,7 @@ InfraWidget::InfraWidget(QWidget *parent) : QWidget(parent)
     grablowlimit = false;
     grabhighlimit = false;
     inverse = false;
+    colortablemap = -1;
 
 }
 
@@ -127,6 +128,34 @@ QColor InfraWidget::getColor(float value)
     return(col);
 }
 
+int InfraWidget::currentColormap()
+{
+    if(opts.colormapMagma)
+        return 0;
+    else if(opts.colormapInferno)
+        return 1;
+    else if(opts.colormapPlasma)
+        return 2;
+    else if(opts.colormapViridis)
+        return 3;
+    return 4;
+}
+
+// getColor(value) == getColorTable().at(qRound(value * 255.0)) for value in [0, 1].
+// The table is only rebuilt when another colormap is selected in the preferences.
+const QVector<QRgb> &InfraWidget::getColorTable()
+{
+    int colormap = currentColormap();
+    if(colormap != colortablemap)
+    {
+        colortable.resize(256);
+        for(int i = 0; i < 256; i++)
+            colortable[i] = getColor(i / 255.0).rgb();
+        colortablemap = colormap;
+    }
+    return colortable;
+}
+
 //QColor InfraWidget::getColor(double value)
 //{
 //    if(value > 1.0 || value < 0.0)
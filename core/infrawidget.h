@@ -3,6 +3,7 @@
 
 #include <QWidget>
 #include <QPainter>
+#include <QVector>
 
 class InfraWidget : public QWidget
 {
@@ -12,6 +13,7 @@ public:
     void setlowcursor(float low);
     void sethighcursor(float high);
     QColor getColor(float value);
+    const QVector<QRgb> &getColorTable();
     void setInverse(bool inv) { inverse = inv; lowlimit = 0.0; highlimit = 1.0; }
     bool getInverse() { return inverse; }
     void initializeLowHigh() { lowlimit = 0.0; highlimit = 1.0; }
@@ -29,6 +31,11 @@ protected:
   bool grabhighlimit;
   bool inverse;
 
+private:
+  int currentColormap();
+  QVector<QRgb> colortable;   // the 256 entries of the selected colormap
+  int colortablemap;          // colormap the table was built for, -1 when not built
+
 };
 
 #endif // INFRAWIDGET_H
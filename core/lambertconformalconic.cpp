@@ -1,7 +1,9 @@
 #include "lambertconformalconic.h"
+#include "tracer.h"
 #include "globals.h"
 #include "options.h"
 #include "pixgeoconversion.h"
+#include "projectionexport.h"
 
 #include <QDebug>
 
@@ -17,6 +19,8 @@ LambertConformalConic::LambertConformalConic(QObject *parent, AVHRRSatellite *se
     max_x = 0.0;
     min_y = 9999999999.0;
     max_y = 0.0;
+    lat1 = 0.0;
+    lat2 = 0.0;
 
      qDebug() << QString("constructor LambertConformalConic");
 
@@ -54,8 +58,8 @@ void LambertConformalConic::Initialize(double r_maj, double r_min, double stdlat
     image_width = imagewidth;
     image_height = imageheight;
 
-    double lat1 = stdlat1*PI/180.0;
-    double lat2 = stdlat2*PI/180.0;
+    lat1 = stdlat1*PI/180.0;
+    lat2 = stdlat2*PI/180.0;
 
     center_lon = c_lon * PI/180.0;
     center_lat = c_lat * PI/180.0;
@@ -161,6 +165,7 @@ void LambertConformalConic::Initialize(double r_maj, double r_min, double stdlat
 
 void LambertConformalConic::CreateMapFromAVHRR(int inputchannel, eSegmentType type)
 {
+    TraceSpan span("projection", "LambertConformalConic::CreateMapFromAVHRR");
 
     calc_map_extents();
 
@@ -193,6 +198,7 @@ void LambertConformalConic::CreateMapFromAVHRR(int inputchannel, eSegmentType ty
 
 void LambertConformalConic::CreateMapFromVIIRS(eSegmentType type, bool combine)
 {
+    TraceSpan span("projection", "LambertConformalConic::CreateMapFromVIIRS");
     calc_map_extents();
 
     if (type == SEG_VIIRSM)
@@ -217,6 +223,7 @@ void LambertConformalConic::CreateMapFromVIIRS(eSegmentType type, bool combine)
 
 void LambertConformalConic::CreateMapFromGeostationary()
 {
+    TraceSpan span("projection", "LambertConformalConic::CreateMapFromGeostationary");
     QApplication::setOverrideCursor( Qt::WaitCursor ); // this might take time
 
     QRgb *scanl;
@@ -243,6 +250,8 @@ void LambertConformalConic::CreateMapFromGeostationary()
     if(sl == NULL)
         return;
 
+    sl->ComposeForProjection();
+
     qDebug() << QString("COFF = %1 COFF_HRV = %2 COFF_NON_HRV = %3").arg(sl->COFF).arg(COFF_HRV).arg(COFF_NONHRV);
     qDebug() << QString("LOFF = %1 LOFF_HRV = %2 LOFF_NON_HRV = %3").arg(sl->LOFF).arg(LOFF_HRV).arg(LOFF_NONHRV);
     qDebug() << QString("CFAC = %1 CFAC_HRV = %2 CFAC_NON_HRV = %3").arg(sl->CFAC).arg(CFAC_HRV).arg(CFAC_NONHRV);
@@ -288,6 +297,11 @@ void LambertConformalConic::CreateMapFromGeostationary()
 
 
 
+    // brightness temperatures of a calibrated MSG infrared image
+    int projwidth = imageptrs->ptrimageProjection->width();
+    int geowidth = imageptrs->ptrimageGeostationary->width();
+    const float *btgeo = (imageptrs->InitializeProjectionBrightnessTemp() && hrvmap == 0 ? imageptrs->ptrBrightnessTempGeostationary.data() : NULL);
+
     for (int j = 0; j < imageptrs->ptrimageProjection->height(); j++)
     {
         for (int i = 0; i < imageptrs->ptrimageProjection->width(); i++)
@@ -308,6 +322,8 @@ void LambertConformalConic::CreateMapFromGeostationary()
                                 rgbval = scanl[col];
                                 fb_painter.setPen(rgbval);
                                 fb_painter.drawPoint(i,j);
+                                if(btgeo != NULL)
+                                    imageptrs->ptrProjectionBrightnessTemp[j * projwidth + i] = btgeo[picrow * geowidth + col];
                             }
                         }
                         else
@@ -378,6 +394,8 @@ void LambertConformalConic::CreateMapFromGeostationary()
                             rgbval = scanl[col];
                             fb_painter.setPen(rgbval);
                             fb_painter.drawPoint(i,j);
+                            if(btgeo != NULL)
+                                imageptrs->ptrProjectionBrightnessTemp[j * projwidth + i] = btgeo[picrow * geowidth + col];
                         }
                     }
                 }
@@ -537,6 +555,27 @@ bool LambertConformalConic::map_inverse(double map_x, double map_y, double &lon_
     return ret;
 }
 
+// map_inverse is affine in the lamccfor coordinates, which include the false easting and northing
+void LambertConformalConic::georeference(ProjectionGeoreference &geo)
+{
+    geo.originx = min_x * map_width / Ax - mapdeltax * Dx/Ax;
+    geo.originy = max_y + mapdeltay * Dy/Ay;
+    geo.pixelx = Dx/Ax;
+    geo.pixely = Dy/Ay;
+    geo.semimajor = r_major;
+    geo.semiminor = r_minor;
+    geo.lon0 = center_lon * 180.0/PI;
+    geo.lat0 = center_lat * 180.0/PI;
+    geo.stdlat1 = lat1 * 180.0/PI;
+    geo.stdlat2 = lat2 * 180.0/PI;
+    geo.height = 0.0;
+    geo.falseeasting = false_easting;
+    geo.falsenorthing = false_northing;
+    geo.proj4 = QString("+proj=lcc +lat_1=%1 +lat_2=%2 +lat_0=%3 +lon_0=%4 +x_0=%5 +y_0=%6 +a=%7 +b=%8 +units=m +no_defs")
+            .arg(geo.stdlat1, 0, 'f', 6).arg(geo.stdlat2, 0, 'f', 6).arg(geo.lat0, 0, 'f', 6).arg(geo.lon0, 0, 'f', 6)
+            .arg(geo.falseeasting, 0, 'f', 3).arg(geo.falsenorthing, 0, 'f', 3).arg(geo.semimajor, 0, 'f', 3).arg(geo.semiminor, 0, 'f', 3);
+}
+
 void LambertConformalConic::testmap()
 {
     double map_x, map_y;
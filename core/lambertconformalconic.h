@@ -4,6 +4,8 @@
 #include <QObject>
 #include "avhrrsatellite.h"
 
+struct ProjectionGeoreference;
+
 class LambertConformalConic : public QObject
 {
     Q_OBJECT
@@ -29,6 +31,7 @@ public:
 
 
     void calc_map_extents();
+    void georeference(ProjectionGeoreference &geo);
 
 
 private:
@@ -65,6 +68,8 @@ private:
     double e;                      /* eccentricity                 */
     double center_lon;             /* center longituted            */
     double center_lat;             /* center latitude              */
+    double lat1;                   /* first standard parallel      */
+    double lat2;                   /* second standard parallel     */
     double ns;                     /* ratio of angle between meridian*/
     double f0;                     /* flattening of ellipsoid      */
     double rh;                     /* height above ellipsoid       */
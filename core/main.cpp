@@ -8,7 +8,10 @@
 #include "options.h"
 #include "poi.h"
 #include "gshhsdata.h"
+#include "benchmark.h"
+#include "tracer.h"
 #include <stdexcept>
+#include <cstring>
 
 #include <QMutex>
 
@@ -24,10 +27,13 @@ gshhsData *gshhsdata;
 QFile loggingFile;
 QTextStream out(&loggingFile);
 bool doLogging;
+bool doBenchmark;
 
 void myMessageOutput(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
-
+    // the debug output of the decoders would be timed with them
+    if(doBenchmark && type == QtDebugMsg)
+        return;
 
 #ifdef NDEBUG
    // release mode code
@@ -95,6 +101,17 @@ void myMessageOutput(QtMsgType type, const QMessageLogContext &context, const QS
 int main(int argc, char *argv[])
 {
     doLogging = false;
+    doBenchmark = false;
+    for(int i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--benchmark") == 0)
+            doBenchmark = true;
+    }
+
+    // no display is needed for a benchmark
+    if(doBenchmark && qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
     loggingFile.setFileName("logging.txt");
     if (!loggingFile.open(QIODevice::WriteOnly | QIODevice::Text))
         return 0;
@@ -102,6 +119,8 @@ int main(int argc, char *argv[])
     qInstallMessageHandler(myMessageOutput);
 
     QApplication app(argc, argv);
+    app.setApplicationName("EUMETCastView");    // part of the cache location, see DirectoryIndex
+    app.setApplicationVersion(APPVERSION);
 
     QStringList styles = QStyleFactory::keys();
 
@@ -116,10 +135,19 @@ int main(int argc, char *argv[])
 
     opts.Initialize();
     poi.Initialize();
+    Tracer::instance();     // the trace starts here when opts.tracing is on
 
     imageptrs = new SegmentImage();
     gshhsdata = new gshhsData();
 
+    if(doBenchmark)
+    {
+        Benchmark benchmark(QCoreApplication::arguments());
+        int ret = benchmark.run();
+        Tracer::instance()->write();
+        return ret;
+    }
+
     QSurfaceFormat format;
     format.setDepthBufferSize(24);
     if (QCoreApplication::arguments().contains(QStringLiteral("--multisample")))
@@ -127,9 +155,6 @@ int main(int argc, char *argv[])
 
     QSurfaceFormat::setDefaultFormat(format);
 
-    app.setApplicationName("EUMETCastView");
-    app.setApplicationVersion(APPVERSION);
-
 //    "QTabWidget::tab:disabled { width: 0; height: 0; margin: 0; padding: 0; border: none; }"
 
     app.setStyleSheet(
@@ -169,5 +194,8 @@ int main(int argc, char *argv[])
     QLabel note("OpenGL Support required");
     note.show();
 #endif
-    return app.exec();
+    int ret = app.exec();
+
+    Tracer::instance()->write();
+    return ret;
 }
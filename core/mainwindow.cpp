@@ -1,7 +1,20 @@
 #include <QDebug>
+#include <QDialog>
+#include <QDateTimeEdit>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QLabel>
+#include <QProgressDialog>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
 
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "projectionexport.h"
+#include "poiextractor.h"
+#include "geomosaic.h"
 #include <hdf5/serial/hdf5.h>
 
 extern Options opts;
@@ -30,6 +43,7 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->stackedWidget->addWidget(formephem); // index 0
 
     formtoolbox = NULL;
+    animationplayer = NULL;
 
     formgeostationary = new FormGeostationary(this, satlist, seglist);
     ui->stackedWidget->addWidget(formgeostationary); // index 1
@@ -117,6 +131,14 @@ MainWindow::MainWindow(QWidget *parent) :
         connect(&seglist->seglh8->watcherBlue[i], SIGNAL(finished()), formimage, SLOT(slotUpdateMeteosat()));
     }
 
+    QList<SegmentListGeostationary *> geolists;
+    geolists << seglist->seglmeteosat << seglist->seglmeteosatrss << seglist->seglmet8 << seglist->seglmet7
+             << seglist->seglgoes13dc3 << seglist->seglgoes15dc3 << seglist->seglgoes13dc4 << seglist->seglgoes15dc4 << seglist->seglh8;
+    for( int i = 0; i < geolists.count(); i++)
+    {
+        connect(geolists.at(i), SIGNAL(segmentcomposed(int, int, bool)), formimage, SLOT(slotSegmentComposed(int, int, bool)));
+    }
+
     imageptrs->gvp = new GeneralVerticalPerspective(this, seglist);
     imageptrs->lcc = new LambertConformalConic(this, seglist);
     imageptrs->sg = new StereoGraphic(this, seglist);
@@ -191,6 +213,7 @@ MainWindow::MainWindow(QWidget *parent) :
     connect( ui->stackedWidget, SIGNAL(currentChanged(int)),formglobecyl, SLOT(updatesatmap(int)) );
     connect( formephem,SIGNAL(signalDirectoriesRead()), formgeostationary, SLOT(PopulateTree()) );
     connect( seglist,SIGNAL(signalAddedSegmentlist()), formephem, SLOT(showSegmentsAdded()));
+    connect( seglist,SIGNAL(signalAddedGeostationarySegments(QList<SegmentFileDescriptor>)), formgeostationary, SLOT(UpdateTree(QList<SegmentFileDescriptor>)) );
 
     connect( formephem,SIGNAL(signalDirectoriesRead()), formglobecyl, SLOT(setScrollBarMaximum()));
     connect( formglobecyl, SIGNAL(emitMakeImage()), formimage, SLOT(slotMakeImage()));
@@ -201,7 +224,11 @@ MainWindow::MainWindow(QWidget *parent) :
 
     connect( formephem, SIGNAL(signalDatagram(QByteArray)), seglist, SLOT(AddSegmentsToListFromUdp(QByteArray)));
 
+    segmentdirectorywatcher = new SegmentDirectoryWatcher(this);
+    connect( segmentdirectorywatcher, SIGNAL(newSegmentFiles(QList<SegmentFileDescriptor>)), seglist, SLOT(AddSegmentsToListFromWatcher(QList<SegmentFileDescriptor>)));
+
     connect( formimage, SIGNAL(render3dgeo(SegmentListGeostationary::eGeoSatellite)), globe, SLOT(Render3DGeo(SegmentListGeostationary::eGeoSatellite)));
+    connect( formimage, SIGNAL(render3dgeosegment(SegmentListGeostationary::eGeoSatellite, int, int)), globe, SLOT(Render3DGeoRows(SegmentListGeostationary::eGeoSatellite, int, int)));
     connect( formimage, SIGNAL(allsegmentsreceivedbuttons(bool)), formtoolbox, SLOT(setToolboxButtons(bool)));
     connect( globe, SIGNAL(renderingglobefinished(bool)), formtoolbox, SLOT(setToolboxButtons(bool)));
 
@@ -334,6 +361,7 @@ void MainWindow::slotPreferencesFinished(int result)
 {
     if(result == 2)
         formtoolbox->setPOIsettings();
+    segmentdirectorywatcher->updateWatchedDirectories();
 }
 
 void MainWindow::on_actionAbout_triggered()
@@ -467,7 +495,7 @@ void MainWindow::on_actionShowToolbox_triggered()
 
 void MainWindow::on_actionCreatePNG_triggered()
 {
-    const QPixmap *pm;
+    QImage image;
     QString filestr;
 
     filestr.append("./");
@@ -490,20 +518,19 @@ void MainWindow::on_actionCreatePNG_triggered()
         if(fileName.mid(fileName.length()-4) != ".jpg" && fileName.mid(fileName.length()-4) != ".jpg" &&
                 fileName.mid(fileName.length()-4) != ".png" && fileName.mid(fileName.length()-4) != ".PNG")
             fileName.append(".jpg");
-        pm = formimage->returnimageLabelptr()->pixmap();
+        image = formimage->returnimageLabelptr()->toImage();
 
         if(!forminfrascales->isHidden())
         {
-            QImage imresult(pm->width(), pm->height() + 80, QImage::Format_RGB32);
+            QImage imresult(image.width(), image.height() + 80, QImage::Format_RGB32);
 
-            QImage im = pm->toImage();
             QPainter painter(&imresult);
 
-            QImage scales = forminfrascales->getScalesImage(im.width());
+            QImage scales = forminfrascales->getScalesImage(image.width());
             //QImage scales(im.width(), 80, im.format());
             //scales.fill(Qt::blue);
 
-            painter.drawImage(0, 0, im);
+            painter.drawImage(0, 0, image);
             painter.drawImage(0, imresult.height()-80, scales);
 
             painter.end();
@@ -511,13 +538,209 @@ void MainWindow::on_actionCreatePNG_triggered()
         }
         else
         {
-            pm->save(fileName);
+            image.save(fileName);
         }
         QApplication::restoreOverrideCursor();
     }
 
 }
 
+void MainWindow::on_actionExportProjection_triggered()
+{
+    if (formimage->channelshown != IMAGE_PROJECTION)
+    {
+        QMessageBox::information(this, tr("Export projection"), tr("Show a projection image first."));
+        return;
+    }
+
+    ProjectionExport exporter;
+    if (!exporter.isValid())
+    {
+        QMessageBox::warning(this, tr("Error"), exporter.errorString().isEmpty() ? tr("There is no projection image to export") : exporter.errorString());
+        return;
+    }
+
+    QString filtertiffdeflate = tr("GeoTIFF deflate (*.tif)");
+    QString filtertiff = tr("GeoTIFF (*.tif)");
+    QString filterraw = tr("Raw with ENVI header (*.raw)");
+    QString selectedfilter;
+
+    QString fileName = QFileDialog::getSaveFileName(this,
+            tr("Export projection"), "./" + formtoolbox->returnFilenamestring(),
+            filtertiffdeflate + ";;" + filtertiff + ";;" + filterraw, &selectedfilter);
+    if (fileName.isEmpty())
+        return;
+
+    bool raw = (selectedfilter == filterraw);
+    QString suffix = raw ? ".raw" : ".tif";
+    if (!fileName.endsWith(suffix, Qt::CaseInsensitive))
+        fileName.append(suffix);
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool ok = raw ? exporter.writeRaw(fileName) : exporter.writeGeoTiff(fileName, selectedfilter == filtertiffdeflate);
+    QApplication::restoreOverrideCursor();
+
+    if (!ok)
+        QMessageBox::warning(this, tr("Error"), exporter.errorString());
+}
+
+void MainWindow::on_actionExtractPoi_triggered()
+{
+    PoiExtractor extractor(seglist);
+    extractor.setPointsFromPoi(poi);
+    if (extractor.pointCount() == 0)
+    {
+        QMessageBox::information(this, tr("Extract points of interest"), tr("There are no points of interest in the projection presets."));
+        return;
+    }
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Extract points of interest"));
+    QDateTimeEdit *fromedit = new QDateTimeEdit(QDateTime::currentDateTimeUtc().addDays(-1), &dialog);
+    QDateTimeEdit *toedit = new QDateTimeEdit(QDateTime::currentDateTimeUtc(), &dialog);
+    fromedit->setDisplayFormat("yyyy-MM-dd hh:mm");
+    toedit->setDisplayFormat("yyyy-MM-dd hh:mm");
+    fromedit->setTimeSpec(Qt::UTC);
+    toedit->setTimeSpec(Qt::UTC);
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, SIGNAL(accepted()), &dialog, SLOT(accept()));
+    connect(buttons, SIGNAL(rejected()), &dialog, SLOT(reject()));
+    QFormLayout *layout = new QFormLayout(&dialog);
+    layout->addRow(tr("From (UTC)"), fromedit);
+    layout->addRow(tr("To (UTC)"), toedit);
+    QLabel *coverage = new QLabel(tr("Searched are the AVHRR segments and the MSG cycles of MET-10, MET-9 and MET-8.\n"
+                                     "GOES, MET-7, FY2, Himawari and VIIRS are not included."), &dialog);
+    layout->addRow(coverage);
+    layout->addRow(buttons);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    QString fileName = QFileDialog::getSaveFileName(this,
+            tr("Extract points of interest"), "./poi_" + fromedit->dateTime().toString("yyyyMMddhhmm") + ".csv",
+            tr("CSV (*.csv)"));
+    if (fileName.isEmpty())
+        return;
+    if (!fileName.endsWith(".csv", Qt::CaseInsensitive))
+        fileName.append(".csv");
+
+    extractor.setTimeRange(fromedit->dateTime(), toedit->dateTime());
+    if (!extractor.prepare())
+    {
+        QMessageBox::warning(this, tr("Error"), extractor.errorString());
+        return;
+    }
+
+    // the segments are decoded in the thread pool, the dialog closes when they are done or canceled
+    QProgressDialog progress(tr("Extracting the points of interest ..."), tr("Cancel"), 0, 0, this);
+    progress.setWindowModality(Qt::WindowModal);
+    QFutureWatcher<void> watcher;
+    connect(&watcher, SIGNAL(progressRangeChanged(int,int)), &progress, SLOT(setRange(int,int)));
+    connect(&watcher, SIGNAL(progressValueChanged(int)), &progress, SLOT(setValue(int)));
+    connect(&watcher, SIGNAL(finished()), &progress, SLOT(reset()));
+    connect(&progress, SIGNAL(canceled()), &watcher, SLOT(cancel()));
+    watcher.setFuture(extractor.start());
+    progress.exec();
+    watcher.waitForFinished();
+    extractor.finish();
+
+    if (watcher.isCanceled())
+        updateStatusBarIndicator(QString("Extraction of the points of interest canceled"));
+    else if (!extractor.writeCsv(fileName))
+        QMessageBox::warning(this, tr("Error"), extractor.errorString());
+    else
+        updateStatusBarIndicator(QString("%1 values written to %2").arg(extractor.result().count()).arg(fileName));
+}
+
+void MainWindow::on_actionGeoMosaic_triggered()
+{
+    GeoMosaic mosaic(seglist);
+    QStringList dates = mosaic.nominalTimes();
+    if (dates.isEmpty())
+    {
+        QMessageBox::information(this, tr("Geostationary mosaic"), tr("There are no geostationary images in the segment directories."));
+        return;
+    }
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Geostationary mosaic"));
+    QFormLayout *layout = new QFormLayout(&dialog);
+    QComboBox *datecombo = new QComboBox(&dialog);
+    for (int i = 0; i < dates.count(); i++)
+        datecombo->addItem(QDateTime::fromString(dates.at(i), "yyyyMMddhhmm").toString("yyyy-MM-dd hh:mm"), dates.at(i));
+    layout->addRow(tr("Nominal time (UTC)"), datecombo);
+
+    QStringList names = mosaic.satelliteNames();
+    QList<QCheckBox *> checkboxes;
+    for (int i = 0; i < names.count(); i++)
+    {
+        QCheckBox *check = new QCheckBox(names.at(i), &dialog);
+        check->setChecked(true);
+        checkboxes.append(check);
+        layout->addRow(check);
+    }
+    QCheckBox *inversecheck = new QCheckBox(tr("Inverse"), &dialog);
+    inversecheck->setChecked(true);
+    layout->addRow(inversecheck);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, SIGNAL(accepted()), &dialog, SLOT(accept()));
+    connect(buttons, SIGNAL(rejected()), &dialog, SLOT(reject()));
+    layout->addRow(buttons);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+
+    QStringList selected;
+    for (int i = 0; i < checkboxes.count(); i++)
+    {
+        if (checkboxes.at(i)->isChecked())
+            selected << names.at(i);
+    }
+
+    if (!mosaic.prepare(datecombo->currentData().toString(), selected, inversecheck->isChecked()))
+    {
+        QMessageBox::warning(this, tr("Error"), mosaic.errorString());
+        return;
+    }
+
+    QProgressDialog progress(tr("Composing the geostationary mosaic ..."), tr("Cancel"), 0, 0, this);
+    progress.setWindowModality(Qt::WindowModal);
+    QFutureWatcher<bool> watcher;
+    connect(&watcher, SIGNAL(finished()), &progress, SLOT(reset()));
+    watcher.setFuture(QtConcurrent::run(&mosaic, &GeoMosaic::compose));
+    progress.exec();
+    if (progress.wasCanceled())
+        mosaic.cancel();
+    watcher.waitForFinished();
+
+    if (mosaic.isCanceled())
+    {
+        updateStatusBarIndicator(QString("Geostationary mosaic canceled"));
+        return;
+    }
+
+    if (!watcher.result())
+    {
+        QMessageBox::warning(this, tr("Error"), mosaic.errorString());
+        return;
+    }
+
+    ui->stackedWidget->setCurrentIndex(3);
+    formimage->displayImage(IMAGE_EQUIRECTANGLE);
+    formimage->adjustPicSize(false);
+}
+
+void MainWindow::on_actionAnimation_triggered()
+{
+    if (animationplayer == NULL)
+        animationplayer = new AnimationPlayer(seglist, this);
+    else
+        animationplayer->refresh();
+
+    animationplayer->show();
+    animationplayer->raise();
+    animationplayer->activateWindow();
+}
+
 void MainWindow::moveImage(QPoint d, QPoint e)
 {
     int width = imagescrollarea->width();
@@ -22,9 +22,11 @@
 #include "imagescrollarea.h"
 #include "segmentimage.h"
 #include "segmentlistgeostationary.h"
+#include "segmentdirectorywatcher.h"
 
 #include "options.h"
 #include "poi.h"
+#include "animationplayer.h"
 
 namespace Ui {
 class MainWindow;
@@ -64,6 +66,8 @@ private:
     Globe *globe;
 
     FormInfraScales *forminfrascales;
+    AnimationPlayer *animationplayer;
+    SegmentDirectoryWatcher *segmentdirectorywatcher;
 
     QTimer *timer;
     QLabel *timeLabel;
@@ -88,6 +92,10 @@ private slots:
     void on_actionShowToolbox_triggered();
 
     void on_actionCreatePNG_triggered();
+    void on_actionExportProjection_triggered();
+    void on_actionExtractPoi_triggered();
+    void on_actionGeoMosaic_triggered();
+    void on_actionAnimation_triggered();
 
     void on_actionMeteosat_triggered();
     void on_actionNormalSize_triggered();
@@ -39,6 +39,16 @@ MapFieldCyl::MapFieldCyl( QWidget *parent, CylEquiDist *meqdis, SatelliteList *s
   down = false;
 
   gridset = true;
+  segmentsdirty = true;
+
+  TwilightLine twilight;
+  twilight.sun_lon = 0;
+  twilight.sun_lat = 0;
+  twilight.width = 0;
+  twilight.height = 0;
+  twilightnow = twilight;
+  twilightfirst = twilight;
+  twilightlast = twilight;
 
   this->startTimer(1000);
 
@@ -84,107 +94,90 @@ void MapFieldCyl::paintEvent( QPaintEvent * )
 
     //qDebug() << QString("in paintevent MapFieldCyl nbr seglist %1 selected %2").arg(segs->segmentlistmetop->NbrOfSegments()).arg(segs->segmentlistmetop->NbrOfSegmentsSelected());
 
-    double first_julian, last_julian;
-
-
-    if (opts.buttonMetop && segs->seglmetop->NbrOfSegments() > 0)
+    QVector<double> key = segmentLayerKey();
+    if(segmentsdirty || key != segmentlayerkey || pmSegments.size() != pmScaled_res.size())
     {
-        if(segs->getShowAllSegments())
-        {
-            segs->seglmetop->RenderSegments( &painter, QColor(Qt::magenta), true );
-        }
-        else
-        {
-            segs->seglmetop->GetFirstLastVisible(&first_julian, &last_julian);
-            showSunPosition(&painter, first_julian, last_julian);
-            segs->seglmetop->RenderSegments( &painter, QColor(Qt::magenta), false );
-        }
+        renderSegmentLayer();
+        segmentlayerkey = key;
+        segmentsdirty = false;
     }
+    painter.drawPixmap(0, 0, pmSegments);
 
-    if (opts.buttonNoaa && segs->seglnoaa->NbrOfSegments() > 0)
-    {
-        if(segs->getShowAllSegments())
-        {
-            segs->seglnoaa->RenderSegments( &painter, QColor(Qt::green), true );
-        }
-        else
-        {
-            segs->seglnoaa->GetFirstLastVisible( &first_julian, &last_julian );
-            showSunPosition(&painter, first_julian, last_julian);
-            segs->seglnoaa->RenderSegments( &painter, QColor(Qt::green), false );
-        }
-    }
+    if (opts.buttonMetop == false && opts.buttonNoaa == false && opts.buttonGAC == false &&
+            opts.buttonHRP == false && opts.buttonVIIRSM == false && opts.buttonVIIRSDNB == false )
+        showSunPosition(&painter);
 
-    if (opts.buttonGAC && segs->seglgac->NbrOfSegments() > 0)
+    if (down)
     {
-        if(segs->getShowAllSegments())
-        {
-            segs->seglgac->RenderSegments( &painter, QColor(Qt::darkYellow), true );
-        }
-        else
-        {
-            segs->seglgac->GetFirstLastVisible( &first_julian, &last_julian );
-            showSunPosition(&painter, first_julian, last_julian);
-            segs->seglgac->RenderSegments( &painter, QColor(Qt::darkYellow), false );
-        }
+        //showSunPosition(&painter);
+        //qDebug() << QString("first_utc = %1, last_utc = %2").arg(first_utc).arg(last_utc);
     }
 
-    if (opts.buttonHRP && segs->seglhrp->NbrOfSegments() > 0)
-    {
-        if(segs->getShowAllSegments())
-        {
-            segs->seglhrp->RenderSegments( &painter, QColor(Qt::darkRed), true );
-        }
-        else
-        {
-            segs->seglhrp->GetFirstLastVisible( &first_julian, &last_julian );
-            showSunPosition(&painter, first_julian, last_julian);
-            segs->seglhrp->RenderSegments( &painter, QColor(Qt::darkRed), false );
-        }
-    }
+    QPainter paint(this);
+    paint.drawPixmap( 0, 0, pmScaled_res );
 
-    if (opts.buttonVIIRSM && segs->seglviirsm->NbrOfSegments() > 0)
-    {
-        if(segs->getShowAllSegments())
-        {
-            segs->seglviirsm->RenderSegments( &painter, QColor(Qt::cyan), true );
-        }
-        else
-        {
-            segs->seglviirsm->GetFirstLastVisible( &first_julian, &last_julian );
-            showSunPosition(&painter, first_julian, last_julian);
-            segs->seglviirsm->RenderSegments( &painter, QColor(Qt::cyan), false );
-        }
-    }
+}
 
-    if (opts.buttonVIIRSDNB && segs->seglviirsdnb->NbrOfSegments() > 0)
+// Everything that only changes with the segment lists : the tracks of the segments and
+// the sun positions and terminators at the first and last visible segment.
+QVector<double> MapFieldCyl::segmentLayerKey()
+{
+    QVector<double> key;
+    SegmentList *lists[6] = { segs->seglmetop, segs->seglnoaa, segs->seglgac, segs->seglhrp, segs->seglviirsm, segs->seglviirsdnb };
+    bool buttons[6] = { opts.buttonMetop, opts.buttonNoaa, opts.buttonGAC, opts.buttonHRP, opts.buttonVIIRSM, opts.buttonVIIRSDNB };
+    double first_julian, last_julian;
+
+    key << segs->getShowAllSegments();
+    for(int i = 0; i < 6; i++)
     {
-        if(segs->getShowAllSegments())
-        {
-            segs->seglviirsdnb->RenderSegments( &painter, QColor(Qt::cyan), true );
-        }
-        else
+        key << buttons[i];
+        if(buttons[i])
         {
-            segs->seglviirsdnb->GetFirstLastVisible( &first_julian, &last_julian );
-            showSunPosition(&painter, first_julian, last_julian);
-            segs->seglviirsdnb->RenderSegments( &painter, QColor(Qt::cyan), false );
+            lists[i]->GetFirstLastVisible(&first_julian, &last_julian);
+            key << lists[i]->NbrOfSegments() << lists[i]->NbrOfSegmentsSelected() << first_julian << last_julian;
         }
     }
+    return key;
+}
 
+void MapFieldCyl::renderSegmentLayer()
+{
+    pmSegments = QPixmap(pmScaled_res.size());
+    pmSegments.fill(Qt::transparent);
+
+    QPainter painter(&pmSegments);
+
+    if (opts.buttonMetop)
+        renderSegmentList(&painter, segs->seglmetop, QColor(Qt::magenta));
+    if (opts.buttonNoaa)
+        renderSegmentList(&painter, segs->seglnoaa, QColor(Qt::green));
+    if (opts.buttonGAC)
+        renderSegmentList(&painter, segs->seglgac, QColor(Qt::darkYellow));
+    if (opts.buttonHRP)
+        renderSegmentList(&painter, segs->seglhrp, QColor(Qt::darkRed));
+    if (opts.buttonVIIRSM)
+        renderSegmentList(&painter, segs->seglviirsm, QColor(Qt::cyan));
+    if (opts.buttonVIIRSDNB)
+        renderSegmentList(&painter, segs->seglviirsdnb, QColor(Qt::cyan));
+}
 
-    if (opts.buttonMetop == false && opts.buttonNoaa == false && opts.buttonGAC == false &&
-            opts.buttonHRP == false && opts.buttonVIIRSM == false && opts.buttonVIIRSDNB == false )
-        showSunPosition(&painter);
+void MapFieldCyl::renderSegmentList(QPainter *painter, SegmentList *sl, QColor col)
+{
+    double first_julian, last_julian;
 
-    if (down)
+    if(sl->NbrOfSegments() == 0)
+        return;
+
+    if(segs->getShowAllSegments())
     {
-        //showSunPosition(&painter);
-        //qDebug() << QString("first_utc = %1, last_utc = %2").arg(first_utc).arg(last_utc);
+        sl->RenderSegments( painter, col, true );
+    }
+    else
+    {
+        sl->GetFirstLastVisible(&first_julian, &last_julian);
+        showSunPosition(painter, first_julian, last_julian);
+        sl->RenderSegments( painter, col, false );
     }
-
-    QPainter paint(this);
-    paint.drawPixmap( 0, 0, pmScaled_res );
-
 }
 
 void MapFieldCyl::resizeEvent( QResizeEvent * )
@@ -226,7 +219,10 @@ void MapFieldCyl::mousePressEvent( QMouseEvent *e )
         isselected = segs->seglviirsdnb->TestForSegment( &lon, &lat, true, segs->getShowAllSegments() );
 
     if(isselected)
+    {
+        segmentsdirty = true;
         emit mapClicked();  // show selected segmentlist in FormEphem
+    }
      else
         sats->TestForSat(e->x(), e->y());
 
@@ -292,7 +288,7 @@ void MapFieldCyl::showSunPosition(QPainter *painter)
   painter->setBrush( Qt::yellow );
   painter->drawEllipse( posx -  4 , posy - 4, 8, 8 );
   painter->setPen( Qt::green );
-  showTwilight(sun_geodetic.lon, sun_geodetic.lat, painter);
+  showTwilight(sun_geodetic.lon, sun_geodetic.lat, painter, twilightnow);
 
 }
 
@@ -320,7 +316,7 @@ void MapFieldCyl::showSunPosition(QPainter *painter, double first_julian, double
   painter->drawEllipse( posx -  4 , posy - 4, 8, 8 );
 
   painter->setPen( Qt::green );
-  showTwilight(sun_geodetic.lon, sun_geodetic.lat, painter);
+  showTwilight(sun_geodetic.lon, sun_geodetic.lat, painter, twilightfirst);
 
   //jul_utc = Julian_Date_of_Year(last_year) + last_utc;
   Calculate_Solar_Position(last_julian, &solar_vector);
@@ -335,16 +331,23 @@ void MapFieldCyl::showSunPosition(QPainter *painter, double first_julian, double
   painter->drawEllipse( posx -  4 , posy - 4, 8, 8 );
 
   painter->setPen( Qt::darkGreen );
-  showTwilight(sun_geodetic.lon, sun_geodetic.lat, painter);
+  showTwilight(sun_geodetic.lon, sun_geodetic.lat, painter, twilightlast);
 
 }
 
-void MapFieldCyl::showTwilight(double sun_lon, double sun_lat, QPainter *painter)
+void MapFieldCyl::showTwilight(double sun_lon, double sun_lat, QPainter *painter, TwilightLine &twilight)
 {
+  // the sun moves 0.1° in 24 seconds
+  if (twilight.width == pmScaled_res.width() && twilight.height == pmScaled_res.height() &&
+      fabs(twilight.sun_lon - sun_lon) < deg2rad(0.1) && fabs(twilight.sun_lat - sun_lat) < deg2rad(0.1))
+  {
+    painter->drawPolyline(twilight.polyline);
+    return;
+  }
+
   double sunhor;
   double Xlon;
   int posx, posy;
-  int posx1,posy1;
 
   Xlon=PI;
 
@@ -362,8 +365,8 @@ void MapFieldCyl::showTwilight(double sun_lon, double sun_lat, QPainter *painter
   else
     posy = (int)( pmScaled_res.height() * ( sunhor - (PI/2) ) / PI);
 
-  posx1 = posx;
-  posy1 = posy;
+  twilight.polyline.clear();
+  twilight.polyline << QPoint(posx, posy);
 
   for (Xlon=PI; Xlon < TWOPI; Xlon += (PI/2)/20)
   {
@@ -381,9 +384,7 @@ void MapFieldCyl::showTwilight(double sun_lon, double sun_lat, QPainter *painter
     else
       posy = (int)( pmScaled_res.height() * ( sunhor -(PI/2)) / PI);
 
-    painter->drawLine( posx1, posy1, posx, posy );
-    posx1 = posx;
-    posy1 = posy;
+    twilight.polyline << QPoint(posx, posy);
 
   }
 
@@ -403,11 +404,16 @@ void MapFieldCyl::showTwilight(double sun_lon, double sun_lat, QPainter *painter
     else
       posy = (int)( pmScaled_res.height() * ( sunhor-(PI/2)) / PI);
 
-    painter->drawLine( posx1, posy1, posx, posy );
-    posx1 = posx;
-    posy1 = posy;
+    twilight.polyline << QPoint(posx, posy);
   }
 
+  twilight.sun_lon = sun_lon;
+  twilight.sun_lat = sun_lat;
+  twilight.width = pmScaled_res.width();
+  twilight.height = pmScaled_res.height();
+
+  painter->drawPolyline(twilight.polyline);
+
 }
 
 void MapFieldCyl::setGrid(bool grid)
@@ -418,25 +424,30 @@ void MapFieldCyl::setGrid(bool grid)
 void MapFieldCyl::showMetopSegments()
 {
     qDebug() << QString("in showmetopsegments");
+    segmentsdirty = true;
     update();
 }
 
 void MapFieldCyl::showNoaaSegments()
 {
+    segmentsdirty = true;
     update();
 }
 
 void MapFieldCyl::showGACSegments()
 {
+    segmentsdirty = true;
     update();
 }
 
 void MapFieldCyl::showHRPSegments()
 {
+    segmentsdirty = true;
     update();
 }
 
 void MapFieldCyl::showVIIRSSegments()
 {
+    segmentsdirty = true;
     update();
 }
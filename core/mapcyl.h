@@ -6,6 +6,15 @@
 #include "satellite.h"
 #include "avhrrsatellite.h"
 
+// Terminator polyline, only recomputed when the sun moved or the map was resized
+struct TwilightLine {
+  double sun_lon;
+  double sun_lat;
+  int width;
+  int height;
+  QPolygon polyline;
+};
+
 class MapFieldCyl : public QWidget
 {
   Q_OBJECT
@@ -29,9 +38,12 @@ protected:
   
 private:
   void scale();
-  void showTwilight(double sun_lon, double sun_lat, QPainter *paint);
+  void showTwilight(double sun_lon, double sun_lat, QPainter *paint, TwilightLine &twilight);
   void showSunPosition(QPainter *paint);
   void showSunPosition(QPainter *paint, double , double );
+  void renderSegmentLayer();
+  QVector<double> segmentLayerKey();
+  void renderSegmentList(QPainter *painter, SegmentList *sl, QColor col);
 
   int conversion_flags;
   const char* filename;
@@ -40,6 +52,13 @@ private:
   //QPixmap pmScaled_n;      // the scaled pixmap at night
   QPixmap pmScaled_res;  //  the end result
   //QPixmap pmBackground;
+  QPixmap pmSegments;    // transparent layer with the segment outlines and their sun positions
+
+  QVector<double> segmentlayerkey;  // state of the segment lists pmSegments was drawn for
+  bool segmentsdirty;
+  TwilightLine twilightnow;
+  TwilightLine twilightfirst;
+  TwilightLine twilightlast;
 
   bool gridset;
   double geo_alt;
@@ -0,0 +1,77 @@
+#include "memorybudget.h"
+#include "options.h"
+
+#include <QDebug>
+
+extern Options opts;
+
+MemoryBudget::MemoryBudget()
+{
+    limit = 0;
+    setup();
+}
+
+MemoryBudget *MemoryBudget::instance()
+{
+    static MemoryBudget memorybudget;
+    return &memorybudget;
+}
+
+// Takes over opts.memorybudget, a lower limit releases buffers right away
+void MemoryBudget::setup()
+{
+    QMutexLocker locker(&mutex);
+    limit = (qint64)qMax(0, opts.memorybudget) * 1024 * 1024;
+    qDebug() << QString("MemoryBudget::setup limit = %1 MB").arg(limit / (1024 * 1024));
+    evict();
+}
+
+void MemoryBudget::update(MemoryOwner *owner)
+{
+    QMutexLocker locker(&mutex);
+    owners.removeAll(owner);
+    owners.append(owner);
+    evict();
+}
+
+void MemoryBudget::remove(MemoryOwner *owner)
+{
+    QMutexLocker locker(&mutex);
+    owners.removeAll(owner);
+}
+
+qint64 MemoryBudget::memoryInUse()
+{
+    QMutexLocker locker(&mutex);
+    qint64 total = 0;
+    for(int i = 0; i < owners.count(); i++)
+        total += owners.at(i)->memoryInUse();
+    return total;
+}
+
+// call with the mutex locked
+void MemoryBudget::evict()
+{
+    if(limit <= 0 || owners.isEmpty())
+        return;
+
+    qint64 total = 0;
+    for(int i = 0; i < owners.count(); i++)
+        total += owners.at(i)->memoryInUse();
+
+    for(int i = 0; i < owners.count() - 1 && total > limit; i++)
+    {
+        MemoryOwner *owner = owners.at(i);
+        qint64 inuse = owner->memoryInUse();
+        if(inuse == 0)
+            continue;
+        if(owner->releaseMemory())
+        {
+            total -= inuse;
+            qDebug() << QString("MemoryBudget::evict released %1 MB of %2").arg(inuse / (1024 * 1024)).arg(owner->memoryOwnerName());
+        }
+    }
+
+    if(total > limit)
+        qDebug() << QString("MemoryBudget::evict %1 MB in use, limit = %2 MB").arg(total / (1024 * 1024)).arg(limit / (1024 * 1024));
+}
@@ -0,0 +1,44 @@
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+// Holder of decoded segment buffers that can give them back and read them again when needed
+class MemoryOwner
+{
+public:
+    virtual ~MemoryOwner() {}
+    virtual qint64 memoryInUse() = 0;
+    virtual bool releaseMemory() = 0;   // false when the buffers are in use and stay
+    virtual QString memoryOwnerName() = 0;
+};
+
+// Upper limit on the decoded segments, opts.memorybudget in MB (0 = no limit). The owners are the polar
+// segment lists with their swath buffers and the active geostationary list with the channel buffers in
+// SegmentImage. The images in SegmentImage (composed, projection, VIIRS) are not counted, they are
+// on screen or made from the buffers : the memory of the process is not bounded by the limit.
+// The owners are kept in order of use. When an owner has composed an image and the total is above
+// the limit, the least recently used owners release their buffers until the total fits.
+// The last owner is never released, it holds the image on screen.
+class MemoryBudget
+{
+public:
+    static MemoryBudget *instance();
+    void setup();
+
+    void update(MemoryOwner *owner);
+    void remove(MemoryOwner *owner);
+    qint64 memoryInUse();
+
+private:
+    MemoryBudget();
+    void evict();
+
+    QMutex mutex;
+    QList<MemoryOwner *> owners;    // least recently used first
+    qint64 limit;                   // bytes, 0 = no limit
+};
+
+#endif // MEMORYBUDGET_H
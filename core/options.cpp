@@ -138,6 +138,7 @@ void Options::Initialize()
     localdirremote = settings.value("/window/localdirremote", "").value<QString>();
     dirremote = settings.value("/window/dirremote", "").value<QString>();
     udpmessages = settings.value("/window/udpmessages", false).toBool();
+    directorywatcher = settings.value("/window/directorywatcher", false).toBool();
 
     gshhsglobe1On = settings.value("/window/gshhsglobe1on", true ).toBool();
     gshhsglobe2On = settings.value("/window/gshhsglobe2on", true ).toBool();
@@ -198,6 +199,13 @@ void Options::Initialize()
     yawcorrection = settings.value("/parameters/yawcorrection", 0.0).toDouble();
 
     clahecliplimit = settings.value("/parameters/clahecliplimit", 1.0).toFloat();
+    regionofinterest = settings.value("/parameters/regionofinterest", false).toBool();
+    decodethreads = settings.value("/parameters/decodethreads", 0).toInt();
+    decodebuffers = settings.value("/parameters/decodebuffers", 0).toInt();
+    memorybudget = settings.value("/parameters/memorybudget", 0).toInt();
+    animationcache = settings.value("/parameters/animationcache", 256).toInt();
+    tracing = settings.value("/parameters/tracing", false).toBool();
+    tracefile = settings.value("/parameters/tracefile", "trace.json").toString();
 
     lastinputprojection = settings.value("/window/lastinputprojection", 0 ).toInt();
     lastVIIRSband = settings.value("/window/viirsband", 0 ).toInt();
@@ -427,6 +435,7 @@ void Options::Save()
     settings.setValue("/window/localdirremote", localdirremote );
     settings.setValue("/window/dirremote", dirremote );
     settings.setValue("/window/udpmessages", udpmessages );
+    settings.setValue("/window/directorywatcher", directorywatcher );
 
 
     settings.setValue("/ephemwindow/splitterSizes", ephemsplittersizes );
@@ -484,6 +493,13 @@ void Options::Save()
 
     settings.setValue("/parameters/yawcorrection", yawcorrection);
     settings.setValue("/parameters/clahecliplimit", clahecliplimit);
+    settings.setValue("/parameters/regionofinterest", regionofinterest);
+    settings.setValue("/parameters/decodethreads", decodethreads);
+    settings.setValue("/parameters/decodebuffers", decodebuffers);
+    settings.setValue("/parameters/memorybudget", memorybudget);
+    settings.setValue("/parameters/animationcache", animationcache);
+    settings.setValue("/parameters/tracing", tracing);
+    settings.setValue("/parameters/tracefile", tracefile);
 
     settings.setValue( "/satellite/geostationarylistlon", geostationarylistlon );
     settings.setValue( "/satellite/geostationarylistname", geostationarylistname );
@@ -110,6 +110,7 @@ public:
     bool imageontextureOnVIIRS;
     bool windowvectors;
     bool udpmessages;
+    bool directorywatcher;
     bool gshhsglobe1On;
     bool gshhsglobe2On;
     bool gshhsglobe3On;
@@ -146,6 +147,13 @@ public:
     int smoothprojectiontype;
     bool gridonprojection;
     float clahecliplimit;
+    bool regionofinterest;  // read only the part of FY2, VIIRS and HRIT files that reaches the projection
+    int decodethreads;      // workers of the segment decode pool, 0 = one per core
+    int decodebuffers;      // segments decoded at the same time, 0 = one per worker
+    int memorybudget;       // MB for the polar swath buffers and the geostationary channel buffers, 0 = no limit
+    int animationcache;     // MB for the frames of the geostationary animation
+    bool tracing;           // spans of the decode and projection stages, see Tracer
+    QString tracefile;
 
     int dnbsblowerlimit;
     int dnbsbupperlimit;
@@ -0,0 +1,487 @@
+#include "poiextractor.h"
+#include "poi.h"
+#include "pixgeoconversion.h"
+#include "calibrationengine.h"
+#include "msgfileaccess.h"
+#include "msgdataaccess.h"
+#include "MSG_HRIT.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <QMatrix4x4>
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <math.h>
+
+// MSG full disc in VIS_IR, 8 segment files of 464 lines
+#define POI_MSG_COLUMNS 3712
+#define POI_MSG_LINES 464
+#define POI_MSG_SEGMENTS 8
+
+// Distance in km of the point from the scan plane at minutes after the state vector and the scan angle of the point,
+// the scan direction with the steering of CalculateCornerPoints
+static double scanPlaneDistance(Segment *segm, const QGeodetic &geo, double minutes, double *angle, bool *visible)
+{
+    QEci qeci;
+    segm->qsgp4->getPosition(minutes, qeci);
+
+    QVector3D d3pos = qeci.GetPos_f();
+    QVector3D d3vel = qeci.GetVel_f();
+    QVector3D d3scan;
+
+    if (segm->segment_type == "HRP" || segm->segment_type == "Metop")
+    {
+        double e = segm->qtle->Eccenticity();
+        double epow2 = e * e;
+        double epow3 = e * e * e;
+
+        double span = qeci.GetDate().spanSec(segm->qtle->Epoch());
+        double M = fmod(segm->qtle->MeanAnomaly() + (TWOPI * (span/segm->qtle->Period())), TWOPI);
+        double C = (2*e - epow3/4)*sin(M) + (5*epow2/4)*sin(2*M) + (13*epow3/12)*sin(3*M);
+        double PSO = fmod(segm->qtle->ArgumentPerigee() + M + C, TWOPI);
+
+        double pitch_steering_angle = - 0.002899 * sin( 2 * PSO);
+        double roll_steering_angle = 0.00089 * sin(PSO);
+        double yaw_factor = 0.068766 * cos(PSO);
+        double yaw_steering_angle = 0.068766 * cos(PSO) * (1 - yaw_factor * yaw_factor/3);
+
+        QMatrix4x4 mat;
+        mat.rotate(yaw_steering_angle * 180/PI, d3pos);
+        mat.rotate(roll_steering_angle * 180/PI, d3vel);
+        mat.rotate(pitch_steering_angle * 180/PI, QVector3D::crossProduct(d3pos,d3vel));
+        d3scan = mat * QVector3D::crossProduct(d3pos,d3vel);
+    }
+    else
+        d3scan = QVector3D::crossProduct(d3pos,d3vel);
+
+    QVector3D d3posnorm = d3pos.normalized();
+    QVector3D d3scannorm = d3scan.normalized();
+    QVector3D d3alongnorm = QVector3D::crossProduct(d3scannorm, d3posnorm).normalized();
+
+    QEci qecipoint(geo, qeci.GetDate());
+    QVector3D d3d = qecipoint.GetPos_f() - d3pos;
+
+    *angle = atan2(QVector3D::dotProduct(d3d, d3scannorm), -QVector3D::dotProduct(d3d, d3posnorm));
+    *visible = QVector3D::dotProduct(qecipoint.GetPos_f(), d3d) < 0.0;
+    return QVector3D::dotProduct(d3d, d3alongnorm);
+}
+
+// The time of the line is found by bisection on the distance to the scan plane, the column from the scan angle
+bool PoiExtractor::locateInSegment(Segment *segm, const PoiPoint &point, PoiHit &hit)
+{
+    if(segm->qsgp4.isNull() || segm->qtle.isNull() || segm->minutes_sensing <= 0.0)
+        return false;
+
+    QGeodetic geo(point.lat * PI / 180.0, point.lon * PI / 180.0, 0.0);
+    double angle;
+    bool visible;
+
+    double t0 = segm->minutes_since_state_vector;
+    double t1 = t0 + segm->minutes_sensing;
+    double d0 = scanPlaneDistance(segm, geo, t0, &angle, &visible);
+    double d1 = scanPlaneDistance(segm, geo, t1, &angle, &visible);
+    if((d0 < 0.0) == (d1 < 0.0))
+        return false;
+
+    // 20 steps leave less than a tenth of a line
+    for(int i = 0; i < 20; i++)
+    {
+        double tm = (t0 + t1) / 2.0;
+        double dm = scanPlaneDistance(segm, geo, tm, &angle, &visible);
+        if((dm < 0.0) == (d0 < 0.0))
+        {
+            t0 = tm;
+            d0 = dm;
+        }
+        else
+            t1 = tm;
+    }
+
+    double tm = (t0 + t1) / 2.0;
+    scanPlaneDistance(segm, geo, tm, &angle, &visible);
+
+    double delta = 0.0009439882 * 1023.5;
+    if(!visible || fabs(angle) > delta)
+        return false;
+
+    int ev = segm->earth_views_per_scanline;
+    hit.line = (tm - segm->minutes_since_state_vector) / segm->minutes_sensing;
+    hit.column = qBound(0, (int)floor((angle + delta) / (2.0 * delta) * (ev - 1) + 0.5), ev - 1);
+    return true;
+}
+
+// Only a segment with a point in it is decoded, a segment that was already in memory keeps its buffers
+static void doExtractSegment(PoiSegmentJob &job)
+{
+    Segment *segm = job.segment;
+
+    QList<PoiHit> hits;
+    for(int i = 0; i < job.points->count(); i++)
+    {
+        PoiHit hit;
+        hit.point = i;
+        if(PoiExtractor::locateInSegment(segm, job.points->at(i), hit))
+            hits.append(hit);
+    }
+    if(hits.isEmpty())
+        return;
+
+    bool inmemory = !segm->ptrbaChannel[0].isNull();
+    if(!inmemory)
+        segm->ReadSegmentInMemory();
+
+    int ev = segm->earth_views_per_scanline;
+    int lines = segm->NbrOfLines;
+
+    for(int h = 0; h < hits.count(); h++)
+    {
+        const PoiHit &hit = hits.at(h);
+        int line = qBound(0, (int)(hit.line * lines), lines - 1);
+
+        for(int k = 0; k < 5; k++)
+        {
+            if(segm->ptrbaChannel[k].isNull())
+                continue;
+
+            PoiSample sample;
+            sample.point = hit.point;
+            sample.time = segm->qdatetime_start.addMSecs((qint64)(hit.line * segm->minutes_sensing * 60000.0));
+            sample.satellite = segm->segment_type;
+            sample.channel = QString("ch%1").arg(k + 1);
+            sample.line = line;
+            sample.column = hit.column;
+            sample.count = segm->ptrbaChannel[k][line * ev + hit.column];
+            sample.bt = -1.0;
+            job.samples.append(sample);
+        }
+    }
+
+    if(!inmemory)
+        segm->resetMemory();
+
+    qDebug() << QString("doExtractSegment %1 points in %2").arg(hits.count()).arg(segm->fileInfo.fileName());
+}
+
+// The prologue of the cycle gives the calibration, every segment file with a point is decoded once
+static void doExtractCycle(PoiCycleJob &job)
+{
+    pixgeoConversion pixconv;
+
+    // segment number, line in the segment and sample in the line of every point that is on the disc
+    QVector<int> segnr(job.points->count(), -1);
+    QVector<int> segline(job.points->count());
+    QVector<int> segcolumn(job.points->count());
+    for(int i = 0; i < job.points->count(); i++)
+    {
+        int col, row;
+        if(pixconv.geocoord2pixcoord(job.sl->geosatlon, job.points->at(i).lat, job.points->at(i).lon,
+                                     COFF_NONHRV, LOFF_NONHRV, CFAC_NONHRV, LFAC_NONHRV, &col, &row) != 0)
+            continue;
+        if(col < 0 || col >= POI_MSG_COLUMNS || row < 0 || row >= POI_MSG_LINES * POI_MSG_SEGMENTS)
+            continue;
+
+        int k = POI_MSG_LINES * POI_MSG_SEGMENTS - 1 - row;
+        segnr[i] = k / POI_MSG_LINES + 1;
+        segline[i] = k % POI_MSG_LINES;
+        segcolumn[i] = POI_MSG_COLUMNS - 1 - col;
+    }
+
+    QDateTime time = QDateTime::fromString(job.date, "yyyyMMddhhmm");
+    time.setTimeSpec(Qt::UTC);
+
+    CalibrationEngine calibration;
+    bool calibrated = false;
+
+    QMap<QString, QMap<int, QFileInfo> >::const_iterator spectrum = job.files.constBegin();
+    while(spectrum != job.files.constEnd())
+    {
+        QMap<int, QFileInfo>::const_iterator seg = spectrum.value().constBegin();
+        while(seg != spectrum.value().constEnd())
+        {
+            if(!segnr.contains(seg.key()))
+            {
+                ++seg;
+                continue;
+            }
+
+            QString filepath = seg.value().absoluteFilePath();
+
+            if(!calibrated)
+            {
+                calibrated = true;
+                MsgFileAccess fa(filepath);
+                QString prologuefile = fa.prologueFile();
+                MsgDataAccess da;
+                MSG_header PRO_head;
+                MSG_data pro;
+                try
+                {
+                    da.read_file(fa.directory + "/" + prologuefile, PRO_head, pro);
+                    if(pro.prologue != 0)
+                        calibration.setup(pro.prologue->radiometric_proc, prologuefile);
+                }
+                catch( std::runtime_error &run )
+                {
+                    qDebug() << QString("Error : runtime error in reading prologue file : %1").arg(run.what());
+                }
+            }
+
+            QByteArray ba = filepath.toLatin1();
+            std::ifstream hrit(ba.data(), (std::ios::binary | std::ios::in) );
+            if (hrit.fail())
+            {
+                qDebug() << QString("doExtractCycle cannot open %1").arg(filepath);
+                ++seg;
+                continue;
+            }
+
+            MSG_header header;
+            MSG_data msgdat;
+            try
+            {
+                header.read_from(hrit);
+                msgdat.read_from(hrit, header);
+            }
+            catch( std::runtime_error &run )
+            {
+                qDebug() << QString("Error : runtime error in reading segment file %1 : %2").arg(filepath).arg(run.what());
+                ++seg;
+                continue;
+            }
+            hrit.close();
+
+            if (header.segment_id->data_field_format == MSG_NO_FORMAT ||
+                    header.image_structure->number_of_columns != POI_MSG_COLUMNS ||
+                    header.image_structure->number_of_lines != POI_MSG_LINES)
+            {
+                ++seg;
+                continue;
+            }
+
+            const float *bttable = calibration.table(spectrum.key());
+            for(int i = 0; i < segnr.count(); i++)
+            {
+                if(segnr.at(i) != seg.key())
+                    continue;
+
+                PoiSample sample;
+                sample.point = i;
+                sample.time = time;
+                sample.satellite = job.satellite;
+                sample.channel = spectrum.key();
+                sample.line = POI_MSG_LINES * POI_MSG_SEGMENTS - 1 - (seg.key() - 1) * POI_MSG_LINES - segline.at(i);
+                sample.column = POI_MSG_COLUMNS - 1 - segcolumn.at(i);
+                sample.count = msgdat.image->data[segline.at(i) * POI_MSG_COLUMNS + segcolumn.at(i)];
+                sample.bt = (bttable != NULL ? bttable[sample.count & (CALIBRATION_COUNTS - 1)] : -1.0);
+                job.samples.append(sample);
+            }
+
+            ++seg;
+        }
+        ++spectrum;
+    }
+}
+
+static void doExtractJob(PoiJob &job)
+{
+    if(job.segmentjob != NULL)
+        doExtractSegment(*job.segmentjob);
+    else
+        doExtractCycle(*job.cyclejob);
+}
+
+static bool sampleLessThan(const PoiSample &s1, const PoiSample &s2)
+{
+    if(s1.point != s2.point)
+        return s1.point < s2.point;
+    if(s1.time != s2.time)
+        return s1.time < s2.time;
+    if(s1.satellite != s2.satellite)
+        return s1.satellite < s2.satellite;
+    return s1.channel < s2.channel;
+}
+
+PoiExtractor::PoiExtractor(AVHRRSatellite *seglist)
+{
+    segs = seglist;
+}
+
+// The centres of the General Vertical Perspective and Stereographic presets
+void PoiExtractor::setPointsFromPoi(const Poi &poi)
+{
+    points.clear();
+
+    for(int i = 0; i < poi.strlGVPName.count() && i < poi.strlGVPLat.count() && i < poi.strlGVPLon.count(); i++)
+    {
+        PoiPoint point;
+        point.name = poi.strlGVPName.at(i);
+        point.lat = poi.strlGVPLat.at(i).toDouble();
+        point.lon = poi.strlGVPLon.at(i).toDouble();
+        points.append(point);
+    }
+
+    for(int i = 0; i < poi.strlSGName.count() && i < poi.strlSGLat.count() && i < poi.strlSGLon.count(); i++)
+    {
+        PoiPoint point;
+        point.name = poi.strlSGName.at(i);
+        point.lat = poi.strlSGLat.at(i).toDouble();
+        point.lon = poi.strlSGLon.at(i).toDouble();
+        points.append(point);
+    }
+}
+
+void PoiExtractor::setTimeRange(const QDateTime &from, const QDateTime &to)
+{
+    this->from = from.toUTC();
+    this->to = to.toUTC();
+}
+
+void PoiExtractor::addPolarJobs(QList<PoiSegmentJob> &jobs, QList<Segment *> *list)
+{
+    for(int i = 0; i < list->count(); i++)
+    {
+        Segment *segm = list->at(i);
+        QDateTime start = segm->qdatetime_start;
+        start.setTimeSpec(Qt::UTC);
+        if(!segm->segmentok || start < from || start > to)
+            continue;
+
+        PoiSegmentJob job;
+        job.segment = segm;
+        job.points = &points;
+        jobs.append(job);
+    }
+}
+
+void PoiExtractor::addCycleJobs(QList<PoiCycleJob> &jobs, SegmentListGeostationary *sl, const QString &satellite,
+                                QMap<QString, QMap<QString, QMap<int, QFileInfo> > > &segmentlistmap)
+{
+    QMap<QString, QMap<QString, QMap<int, QFileInfo> > >::const_iterator cycle = segmentlistmap.constBegin();
+    while(cycle != segmentlistmap.constEnd())
+    {
+        QDateTime time = QDateTime::fromString(cycle.key(), "yyyyMMddhhmm");
+        time.setTimeSpec(Qt::UTC);
+        if(time >= from && time <= to)
+        {
+            PoiCycleJob job;
+            job.sl = sl;
+            job.satellite = satellite;
+            job.date = cycle.key();
+            job.files = cycle.value();
+            job.files.remove("HRV___");
+            job.points = &points;
+            jobs.append(job);
+        }
+        ++cycle;
+    }
+}
+
+// Checks the points and the time range and makes a job of every segment and cycle in the range
+bool PoiExtractor::prepare()
+{
+    samples.clear();
+    error.clear();
+    segmentjobs.clear();
+    cyclejobs.clear();
+    jobs.clear();
+
+    if(points.isEmpty())
+    {
+        error = "There are no points of interest";
+        return false;
+    }
+    if(!from.isValid() || !to.isValid() || from > to)
+    {
+        error = "The time range is not valid";
+        return false;
+    }
+
+    addPolarJobs(segmentjobs, segs->seglmetop->GetSegmentlistptr());
+    addPolarJobs(segmentjobs, segs->seglnoaa->GetSegmentlistptr());
+    addPolarJobs(segmentjobs, segs->seglhrp->GetSegmentlistptr());
+    addPolarJobs(segmentjobs, segs->seglgac->GetSegmentlistptr());
+
+    addCycleJobs(cyclejobs, segs->seglmeteosat, "MET-10", segs->segmentlistmapmeteosat);
+    addCycleJobs(cyclejobs, segs->seglmeteosatrss, "MET-9", segs->segmentlistmapmeteosatrss);
+    addCycleJobs(cyclejobs, segs->seglmet8, "MET-8", segs->segmentlistmapmet8);
+
+    for(int i = 0; i < segmentjobs.count(); i++)
+    {
+        PoiJob job;
+        job.segmentjob = &segmentjobs[i];
+        job.cyclejob = NULL;
+        jobs.append(job);
+    }
+    for(int i = 0; i < cyclejobs.count(); i++)
+    {
+        PoiJob job;
+        job.segmentjob = NULL;
+        job.cyclejob = &cyclejobs[i];
+        jobs.append(job);
+    }
+
+    qDebug() << QString("PoiExtractor::prepare %1 points %2 segments %3 cycles").arg(points.count()).arg(segmentjobs.count()).arg(cyclejobs.count());
+    return true;
+}
+
+// The jobs run in the thread pool. Until finish() the memory budget must not release the buffers
+// of a segment that a job reads.
+QFuture<void> PoiExtractor::start()
+{
+    polarlists.clear();
+    polarlists << segs->seglmetop << segs->seglnoaa << segs->seglhrp << segs->seglgac;
+    for(int i = 0; i < polarlists.count(); i++)
+        polarlists.at(i)->memoryreaders.ref();
+
+    return QtConcurrent::map(jobs, doExtractJob);
+}
+
+// After the future of start() has finished or was canceled, with the values of the jobs that ran
+void PoiExtractor::finish()
+{
+    for(int i = 0; i < polarlists.count(); i++)
+        polarlists.at(i)->memoryreaders.deref();
+    polarlists.clear();
+
+    for(int i = 0; i < segmentjobs.count(); i++)
+        samples.append(segmentjobs.at(i).samples);
+    for(int i = 0; i < cyclejobs.count(); i++)
+        samples.append(cyclejobs.at(i).samples);
+
+    std::sort(samples.begin(), samples.end(), sampleLessThan);
+
+    qDebug() << QString("PoiExtractor::finish %1 samples").arg(samples.count());
+}
+
+bool PoiExtractor::writeCsv(const QString &filename)
+{
+    QFile file(filename);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        error = QString("Cannot open %1 : %2").arg(filename).arg(file.errorString());
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "name,lat,lon,time,satellite,channel,line,column,count,bt\n";
+    for(int i = 0; i < samples.count(); i++)
+    {
+        const PoiSample &sample = samples.at(i);
+        const PoiPoint &point = points.at(sample.point);
+        out << QString("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10\n").arg(point.name).arg(point.lat, 0, 'f', 4).arg(point.lon, 0, 'f', 4)
+               .arg(sample.time.toString("yyyy-MM-ddThh:mm:ssZ")).arg(sample.satellite).arg(sample.channel)
+               .arg(sample.line).arg(sample.column).arg(sample.count)
+               .arg(sample.bt > 0.0 ? QString::number(sample.bt, 'f', 2) : QString());
+    }
+
+    file.close();
+    if(file.error() != QFile::NoError)
+    {
+        error = QString("Error writing %1 : %2").arg(filename).arg(file.errorString());
+        return false;
+    }
+    return true;
+}
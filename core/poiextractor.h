@@ -0,0 +1,111 @@
+#ifndef POIEXTRACTOR_H
+#define POIEXTRACTOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QVector>
+#include <QList>
+#include <QMap>
+#include <QFileInfo>
+#include <QFuture>
+
+#include "avhrrsatellite.h"
+#include "segment.h"
+#include "segmentlistgeostationary.h"
+
+class Poi;
+
+struct PoiPoint {
+    QString name;
+    double lat;                 // degrees
+    double lon;
+};
+
+// One value of the time series, count is -1 and bt is -1.0 when there is none
+struct PoiSample {
+    int point;                  // index in the point list
+    QDateTime time;             // UTC of the line or the cycle
+    QString satellite;
+    QString channel;
+    int line;                   // in the segment or in the full disc
+    int column;
+    int count;
+    double bt;                  // Kelvin, MSG infrared channels only
+};
+
+// Where a point falls in a segment, line is the fraction of the segment in [0, 1)
+struct PoiHit {
+    int point;
+    double line;
+    int column;
+};
+
+struct PoiSegmentJob {
+    Segment *segment;
+    const QVector<PoiPoint> *points;
+    QList<PoiSample> samples;
+};
+
+struct PoiCycleJob {
+    SegmentListGeostationary *sl;
+    QString satellite;
+    QString date;               // yyyyMMddhhmm of the cycle
+    QMap<QString, QMap<int, QFileInfo> > files;    // spectrum, segment number
+    const QVector<PoiPoint> *points;
+    QList<PoiSample> samples;
+};
+
+// One job of the thread pool, a polar segment or a geostationary cycle
+struct PoiJob {
+    PoiSegmentJob *segmentjob;
+    PoiCycleJob *cyclejob;
+};
+
+// Time series of channel values at a list of points, over every AVHRR segment and MSG cycle
+// of the segment directories that starts within a time range.
+// The position of a point in a polar segment is found from the orbit and the scan geometry,
+// without the earth locations of the segment : a segment is only decoded when a point is in it
+// and the buffers are given back afterwards. For a geostationary cycle the image line and
+// column of a point are fixed, only the segment files with these lines are decoded.
+// The segments and the cycles are handled in the thread pool : prepare() makes the jobs, start() returns
+// a future with the number of jobs done as progress, finish() collects the values once it has ended.
+// Only the AVHRR segments and the MSG cycles (MET-10, MET-9 and MET-8) are searched. GOES, MET-7, FY2,
+// Himawari and VIIRS are left out.
+class PoiExtractor
+{
+public:
+    explicit PoiExtractor(AVHRRSatellite *seglist);
+
+    void setPoints(const QVector<PoiPoint> &points) { this->points = points; }
+    void setPointsFromPoi(const Poi &poi);
+    void setTimeRange(const QDateTime &from, const QDateTime &to);
+
+    int pointCount() const { return points.count(); }
+    bool prepare();
+    QFuture<void> start();
+    void finish();
+    bool writeCsv(const QString &filename);
+    const QList<PoiSample> &result() const { return samples; }
+    QString errorString() const { return error; }
+
+    static bool locateInSegment(Segment *segm, const PoiPoint &point, PoiHit &hit);
+
+private:
+    void addPolarJobs(QList<PoiSegmentJob> &jobs, QList<Segment *> *list);
+    void addCycleJobs(QList<PoiCycleJob> &jobs, SegmentListGeostationary *sl, const QString &satellite,
+                      QMap<QString, QMap<QString, QMap<int, QFileInfo> > > &segmentlistmap);
+
+    AVHRRSatellite *segs;
+    QList<PoiSegmentJob> segmentjobs;
+    QList<PoiCycleJob> cyclejobs;
+    QList<PoiJob> jobs;
+    QList<SegmentList *> polarlists;
+    QVector<PoiPoint> points;
+    QDateTime from;
+    QDateTime to;
+    QList<PoiSample> samples;
+    QString error;
+};
+
+#endif // POIEXTRACTOR_H
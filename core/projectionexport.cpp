@@ -0,0 +1,544 @@
+#include "projectionexport.h"
+#include "segmentimage.h"
+#include "formtoolbox.h"
+#include "options.h"
+#include "zlib.h"
+
+#include <QtConcurrent/QtConcurrent>
+#include <QtEndian>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QFile>
+#include <QTextStream>
+#include <QMutex>
+#include <QDebug>
+
+extern Options opts;
+extern SegmentImage *imageptrs;
+extern QMutex g_mutex;
+
+// offsets in a classic TIFF are 32 bit
+#define TIFF_MAX_SIZE Q_INT64_C(0xFFFFFFFF)
+
+// rows of a raw job
+#define EXPORT_RAW_ROWS 32
+
+struct TiffEntry {
+    quint16 tag;
+    quint16 type;           // 2 = ASCII, 3 = SHORT, 4 = LONG, 12 = DOUBLE
+    quint32 count;
+    QByteArray value;       // little endian
+};
+
+// The rectangle is stored in RGBA order or as little endian floats, the rest of the output is zero
+static void doExportTile(ExportJob &job)
+{
+    QByteArray raw(job.size.width() * job.size.height() * 4, 0);
+    uchar *out = (uchar *)raw.data();
+
+    for (int y = 0; y < job.rect.height(); y++)
+    {
+        uchar *dst = out + y * job.size.width() * 4;
+
+        if(job.image != NULL)
+        {
+            const QRgb *row = (const QRgb *)job.image->constScanLine(job.rect.top() + y) + job.rect.left();
+            for (int x = 0; x < job.rect.width(); x++)
+            {
+                dst[4*x] = qRed(row[x]);
+                dst[4*x + 1] = qGreen(row[x]);
+                dst[4*x + 2] = qBlue(row[x]);
+                dst[4*x + 3] = qAlpha(row[x]);
+            }
+        }
+        else
+        {
+            const float *row = job.plane + (qint64)(job.rect.top() + y) * job.width + job.rect.left();
+            for (int x = 0; x < job.rect.width(); x++)
+            {
+                quint32 bits;
+                memcpy(&bits, &row[x], 4);
+                qToLittleEndian<quint32>(bits, dst + 4*x);
+            }
+        }
+    }
+
+    if(job.compress)
+    {
+        uLongf destlen = compressBound(raw.size());
+        job.data.resize(destlen);
+        job.ok = compress2((Bytef *)job.data.data(), &destlen, (const Bytef *)raw.constData(), raw.size(), Z_DEFAULT_COMPRESSION) == Z_OK;
+        job.data.resize(destlen);
+    }
+    else
+    {
+        job.data = raw;
+        job.ok = true;
+    }
+}
+
+static TiffEntry tiffShorts(quint16 tag, const QList<quint16> &values)
+{
+    TiffEntry entry;
+    entry.tag = tag;
+    entry.type = 3;
+    entry.count = values.count();
+    QDataStream out(&entry.value, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+    for (int i = 0; i < values.count(); i++)
+        out << values.at(i);
+    return entry;
+}
+
+static TiffEntry tiffLongs(quint16 tag, const QList<quint32> &values)
+{
+    TiffEntry entry;
+    entry.tag = tag;
+    entry.type = 4;
+    entry.count = values.count();
+    QDataStream out(&entry.value, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+    for (int i = 0; i < values.count(); i++)
+        out << values.at(i);
+    return entry;
+}
+
+static TiffEntry tiffDoubles(quint16 tag, const QList<double> &values)
+{
+    TiffEntry entry;
+    entry.tag = tag;
+    entry.type = 12;
+    entry.count = values.count();
+    QDataStream out(&entry.value, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    for (int i = 0; i < values.count(); i++)
+        out << values.at(i);
+    return entry;
+}
+
+static TiffEntry tiffAscii(quint16 tag, const QByteArray &text)
+{
+    TiffEntry entry;
+    entry.tag = tag;
+    entry.type = 2;
+    entry.value = text;
+    entry.value.append('\0');
+    entry.count = entry.value.size();
+    return entry;
+}
+
+// The directory at offset, followed by the values that do not fit in an entry. The entries are in order of tag.
+static QByteArray tiffDirectory(const QList<TiffEntry> &entries, quint32 offset)
+{
+    QByteArray ifd;
+    QByteArray values;
+    quint32 valueoffset = offset + 2 + entries.count() * 12 + 4;
+
+    QDataStream out(&ifd, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out << (quint16)entries.count();
+
+    for (int i = 0; i < entries.count(); i++)
+    {
+        const TiffEntry &entry = entries.at(i);
+        out << entry.tag << entry.type << entry.count;
+        if(entry.value.size() <= 4)
+        {
+            QByteArray value = entry.value;
+            value.append(QByteArray(4 - value.size(), '\0'));
+            out.writeRawData(value.constData(), 4);
+        }
+        else
+        {
+            out << (quint32)(valueoffset + values.size());
+            values.append(entry.value);
+            if(values.size() & 1)
+                values.append('\0');
+        }
+    }
+    out << (quint32)0;
+
+    return ifd + values;
+}
+
+static void addGeoKey(QList<quint16> &keys, quint16 key, quint16 location, quint16 count, quint16 value)
+{
+    keys << key << location << count << value;
+}
+
+ProjectionExport::ProjectionExport()
+{
+    width = imageptrs->ptrimageProjection->width();
+    height = imageptrs->ptrimageProjection->height();
+    geo.projection = opts.currenttoolbox;
+    valid = width > 0 && height > 0;
+
+    if(geo.projection == TAB_LLC)
+        imageptrs->lcc->georeference(geo);
+    else if(geo.projection == TAB_GVP)
+        imageptrs->gvp->georeference(geo);
+    else if(geo.projection == TAB_GS)
+        imageptrs->sg->georeference(geo);
+    else
+        valid = false;
+}
+
+bool ProjectionExport::hasBrightnessTemp() const
+{
+    return !imageptrs->ptrProjectionBrightnessTemp.isNull();
+}
+
+// name_bt.tif for name.tif
+QString ProjectionExport::planeFileName(const QString &filename)
+{
+    QFileInfo fi(filename);
+    return fi.path() + "/" + fi.completeBaseName() + "_bt." + fi.suffix();
+}
+
+bool ProjectionExport::writeGeoTiff(const QString &filename, bool compress)
+{
+    if(!valid)
+    {
+        error = QString("There is no projection image to export");
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QImage converted;
+    const QImage *image = imageptrs->ptrimageProjection;
+    if(image->format() != QImage::Format_ARGB32 && image->format() != QImage::Format_RGB32)
+    {
+        converted = image->convertToFormat(QImage::Format_ARGB32);
+        image = &converted;
+    }
+
+    bool ok = writeGeoTiffFile(filename, image, NULL, compress);
+    if(ok && hasBrightnessTemp())
+        ok = writeGeoTiffFile(planeFileName(filename), NULL, imageptrs->ptrProjectionBrightnessTemp.data(), compress);
+
+    qDebug() << QString("ProjectionExport::writeGeoTiff %1 %2 x %3 compress = %4 in %5 msec").arg(filename).arg(width).arg(height).arg(compress).arg(timer.elapsed());
+    return ok;
+}
+
+bool ProjectionExport::writeRaw(const QString &filename)
+{
+    if(!valid)
+    {
+        error = QString("There is no projection image to export");
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QImage converted;
+    const QImage *image = imageptrs->ptrimageProjection;
+    if(image->format() != QImage::Format_ARGB32 && image->format() != QImage::Format_RGB32)
+    {
+        converted = image->convertToFormat(QImage::Format_ARGB32);
+        image = &converted;
+    }
+
+    bool ok = writeRawFile(filename, image, NULL) && writeEnviHeader(filename, false);
+    if(ok && hasBrightnessTemp())
+        ok = writeRawFile(planeFileName(filename), NULL, imageptrs->ptrProjectionBrightnessTemp.data()) && writeEnviHeader(planeFileName(filename), true);
+
+    qDebug() << QString("ProjectionExport::writeRaw %1 %2 x %3 in %4 msec").arg(filename).arg(width).arg(height).arg(timer.elapsed());
+    return ok;
+}
+
+// Little endian tiled TIFF with the directory after the tiles, the header is patched when the directory is written
+bool ProjectionExport::writeGeoTiffFile(const QString &filename, const QImage *image, const float *plane, bool compress)
+{
+    QFile file(filename);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        error = QString("Failed to open %1\n%2").arg(filename).arg(file.errorString());
+        return false;
+    }
+
+    int tilesacross = (width + EXPORT_TILE_SIZE - 1) / EXPORT_TILE_SIZE;
+    int tilesdown = (height + EXPORT_TILE_SIZE - 1) / EXPORT_TILE_SIZE;
+    QList<quint32> offsets;
+    QList<quint32> bytecounts;
+    bool ok = file.write("II*\0\0\0\0\0", 8) == 8;
+
+    for (int ty = 0; ty < tilesdown && ok; ty++)
+    {
+        QList<ExportJob> jobs;
+        for (int tx = 0; tx < tilesacross; tx++)
+        {
+            ExportJob job;
+            job.image = image;
+            job.plane = plane;
+            job.width = width;
+            job.rect = QRect(tx * EXPORT_TILE_SIZE, ty * EXPORT_TILE_SIZE, EXPORT_TILE_SIZE, EXPORT_TILE_SIZE).intersected(QRect(0, 0, width, height));
+            job.size = QSize(EXPORT_TILE_SIZE, EXPORT_TILE_SIZE);
+            job.compress = compress;
+            job.ok = false;
+            jobs.append(job);
+        }
+
+        g_mutex.lock();
+        QtConcurrent::blockingMap(jobs, doExportTile);
+        g_mutex.unlock();
+
+        for (int i = 0; i < jobs.count() && ok; i++)
+        {
+            if(!jobs.at(i).ok)
+            {
+                error = QString("Compression of a tile of %1 failed").arg(filename);
+                ok = false;
+            }
+            else if(file.pos() + jobs.at(i).data.size() > TIFF_MAX_SIZE)
+            {
+                error = QString("%1 would be larger than 4 GB, export as raw instead").arg(filename);
+                ok = false;
+            }
+            else
+            {
+                offsets.append((quint32)file.pos());
+                bytecounts.append((quint32)jobs.at(i).data.size());
+                if(file.write(jobs.at(i).data) != jobs.at(i).data.size())
+                {
+                    error = QString("Failed to write %1\n%2").arg(filename).arg(file.errorString());
+                    ok = false;
+                }
+            }
+        }
+    }
+
+    if(ok)
+    {
+        QList<TiffEntry> entries;
+        int samples = image != NULL ? 4 : 1;
+        QList<quint16> bitspersample, sampleformat;
+        for (int i = 0; i < samples; i++)
+        {
+            bitspersample << (image != NULL ? 8 : 32);
+            sampleformat << (image != NULL ? 1 : 3);
+        }
+
+        QList<double> doubleparams;
+        QByteArray asciiparams;
+        QByteArray geokeys = geoKeyDirectory(doubleparams, asciiparams);
+        TiffEntry keyentry;
+        keyentry.tag = 34735;
+        keyentry.type = 3;
+        keyentry.count = geokeys.size() / 2;
+        keyentry.value = geokeys;
+
+        entries << tiffLongs(256, QList<quint32>() << width);
+        entries << tiffLongs(257, QList<quint32>() << height);
+        entries << tiffShorts(258, bitspersample);
+        entries << tiffShorts(259, QList<quint16>() << (compress ? 8 : 1));
+        entries << tiffShorts(262, QList<quint16>() << (image != NULL ? 2 : 1));
+        entries << tiffShorts(277, QList<quint16>() << samples);
+        entries << tiffShorts(284, QList<quint16>() << 1);
+        entries << tiffAscii(305, "EUMETCastView");
+        entries << tiffShorts(322, QList<quint16>() << EXPORT_TILE_SIZE);
+        entries << tiffShorts(323, QList<quint16>() << EXPORT_TILE_SIZE);
+        entries << tiffLongs(324, offsets);
+        entries << tiffLongs(325, bytecounts);
+        if(image != NULL)
+            entries << tiffShorts(338, QList<quint16>() << 2);
+        entries << tiffShorts(339, sampleformat);
+        entries << tiffDoubles(33550, QList<double>() << geo.pixelx << geo.pixely << 0.0);
+        entries << tiffDoubles(33922, QList<double>() << 0.0 << 0.0 << 0.0 << geo.originx << geo.originy << 0.0);
+        entries << keyentry;
+        if(!doubleparams.isEmpty())
+            entries << tiffDoubles(34736, doubleparams);
+        entries << tiffAscii(34737, asciiparams);
+        if(plane != NULL)
+            entries << tiffAscii(42113, "-1");
+
+        if(file.pos() & 1)
+            file.write("\0", 1);
+        quint32 ifdoffset = (quint32)file.pos();
+        QByteArray ifd = tiffDirectory(entries, ifdoffset);
+
+        if(file.pos() + ifd.size() > TIFF_MAX_SIZE)
+        {
+            error = QString("%1 would be larger than 4 GB, export as raw instead").arg(filename);
+            ok = false;
+        }
+        else
+        {
+            uchar header[4];
+            qToLittleEndian<quint32>(ifdoffset, header);
+            ok = file.write(ifd) == ifd.size() && file.seek(4) && file.write((const char *)header, 4) == 4;
+            if(!ok)
+                error = QString("Failed to write %1\n%2").arg(filename).arg(file.errorString());
+        }
+    }
+
+    file.close();
+    if(!ok)
+        file.remove();
+
+    return ok;
+}
+
+// The GeoKeyDirectory as SHORT values, the double and ascii parameters it refers to are returned as well
+QByteArray ProjectionExport::geoKeyDirectory(QList<double> &doubleparams, QByteArray &asciiparams)
+{
+    QList<quint16> keys;
+
+    asciiparams = geo.proj4.toLatin1() + "|";
+    doubleparams.clear();
+
+    addGeoKey(keys, 1024, 0, 1, 1);                         // GTModelTypeGeoKey = ModelTypeProjected
+    addGeoKey(keys, 1025, 0, 1, 1);                         // GTRasterTypeGeoKey = RasterPixelIsArea
+    addGeoKey(keys, 1026, 34737, asciiparams.size(), 0);    // GTCitationGeoKey
+    addGeoKey(keys, 2048, 0, 1, 32767);                     // GeographicTypeGeoKey = user defined
+    addGeoKey(keys, 2050, 0, 1, 32767);                     // GeogGeodeticDatumGeoKey
+    addGeoKey(keys, 2054, 0, 1, 9102);                      // GeogAngularUnitsGeoKey = degree
+    addGeoKey(keys, 2056, 0, 1, 32767);                     // GeogEllipsoidGeoKey
+    addGeoKey(keys, 2057, 34736, 1, doubleparams.count());  // GeogSemiMajorAxisGeoKey
+    doubleparams << geo.semimajor;
+    addGeoKey(keys, 2058, 34736, 1, doubleparams.count());  // GeogSemiMinorAxisGeoKey
+    doubleparams << geo.semiminor;
+    addGeoKey(keys, 3072, 0, 1, 32767);                     // ProjectedCSTypeGeoKey
+    addGeoKey(keys, 3074, 0, 1, 32767);                     // ProjectionGeoKey
+
+    if(geo.projection == TAB_LLC)
+        addGeoKey(keys, 3075, 0, 1, 8);                     // ProjCoordTransGeoKey = CT_LambertConfConic_2SP
+    else if(geo.projection == TAB_GS)
+        addGeoKey(keys, 3075, 0, 1, 14);                    // ProjCoordTransGeoKey = CT_Stereographic
+
+    addGeoKey(keys, 3076, 0, 1, 9001);                      // ProjLinearUnitsGeoKey = metre
+
+    if(geo.projection == TAB_LLC)
+    {
+        addGeoKey(keys, 3078, 34736, 1, doubleparams.count());  // ProjStdParallel1GeoKey
+        doubleparams << geo.stdlat1;
+        addGeoKey(keys, 3079, 34736, 1, doubleparams.count());  // ProjStdParallel2GeoKey
+        doubleparams << geo.stdlat2;
+        addGeoKey(keys, 3084, 34736, 1, doubleparams.count());  // ProjFalseOriginLongGeoKey
+        doubleparams << geo.lon0;
+        addGeoKey(keys, 3085, 34736, 1, doubleparams.count());  // ProjFalseOriginLatGeoKey
+        doubleparams << geo.lat0;
+        addGeoKey(keys, 3086, 34736, 1, doubleparams.count());  // ProjFalseOriginEastingGeoKey
+        doubleparams << geo.falseeasting;
+        addGeoKey(keys, 3087, 34736, 1, doubleparams.count());  // ProjFalseOriginNorthingGeoKey
+        doubleparams << geo.falsenorthing;
+    }
+    else if(geo.projection == TAB_GS)
+    {
+        addGeoKey(keys, 3082, 34736, 1, doubleparams.count());  // ProjFalseEastingGeoKey
+        doubleparams << geo.falseeasting;
+        addGeoKey(keys, 3083, 34736, 1, doubleparams.count());  // ProjFalseNorthingGeoKey
+        doubleparams << geo.falsenorthing;
+        addGeoKey(keys, 3088, 34736, 1, doubleparams.count());  // ProjCenterLongGeoKey
+        doubleparams << geo.lon0;
+        addGeoKey(keys, 3089, 34736, 1, doubleparams.count());  // ProjCenterLatGeoKey
+        doubleparams << geo.lat0;
+        addGeoKey(keys, 3092, 34736, 1, doubleparams.count());  // ProjScaleAtNatOriginGeoKey
+        doubleparams << 1.0;
+    }
+
+    QList<quint16> directory;
+    directory << 1 << 1 << 0 << keys.count() / 4;
+    directory << keys;
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+    for (int i = 0; i < directory.count(); i++)
+        out << directory.at(i);
+    return data;
+}
+
+// Interleaved RGBA bytes or little endian floats, written in blocks of EXPORT_TILE_SIZE rows
+bool ProjectionExport::writeRawFile(const QString &filename, const QImage *image, const float *plane)
+{
+    QFile file(filename);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        error = QString("Failed to open %1\n%2").arg(filename).arg(file.errorString());
+        return false;
+    }
+
+    bool ok = true;
+
+    for (int block = 0; block < height && ok; block += EXPORT_TILE_SIZE)
+    {
+        QList<ExportJob> jobs;
+        for (int row = block; row < qMin(block + EXPORT_TILE_SIZE, height); row += EXPORT_RAW_ROWS)
+        {
+            ExportJob job;
+            job.image = image;
+            job.plane = plane;
+            job.width = width;
+            job.rect = QRect(0, row, width, qMin(EXPORT_RAW_ROWS, height - row));
+            job.size = job.rect.size();
+            job.compress = false;
+            job.ok = false;
+            jobs.append(job);
+        }
+
+        g_mutex.lock();
+        QtConcurrent::blockingMap(jobs, doExportTile);
+        g_mutex.unlock();
+
+        for (int i = 0; i < jobs.count() && ok; i++)
+        {
+            if(file.write(jobs.at(i).data) != jobs.at(i).data.size())
+            {
+                error = QString("Failed to write %1\n%2").arg(filename).arg(file.errorString());
+                ok = false;
+            }
+        }
+    }
+
+    file.close();
+    if(!ok)
+        file.remove();
+
+    return ok;
+}
+
+// name.hdr next to name.raw, map info has the upper left corner of the first pixel
+bool ProjectionExport::writeEnviHeader(const QString &filename, bool plane)
+{
+    QFileInfo fi(filename);
+    QString headername = fi.path() + "/" + fi.completeBaseName() + ".hdr";
+    QFile file(headername);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        error = QString("Failed to open %1\n%2").arg(headername).arg(file.errorString());
+        return false;
+    }
+
+    QString name = geo.projection == TAB_LLC ? "Lambert Conformal Conic" : geo.projection == TAB_GVP ? "General Vertical Perspective" : "Stereographic";
+
+    QTextStream out(&file);
+    out << "ENVI\n";
+    out << "description = {EUMETCastView " << name << " projection}\n";
+    out << "samples = " << width << "\n";
+    out << "lines = " << height << "\n";
+    out << "bands = " << (plane ? 1 : 4) << "\n";
+    out << "header offset = 0\n";
+    out << "file type = ENVI Standard\n";
+    out << "data type = " << (plane ? 4 : 1) << "\n";
+    out << "interleave = bip\n";
+    out << "byte order = 0\n";
+    if(plane)
+    {
+        out << "band names = {brightness temperature}\n";
+        out << "data ignore value = -1\n";
+    }
+    else
+        out << "band names = {red, green, blue, alpha}\n";
+    out << QString("map info = {%1, 1, 1, %2, %3, %4, %5, units=Meters}\n").arg(name)
+           .arg(geo.originx, 0, 'f', 3).arg(geo.originy, 0, 'f', 3).arg(geo.pixelx, 0, 'f', 6).arg(geo.pixely, 0, 'f', 6);
+    out << "proj4 = {" << geo.proj4 << "}\n";
+    out.flush();
+
+    file.close();
+    return file.error() == QFile::NoError;
+}
@@ -0,0 +1,73 @@
+#ifndef PROJECTIONEXPORT_H
+#define PROJECTIONEXPORT_H
+
+#include <QImage>
+#include <QString>
+#include <QByteArray>
+#include <QRect>
+#include <QList>
+
+// side of a GeoTIFF tile, also the number of rows that is made and written in one go
+#define EXPORT_TILE_SIZE 256
+
+// Maps the pixels of the projection image to projected coordinates, the upper left corner
+// of pixel (col, row) is at (originx + col * pixelx, originy - row * pixely)
+struct ProjectionGeoreference {
+    int projection;          // TAB_LLC, TAB_GVP or TAB_GS
+    double originx;          // metres
+    double originy;
+    double pixelx;           // metres
+    double pixely;
+    double semimajor;        // metres, equal for a sphere
+    double semiminor;
+    double lon0;             // degrees
+    double lat0;
+    double stdlat1;          // degrees, LCC only
+    double stdlat2;
+    double height;           // metres above the sphere, GVP only
+    double falseeasting;     // metres
+    double falsenorthing;
+    QString proj4;
+};
+
+struct ExportJob {
+    const QImage *image;     // projection image in ARGB32, or NULL
+    const float *plane;      // brightness temperature plane when image is NULL
+    int width;               // of the plane
+    QRect rect;              // part of the image or plane
+    QSize size;              // of the output, rect is padded with zero to this size
+    bool compress;
+    QByteArray data;
+    bool ok;
+};
+
+// Writes imageptrs->ptrimageProjection and imageptrs->ptrProjectionBrightnessTemp with their georeference,
+// as tiled GeoTIFF (optionally deflate compressed) or as raw files with an ENVI header.
+// The tiles of a block of EXPORT_TILE_SIZE rows are made in the thread pool and written before
+// the next block is made, the memory in use does not grow with the size of the projection.
+class ProjectionExport
+{
+public:
+    ProjectionExport();
+
+    bool isValid() const { return valid; }
+    bool hasBrightnessTemp() const;
+    bool writeGeoTiff(const QString &filename, bool compress);
+    bool writeRaw(const QString &filename);
+    QString errorString() const { return error; }
+    static QString planeFileName(const QString &filename);
+
+private:
+    bool writeGeoTiffFile(const QString &filename, const QImage *image, const float *plane, bool compress);
+    bool writeRawFile(const QString &filename, const QImage *image, const float *plane);
+    bool writeEnviHeader(const QString &filename, bool plane);
+    QByteArray geoKeyDirectory(QList<double> &doubleparams, QByteArray &asciiparams);
+
+    ProjectionGeoreference geo;
+    int width;
+    int height;
+    bool valid;
+    QString error;
+};
+
+#endif // PROJECTIONEXPORT_H
@@ -0,0 +1,266 @@
+#include "projectionextent.h"
+#include "segmentimage.h"
+#include "pixgeoconversion.h"
+#include "formtoolbox.h"
+#include "options.h"
+
+#include <QVector>
+#include <QDebug>
+
+extern Options opts;
+extern SegmentImage *imageptrs;
+
+// distance in projection pixels between the samples of the projection image
+#define EXTENT_SAMPLE_STEP 8
+
+ProjectionExtent::ProjectionExtent()
+{
+    projection = opts.currenttoolbox;
+    width = imageptrs->ptrimageProjection->width();
+    height = imageptrs->ptrimageProjection->height();
+
+    active = opts.regionofinterest && width > 0 && height > 0 &&
+            (projection == TAB_LLC || projection == TAB_GVP || projection == TAB_GS);
+}
+
+bool ProjectionExtent::inverse(int map_x, int map_y, double &lon_rad, double &lat_rad)
+{
+    if(projection == TAB_LLC)
+        return imageptrs->lcc->map_inverse(map_x, map_y, lon_rad, lat_rad);
+    else if(projection == TAB_GVP)
+        return imageptrs->gvp->map_inverse(map_x, map_y, lon_rad, lat_rad);
+    else if(projection == TAB_GS)
+        return imageptrs->sg->map_inverse(map_x, map_y, lon_rad, lat_rad);
+    return false;
+}
+
+bool ProjectionExtent::forward(double lon_rad, double lat_rad, double &map_x, double &map_y)
+{
+    if(projection == TAB_LLC)
+        return imageptrs->lcc->map_forward_neg_coord(lon_rad, lat_rad, map_x, map_y);
+    else if(projection == TAB_GVP)
+        return imageptrs->gvp->map_forward_neg_coord(lon_rad, lat_rad, map_x, map_y);
+    else if(projection == TAB_GS)
+        return imageptrs->sg->map_forward_neg_coord(lon_rad, lat_rad, map_x, map_y);
+    return false;
+}
+
+// The projection image is sampled on a grid and every sample is traced back to the geostationary image.
+// The bounding box of these pixels is widened by the largest step between neighbouring samples,
+// so the pixels picked up between the samples are inside as well.
+ArrayRegion ProjectionExtent::geostationaryRegion(double sub_lon, long coff, long loff, long long cfac, long long lfac, int rows, int cols)
+{
+    if(!active)
+        return fullRegion(rows, cols);
+
+    pixgeoConversion pixconv;
+    double lon_rad, lat_rad;
+    int col, row;
+    int minrow = rows, maxrow = -1, mincol = cols, maxcol = -1;
+    int gap = 0;
+
+    int nbrsamples = (width - 1) / EXTENT_SAMPLE_STEP + 2;
+    QVector<int> abovecol(nbrsamples, -1);
+    QVector<int> aboverow(nbrsamples, -1);
+
+    for(int y = 0; ; y += EXTENT_SAMPLE_STEP)
+    {
+        int map_y = qMin(y, height - 1);
+        int leftcol = -1, leftrow = -1;
+
+        for(int i = 0; i < nbrsamples; i++)
+        {
+            int map_x = qMin(i * EXTENT_SAMPLE_STEP, width - 1);
+            int c = -1, r = -1;
+
+            if(inverse(map_x, map_y, lon_rad, lat_rad) &&
+                    pixconv.geocoord2pixcoord(sub_lon, lat_rad*180.0/PI, lon_rad*180.0/PI, coff, loff, cfac, lfac, &col, &row) == 0)
+            {
+                c = col;
+                r = row;
+                minrow = qMin(minrow, r);
+                maxrow = qMax(maxrow, r);
+                mincol = qMin(mincol, c);
+                maxcol = qMax(maxcol, c);
+                if(leftcol >= 0)
+                    gap = qMax(gap, qMax(qAbs(c - leftcol), qAbs(r - leftrow)));
+                if(abovecol[i] >= 0)
+                    gap = qMax(gap, qMax(qAbs(c - abovecol[i]), qAbs(r - aboverow[i])));
+            }
+            leftcol = abovecol[i] = c;
+            leftrow = aboverow[i] = r;
+        }
+
+        if(map_y == height - 1)
+            break;
+    }
+
+    ArrayRegion region;
+
+    if(maxrow < 0)
+    {
+        region.firstrow = region.nbrrows = region.firstcol = region.nbrcols = 0;
+    }
+    else
+    {
+        int margin = gap + 2;
+        region.firstrow = qBound(0, minrow - margin, rows - 1);
+        region.nbrrows = qBound(0, maxrow + margin, rows - 1) - region.firstrow + 1;
+        region.firstcol = qBound(0, mincol - margin, cols - 1);
+        region.nbrcols = qBound(0, maxcol + margin, cols - 1) - region.firstcol + 1;
+    }
+
+    qDebug() << QString("ProjectionExtent::geostationaryRegion rows %1 - %2 columns %3 - %4 of %5 x %6")
+                .arg(region.firstrow).arg(region.firstrow + region.nbrrows).arg(region.firstcol).arg(region.firstcol + region.nbrcols).arg(rows).arg(cols);
+
+    return region;
+}
+
+// The tie points hold the corners of the zones of a swath : two rows per scan (first and last line)
+// and nbrzones + 1 columns. A zone is in the region when the box around its corners in the projection
+// overlaps the projection image. The region is widened by one zone on each side.
+ArrayRegion ProjectionExtent::swathRegion(const float *tielat, const float *tielon, int nbrscans, int nbrzones, int scanlines, int zonecolumns)
+{
+    int rows = nbrscans * scanlines;
+    int cols = nbrzones * zonecolumns;
+
+    if(!active || tielat == NULL || tielon == NULL)
+        return fullRegion(rows, cols);
+
+    int minscan = nbrscans, maxscan = -1, minzone = nbrzones, maxzone = -1;
+    double map_x, map_y;
+
+    for(int itrack = 0; itrack < nbrscans; itrack++)
+    {
+        for(int iscan = 0; iscan < nbrzones; iscan++)
+        {
+            int corners[4] = { 2 * itrack * (nbrzones + 1) + iscan, 2 * itrack * (nbrzones + 1) + iscan + 1,
+                               (2 * itrack + 1) * (nbrzones + 1) + iscan, (2 * itrack + 1) * (nbrzones + 1) + iscan + 1 };
+            double minx = 1e30, maxx = -1e30, miny = 1e30, maxy = -1e30;
+            bool mapped = false;
+
+            for(int k = 0; k < 4; k++)
+            {
+                float lat = tielat[corners[k]];
+                float lon = tielon[corners[k]];
+                if(lat < -90.0 || lat > 90.0 || lon < -180.0 || lon > 180.0) // fill values
+                    continue;
+                if(forward(lon*PI/180.0, lat*PI/180.0, map_x, map_y))
+                {
+                    minx = qMin(minx, map_x);
+                    maxx = qMax(maxx, map_x);
+                    miny = qMin(miny, map_y);
+                    maxy = qMax(maxy, map_y);
+                    mapped = true;
+                }
+            }
+
+            if(mapped && maxx >= 0 && minx < width && maxy >= 0 && miny < height)
+            {
+                minscan = qMin(minscan, itrack);
+                maxscan = qMax(maxscan, itrack);
+                minzone = qMin(minzone, iscan);
+                maxzone = qMax(maxzone, iscan);
+            }
+        }
+    }
+
+    ArrayRegion region;
+
+    if(maxscan < 0)
+    {
+        region.firstrow = region.nbrrows = region.firstcol = region.nbrcols = 0;
+    }
+    else
+    {
+        minscan = qMax(0, minscan - 1);
+        maxscan = qMin(nbrscans - 1, maxscan + 1);
+        minzone = qMax(0, minzone - 1);
+        maxzone = qMin(nbrzones - 1, maxzone + 1);
+        region.firstrow = minscan * scanlines;
+        region.nbrrows = (maxscan - minscan + 1) * scanlines;
+        region.firstcol = minzone * zonecolumns;
+        region.nbrcols = (maxzone - minzone + 1) * zonecolumns;
+    }
+
+    qDebug() << QString("ProjectionExtent::swathRegion rows %1 - %2 columns %3 - %4 of %5 x %6")
+                .arg(region.firstrow).arg(region.firstrow + region.nbrrows).arg(region.firstcol).arg(region.firstcol + region.nbrcols).arg(rows).arg(cols);
+
+    return region;
+}
+
+ArrayRegion ProjectionExtent::fullRegion(int rows, int cols)
+{
+    ArrayRegion region;
+    region.firstrow = 0;
+    region.nbrrows = rows;
+    region.firstcol = 0;
+    region.nbrcols = cols;
+    return region;
+}
+
+bool ProjectionExtent::isFullRegion(const ArrayRegion &region, int rows, int cols)
+{
+    return region.firstrow == 0 && region.nbrrows == rows && region.firstcol == 0 && region.nbrcols == cols;
+}
+
+// An empty inner region (nothing in the projection) is in every region.
+bool ProjectionExtent::containsRegion(const ArrayRegion &outer, const ArrayRegion &inner)
+{
+    if(inner.nbrrows <= 0 || inner.nbrcols <= 0)
+        return true;
+
+    return inner.firstrow >= outer.firstrow && inner.firstrow + inner.nbrrows <= outer.firstrow + outer.nbrrows &&
+            inner.firstcol >= outer.firstcol && inner.firstcol + inner.nbrcols <= outer.firstcol + outer.nbrcols;
+}
+
+bool ProjectionExtent::isInRegion(const ArrayRegion &region, int row, int col)
+{
+    return row >= region.firstrow && row < region.firstrow + region.nbrrows &&
+            col >= region.firstcol && col < region.firstcol + region.nbrcols;
+}
+
+// The smallest region holding both regions
+ArrayRegion ProjectionExtent::unionRegion(const ArrayRegion &a, const ArrayRegion &b)
+{
+    if(a.nbrrows <= 0 || a.nbrcols <= 0)
+        return b;
+    if(b.nbrrows <= 0 || b.nbrcols <= 0)
+        return a;
+
+    ArrayRegion region;
+    region.firstrow = qMin(a.firstrow, b.firstrow);
+    region.nbrrows = qMax(a.firstrow + a.nbrrows, b.firstrow + b.nbrrows) - region.firstrow;
+    region.firstcol = qMin(a.firstcol, b.firstcol);
+    region.nbrcols = qMax(a.firstcol + a.nbrcols, b.firstcol + b.nbrcols) - region.firstcol;
+    return region;
+}
+
+// Reads the region of a rows x cols dataset to the same place in buffer, which holds the full array.
+// The rest of the buffer is left as it is.
+herr_t ProjectionExtent::readRegion(hid_t dataset_id, hid_t mem_type_id, int rows, int cols, const ArrayRegion &region, void *buffer)
+{
+    if(isFullRegion(region, rows, cols))
+        return H5Dread(dataset_id, mem_type_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer);
+
+    if(region.nbrrows <= 0 || region.nbrcols <= 0)
+        return 0;
+
+    hsize_t dims[2] = { (hsize_t)rows, (hsize_t)cols };
+    hsize_t start[2] = { (hsize_t)region.firstrow, (hsize_t)region.firstcol };
+    hsize_t count[2] = { (hsize_t)region.nbrrows, (hsize_t)region.nbrcols };
+
+    hid_t filespace_id = H5Dget_space(dataset_id);
+    hid_t memspace_id = H5Screate_simple(2, dims, NULL);
+
+    herr_t h5_status = H5Sselect_hyperslab(filespace_id, H5S_SELECT_SET, start, NULL, count, NULL);
+    if(h5_status >= 0)
+        h5_status = H5Sselect_hyperslab(memspace_id, H5S_SELECT_SET, start, NULL, count, NULL);
+    if(h5_status >= 0)
+        h5_status = H5Dread(dataset_id, mem_type_id, memspace_id, filespace_id, H5P_DEFAULT, buffer);
+
+    H5Sclose(memspace_id);
+    H5Sclose(filespace_id);
+
+    return h5_status;
+}
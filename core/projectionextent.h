@@ -0,0 +1,43 @@
+#ifndef PROJECTIONEXTENT_H
+#define PROJECTIONEXTENT_H
+
+#include <hdf5/serial/hdf5.h>
+
+// Block of rows and columns of a 2D dataset
+struct ArrayRegion {
+    int firstrow;
+    int nbrrows;
+    int firstcol;
+    int nbrcols;
+};
+
+// Extent of the current projection (Lambert, perspective or stereographic).
+// Used to read only the part of an input file that can reach the projection image.
+// Without a projection image, or with opts.regionofinterest off, every region is the full array.
+class ProjectionExtent
+{
+public:
+    ProjectionExtent();
+    bool isActive() { return active; }
+
+    ArrayRegion geostationaryRegion(double sub_lon, long coff, long loff, long long cfac, long long lfac, int rows, int cols);
+    ArrayRegion swathRegion(const float *tielat, const float *tielon, int nbrscans, int nbrzones, int scanlines, int zonecolumns);
+
+    static ArrayRegion fullRegion(int rows, int cols);
+    static bool isFullRegion(const ArrayRegion &region, int rows, int cols);
+    static bool containsRegion(const ArrayRegion &outer, const ArrayRegion &inner);
+    static bool isInRegion(const ArrayRegion &region, int row, int col);
+    static ArrayRegion unionRegion(const ArrayRegion &a, const ArrayRegion &b);
+    static herr_t readRegion(hid_t dataset_id, hid_t mem_type_id, int rows, int cols, const ArrayRegion &region, void *buffer);
+
+private:
+    bool inverse(int map_x, int map_y, double &lon_rad, double &lat_rad);
+    bool forward(double lon_rad, double lat_rad, double &map_x, double &map_y);
+
+    bool active;
+    int projection;     // opts.currenttoolbox
+    int width;
+    int height;
+};
+
+#endif // PROJECTIONEXTENT_H
@@ -1,4 +1,5 @@
 #include "qcompressor.h"
+#include <QFile>
 
 
 /**
@@ -195,3 +196,74 @@ bool QCompressor::gzipDecompress(QByteArray input, QByteArray &output)
     else
         return(true);
 }
+
+/**
+ * @brief Decompresses a GZIP file straight into the output buffer, reading the file in chunks
+ * @param filepath The compressed file
+ * @param output The result of the decompression, its memory is reused when it is large enough
+ * @param maxsize The largest decompressed size that is accepted
+ * @return @c true if the decompression was successfull, @c false otherwise
+ */
+bool QCompressor::gzipDecompressFile(QString filepath, QByteArray &output, qint64 maxsize)
+{
+    QFile file(filepath);
+    if(!file.open(QIODevice::ReadOnly))
+        return(false);
+
+    // The last 4 bytes of a gzip file hold the decompressed size (modulo 2^32)
+    uchar trailer[4];
+    if(file.size() < 18 || !file.seek(file.size() - 4) || file.read((char*)trailer, 4) != 4 || !file.seek(0))
+        return(false);
+
+    quint32 isize = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | ((quint32)trailer[3] << 24);
+    if(isize == 0 || isize > maxsize)
+        return(false);
+
+    // Keeps the allocation of the previous file when this one is not larger, reserve() stops resize() from shrinking it
+    output.reserve(isize);
+    output.resize(isize);
+
+    // Prepare inflater status
+    z_stream strm;
+    strm.zalloc = Z_NULL;
+    strm.zfree = Z_NULL;
+    strm.opaque = Z_NULL;
+    strm.avail_in = 0;
+    strm.next_in = Z_NULL;
+
+    int ret = inflateInit2(&strm, GZIP_WINDOWS_BIT);
+    if (ret != Z_OK)
+        return(false);
+
+    strm.next_out = (unsigned char*)output.data();
+    strm.avail_out = isize;
+
+    char in[GZIP_CHUNK_SIZE];
+
+    do {
+        qint64 chunk_size = file.read(in, GZIP_CHUNK_SIZE);
+        if(chunk_size <= 0)
+            break;
+
+        strm.next_in = (unsigned char*)in;
+        strm.avail_in = chunk_size;
+
+        do {
+            ret = inflate(&strm, Z_NO_FLUSH);
+
+            // Z_BUF_ERROR : the output is full, the file is larger than its trailer says
+            if(ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR || ret == Z_BUF_ERROR)
+            {
+                inflateEnd(&strm);
+                return(false);
+            }
+        } while (strm.avail_in > 0 && ret != Z_STREAM_END);
+
+    } while (ret != Z_STREAM_END);
+
+    bool ok = (ret == Z_STREAM_END && strm.total_out == isize);
+
+    inflateEnd(&strm);
+
+    return(ok);
+}
@@ -3,6 +3,7 @@
 
 #include "zlib.h"
 #include <QByteArray>
+#include <QString>
 
 #define GZIP_WINDOWS_BIT 15 + 16
 #define GZIP_CHUNK_SIZE 32 * 1024
@@ -12,6 +13,7 @@ class QCompressor
 public:
     static bool gzipCompress(QByteArray input, QByteArray &output, int level = -1);
     static bool gzipDecompress(QByteArray input, QByteArray &output);
+    static bool gzipDecompressFile(QString filepath, QByteArray &output, qint64 maxsize);
 };
 
 #endif // QCOMPRESSOR_H
@@ -567,6 +567,10 @@ void SatelliteList::ReReadTle(void)
 
   qDebug() << "voor iterator ReReadTle";
 
+  QSet<int> catnbrs;
+  for ( QStringList::Iterator itc = opts.catnbrlist.begin(); itc != opts.catnbrlist.end(); ++itc )
+    catnbrs.insert((*itc).toInt( &ok, 10));
+
   for ( QStringList::Iterator it = opts.tlelist.begin(); it != opts.tlelist.end(); ++it )
   {
     QFile file( *it );
@@ -589,16 +593,8 @@ void SatelliteList::ReReadTle(void)
           if (lleft!=QString("2")) break;
 
           thesat = new Satellite(line.trimmed(), line1, line2, Qt::yellow );
-          thesat->active = false;
-
-          for ( QStringList::Iterator itc = opts.catnbrlist.begin(); itc != opts.catnbrlist.end(); ++itc )
-          {
-            if ( (*itc).toInt( &ok, 10) == line1.mid(2, 5).toInt( &ok, 10 ) )
-            {
-              thesat->active = true;
-              break;
-            }
-          }
+          thesat->tlefile = *it;
+          thesat->active = catnbrs.contains(line1.mid(2, 5).toInt( &ok, 10 ));
 
           satlist.append( *thesat );
         }
@@ -966,6 +962,18 @@ void SatelliteList::SetActive(const int catnr)
 
 }
 
+void SatelliteList::SetActive(const QSet<int> &catnrs)
+{
+  QList<Satellite>::iterator sat = satlist.begin();
+
+  while ( sat != satlist.end() )
+  {
+    if(catnrs.contains((*sat).catnr))
+      (*sat).active = true;
+    ++sat;
+  }
+}
+
 double SatelliteList::GetSatAlt(const int catnr)
 {
     QList<Satellite>::iterator sat = satlist.begin();
@@ -17,6 +17,7 @@
 #include <QColor>
 #include <QVector2D>
 #include <QVector3D>
+#include <QSet>
 
 class Satellite
 {
@@ -42,6 +43,7 @@ public:
     bool active; // sat is selected
     QString sat_name; /* Satellite name string    */
     QString idesg;    /* International Designator */
+    QString tlefile;  /* TLE file it was read from */
     QVector2D winsatpos;
     QTle *qtle;
     QSgp4 *qsgp4;
@@ -85,6 +87,7 @@ public:
     void showHorizon(double lon, double lat, double geo_alt, QPainter *painter);
     void ReloadList(void);
     void SetActive(const int catnr);
+    void SetActive(const QSet<int> &catnrs);
     void ClearActive(void);
     //  int NbrActiveSats(void);
     void SetSelectedSat(const int catnr);
@@ -1,4 +1,5 @@
 #include "segment.h"
+#include "tracer.h"
 #include "segmentimage.h"
 
 #include "options.h"
@@ -28,6 +29,7 @@ Segment::Segment(QObject *parent) :
     cnt_viadr = 0;
     //image_ready = false;
     segmentok = true;
+    earthloc_size = 0;
 
     for(int k = 0; k < 5; k++)
     {
@@ -239,6 +241,7 @@ void Segment::resetMemory()
     {
         ptrbaVIIRS[k].reset();
     }
+    ptrbaVIIRSDNB.reset();
 
     projectionCoordX.reset();
     projectionCoordY.reset();
@@ -255,6 +258,39 @@ void Segment::resetMemory()
 
 }
 
+// Bytes held by the swath sized arrays : channel data, projection coordinates and earth locations
+qint64 Segment::memoryInUse()
+{
+    qint64 swath = (qint64)earth_views_per_scanline * NbrOfLines;
+    qint64 bytes = 0;
+
+    for(int k = 0; k < 5; k++)
+    {
+        if(!ptrbaChannel[k].isNull())
+            bytes += swath * sizeof(unsigned short);
+    }
+
+    for(int k = 0; k < 3; k++)
+    {
+        if(!ptrbaVIIRS[k].isNull())
+            bytes += swath * sizeof(unsigned short);
+    }
+
+    if(!ptrbaVIIRSDNB.isNull())
+        bytes += swath * sizeof(float);
+    if(!projectionCoordX.isNull())
+        bytes += swath * (sizeof(int) * 2 + sizeof(QRgb));
+
+    if(!earthloc_lon.isNull())
+        bytes += earthloc_size * sizeof(float);
+    if(!earthloc_lat.isNull())
+        bytes += earthloc_size * sizeof(float);
+    if(!solar_zenith_angle.isNull())
+        bytes += earthloc_size * sizeof(float);
+
+    return bytes;
+}
+
 
 void Segment::RenderSatPath(QPainter *painter, QColor color)
 {
@@ -758,6 +794,7 @@ void Segment::RenderSegmentlineInTexture( int channel, int nbrLine, int nbrTotal
 void Segment::RenderSegmentlineInTextureRad(int channel, double lat_first, double lon_first, double lat_last, double lon_last, double altitude, int heightintotalimage)
 {
     QRgb *row_col;
+    QVector<QRgb> row_buffer;
 
     double latdiff = sin((lat_first-lat_last)/2);
     double londiff = sin((lon_first-lon_last)/2);
@@ -786,16 +823,8 @@ void Segment::RenderSegmentlineInTextureRad(int channel, double lat_first, doubl
 
 
 
-    if (channel == 1)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(heightintotalimage);
-    else if (channel == 2)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(heightintotalimage);
-    else if (channel == 3)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(heightintotalimage);
-    else if (channel == 4)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(heightintotalimage);
-    else if (channel == 5)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(heightintotalimage);
+    if (channel >= 1 && channel <= 5)
+        row_col = imageptrs->ChannelLine(channel - 1, heightintotalimage, row_buffer);
     else if (channel == 6)
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(heightintotalimage);
     else if (channel == 10)
@@ -871,7 +900,8 @@ void Segment::RenderSegmentInTexture(int channel, int nbrTotalLine)
 
 void Segment::ComposeSegmentImage()
 {
-    QRgb *row_ch[5];
+    TraceSpan span("compose", "Segment::ComposeSegmentImage", fileInfo);
+    quint16 *row_ch[5];
     QRgb *row_col;
     quint16 pixel[5];
     quint16 R_value, G_value, B_value;
@@ -910,11 +940,8 @@ void Segment::ComposeSegmentImage()
 
     for (int line = 0; line < this->NbrOfLines; line++)
     {
-        row_ch[0] = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(startheight + line);
-        row_ch[1] = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(startheight + line);
-        row_ch[2] = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(startheight + line);
-        row_ch[3] = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(startheight + line);
-        row_ch[4] = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(startheight + line);
+        for( int k = 0; k < 5; k++)
+            row_ch[k] = imageptrs->planecomp_ch[k].scanLine(startheight + line);
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(startheight + line);
 
         for (int pixelx = 0; pixelx < earth_views_per_scanline; pixelx++)
@@ -922,16 +949,7 @@ void Segment::ComposeSegmentImage()
             for( int k = 0; k < 5; k++)
             {
                 pixel[k] = *(this->ptrbaChannel[k].data() + line * earth_views_per_scanline + pixelx);
-                R_value = imageptrs->lut_ch[k][pixel[k]]/4;
-                if (inverse.at(k) == "1")
-                    //row_ch[k][pixelx] = qRgb(255 - (pixel[k]/4), 255 - (pixel[k]/4), 255 - (pixel[k]/4));
-                    row_ch[k][pixelx] = qRgb(255 - R_value, 255 - R_value, 255 - R_value);
-                else
-                {
-                    //row_ch[k][pixelx] = qRgb(pixel[k]/4, pixel[k]/4, pixel[k]/4);
-                    row_ch[k][pixelx] = qRgb(R_value, R_value, R_value);
-                }
-
+                row_ch[k][pixelx] = pixel[k];
             }
 
             //int B = (int)(imageptrs->lut_ch[0][pixel[0]]/4);
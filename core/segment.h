@@ -38,6 +38,7 @@ public:
 
     virtual void initializeMemory();
     virtual void resetMemory();
+    virtual qint64 memoryInUse();
 //    virtual void cleanupMemory();
     void RenderSatPath(QPainter *painter, QColor color);
     void sphericalToPixel(double lon, double lat, int &x, int &y, int devwidth, int devheight);
@@ -128,6 +129,7 @@ public:
 
     QScopedArrayPointer<float> earthloc_lon;
     QScopedArrayPointer<float> earthloc_lat;
+    int earthloc_size;      // floats in earthloc_lon, earthloc_lat and solar_zenith_angle
 
     QScopedArrayPointer<float> solar_zenith_angle; // 1080 X 103
     QScopedArrayPointer<float> satellite_zenith_angle;
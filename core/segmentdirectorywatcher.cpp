@@ -0,0 +1,193 @@
+#include "segmentdirectorywatcher.h"
+#include "options.h"
+
+#include <QDir>
+#include <QDate>
+#include <QDebug>
+
+extern Options opts;
+
+#define WATCHER_PENDING_INTERVAL 200    // msec between two size checks of a new file
+#define WATCHER_STABLE_CHECKS 2         // number of checks with an unchanged size before a file is taken
+#define WATCHER_PENDING_POLLS 1500      // 5 minutes of checks before a file that does not settle is dropped
+#define WATCHER_DIRECTORY_INTERVAL 60000
+
+SegmentDirectoryWatcher::SegmentDirectoryWatcher(QObject *parent) :
+    QObject(parent)
+{
+    connect(&watcher, SIGNAL(directoryChanged(QString)), this, SLOT(slotDirectoryChanged(QString)));
+
+    pendingtimer.setInterval(WATCHER_PENDING_INTERVAL);
+    connect(&pendingtimer, SIGNAL(timeout()), this, SLOT(slotCheckPending()));
+
+    // Picks up a new day directory and changes in the preferences
+    directorytimer.setInterval(WATCHER_DIRECTORY_INTERVAL);
+    connect(&directorytimer, SIGNAL(timeout()), this, SLOT(slotUpdateDirectories()));
+    directorytimer.start();
+
+    updateWatchedDirectories();
+}
+
+QStringList SegmentDirectoryWatcher::wantedDirectories()
+{
+    QStringList wanted;
+
+    if (!opts.directorywatcher)
+        return wanted;
+
+    QString today = QDateTime::currentDateTimeUtc().date().toString("yyyyMMdd");
+
+    QStringList::Iterator its = opts.segmentdirectorylist.begin();
+    QStringList::Iterator itc = opts.segmentdirectorylistinc.begin(); //segmentdirectory checked
+
+    while( its != opts.segmentdirectorylist.end() && itc != opts.segmentdirectorylistinc.end())
+    {
+        if (*itc == "1")  //include checked
+        {
+            QString thepath = (*its) + "/" + today;
+            QString thepathYYYYMMDD = (*its) + "/" + today.mid(0, 4) + "/" + today.mid(4, 2) + "/" + today.mid(6, 2);
+
+            wanted << QFileInfo(*its).absoluteFilePath();
+            if (QFileInfo(thepath).isDir())
+                wanted << QFileInfo(thepath).absoluteFilePath();
+            else if (QFileInfo(thepathYYYYMMDD).isDir())
+                wanted << QFileInfo(thepathYYYYMMDD).absoluteFilePath();
+        }
+        ++its;
+        ++itc;
+    }
+
+    return wanted;
+}
+
+void SegmentDirectoryWatcher::updateWatchedDirectories()
+{
+    QStringList wanted = wantedDirectories();
+    QStringList watched = watcher.directories();
+
+    foreach (const QString &dirpath, watched)
+    {
+        if (!wanted.contains(dirpath))
+        {
+            watcher.removePath(dirpath);
+            knownfiles.remove(dirpath);
+            qDebug() << QString("SegmentDirectoryWatcher stops watching %1").arg(dirpath);
+        }
+    }
+
+    foreach (const QString &dirpath, wanted)
+    {
+        if (!watched.contains(dirpath))
+            watchDirectory(dirpath);
+    }
+}
+
+void SegmentDirectoryWatcher::watchDirectory(QString dirpath)
+{
+    // The files that are already there are known through the directory index
+    QSet<QString> names;
+    QList<SegmentFileDescriptor> desclist = DirectoryIndex::readDirectory(dirpath);
+    foreach (const SegmentFileDescriptor &desc, desclist)
+        names.insert(desc.filename);
+
+    knownfiles.insert(dirpath, names);
+
+    if (watcher.addPath(dirpath))
+        qDebug() << QString("SegmentDirectoryWatcher watching %1 (%2 files)").arg(dirpath).arg(names.size());
+    else
+        qDebug() << QString("SegmentDirectoryWatcher can not watch %1").arg(dirpath);
+}
+
+void SegmentDirectoryWatcher::slotDirectoryChanged(const QString &path)
+{
+    QSet<QString> &known = knownfiles[path];
+
+    QDir dir(path);
+    QStringList names = dir.entryList(QDir::Files | QDir::NoSymLinks, QDir::Unsorted);
+    QSet<QString> present;
+
+    foreach (const QString &name, names)
+    {
+        present.insert(name);
+        if (known.contains(name))
+            continue;
+
+        QString filepath = path + "/" + name;
+        if (!pendingfiles.contains(filepath))
+        {
+            PendingFile pf;
+            pf.dirpath = path;
+            pf.filename = name;
+            pf.size = -1;
+            pf.stablecount = 0;
+            pf.polls = 0;
+            pendingfiles.insert(filepath, pf);
+        }
+    }
+
+    // Removed files can arrive again with the same name
+    known.intersect(present);
+
+    if (!pendingfiles.isEmpty() && !pendingtimer.isActive())
+        pendingtimer.start();
+}
+
+void SegmentDirectoryWatcher::slotUpdateDirectories()
+{
+    updateWatchedDirectories();
+}
+
+void SegmentDirectoryWatcher::slotCheckPending()
+{
+    QList<SegmentFileDescriptor> ready;
+
+    QMutableHashIterator<QString, PendingFile> it(pendingfiles);
+    while (it.hasNext())
+    {
+        it.next();
+        PendingFile &pf = it.value();
+        QFileInfo fileinfo(it.key());
+
+        if (!fileinfo.exists())
+        {
+            it.remove();
+            continue;
+        }
+
+        if (++pf.polls > WATCHER_PENDING_POLLS)
+        {
+            qDebug() << QString("SegmentDirectoryWatcher drops %1, the size did not settle").arg(it.key());
+            it.remove();
+            continue;
+        }
+
+        qint64 size = fileinfo.size();
+        if (size > 0 && size == pf.size)
+            pf.stablecount++;
+        else
+            pf.stablecount = 0;
+        pf.size = size;
+
+        if (pf.stablecount >= WATCHER_STABLE_CHECKS)
+        {
+            SegmentFileDescriptor desc = SegmentFileDescriptor::classify(pf.filename);
+            desc.absolutepath = pf.dirpath;
+            desc.size = size;
+            desc.modified = fileinfo.lastModified().toMSecsSinceEpoch();
+
+            knownfiles[pf.dirpath].insert(pf.filename);
+            if (desc.filetype != SegmentFileDescriptor::FILE_NONE)
+                ready.append(desc);
+            it.remove();
+        }
+    }
+
+    if (pendingfiles.isEmpty())
+        pendingtimer.stop();
+
+    if (ready.size() > 0)
+    {
+        qDebug() << QString("SegmentDirectoryWatcher %1 new segment files").arg(ready.size());
+        emit newSegmentFiles(ready);
+    }
+}
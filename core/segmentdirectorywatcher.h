@@ -0,0 +1,55 @@
+#ifndef SEGMENTDIRECTORYWATCHER_H
+#define SEGMENTDIRECTORYWATCHER_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
+#include "directoryindex.h"
+
+// Watches the included segment directories (and the dated sub-directory of today) and
+// reports the files that arrive in them. On Linux QFileSystemWatcher uses inotify.
+// A new file is only reported when its size did not change between two checks,
+// so files that are still being written are not picked up. Files that do not settle
+// within a few minutes are dropped, a later change of the directory picks them up again.
+class SegmentDirectoryWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SegmentDirectoryWatcher(QObject *parent = 0);
+    void updateWatchedDirectories();
+
+private:
+
+    struct PendingFile {
+        QString dirpath;
+        QString filename;
+        qint64 size;
+        int stablecount;
+        int polls;          // checks so far, the file is dropped after WATCHER_PENDING_POLLS
+    };
+
+    void watchDirectory(QString dirpath);
+    QStringList wantedDirectories();
+
+    QFileSystemWatcher watcher;
+    QTimer pendingtimer;
+    QTimer directorytimer;
+    QHash<QString, QSet<QString> > knownfiles;
+    QHash<QString, PendingFile> pendingfiles;
+
+signals:
+    void newSegmentFiles(QList<SegmentFileDescriptor> desclist);
+
+private slots:
+    void slotDirectoryChanged(const QString &path);
+    void slotCheckPending();
+    void slotUpdateDirectories();
+
+};
+
+#endif // SEGMENTDIRECTORYWATCHER_H
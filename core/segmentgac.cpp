@@ -1,4 +1,5 @@
 #include "segmentgac.h"
+#include "tracer.h"
 
 #include "sgp4sdp4.h"
 #include "globals.h"
@@ -407,6 +408,7 @@ quint32 SegmentGAC::get_next_header( QByteArray ba )
 
 Segment *SegmentGAC::ReadSegmentInMemory()
 {
+    TraceSpan span("decode", "SegmentGAC::ReadSegmentInMemory", fileInfo);
     FILE*   f;
     BZFILE* b;
     int     nBuf;
@@ -422,6 +424,7 @@ Segment *SegmentGAC::ReadSegmentInMemory()
 
     int heightinsegment = 0;
 
+    earthloc_size = 360*51;
     earthloc_lon.reset(new float[360*51]);
     earthloc_lat.reset(new float[360*51]);
 
@@ -725,22 +728,15 @@ void SegmentGAC::RenderSegmentlineInSG( int channel, int nbrLine, int heightinto
     double dtot;
 
     QRgb *row_col;
+    QVector<QRgb> row_buffer;
     QRgb rgbvalue = qRgb(0,0,0);
 
 
 
     if (channel == 6)
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(heightintotalimage);
-    else if (channel == 1)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(heightintotalimage);
-    else if (channel == 2)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(heightintotalimage);
-    else if (channel == 3)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(heightintotalimage);
-    else if (channel == 4)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(heightintotalimage);
-    else if (channel == 5)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(heightintotalimage);
+    else if (channel >= 1 && channel <= 5)
+        row_col = imageptrs->ChannelLine(channel - 1, heightintotalimage, row_buffer);
 
     g_mutex.lock();
 
@@ -807,20 +803,13 @@ void SegmentGAC::RenderSegmentlineInGVP( int channel, int nbrLine, int heightint
     double dtot;
 
     QRgb *row_col;
+    QVector<QRgb> row_buffer;
     QRgb rgbvalue = qRgb(0,0,0);
 
     if (channel == 6)
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(heightintotalimage);
-    else if (channel == 1)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(heightintotalimage);
-    else if (channel == 2)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(heightintotalimage);
-    else if (channel == 3)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(heightintotalimage);
-    else if (channel == 4)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(heightintotalimage);
-    else if (channel == 5)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(heightintotalimage);
+    else if (channel >= 1 && channel <= 5)
+        row_col = imageptrs->ChannelLine(channel - 1, heightintotalimage, row_buffer);
 
     g_mutex.lock();
 
@@ -887,20 +876,13 @@ void SegmentGAC::RenderSegmentlineInLCC( int channel, int nbrLine, int heightint
     double dtot;
 
     QRgb *row_col;
+    QVector<QRgb> row_buffer;
     QRgb rgbvalue = qRgb(0,0,0);
 
     if (channel == 6)
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(heightintotalimage);
-    else if (channel == 1)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(heightintotalimage);
-    else if (channel == 2)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(heightintotalimage);
-    else if (channel == 3)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(heightintotalimage);
-    else if (channel == 4)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(heightintotalimage);
-    else if (channel == 5)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(heightintotalimage);
+    else if (channel >= 1 && channel <= 5)
+        row_col = imageptrs->ChannelLine(channel - 1, heightintotalimage, row_buffer);
 
     g_mutex.lock();
 
@@ -967,6 +949,7 @@ void SegmentGAC::RenderSegmentlineInProjection( int channel, int nbrLine, int he
     //RenderSegmentlineInTextureRad( channel, this->earth_loc_lat_first[nbrLine], earth_loc_lon_first[nbrLine],
     //                               earth_loc_lat_last[nbrLine], earth_loc_lon_last[nbrLine], earth_loc_altitude[nbrLine], nbrTotalLine);
     QRgb *row_col;
+    QVector<QRgb> row_buffer;
 
     double latdiff = sin((this->earth_loc_lat_first[nbrLine]-this->earth_loc_lat_last[nbrLine])/2);
     double londiff = sin((this->earth_loc_lon_first[nbrLine]-this->earth_loc_lon_last[nbrLine])/2);
@@ -996,16 +979,8 @@ void SegmentGAC::RenderSegmentlineInProjection( int channel, int nbrLine, int he
 
     if (channel == 6)
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(heightintotalimage);
-    else if (channel == 1)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(heightintotalimage);
-    else if (channel == 2)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(heightintotalimage);
-    else if (channel == 3)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(heightintotalimage);
-    else if (channel == 4)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(heightintotalimage);
-    else if (channel == 5)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(heightintotalimage);
+    else if (channel >= 1 && channel <= 5)
+        row_col = imageptrs->ChannelLine(channel - 1, heightintotalimage, row_buffer);
 
 
     double map_x, map_y;
@@ -1,4 +1,5 @@
 #include "segmenthrp.h"
+#include "tracer.h"
 
 #include "sgp4sdp4.h"
 #include "globals.h"
@@ -366,6 +367,7 @@ int SegmentHRP::ReadNbrOfLines()
 
 Segment *SegmentHRP::ReadSegmentInMemory()
 {
+    TraceSpan span("decode", "SegmentHRP::ReadSegmentInMemory", fileInfo);
 
     FILE*   f;
     BZFILE* b;
@@ -727,19 +729,12 @@ void SegmentHRP::RenderSegmentlineInProjection( int channel, int heightintotalim
 {
 
     QRgb *row_col;
+    QVector<QRgb> row_buffer;
 
     if (channel == 6)
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(heightintotalimage);
-    else if (channel == 1)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(heightintotalimage);
-    else if (channel == 2)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(heightintotalimage);
-    else if (channel == 3)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(heightintotalimage);
-    else if (channel == 4)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(heightintotalimage);
-    else if (channel == 5)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(heightintotalimage);
+    else if (channel >= 1 && channel <= 5)
+        row_col = imageptrs->ChannelLine(channel - 1, heightintotalimage, row_buffer);
 
     QSgp4Date dateref = eciref.GetDate();
     Vector3 posref = eciref.GetPos();
@@ -818,19 +813,12 @@ void SegmentHRP::RenderSegmentlineInLCCcEci( int channel, int heightintotalimage
 {
 
     QRgb *row_col;
+    QVector<QRgb> row_buffer;
 
     if (channel == 6)
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(heightintotalimage);
-    else if (channel == 1)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(heightintotalimage);
-    else if (channel == 2)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(heightintotalimage);
-    else if (channel == 3)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(heightintotalimage);
-    else if (channel == 4)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(heightintotalimage);
-    else if (channel == 5)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(heightintotalimage);
+    else if (channel >= 1 && channel <= 5)
+        row_col = imageptrs->ChannelLine(channel - 1, heightintotalimage, row_buffer);
 
     cJulian dateref = eciref.getDate();
     QVector4D posref4d = eciref.getPos();
@@ -1083,22 +1071,15 @@ void SegmentHRP::RenderSegmentlineInProjectionAlternative(int channel, int heigh
 {
 
     QRgb *row_col;
+    QVector<QRgb> row_buffer;
     double map_x, map_y;
     QRgb rgbvalue = qRgb(0,0,0);
 
 
     if (channel == 6)
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(heightintotalimage);
-    else if (channel == 1)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(heightintotalimage);
-    else if (channel == 2)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(heightintotalimage);
-    else if (channel == 3)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(heightintotalimage);
-    else if (channel == 4)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(heightintotalimage);
-    else if (channel == 5)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(heightintotalimage);
+    else if (channel >= 1 && channel <= 5)
+        row_col = imageptrs->ChannelLine(channel - 1, heightintotalimage, row_buffer);
 
     for ( int nbrPoint = 0; nbrPoint < this->earth_views_per_scanline; nbrPoint++ )
     {
@@ -1,10 +1,9 @@
 #include "segmentimage.h"
+#include "tracer.h"
 
 #include <QDebug>
-#define uiNR_OF_GREY (4096)
-
-const unsigned int uiMAX_REG_X = 16;	  /* max. # contextual regions in x-direction */
-const unsigned int uiMAX_REG_Y = 16;	  /* max. # contextual regions in y-direction */
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
 
 extern Options opts;
 
@@ -13,9 +12,12 @@ SegmentImage::SegmentImage()
 
     for(int k = 0; k < 5; k++)
     {
-        this->ptrimagecomp_ch[k] = new QImage();
+        inverse_ch[k] = false;
+        for(int i = 0; i < 1024; i++)
+            lutplane_ch[k][i] = 0;
     }
 
+    ptrimagechannel = new QImage();
     ptrimagecomp_col = new QImage();
     ptrexpand_col = new QImage();
     ptrimageGeostationary = new QImage(3712, 3712, QImage::Format_ARGB32);
@@ -34,13 +36,20 @@ SegmentImage::SegmentImage()
         ptrRed[i] = NULL;
         ptrGreen[i] = NULL;
         ptrBlue[i] = NULL;
+        sizeRed[i] = 0;
+        sizeGreen[i] = 0;
+        sizeBlue[i] = 0;
     }
 
     for( int i = 0; i < 24; i++)
     {
         ptrHRV[i] = NULL;
+        sizeHRV[i] = 0;
     }
 
+    geostationarygeneration.store(1);
+    expandgatherwidth = 0;
+
 }
 
 void SegmentImage::CalcSatAngles()
@@ -134,11 +143,13 @@ void SegmentImage::DeleteImagePtrs()
 
     for(int k = 0; k < 5; k++)
     {
-        if(ptrimagecomp_ch[k] != NULL)
-        {
-            delete ptrimagecomp_ch[k];
-            ptrimagecomp_ch[k] = NULL;
-        }
+        planecomp_ch[k].clear();
+    }
+
+    if(ptrimagechannel != NULL)
+    {
+        delete ptrimagechannel;
+        ptrimagechannel = NULL;
     }
 
     if(ptrimagecomp_col != NULL)
@@ -193,40 +204,64 @@ void SegmentImage::ResetPtrImage()
     {
         if (ptrRed[i] != NULL)
         {
-            delete ptrRed[i];
+            delete [] ptrRed[i];
             ptrRed[i] = NULL;
         }
         if (ptrGreen[i] != NULL)
         {
-            delete ptrGreen[i];
+            delete [] ptrGreen[i];
             ptrGreen[i] = NULL;
         }
         if (ptrBlue[i] != NULL)
         {
-            delete ptrBlue[i];
+            delete [] ptrBlue[i];
             ptrBlue[i] = NULL;
         }
+        sizeRed[i] = 0;
+        sizeGreen[i] = 0;
+        sizeBlue[i] = 0;
     }
 
     for( int i = 0; i < 24; i++)
     {
         if (ptrHRV[i] != NULL)
         {
-            delete ptrHRV[i];
+            delete [] ptrHRV[i];
             ptrHRV[i] = NULL;
         }
+        sizeHRV[i] = 0;
     }
 }
 
-void SegmentImage::InitializeAVHRRImages( int imagewidth, int imageheight) // , long stat_min_ch[], long stat_max_ch[] )
+// A zeroed channel buffer of a geostationary segment, buffers[index] is used again when it has the same size.
+// The decode tasks each fill their own index.
+quint16 *SegmentImage::NewGeostationaryBuffer(quint16 **buffers, int *sizes, int index, int count)
 {
-    qDebug() << "voor initializeimages";
-
-    for(int k = 0; k < 5; k++)
+    if(buffers[index] != NULL && sizes[index] != count)
     {
-        if(ptrimagecomp_ch[k] != NULL)
-            delete ptrimagecomp_ch[k];
+        delete [] buffers[index];
+        buffers[index] = NULL;
     }
+    if(buffers[index] == NULL)
+        buffers[index] = new quint16[count];
+    sizes[index] = count;
+    memset(buffers[index], 0, count * sizeof(quint16));
+    return buffers[index];
+}
+
+qint64 SegmentImage::GeostationaryBufferBytes() const
+{
+    qint64 samples = 0;
+    for( int i = 0; i < 10; i++)
+        samples += (qint64)sizeRed[i] + sizeGreen[i] + sizeBlue[i];
+    for( int i = 0; i < 24; i++)
+        samples += sizeHRV[i];
+    return samples * sizeof(quint16);
+}
+
+void SegmentImage::InitializeAVHRRImages( int imagewidth, int imageheight) // , long stat_min_ch[], long stat_max_ch[] )
+{
+    qDebug() << "voor initializeimages";
 
     if(ptrimagecomp_col != NULL)
         delete ptrimagecomp_col;
@@ -235,9 +270,14 @@ void SegmentImage::InitializeAVHRRImages( int imagewidth, int imageheight) // ,
 
     for(int k = 0; k < 5; k++)
     {
-        ptrimagecomp_ch[k] = new QImage(imagewidth, imageheight, QImage::Format_ARGB32);
+        planecomp_ch[k].resize(imagewidth, imageheight);
     }
 
+    // the grey image of a channel is made when it is shown
+    if(ptrimagechannel != NULL)
+        delete ptrimagechannel;
+    ptrimagechannel = new QImage();
+
     ptrimagecomp_col = new QImage(imagewidth, imageheight, QImage::Format_ARGB32);
 
 
@@ -254,7 +294,27 @@ void SegmentImage::InitializeImageGeostationary( int imagewidth, int imageheight
 
     ptrimageGeostationary = new QImage(imagewidth, imageheight, QImage::Format_ARGB32);
     ptrimageGeostationary->fill(Qt::black);
+    ptrBrightnessTempGeostationary.reset();
+
+    // new geostationary image, the cached CLAHE histograms are no longer valid
+    geostationarygeneration.ref();
+
+}
+
+// A projection of a calibrated geostationary image gets the brightness temperatures as well,
+// the pixels the projection does not reach stay at -1.0
+bool SegmentImage::InitializeProjectionBrightnessTemp()
+{
+    if(ptrBrightnessTempGeostationary.isNull())
+    {
+        ptrProjectionBrightnessTemp.reset();
+        return false;
+    }
 
+    int size = ptrimageProjection->width() * ptrimageProjection->height();
+    ptrProjectionBrightnessTemp.reset(new float[size]);
+    std::fill(ptrProjectionBrightnessTemp.data(), ptrProjectionBrightnessTemp.data() + size, -1.0f);
+    return true;
 }
 
 
@@ -265,7 +325,7 @@ void SegmentImage::ReverseImage()
 
     for(int k = 0; k < 5; k++)
     {
-       ptrimagecomp_ch[k] = ReverseImageChannel(ptrimagecomp_ch[k]);
+       planecomp_ch[k].reverse();
     }
 
 }
@@ -298,28 +358,79 @@ QImage *SegmentImage::ReverseImageChannel(QImage *ptr)
     return ptrimage;
 }
 
-void SegmentImage::ExpandImage(int channelshown)
+// The inversion of the channels as they are composed, for the images made from the planes
+void SegmentImage::SetupChannelInverse()
 {
-    QRgb *row_col;
+    QStringList inverse;
+    if (opts.buttonMetop)
+        inverse = opts.metop_invlist;
+    else if (opts.buttonNoaa)
+        inverse = opts.noaa_invlist;
+    else if (opts.buttonGAC)
+        inverse = opts.gac_invlist;
+    else if (opts.buttonHRP)
+        inverse = opts.hrp_invlist;
 
-    QRgb *row_result;
+    for(int k = 0; k < 5; k++)
+        inverse_ch[k] = (k < inverse.count() && inverse.at(k) == "1");
+}
 
-    if(channelshown == 7)
-        return;
+// The LUT of the channels as they are composed, for the images made from the planes
+void SegmentImage::SetupChannelLUT()
+{
+    for(int k = 0; k < 5; k++)
+        for(int i = 0; i < 1024; i++)
+            lutplane_ch[k][i] = lut_ch[k][i];
+}
 
-    int TotalLines = ptrimagecomp_col->size().height();
-    if (TotalLines == 0)
-        return;
+// The grey image of channel k (0 - 4) with the LUT of the planes, for showing and expanding
+void SegmentImage::ComposeChannelImage(int k)
+{
+    if(ptrimagechannel == NULL)
+        ptrimagechannel = new QImage();
+    planecomp_ch[k].toImage(ptrimagechannel, lutplane_ch[k], 2, inverse_ch[k]);
+}
 
-    qDebug() << QString("=============  in expand image ; totallines = %1").arg(TotalLines);
-    qDebug() << QString("=============  in expand image ; width = %1").arg(ptrimagecomp_col->size().width());
-    qDebug() << QString("=============  in expand image ; channelshown = %1").arg(channelshown);
+// The colours of a line of channel k, for the renderers that used to read the channel images
+QRgb *SegmentImage::ChannelLine(int k, int line, QVector<QRgb> &buffer) const
+{
+    buffer.resize(planecomp_ch[k].width());
+    planecomp_ch[k].toRgbLine(line, lutplane_ch[k], 2, inverse_ch[k], buffer.data());
+    return buffer.data();
+}
 
-    int nbrwidth = ptrimagecomp_col->size().width()/2;
+struct ExpandJob {
+    QImage *in;
+    QImage *out;
+    const int *gather;
+    int first;          // first row
+    int last;           // one past the last row
+};
+
+static void doExpandRows(ExpandJob &job)
+{
+    int width = job.out->width();
+
+    for( int j = job.first; j < job.last; j++)
+    {
+        const QRgb *row_col = (const QRgb *)job.in->constScanLine(j);
+        QRgb *row_result = (QRgb *)job.out->scanLine(j);
+
+        for( int x = 0; x < width; x++)
+            row_result[x] = row_col[job.gather[x]];
+    }
+}
+
+// Source column of every column of the expanded image. The pixels at nadir are kept,
+// towards the edges of the swath a pixel is repeated p[j] times to correct the scan geometry.
+void SegmentImage::SetupExpandGather(int nbrwidth)
+{
+    if(nbrwidth == expandgatherwidth)
+        return;
 
     double theta_p = Radians(55.37) /nbrwidth;
 
-    int *p = new int[nbrwidth];
+    QVector<int> p(nbrwidth);
     p[0] = 1;
 
     int totalline = 1;
@@ -332,72 +443,78 @@ void SegmentImage::ExpandImage(int channelshown)
 
     qDebug() << QString("totalline = %1").arg(totalline);
 
-    delete ptrexpand_col;
-
-    ptrexpand_col = new QImage(2 * totalline, TotalLines, QImage::Format_ARGB32);
+    expandgather.resize(2 * totalline);
 
-    int inp = 0, outp = 0;
+    int outp = totalline-1;
+    for( int inp = nbrwidth-1; inp >= 0; inp--)
+    {
+        for( int rep=0; rep < p[nbrwidth-1-inp]; rep++)
+            expandgather[outp--] = inp;
+    }
 
-    for( int j = 0;  j < TotalLines ; j++)
+    outp = totalline;
+    for( int inp = nbrwidth; inp < nbrwidth*2; inp++)
     {
-        switch (channelshown)
-        {
-            case 1:
-                row_col = (QRgb*)ptrimagecomp_ch[0]->scanLine(j);
-                row_result = (QRgb *)ptrexpand_col->scanLine(j);
-                break;
-            case 2:
-                row_col = (QRgb*)ptrimagecomp_ch[1]->scanLine(j);
-                row_result = (QRgb *)ptrexpand_col->scanLine(j);
-                break;
-            case 3:
-                row_col = (QRgb*)ptrimagecomp_ch[2]->scanLine(j);
-                row_result = (QRgb *)ptrexpand_col->scanLine(j);
-                break;
-            case 4:
-                row_col = (QRgb*)ptrimagecomp_ch[3]->scanLine(j);
-                row_result = (QRgb *)ptrexpand_col->scanLine(j);
-                break;
-            case 5:
-                row_col = (QRgb*)ptrimagecomp_ch[4]->scanLine(j);
-                row_result = (QRgb *)ptrexpand_col->scanLine(j);
-                break;
-            case 6:
-                row_col = (QRgb*)ptrimagecomp_col->scanLine(j);
-                row_result = (QRgb *)ptrexpand_col->scanLine(j);
-                break;
+        for( int rep=0; rep < p[inp - nbrwidth]; rep++)
+            expandgather[outp++] = inp;
+    }
 
-        }
-        inp = nbrwidth-1;
-        outp = totalline-1;
+    expandgatherwidth = nbrwidth;
+}
 
-        while( inp >=0)
-        {
+void SegmentImage::ExpandImage(int channelshown)
+{
+    QImage *ptrin;
 
-            for( int rep=0; rep < p[nbrwidth-1-inp]; rep++)
-            {
-                row_result[outp] = row_col[inp];
-                outp--;
-            }
-            inp--;
-        }
+    switch (channelshown)
+    {
+        case 1:
+        case 2:
+        case 3:
+        case 4:
+        case 5:
+            ComposeChannelImage(channelshown - 1);
+            ptrin = ptrimagechannel;
+            break;
+        case 6:
+            ptrin = ptrimagecomp_col;
+            break;
+        default:
+            return;
+    }
 
-        inp = nbrwidth;
-        outp = totalline;
+    int TotalLines = ptrimagecomp_col->size().height();
+    if (TotalLines == 0)
+        return;
 
-        while( inp < nbrwidth*2)
-        {
+    qDebug() << QString("=============  in expand image ; totallines = %1").arg(TotalLines);
+    qDebug() << QString("=============  in expand image ; width = %1").arg(ptrimagecomp_col->size().width());
+    qDebug() << QString("=============  in expand image ; channelshown = %1").arg(channelshown);
 
-            for( int rep=0; rep < p[inp - nbrwidth]; rep++)
-            {
-                row_result[outp] = row_col[inp];
-                outp++;
-            }
-            inp++;
-        }
+    SetupExpandGather(ptrimagecomp_col->size().width()/2);
+
+    // reuse the expanded image when the size did not change
+    if(ptrexpand_col == NULL || ptrexpand_col->width() != expandgather.size() || ptrexpand_col->height() != TotalLines)
+    {
+        delete ptrexpand_col;
+        ptrexpand_col = new QImage(expandgather.size(), TotalLines, QImage::Format_ARGB32);
     }
 
-    delete [] p;
+    QList<ExpandJob> jobs;
+    for( int first = 0; first < TotalLines; first += 64)
+    {
+        ExpandJob job;
+        job.in = ptrin;
+        job.out = ptrexpand_col;
+        job.gather = expandgather.constData();
+        job.first = first;
+        job.last = qMin(first + 64, TotalLines);
+        jobs.append(job);
+    }
+
+    // detach in this thread, the rows are written from the thread pool
+    ptrexpand_col->bits();
+    QtConcurrent::blockingMap(jobs, doExpandRows);
 }
 
 
@@ -407,7 +524,7 @@ void SegmentImage::RotateImage()
 
     for(int k = 0; k < 5; k++)
     {
-       ptrimagecomp_ch[k] = ReverseImageChannel(ptrimagecomp_ch[k]);
+       planecomp_ch[k].reverse();
     }
 
 }
@@ -480,259 +597,12 @@ int  SegmentImage::CLAHE (unsigned short* pImage, unsigned int uiXRes, unsigned
  * image. A clip limit smaller than 1 results in standard (non-contrast limited) AHE.
  */
 {
+    TraceSpan span("clahe", "SegmentImage::CLAHE");
 
     qDebug() << "int  SegmentImage::CLAHE (unsigned short ............";
 
-    unsigned int uiX, uiY;		  /* counters */
-    unsigned int uiXSize, uiYSize, uiSubX, uiSubY; /* size of context. reg. and subimages */
-    unsigned int uiXL, uiXR, uiYU, uiYB;  /* auxiliary variables interpolation routine */
-    unsigned long ulClipLimit, ulNrPixels;/* clip limit and region pixel count */
-    unsigned short* pImPointer;		   /* pointer to image */
-    unsigned short aLUT[uiNR_OF_GREY];	    /* lookup table used for scaling of input image */
-    unsigned long* pulHist, *pulMapArray; /* pointer to histogram and mappings*/
-    unsigned long* pulLU, *pulLB, *pulRU, *pulRB; /* auxiliary pointers interpolation */
-
-    if (uiNrX > uiMAX_REG_X) return -1;	   /* # of regions x-direction too large */
-    if (uiNrY > uiMAX_REG_Y) return -2;	   /* # of regions y-direction too large */
-    if (uiXRes % uiNrX) return -3;	  /* x-resolution no multiple of uiNrX */
-    if (uiYRes % uiNrY) return -4;	  /* y-resolution no multiple of uiNrY */
-    if (Max >= uiNR_OF_GREY) return -5;	   /* maximum too large */
-    if (Min >= Max) return -6;		  /* minimum equal or larger than maximum */
-    if (uiNrX < 2 || uiNrY < 2) return -7;/* at least 4 contextual regions required */
-    if (fCliplimit == 1.0) return 0;	  /* is OK, immediately returns original image. */
-    if (uiNrBins == 0) uiNrBins = 128;	  /* default value when not specified */
-
-    pulMapArray=(unsigned long *)malloc(sizeof(unsigned long)*uiNrX*uiNrY*uiNrBins);
-    if (pulMapArray == 0) return -8;	  /* Not enough memory! (try reducing uiNrBins) */
-
-    uiXSize = uiXRes/uiNrX; uiYSize = uiYRes/uiNrY;  /* Actual size of contextual regions */
-    ulNrPixels = (unsigned long)uiXSize * (unsigned long)uiYSize;
-
-    if(fCliplimit > 0.0) {		  /* Calculate actual cliplimit	 */
-       ulClipLimit = (unsigned long) (fCliplimit * (uiXSize * uiYSize) / uiNrBins);
-       ulClipLimit = (ulClipLimit < 1UL) ? 1UL : ulClipLimit;
-    }
-    else ulClipLimit = 1UL<<14;		  /* Large value, do not clip (AHE) */
-    MakeLut(aLUT, Min, Max, uiNrBins);	  /* Make lookup table for mapping of greyvalues */
-    qDebug() << "Calculate greylevel mappings for each contextual region";
-    for (uiY = 0, pImPointer = pImage; uiY < uiNrY; uiY++)
-    {
-        for (uiX = 0; uiX < uiNrX; uiX++, pImPointer += uiXSize)
-        {
-            pulHist = &pulMapArray[uiNrBins * (uiY * uiNrX + uiX)];
-            MakeHistogram(pImPointer,uiXRes,uiXSize,uiYSize,pulHist,uiNrBins,aLUT);
-            ClipHistogram(pulHist, uiNrBins, ulClipLimit);
-            MapHistogram(pulHist, Min, Max, uiNrBins, ulNrPixels);
-        }
-        pImPointer += (uiYSize - 1) * uiXRes;		  /* skip lines, set pointer */
-    }
-
-    qDebug() << "Interpolate greylevel mappings to get CLAHE image";
-    for (pImPointer = pImage, uiY = 0; uiY <= uiNrY; uiY++)
-    {
-        if (uiY == 0)       /* special case: top row */
-        {
-            uiSubY = uiYSize >> 1;  uiYU = 0; uiYB = 0;
-        }
-        else
-        {
-            if (uiY == uiNrY)				  /* special case: bottom row */
-            {
-                uiSubY = uiYSize >> 1;	uiYU = uiNrY-1;	 uiYB = uiYU;
-            }
-            else
-                {					  /* default values */
-                    uiSubY = uiYSize; uiYU = uiY - 1; uiYB = uiYU + 1;
-                }
-        }
-
-        for (uiX = 0; uiX <= uiNrX; uiX++)
-        {
-            if (uiX == 0)				  /* special case: left column */
-            {
-                uiSubX = uiXSize >> 1; uiXL = 0; uiXR = 0;
-            }
-            else
-                {
-                    if (uiX == uiNrX)			  /* special case: right column */
-                    {
-                        uiSubX = uiXSize >> 1;  uiXL = uiNrX - 1; uiXR = uiXL;
-                    }
-                    else
-                        {					  /* default values */
-                            uiSubX = uiXSize; uiXL = uiX - 1; uiXR = uiXL + 1;
-                        }
-                }
-
-            pulLU = &pulMapArray[uiNrBins * (uiYU * uiNrX + uiXL)];
-            pulRU = &pulMapArray[uiNrBins * (uiYU * uiNrX + uiXR)];
-            pulLB = &pulMapArray[uiNrBins * (uiYB * uiNrX + uiXL)];
-            pulRB = &pulMapArray[uiNrBins * (uiYB * uiNrX + uiXR)];
-            Interpolate(pImPointer,uiXRes,pulLU,pulRU,pulLB,pulRB,uiSubX,uiSubY,aLUT);
-            pImPointer += uiSubX;			  /* set pointer on next matrix */
-        }
-        pImPointer += (uiSubY - 1) * uiXRes;
-    }
-
-    free(pulMapArray);					  /* free space for histograms */
-    return 0;						  /* return status OK */
-}
-
-void  SegmentImage::ClipHistogram (unsigned long* pulHistogram, unsigned int
-             uiNrGreylevels, unsigned long ulClipLimit)
-/* This function performs clipping of the histogram and redistribution of bins.
- * The histogram is clipped and the number of excess pixels is counted. Afterwards
- * the excess pixels are equally redistributed across the whole histogram (providing
- * the bin count is smaller than the cliplimit).
- */
-{
-    unsigned long* pulBinPointer, *pulEndPointer, *pulHisto;
-    unsigned long ulNrExcess, ulUpper, ulBinIncr, ulStepSize, i;
-    long lBinExcess;
-
-    ulNrExcess = 0;  pulBinPointer = pulHistogram;
-    for (i = 0; i < uiNrGreylevels; i++) { /* calculate total number of excess pixels */
-    lBinExcess = (long) pulBinPointer[i] - (long) ulClipLimit;
-    if (lBinExcess > 0) ulNrExcess += lBinExcess;	  /* excess in current bin */
-    };
-
-    /* Second part: clip histogram and redistribute excess pixels in each bin */
-    ulBinIncr = ulNrExcess / uiNrGreylevels;		  /* average binincrement */
-    ulUpper =  ulClipLimit - ulBinIncr;	 /* Bins larger than ulUpper set to cliplimit */
-
-    for (i = 0; i < uiNrGreylevels; i++)
-    {
-        if (pulHistogram[i] > ulClipLimit) pulHistogram[i] = ulClipLimit; /* clip bin */
-        else
-        {
-            if (pulHistogram[i] > ulUpper)		/* high bin count */
-            {
-                ulNrExcess -= pulHistogram[i] - ulUpper; pulHistogram[i]=ulClipLimit;
-            }
-            else
-            {					/* low bin count */
-                ulNrExcess -= ulBinIncr; pulHistogram[i] += ulBinIncr;
-            }
-        }
-    }
-
-    while (ulNrExcess)       /* Redistribute remaining excess  */
-    {
-        pulEndPointer = &pulHistogram[uiNrGreylevels]; pulHisto = pulHistogram;
-
-        while (ulNrExcess && pulHisto < pulEndPointer)
-        {
-            ulStepSize = uiNrGreylevels / ulNrExcess;
-            if (ulStepSize < 1) ulStepSize = 1;		  /* stepsize at least 1 */
-            for (pulBinPointer=pulHisto; pulBinPointer < pulEndPointer && ulNrExcess; pulBinPointer += ulStepSize)
-            {
-                if (*pulBinPointer < ulClipLimit)
-                {
-                    (*pulBinPointer)++;	 ulNrExcess--;	  /* reduce excess */
-                }
-            }
-            pulHisto++;		  /* restart redistributing on other bin location */
-        }
-    }
-}
-
-void  SegmentImage::MakeHistogram (unsigned short* pImage, unsigned int uiXRes,
-        unsigned int uiSizeX, unsigned int uiSizeY,
-        unsigned long* pulHistogram,
-        unsigned int uiNrGreylevels, unsigned short* pLookupTable)
-/* This function classifies the greylevels present in the array image into
- * a greylevel histogram. The pLookupTable specifies the relationship
- * between the greyvalue of the pixel (typically between 0 and 4095) and
- * the corresponding bin in the histogram (usually containing only 128 bins).
- */
-{
-    //qDebug() << QString("MakeHistogram uiXRes = %1 uiSizeX = %2 uiSizeY = %3 uiNrGreylevels = %4").arg(uiXRes).arg(uiSizeX).arg(uiSizeY).arg(uiNrGreylevels);
-
-    unsigned short* pImagePointer;
-    unsigned int i;
-
-    for (i = 0; i < uiNrGreylevels; i++) pulHistogram[i] = 0L; /* clear histogram */
-
-    for (i = 0; i < uiSizeY; i++)
-    {
-        pImagePointer = &pImage[uiSizeX];
-        while (pImage < pImagePointer) pulHistogram[pLookupTable[*pImage++]]++;
-        pImagePointer += uiXRes;
-        pImage = pImagePointer-uiSizeX;
-    }
-}
-
-void  SegmentImage::MapHistogram (unsigned long* pulHistogram, unsigned short Min, unsigned short Max,
-           unsigned int uiNrGreylevels, unsigned long ulNrOfPixels)
-/* This function calculates the equalized lookup table (mapping) by
- * cumulating the input histogram. Note: lookup table is rescaled in range [Min..Max].
- */
-{
-    unsigned int i;  unsigned long ulSum = 0;
-    const float fScale = ((float)(Max - Min)) / ulNrOfPixels;
-    const unsigned long ulMin = (unsigned long) Min;
-
-    for (i = 0; i < uiNrGreylevels; i++) {
-    ulSum += pulHistogram[i]; pulHistogram[i]=(unsigned long)(ulMin+ulSum*fScale);
-    if (pulHistogram[i] > Max) pulHistogram[i] = Max;
-    }
-}
-
-void  SegmentImage::MakeLut (unsigned short * pLUT, unsigned short Min, unsigned short Max, unsigned int uiNrBins)
-/* To speed up histogram clipping, the input image [Min,Max] is scaled down to
- * [0,uiNrBins-1]. This function calculates the LUT.
- */
-{
-    int i;
-    const unsigned short BinSize = (unsigned short) (1 + (Max - Min) / uiNrBins);
-
-    for (i = Min; i <= Max; i++)  pLUT[i] = (i - Min) / BinSize;
-}
-
-void  SegmentImage::Interpolate (unsigned short *pImage, int uiXRes, unsigned long * pulMapLU,
-     unsigned long * pulMapRU, unsigned long * pulMapLB,  unsigned long * pulMapRB,
-     unsigned int uiXSize, unsigned int uiYSize, unsigned short *pLUT)
-/* pImage      - pointer to input/output image
- * uiXRes      - resolution of image in x-direction
- * pulMap*     - mappings of greylevels from histograms
- * uiXSize     - uiXSize of image submatrix
- * uiYSize     - uiYSize of image submatrix
- * pLUT	       - lookup table containing mapping greyvalues to bins
- * This function calculates the new greylevel assignments of pixels within a submatrix
- * of the image with size uiXSize and uiYSize. This is done by a bilinear interpolation
- * between four different mappings in order to eliminate boundary artifacts.
- * It uses a division; since division is often an expensive operation, I added code to
- * perform a logical shift instead when feasible.
- */
-{
-    const unsigned int uiIncr = uiXRes-uiXSize; /* Pointer increment after processing row */
-    unsigned short GreyValue; unsigned int uiNum = uiXSize*uiYSize; /* Normalization factor */
-
-    unsigned int uiXCoef, uiYCoef, uiXInvCoef, uiYInvCoef, uiShift = 0;
-
-    if (uiNum & (uiNum - 1))   /* If uiNum is not a power of two, use division */
-        for (uiYCoef = 0, uiYInvCoef = uiYSize; uiYCoef < uiYSize;  uiYCoef++, uiYInvCoef--,pImage+=uiIncr)
-        {
-            for (uiXCoef = 0, uiXInvCoef = uiXSize; uiXCoef < uiXSize; uiXCoef++, uiXInvCoef--)
-            {
-                GreyValue = pLUT[*pImage];		   /* get histogram bin value */
-                *pImage++ = (unsigned short ) ((uiYInvCoef * (uiXInvCoef*pulMapLU[GreyValue] + uiXCoef * pulMapRU[GreyValue])
-                    + uiYCoef * (uiXInvCoef * pulMapLB[GreyValue] + uiXCoef * pulMapRB[GreyValue])) / uiNum);
-            }
-        }
-    else
-    {			   /* avoid the division and use a right shift instead */
-        while (uiNum >>= 1) uiShift++;		   /* Calculate 2log of uiNum */
-        for (uiYCoef = 0, uiYInvCoef = uiYSize; uiYCoef < uiYSize; uiYCoef++, uiYInvCoef--,pImage+=uiIncr)
-        {
-            for (uiXCoef = 0, uiXInvCoef = uiXSize; uiXCoef < uiXSize; uiXCoef++, uiXInvCoef--)
-            {
-                GreyValue = pLUT[*pImage];	  /* get histogram bin value */
-                *pImage++ = (unsigned short)((uiYInvCoef* (uiXInvCoef * pulMapLU[GreyValue] + uiXCoef * pulMapRU[GreyValue])
-                    + uiYCoef * (uiXInvCoef * pulMapLB[GreyValue] + uiXCoef * pulMapRB[GreyValue])) >> uiShift);
-            }
-        }
-    }
+    CLAHEEngine engine;
+    return engine.equalize(pImage, uiXRes, uiYRes, Min, Max, uiNrX, uiNrY, uiNrBins, fCliplimit);
 }
 
 void  SegmentImage::SmoothProjectionImage()
@@ -4,6 +4,7 @@
 #include <QImage>
 
 #include <QFutureWatcher>
+#include <QAtomicInt>
 #include <QOpenGLFramebufferObject>
 
 #include "sgp4sdp4.h"
@@ -11,6 +12,9 @@
 #include "generalverticalperspective.h"
 #include "lambertconformalconic.h"
 #include "stereographic.h"
+#include "claheengine.h"
+#include "calibrationengine.h"
+#include "channelplane.h"
 
 enum MapReturn
 {
@@ -34,20 +38,30 @@ public:
     void ExpandImage(int channelshown);
     void RotateImage();
     void ResetPtrImage();
+    quint16 *NewGeostationaryBuffer(quint16 **buffers, int *sizes, int index, int count);
+    qint64 GeostationaryBufferBytes() const;
     void InitializeAVHRRImages( int imagewidth, int imageheight ); //, long stat_min_ch[], long stat_max_ch[] );
     void InitializeImageGeostationary( int imagewidth, int imageheight ); //, long stat_min_ch[], long stat_max_ch[] );
     int CLAHE (unsigned short *pImage, unsigned int uiXRes, unsigned int uiYRes,
          unsigned short Min, unsigned short Max, unsigned int uiNrX, unsigned int uiNrY,
               unsigned int uiNrBins, float fCliplimit);
     void SmoothProjectionImage();
+    bool InitializeProjectionBrightnessTemp();
     void showHistogram(QImage *ptr);
     qint32 Min(const qint32 v11, const qint32 v12, const qint32 v21, const qint32 v22);
     qint32 Max(const qint32 v11, const qint32 v12, const qint32 v21, const qint32 v22);
     bool bhm_line(int x1, int y1, int x2, int y2, QRgb rgb1, QRgb rgb2, QRgb *canvas, int dimx);
     void MapInterpolation(QRgb *canvas, quint16 dimx, quint16 dimy);
     void MapCanvas(QRgb *canvas, qint32 anchorX, qint32 anchorY, quint16 dimx, quint16 dimy, bool combine);
-
-    QImage *ptrimagecomp_ch[5];
+    void SetupChannelInverse();
+    void SetupChannelLUT();
+    void ComposeChannelImage(int k);
+    QRgb *ChannelLine(int k, int line, QVector<QRgb> &buffer) const;
+
+    ChannelPlane planecomp_ch[5];   // counts of the AVHRR channels
+    bool inverse_ch[5];
+    quint16 lutplane_ch[5][1024];   // lut_ch when the planes were composed, the VIIRS composes reuse lut_ch
+    QImage *ptrimagechannel;        // the channel shown, made from its plane
     QImage *ptrimagecomp_col;
     QImage *ptrexpand_col;
     QImage *ptrimageViirsM;
@@ -60,6 +74,7 @@ public:
 
     QScopedArrayPointer<float> ptrProjectionBrightnessTemp;
     QScopedArrayPointer<quint8> ptrProjectionInfra; // for Infra
+    QScopedArrayPointer<float> ptrBrightnessTempGeostationary; // single MSG infrared channel, size of ptrimageGeostationary
 
     QPixmap *pmOriginal;
     QPixmap *pmOut;
@@ -84,7 +99,19 @@ public:
     quint16 *ptrBlue[10];
 
     quint16 *ptrHRV[24];
+    int sizeRed[10];                    // samples in the channel buffers, for the memory budget
+    int sizeGreen[10];
+    int sizeBlue[10];
+    int sizeHRV[24];
+
+    CLAHEEngine clahegeo[3];            // CLAHE of the geostationary channels, keeps the histograms
+    QAtomicInt geostationarygeneration; // changes with every new geostationary image and every stored segment
+    CalibrationEngine calibrationgeo;   // count to brightness temperature tables from the MSG prologue
+
     void CalcSatAngles();
+    void SetupExpandGather(int nbrwidth);
+    QVector<int> expandgather;      // source column for every column of ptrexpand_col
+    int expandgatherwidth;          // half width of the image the table was built for
     double Sigmadist[2048];
     double fraction[2048];
     double SigmadistGAC[409];
@@ -92,18 +119,6 @@ public:
 
 
 private:
-    void ClipHistogram (unsigned long* pulHistogram, unsigned int
-                 uiNrGreylevels, unsigned long ulClipLimit);
-    void MakeHistogram (unsigned short* pImage, unsigned int uiXRes,
-            unsigned int uiSizeX, unsigned int uiSizeY,
-            unsigned long* pulHistogram,
-            unsigned int uiNrGreylevels, unsigned short* pLookupTable);
-    void MapHistogram (unsigned long* pulHistogram, unsigned short Min, unsigned short Max,
-               unsigned int uiNrGreylevels, unsigned long ulNrOfPixels);
-    void MakeLut (unsigned short * pLUT, unsigned short Min, unsigned short Max, unsigned int uiNrBins);
-    void Interpolate (unsigned short * pImage, int uiXRes, unsigned long * pulMapLU,
-         unsigned long * pulMapRU, unsigned long * pulMapLB,  unsigned long * pulMapRB,
-         unsigned int uiXSize, unsigned int uiYSize, unsigned short * pLUT);
     QImage *RotateImageChannel(QImage *ptr);
     void boundaryFill4 (int x, int y);
 
@@ -4,6 +4,7 @@
 //#include "segmentmetop.h"
 //#include "segmentimage.h"
 #include "segmentlist.h"
+#include "tracer.h"
 #include "avhrrsatellite.h"
 #include "options.h"
 #include <iomanip>
@@ -39,6 +40,77 @@ SegmentList::SegmentList(QObject *parent) :
     }
 
     TotalSegmentsInDirectory = 0;
+    memorybusy = false;
+    memoryreleased = false;
+}
+
+SegmentList::~SegmentList()
+{
+    MemoryBudget::instance()->remove(this);
+}
+
+qint64 SegmentList::memoryInUse()
+{
+    qint64 bytes = 0;
+
+    QList<Segment*>::iterator segsel = segsselected.begin();
+    while ( segsel != segsselected.end() )
+    {
+        bytes += (*segsel)->memoryInUse();
+        ++segsel;
+    }
+
+    return bytes;
+}
+
+bool SegmentList::releaseMemory()
+{
+    if(memorybusy || memoryreaders.load() > 0)
+        return false;
+
+    QList<Segment*>::iterator segsel = segsselected.begin();
+    while ( segsel != segsselected.end() )
+    {
+        (*segsel)->resetMemory();
+        ++segsel;
+    }
+
+    memoryreleased = true;
+    return true;
+}
+
+QString SegmentList::memoryOwnerName()
+{
+    return QString("segment list %1 (%2 segments)").arg(seglisttype).arg(segsselected.count());
+}
+
+// Reads the selected segments again after releaseMemory(), before a projection needs them.
+// The list statistics and LUT of the last ComposeImage() are kept.
+void SegmentList::ReloadReleasedSegments()
+{
+    if(!memoryreleased)
+        return;
+
+    qDebug() << QString("SegmentList::ReloadReleasedSegments %1").arg(memoryOwnerName());
+
+    QList<Segment*>::iterator segsel = segsselected.begin();
+    while ( segsel != segsselected.end() )
+    {
+        (*segsel)->initializeMemory();
+        ++segsel;
+    }
+
+    QtConcurrent::blockingMap(segsselected.begin(), segsselected.end(), &SegmentList::doReadSegmentInMemory);
+
+    segsel = segsselected.begin();
+    while ( segsel != segsselected.end() )
+    {
+        (*segsel)->NormalizeSegment(channel_3_select);
+        ++segsel;
+    }
+
+    memoryreleased = false;
+    MemoryBudget::instance()->update(this);
 }
 
 int SegmentList::NbrOfSegments()
@@ -456,6 +528,8 @@ bool SegmentList::ComposeImage(double gamma_ch[])
 
     emit progressCounter(0);
 
+    memorybusy = true;
+
     progressresultready = 0;
 
     for(int i = 0; i < 5; i++)
@@ -481,6 +555,7 @@ bool SegmentList::ComposeImage(double gamma_ch[])
     }
 
     segsselected.clear();
+    memoryreleased = false;
 
     int startlinenbr = 0;
 
@@ -530,6 +605,7 @@ bool SegmentList::ComposeImage(double gamma_ch[])
 
 void SegmentList::readfinished()
 {
+    TraceSpan span("compose", "SegmentList::readfinished");
 
     int count3a = 0;
     int count3b = 0;
@@ -683,6 +759,9 @@ void SegmentList::ComposeImage1()
 {
     qDebug() << "SegmentList::ComposeImage1()";
 
+    imageptrs->SetupChannelInverse();
+    imageptrs->SetupChannelLUT();
+
     watchercompose = new QFutureWatcher<void>(this);
     connect(watchercompose, SIGNAL(resultReadyAt(int)), SLOT(resultcomposeisready(int)));
     connect(watchercompose, SIGNAL(finished()), SLOT(composefinished()));
@@ -707,6 +786,9 @@ void SegmentList::composefinished()
 
     emit progressCounter(100);
 
+    memorybusy = false;
+    MemoryBudget::instance()->update(this);
+
     QApplication::restoreOverrideCursor();
 
 /*
@@ -748,6 +830,7 @@ void SegmentList::ComposeGVProjection(int inputchannel)
 {
 
     qDebug() << "SegmentList::ComposeGVProjection()";
+    ReloadReleasedSegments();
     QList<Segment*>::iterator segit = segsselected.begin();
     while ( segit != segsselected.end() )
     {
@@ -772,6 +855,7 @@ void SegmentList::ComposeLCCProjection(int inputchannel)
 {
 
     qDebug() << "SegmentList::ComposeLCCProjection()";
+    ReloadReleasedSegments();
     QList<Segment*>::iterator segit = segsselected.begin();
     while ( segit != segsselected.end() )
     {
@@ -785,6 +869,7 @@ void SegmentList::ComposeLCCProjection(int inputchannel)
 void SegmentList::ComposeSGProjection(int inputchannel)
 {
     qDebug() << "SegmentList::ComposeSGProjection()";
+    ReloadReleasedSegments();
     QList<Segment*>::iterator segit = segsselected.begin();
     while ( segit != segsselected.end() )
     {
@@ -825,6 +910,7 @@ void SegmentList::ClearSegments()
 {
 
     segsselected.clear();
+    memoryreleased = false;
 
     while (!segmentlist.isEmpty())
     {
@@ -6,17 +6,20 @@
 #include <QDebug>
 #include <QPen>
 #include <QFutureWatcher>
+#include <QAtomicInt>
 #include "globals.h"
+#include "memorybudget.h"
 
 class Segment;
 
-class SegmentList : public QObject
+class SegmentList : public QObject, public MemoryOwner
 {
     Q_OBJECT
 
 public:
 
     explicit SegmentList(QObject *parent = 0);
+    ~SegmentList();
     void CalculateSunPosition(double first_julian, double last_julian, QVector3D *sunPosition);
     void SetNbrOfVisibleSegments(int nbr);
     int GetNbrOfVisibleSegments();
@@ -54,6 +57,11 @@ public:
     void SmoothProjectionImageBilinear();
     void SmoothProjectionImageBicubic();
 
+    qint64 memoryInUse();
+    bool releaseMemory();
+    QString memoryOwnerName();
+    virtual void ReloadReleasedSegments();
+
     static void doReadSegmentInMemory(Segment *t);
     static void doComposeSegmentImage(Segment *t);
     static void doComposeGVProjection(Segment *t);
@@ -93,6 +101,9 @@ protected:
     int progressresultready; // for progresscounter
     int projectioninputchannel;
     bool channel_3_select;
+    bool memorybusy;        // segments are being read or composed
+    QAtomicInt memoryreaders;   // PoiExtractor runs reading the segment buffers
+    bool memoryreleased;    // the selected segments gave their buffers to the memory budget
 
 signals:
     void segmentlistfinished(bool settoolboxbuttons);
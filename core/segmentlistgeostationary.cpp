@@ -2,12 +2,18 @@
 #include <QFuture>
 #include <QtConcurrent/QtConcurrent>
 #include "segmentlistgeostationary.h"
+#include "tracer.h"
 #include "segmentimage.h"
 #include "qcompressor.h"
+#include "claheengine.h"
+#include "projectionextent.h"
+#include "decodepool.h"
 #include <hdf5/serial/hdf5.h>
+#include <hdf5/serial/hdf5_hl.h>
 
 #include "MSG_HRIT.h"
 #include <QMutex>
+#include <algorithm>
 
 #define BYTE_SWAP4(x) \
     (((x & 0xFF000000) >> 24) | \
@@ -107,6 +113,7 @@ SegmentListGeostationary::SegmentListGeostationary(QObject *parent) :
     LFAC = 0;
 
     areatype = 0;
+    projectionsegmentlines = 0;
     ResetSegments();
     this->bActiveSegmentList = false;
     this->bisRSS = false;
@@ -115,6 +122,89 @@ SegmentListGeostationary::SegmentListGeostationary(QObject *parent) :
 
 }
 
+SegmentListGeostationary::~SegmentListGeostationary()
+{
+    MemoryBudget::instance()->remove(this);
+}
+
+// The channel buffers of the active list and the inflated FY2 files that are kept for the next cycle
+qint64 SegmentListGeostationary::memoryInUse()
+{
+    qint64 bytes = 0;
+    for(int j = 0; j < 3; j++)
+        bytes += hdfimage[j].capacity();
+    if(bActiveSegmentList)
+        bytes += imageptrs->GeostationaryBufferBytes();
+    return bytes;
+}
+
+// Not while segments are decoded into the buffers
+bool SegmentListGeostationary::releaseMemory()
+{
+    for(int i = 0; i < 10; i++)
+    {
+        if(watcherRed[i].isRunning() || watcherGreen[i].isRunning() || watcherBlue[i].isRunning() || watcherMono[i].isRunning())
+            return false;
+    }
+    for(int i = 0; i < 24; i++)
+    {
+        if(watcherHRV[i].isRunning())
+            return false;
+    }
+
+    for(int j = 0; j < 3; j++)
+        hdfimage[j] = QByteArray();
+
+    if(bActiveSegmentList)
+    {
+        imageptrs->ResetPtrImage();
+        memoryreleased = true;
+    }
+    return true;
+}
+
+QString SegmentListGeostationary::memoryOwnerName()
+{
+    return QString("geostationary channel buffers %1 %2").arg(geosatname).arg(kindofimage);
+}
+
+// Decodes the files of the image again after releaseMemory(). The GUI watchers and imagefinished are left
+// alone, the image on screen is not replaced.
+void SegmentListGeostationary::ReloadReleasedBuffers()
+{
+    if(!memoryreleased)
+        return;
+    memoryreleased = false;
+
+    qDebug() << QString("SegmentListGeostationary::ReloadReleasedBuffers %1").arg(memoryOwnerName());
+
+    blockSignals(true);
+    if((m_GeoSatellite == FY2E || m_GeoSatellite == FY2G) && !hdffilelist.isEmpty())
+    {
+        QFuture<void> future = DecodePool::instance()->runDecode(0, std::bind(doComposeGeostationaryHDFInThread, this, hdffilelist, hdfspectrum, hdfinverse));
+        future.waitForFinished();
+    }
+    else if(m_GeoSatellite == FY2E || m_GeoSatellite == FY2G)
+    {
+        for(int j = 0; j < composedfiles.size(); j++)
+            ComposeImageHDFSerial(QFileInfo(composedfiles.at(j)), composedspectrum, composedinverse);
+    }
+    else
+    {
+        QList<QFuture<void> > futures;
+        for(int j = 0; j < composedfiles.size(); j++)
+        {
+            QFutureWatcher<void> *watcher;
+            futures.append(DecodeSegmentXRIT(QFileInfo(composedfiles.at(j)), composedspectrum, composedinverse, &watcher));
+        }
+        for(int j = 0; j < futures.size(); j++)
+            futures[j].waitForFinished();
+    }
+    blockSignals(false);
+
+    MemoryBudget::instance()->update(this);
+}
+
 void SegmentListGeostationary::ResetSegments()
 {
     for( int i = 0; i < 10; i++)
@@ -138,6 +228,10 @@ void SegmentListGeostationary::ResetSegments()
         isPresentMono[i] = false;
     }
 
+    projectiondeferred.clear();
+    hdffilelist.clear();
+    composedfiles.clear();
+    memoryreleased = false;
 }
 
 bool SegmentListGeostationary::ComposeImageXRIT(QFileInfo fileinfo, QVector<QString> spectrumvector, QVector<bool> inversevector)
@@ -149,47 +243,65 @@ bool SegmentListGeostationary::ComposeImageXRIT(QFileInfo fileinfo, QVector<QStr
 
     */
 
-    //QFile file(filepath);
-    //QFileInfo fileinfo(file);
+    qDebug() << QString("SegmentListGeostationary::ComposeImage filePath = %1").arg(fileinfo.filePath());
+
+    composedfiles.append(fileinfo.filePath());
+    composedspectrum = spectrumvector;
+    composedinverse = inversevector;
+
+    QFutureWatcher<void> *watcher = NULL;
+    QFuture<void> future = DecodeSegmentXRIT(fileinfo, spectrumvector, inversevector, &watcher);
+    if(watcher != NULL)
+        watcher->setFuture(future);
+
+    return true;
+}
+
+// Starts the decoding of an XRIT segment on the decode pool. watcher is set to the watcher of its
+// channel and segment, the one that shows the image when it is set to the future.
+QFuture<void> SegmentListGeostationary::DecodeSegmentXRIT(const QFileInfo &fileinfo, const QVector<QString> &spectrumvector, const QVector<bool> &inversevector, QFutureWatcher<void> **watcher)
+{
     int filesequence = fileinfo.fileName().mid(36, 6).toInt()-1;
     QString filespectrum = fileinfo.fileName().mid(26, 6);
-    QString filedate = fileinfo.fileName().mid(46, 12);
 
-    qDebug() << QString("SegmentListGeostationary::ComposeImage filePath = %1").arg(fileinfo.filePath());
+    // the segments at the top of the image are decoded first, the channels of a segment one after the other
+    int priority = (m_GeoSatellite == GOES_13 || m_GeoSatellite == GOES_15 ? -filesequence : filesequence);
+
+    *watcher = NULL;
 
     if( filespectrum  == "HRV___")
     {
-        QFuture<void> future = QtConcurrent::run(doComposeGeostationaryXRIT, this, fileinfo.filePath(), 0, spectrumvector, inversevector);
-        watcherHRV[filesequence].setFuture(future);
+        *watcher = &watcherHRV[filesequence];
+        return DecodePool::instance()->runDecode(priority, std::bind(doComposeGeostationaryXRIT, this, fileinfo.filePath(), 0, spectrumvector, inversevector));
     }
     else if(m_GeoSatellite == MET_7 || m_GeoSatellite == GOES_13 || m_GeoSatellite == GOES_15 )
     {
-        QFuture<void> future = QtConcurrent::run(doComposeGeostationaryXRIT, this, fileinfo.filePath(), 0, spectrumvector, inversevector);
-        watcherMono[filesequence].setFuture(future);
+        *watcher = &watcherMono[filesequence];
+        return DecodePool::instance()->runDecode(priority, std::bind(doComposeGeostationaryXRIT, this, fileinfo.filePath(), 0, spectrumvector, inversevector));
     }
     else if(m_GeoSatellite == MET_10 || m_GeoSatellite == MET_9 || m_GeoSatellite == MET_8)
     {
         if( spectrumvector.at(1) == "" && spectrumvector.at(2) == "")
         {
-            QFuture<void> future = QtConcurrent::run(doComposeGeostationaryXRIT, this, fileinfo.filePath(), 0, spectrumvector, inversevector);
-            watcherRed[filesequence].setFuture(future);
+            *watcher = &watcherRed[filesequence];
+            return DecodePool::instance()->runDecode(priority, std::bind(doComposeGeostationaryXRIT, this, fileinfo.filePath(), 0, spectrumvector, inversevector));
         }
         else
         {
             if(spectrumvector.at(0) == filespectrum)
             {
-                QFuture<void> future = QtConcurrent::run(doComposeGeostationaryXRIT, this, fileinfo.filePath(), 0, spectrumvector, inversevector);
-                watcherRed[filesequence].setFuture(future);
+                *watcher = &watcherRed[filesequence];
+                return DecodePool::instance()->runDecode(priority, std::bind(doComposeGeostationaryXRIT, this, fileinfo.filePath(), 0, spectrumvector, inversevector));
             }
             else if(spectrumvector.at(1) == filespectrum)
             {
-                QFuture<void> future = QtConcurrent::run(doComposeGeostationaryXRIT, this, fileinfo.filePath(), 1, spectrumvector, inversevector);
-                watcherGreen[filesequence].setFuture(future);
+                *watcher = &watcherGreen[filesequence];
+                return DecodePool::instance()->runDecode(priority, std::bind(doComposeGeostationaryXRIT, this, fileinfo.filePath(), 1, spectrumvector, inversevector));
             }
             else if(spectrumvector.at(2) == filespectrum)
             {
-                QFuture<void> future = QtConcurrent::run(doComposeGeostationaryXRIT, this, fileinfo.filePath(), 2, spectrumvector, inversevector);
-                watcherBlue[filesequence].setFuture(future);
+                *watcher = &watcherBlue[filesequence];
+                return DecodePool::instance()->runDecode(priority, std::bind(doComposeGeostationaryXRIT, this, fileinfo.filePath(), 2, spectrumvector, inversevector));
             }
         }
     }
@@ -197,35 +309,35 @@ bool SegmentListGeostationary::ComposeImageXRIT(QFileInfo fileinfo, QVector<QStr
     {
         filesequence = fileinfo.fileName().mid(25, 3).toInt()-1;
         filespectrum = fileinfo.fileName().mid(8, 3);
-        filedate = fileinfo.fileName().mid(12, 11) + "0";
+        priority = -filesequence;
 
         if( spectrumvector.at(1) == "" && spectrumvector.at(2) == "")
         {
-            QFuture<void> future = QtConcurrent::run(doComposeGeostationaryXRITHimawari, this, fileinfo.filePath(), 0, spectrumvector, inversevector);
-            watcherRed[filesequence].setFuture(future);
+            *watcher = &watcherRed[filesequence];
+            return DecodePool::instance()->runDecode(priority, std::bind(doComposeGeostationaryXRITHimawari, this, fileinfo.filePath(), 0, spectrumvector, inversevector));
         }
         else
         {
             if(spectrumvector.at(0) == filespectrum)
             {
-                QFuture<void> future = QtConcurrent::run(doComposeGeostationaryXRITHimawari, this, fileinfo.filePath(), 0, spectrumvector, inversevector);
-                watcherRed[filesequence].setFuture(future);
+                *watcher = &watcherRed[filesequence];
+                return DecodePool::instance()->runDecode(priority, std::bind(doComposeGeostationaryXRITHimawari, this, fileinfo.filePath(), 0, spectrumvector, inversevector));
             }
             else if(spectrumvector.at(1) == filespectrum)
             {
-                QFuture<void> future = QtConcurrent::run(doComposeGeostationaryXRITHimawari, this, fileinfo.filePath(), 1, spectrumvector, inversevector);
-                watcherGreen[filesequence].setFuture(future);
+                *watcher = &watcherGreen[filesequence];
+                return DecodePool::instance()->runDecode(priority, std::bind(doComposeGeostationaryXRITHimawari, this, fileinfo.filePath(), 1, spectrumvector, inversevector));
             }
             else if(spectrumvector.at(2) == filespectrum)
             {
-                QFuture<void> future = QtConcurrent::run(doComposeGeostationaryXRITHimawari, this, fileinfo.filePath(), 2, spectrumvector, inversevector);
-                watcherBlue[filesequence].setFuture(future);
+                *watcher = &watcherBlue[filesequence];
+                return DecodePool::instance()->runDecode(priority, std::bind(doComposeGeostationaryXRITHimawari, this, fileinfo.filePath(), 2, spectrumvector, inversevector));
             }
         }
 
     }
 
-    return true;
+    return QFuture<void>();
 }
 
 bool SegmentListGeostationary::ComposeImageHDFInThread(QStringList strlist, QVector<QString> spectrumvector, QVector<bool> inversevector)
@@ -234,8 +346,12 @@ bool SegmentListGeostationary::ComposeImageHDFInThread(QStringList strlist, QVec
     //"Z_SATE_C_BABJ_20150809101500_O_FY2E_FDI_IR1_001_NOM.HDF.gz"
     qDebug() << QString("SegmentListGeostationary::ComposeImageHDFInThread spectrumvector = %1 %2 %3").arg(spectrumvector.at(0)).arg(spectrumvector.at(1)).arg(spectrumvector.at(2));
 
+    hdffilelist = strlist;
+    hdfspectrum = spectrumvector;
+    hdfinverse = inversevector;
+
     QApplication::setOverrideCursor(( Qt::WaitCursor));
-    QFuture<void> future = QtConcurrent::run(doComposeGeostationaryHDFInThread, this, strlist, spectrumvector, inversevector);
+    QFuture<void> future = DecodePool::instance()->runDecode(0, std::bind(doComposeGeostationaryHDFInThread, this, strlist, spectrumvector, inversevector));
     watcherRed[0].setFuture(future);
 
     return true;
@@ -253,6 +369,11 @@ bool SegmentListGeostationary::ComposeImageHDFSerial(QFileInfo fileinfo, QVector
     qDebug() << QString("SegmentListGeostationary::ComposeImageHDFSerial spectrumvector = %1 %2 %3").arg(spectrumvector.at(0)).arg(spectrumvector.at(1)).arg(spectrumvector.at(2));
     qDebug() << QString("SegmentListGeostationary::ComposeImageHDFSerial kindofimage = %1").arg(kindofimage);
 
+    if(!composedfiles.contains(fileinfo.filePath()))
+        composedfiles.append(fileinfo.filePath());
+    composedspectrum = spectrumvector;
+    composedinverse = inversevector;
+
     if(kindofimage == "VIS_IR" || kindofimage == "VIS_IR Color")
     {
 
@@ -319,6 +440,149 @@ void SegmentListGeostationary::InsertPresent( QVector<QString> spectrumvector, Q
 
 }
 
+// Works out which lines of the geostationary image can reach the current projection, so CreateGeoImageXRIT
+// leaves the other segments compressed. Only for the images where the lines of pixgeoConversion are the lines
+// of ptrimageGeostationary and a missing segment stays black : the full disk of MET_8, MET_10, MET_7 and GOES,
+// and the full HRV. Rapid scan, HRV Color and Himawari (which needs all its segments for the stretch)
+// decode every segment. The segments left out are kept with DeferSegment for ComposeForProjection.
+void SegmentListGeostationary::SetupProjectionRegion(QVector<QString> spectrumvector, QVector<bool> inversevector)
+{
+    int rows = imageptrs->ptrimageGeostationary->height();
+    int cols = imageptrs->ptrimageGeostationary->width();
+
+    projectionsegmentlines = 0;
+    projectionregion = ProjectionExtent::fullRegion(rows, cols);
+    projectiondeferred.clear();
+    projectionspectrum = spectrumvector;
+    projectioninverse = inversevector;
+
+    if(m_GeoSatellite == MET_10 || m_GeoSatellite == MET_8)
+    {
+        if(kindofimage == "VIS_IR" || kindofimage == "VIS_IR Color" || (kindofimage == "HRV" && areatype == 1))
+            projectionsegmentlines = 464;
+    }
+    else if(m_GeoSatellite == MET_7)
+        projectionsegmentlines = 500;
+    else if(m_GeoSatellite == GOES_13 || m_GeoSatellite == GOES_15)
+        projectionsegmentlines = 464;
+
+    if(projectionsegmentlines == 0)
+        return;
+
+    ProjectionExtent extent;
+    if(!extent.isActive())
+    {
+        projectionsegmentlines = 0;
+        return;
+    }
+
+    ArrayRegion region = extent.geostationaryRegion(geosatlon, COFF, LOFF, CFAC, LFAC, rows, cols);
+    if(region.nbrrows <= 0)
+    {
+        // nothing of this satellite in the projection, show the whole disk rather than an empty image
+        projectionsegmentlines = 0;
+        return;
+    }
+
+    projectionregion = region;
+}
+
+bool SegmentListGeostationary::isSegmentInProjection(int filesequence)
+{
+    if(projectionsegmentlines == 0)
+        return true;
+
+    int nbrsegments = imageptrs->ptrimageGeostationary->height() / projectionsegmentlines;
+    int firstline;
+
+    // the same line order as ComposeSegmentImageXRIT
+    if(m_GeoSatellite == GOES_13 || m_GeoSatellite == GOES_15)
+        firstline = projectionsegmentlines * filesequence;
+    else
+        firstline = projectionsegmentlines * (nbrsegments - 1 - filesequence);
+
+    return firstline < projectionregion.firstrow + projectionregion.nbrrows &&
+            firstline + projectionsegmentlines > projectionregion.firstrow;
+}
+
+void SegmentListGeostationary::DeferSegment(QString filepath)
+{
+    projectiondeferred.append(filepath);
+}
+
+// Called by the projections before they read ptrimageGeostationary. The image was decoded for the projection
+// of the time; when the current one reaches further, the deferred XRIT segments it needs are decoded now,
+// and the FY2 datasets are read again for the new region. Waits until the image is complete.
+void SegmentListGeostationary::ComposeForProjection()
+{
+    ReloadReleasedBuffers();
+
+    int rows = imageptrs->ptrimageGeostationary->height();
+    int cols = imageptrs->ptrimageGeostationary->width();
+
+    if(m_GeoSatellite == FY2E || m_GeoSatellite == FY2G)
+    {
+        if(hdffilelist.isEmpty())
+            return;
+
+        watcherRed[0].waitForFinished();
+
+        int nomsize = (kindofimage == "HRV" ? 9152 : 2288);
+        ProjectionExtent extent;
+        ArrayRegion region = extent.geostationaryRegion(geosatlon, COFF, LOFF, CFAC, LFAC, nomsize, nomsize);
+        if(ProjectionExtent::containsRegion(hdfregion, region))
+            return;
+
+        qDebug() << QString("SegmentListGeostationary::ComposeForProjection read FY2 again rows %1 - %2")
+                    .arg(region.firstrow).arg(region.firstrow + region.nbrrows);
+
+        // not through watcherRed[0] or imagefinished, they would put the geostationary image back on screen
+        // in place of the projection
+        blockSignals(true);
+        QFuture<void> future = DecodePool::instance()->runDecode(0, std::bind(doComposeGeostationaryHDFInThread, this, hdffilelist, hdfspectrum, hdfinverse));
+        future.waitForFinished();
+        blockSignals(false);
+        return;
+    }
+
+    if(projectionsegmentlines == 0 || projectiondeferred.isEmpty())
+        return;
+
+    ProjectionExtent extent;
+    ArrayRegion region = (extent.isActive() ? extent.geostationaryRegion(geosatlon, COFF, LOFF, CFAC, LFAC, rows, cols) :
+                                               ProjectionExtent::fullRegion(rows, cols));
+    projectionregion = ProjectionExtent::unionRegion(projectionregion, region);
+
+    QStringList deferred = projectiondeferred;
+    QList<QFuture<void> > futures;
+    projectiondeferred.clear();
+
+    for(int j = 0; j < deferred.size(); j++)
+    {
+        QFileInfo fileinfo(deferred.at(j));
+        int filesequence = fileinfo.fileName().mid(36, 6).toInt()-1;
+        QString filespectrum = fileinfo.fileName().mid(26, 6);
+
+        if(!isSegmentInProjection(filesequence))
+        {
+            projectiondeferred.append(deferred.at(j));
+            continue;
+        }
+
+        qDebug() << QString("SegmentListGeostationary::ComposeForProjection ----> %1").arg(fileinfo.filePath());
+        InsertPresent(projectionspectrum, filespectrum, filesequence);
+        composedfiles.append(fileinfo.filePath());
+
+        // the GUI watchers of the segments are left alone, their finished() would show the geostationary
+        // image in place of the projection
+        QFutureWatcher<void> *watcher;
+        futures.append(DecodeSegmentXRIT(fileinfo, projectionspectrum, projectioninverse, &watcher));
+    }
+
+    for(int j = 0; j < futures.size(); j++)
+        futures[j].waitForFinished();
+}
+
 //void SegmentListGeostationary::ComposeSegmentImageXRIT( QString filepath, int channelindex, QVector<QString> spectrumvector, QVector<bool> inversevector )
 //{
 
@@ -543,6 +807,7 @@ void SegmentListGeostationary::InsertPresent( QVector<QString> spectrumvector, Q
 
 void SegmentListGeostationary::ComposeSegmentImageXRIT( QString filepath, int channelindex, QVector<QString> spectrumvector, QVector<bool> inversevector )
 {
+    TraceSpan span("compose", "SegmentListGeostationary::ComposeSegmentImageXRIT", filepath);
 
     QRgb *row_col;
 
@@ -571,9 +836,11 @@ void SegmentListGeostationary::ComposeSegmentImageXRIT( QString filepath, int ch
         return;
     }
 
+    TraceSpan decodespan("decode", "HRIT read_from", filepath);
     header->read_from(hrit);
     msgdat->read_from(hrit, *header);
     hrit.close();
+    decodespan.finish();
 
     if (header->segment_id->data_field_format == MSG_NO_FORMAT)
     {
@@ -614,31 +881,26 @@ void SegmentListGeostationary::ComposeSegmentImageXRIT( QString filepath, int ch
 
     if (filespectrum == "HRV___")
     {
-        imageptrs->ptrHRV[filesequence] = new quint16[number_of_lines * number_of_columns];
-        memset(imageptrs->ptrHRV[filesequence], 0, number_of_lines * number_of_columns *sizeof(quint16));
+        imageptrs->NewGeostationaryBuffer(imageptrs->ptrHRV, imageptrs->sizeHRV, filesequence, number_of_lines * number_of_columns);
     }
     else if(m_GeoSatellite == MET_7 || m_GeoSatellite == GOES_13 || m_GeoSatellite == GOES_15)
     {
-        imageptrs->ptrRed[filesequence] = new quint16[number_of_lines * number_of_columns];
-        memset(imageptrs->ptrRed[filesequence], 0, number_of_lines * number_of_columns *sizeof(quint16));
+        imageptrs->NewGeostationaryBuffer(imageptrs->ptrRed, imageptrs->sizeRed, filesequence, number_of_lines * number_of_columns);
 
     }
     else
     {
         if(channelindex == 0)
         {
-            imageptrs->ptrRed[filesequence] = new quint16[number_of_lines * number_of_columns];
-            memset(imageptrs->ptrRed[filesequence], 0, number_of_lines * number_of_columns *sizeof(quint16));
+            imageptrs->NewGeostationaryBuffer(imageptrs->ptrRed, imageptrs->sizeRed, filesequence, number_of_lines * number_of_columns);
         }
         else if(channelindex == 1)
         {
-            imageptrs->ptrGreen[filesequence] = new quint16[number_of_lines * number_of_columns];
-            memset(imageptrs->ptrGreen[filesequence], 0, number_of_lines * number_of_columns *sizeof(quint16));
+            imageptrs->NewGeostationaryBuffer(imageptrs->ptrGreen, imageptrs->sizeGreen, filesequence, number_of_lines * number_of_columns);
         }
         else if(channelindex == 2)
         {
-            imageptrs->ptrBlue[filesequence] = new quint16[number_of_lines * number_of_columns];
-            memset(imageptrs->ptrBlue[filesequence], 0, number_of_lines * number_of_columns *sizeof(quint16));
+            imageptrs->NewGeostationaryBuffer(imageptrs->ptrBlue, imageptrs->sizeBlue, filesequence, number_of_lines * number_of_columns);
         }
     }
 
@@ -675,6 +937,34 @@ void SegmentListGeostationary::ComposeSegmentImageXRIT( QString filepath, int ch
         }
     }
 
+    // brightness temperatures of a single MSG infrared channel, in the line and column order of ptrimageGeostationary
+    const float *bttable = NULL;
+    if(kindofimage == "VIS_IR" && (m_GeoSatellite == MET_10 || m_GeoSatellite == MET_9 || m_GeoSatellite == MET_8))
+        bttable = imageptrs->calibrationgeo.table(filespectrum);
+
+    if(bttable != NULL && npix <= im->width())
+    {
+        int width = im->width();
+        if(imageptrs->ptrBrightnessTempGeostationary.isNull())
+        {
+            size_t size = (size_t)width * im->height();
+            imageptrs->ptrBrightnessTempGeostationary.reset(new float[size]);
+            std::fill(imageptrs->ptrBrightnessTempGeostationary.data(), imageptrs->ptrBrightnessTempGeostationary.data() + size, -1.0f);
+        }
+
+        for(int line = 0; line < nlin; line++)
+        {
+            int imageline = nlin * planned_end_segment - 1 - nlin * filesequence - line;
+            if(imageline < 0 || imageline >= im->height())
+                continue;
+            float *btrow = imageptrs->ptrBrightnessTempGeostationary.data() + (size_t)imageline * width;
+            const MSG_SAMPLE *pixrow = pixels + line * npix;
+            for (int pixelx = 0 ; pixelx < npix; pixelx++)
+                btrow[npix - 1 - pixelx] = bttable[pixrow[pixelx] & (CALIBRATION_COUNTS - 1)];
+        }
+    }
+
+
 
 //    quint16 stat_min;
 //    quint16 stat_max;
@@ -756,8 +1046,9 @@ void SegmentListGeostationary::ComposeSegmentImageXRIT( QString filepath, int ch
                 row_col[npix - 1 - pixelx] = qRgb(r,g,b);
 
             }
-            else if( kindofimage == "VIS_IR" || kindofimage == "HRV")
+            else if( kindofimage == "VIS_IR" || kindofimage == "HRV" || (kindofimage == "HRV Color" && filespectrum == "HRV___"))
             {
+                // for HRV Color the grey HRV segment is shown until ComposeColorHRV overwrites it
                 if(inversevector[0])
                     valcontrast = 255 - valcontrast;
 
@@ -795,14 +1086,27 @@ void SegmentListGeostationary::ComposeSegmentImageXRIT( QString filepath, int ch
         qDebug() << QString("channelindex = %1 filesequence = %2 ").arg(channelindex).arg(filesequence);
     }
 
+    bool segmentshown = (kindofimage == "VIS_IR" || kindofimage == "VIS_IR Color" || kindofimage == "HRV" || (kindofimage == "HRV Color" && filespectrum == "HRV___"));
+    bool segmentcomplete = (kindofimage == "VIS_IR Color" ? isSegmentComposedRGB(filesequence) : true);
+
     if(kindofimage == "HRV Color" && allHRVColorSegmentsReceived())
     {
         qDebug() << "-----> HRV Color and allHRVColorSegmentsReceived";
         this->ComposeColorHRV();
     }
 
+    // the CLAHE histograms of the image without this segment are no longer valid
+    imageptrs->geostationarygeneration.ref();
+
     g_mutex.unlock();
 
+    if(segmentshown)
+    {
+        if(m_GeoSatellite == GOES_13 || m_GeoSatellite == GOES_15)
+            emit segmentcomposed(nlin * filesequence, nlin, segmentcomplete);
+        else
+            emit segmentcomposed(nlin * (planned_end_segment - 1 - filesequence), nlin, segmentcomplete);
+    }
 
     delete header;
     delete msgdat;
@@ -812,6 +1116,7 @@ void SegmentListGeostationary::ComposeSegmentImageXRIT( QString filepath, int ch
 
 void SegmentListGeostationary::ComposeSegmentImageXRITHimawari( QString filepath, int channelindex, QVector<QString> spectrumvector, QVector<bool> inversevector )
 {
+    TraceSpan span("compose", "SegmentListGeostationary::ComposeSegmentImageXRITHimawari", filepath);
 //IMG_DK01B04_201510090000_001.bz2
 //012345678901234567890123456789
     QRgb *row_col;
@@ -842,7 +1147,7 @@ void SegmentListGeostationary::ComposeSegmentImageXRITHimawari( QString filepath
     fileout.open(QIODevice::WriteOnly);
     QDataStream streamout(&fileout);
 
-
+    TraceSpan bz2span("bz2", "BZ2_bzRead", fileinfo);
     if((bzfile = BZ2_bzopen(fileinfo.absoluteFilePath().toLatin1(),"rb"))==NULL)
     {
         qDebug() << "error in BZ2_bzopen";
@@ -861,6 +1166,7 @@ void SegmentListGeostationary::ComposeSegmentImageXRITHimawari( QString filepath
     BZ2_bzclose ( bzfile );
 
     fileout.close();
+    bz2span.finish();
 
     QByteArray ba = basename.toLatin1();
     const char *c_segname = ba.data();
@@ -873,9 +1179,11 @@ void SegmentListGeostationary::ComposeSegmentImageXRITHimawari( QString filepath
         return;
     }
 
+    TraceSpan decodespan("decode", "HRIT read_from_himawari", filepath);
     header->read_from(hrit);
     msgdat->read_from_himawari(hrit, *header);
     hrit.close();
+    decodespan.finish();
 
     if (header->segment_id->data_field_format == MSG_NO_FORMAT)
     {
@@ -908,18 +1216,15 @@ void SegmentListGeostationary::ComposeSegmentImageXRITHimawari( QString filepath
 
     if(channelindex == 0)
     {
-        imageptrs->ptrRed[filesequence] = new quint16[number_of_lines * number_of_columns];
-        memset(imageptrs->ptrRed[filesequence], 0, number_of_lines * number_of_columns *sizeof(quint16));
+        imageptrs->NewGeostationaryBuffer(imageptrs->ptrRed, imageptrs->sizeRed, filesequence, number_of_lines * number_of_columns);
     }
     else if(channelindex == 1)
     {
-        imageptrs->ptrGreen[filesequence] = new quint16[number_of_lines * number_of_columns];
-        memset(imageptrs->ptrGreen[filesequence], 0, number_of_lines * number_of_columns *sizeof(quint16));
+        imageptrs->NewGeostationaryBuffer(imageptrs->ptrGreen, imageptrs->sizeGreen, filesequence, number_of_lines * number_of_columns);
     }
     else if(channelindex == 2)
     {
-        imageptrs->ptrBlue[filesequence] = new quint16[number_of_lines * number_of_columns];
-        memset(imageptrs->ptrBlue[filesequence], 0, number_of_lines * number_of_columns *sizeof(quint16));
+        imageptrs->NewGeostationaryBuffer(imageptrs->ptrBlue, imageptrs->sizeBlue, filesequence, number_of_lines * number_of_columns);
     }
 
 
@@ -1027,10 +1332,13 @@ void SegmentListGeostationary::ComposeSegmentImageXRITHimawari( QString filepath
         else if(channelindex == 2)
             this->issegmentcomposedBlue[filesequence] = true;
 
+    bool segmentcomplete = (kindofimage == "VIS_IR Color" ? isSegmentComposedRGB(filesequence) : true);
 
+    imageptrs->geostationarygeneration.ref();
 
     g_mutex.unlock();
 
+    emit segmentcomposed(nlin * filesequence, nlin, segmentcomplete);
 
     delete header;
     delete msgdat;
@@ -1130,8 +1438,23 @@ void SegmentListGeostationary::recalcHimawari()
 
 }
 
+// Inflates the gzipped FY2 file into hdfimage[index] and opens it as an HDF5 file image, without a
+// temporary file. The buffer must stay untouched until the file is closed. It is kept for the next
+// cycle, at most FY2_MAX_HDF_IMAGE, and only given back by releaseMemory().
+hid_t SegmentListGeostationary::OpenHDFImage(QString filepath, int index)
+{
+    if(!QCompressor::gzipDecompressFile(filepath, hdfimage[index], FY2_MAX_HDF_IMAGE))
+    {
+        qDebug() << "-----> gzipDecompress failed ! " << filepath;
+        return -1;
+    }
+
+    return H5LTopen_file_image(hdfimage[index].data(), hdfimage[index].size(), H5LT_FILE_IMAGE_DONT_COPY | H5LT_FILE_IMAGE_DONT_RELEASE);
+}
+
 void SegmentListGeostationary::ComposeSegmentImageHDF( QFileInfo fileinfo, int channelindex, QVector<QString> spectrumvector, QVector<bool> inversevector )
 {
+    TraceSpan span("compose", "SegmentListGeostationary::ComposeSegmentImageHDF", fileinfo);
 
     double gamma = opts.meteosatgamma;
     quint16 valgamma;
@@ -1143,65 +1466,41 @@ void SegmentListGeostationary::ComposeSegmentImageHDF( QFileInfo fileinfo, int c
     int r,g, b;
 
     QImage *im;
-    QString outfilename;
 
     im = imageptrs->ptrimageGeostationary;
 
-    {
-        QFile inFile(fileinfo.filePath());
-        inFile.open(QIODevice::ReadOnly);
-        QByteArray compressed = inFile.readAll();
-
-        QByteArray decompressed;
-        outfilename = fileinfo.fileName().mid(0, fileinfo.fileName().length()-3);
-
-        QFile outfile(outfilename);
-        if(QCompressor::gzipDecompress(compressed, decompressed))
-        {
-            outfile.open(QIODevice::WriteOnly);
-            QDataStream out(&outfile);
-            out.writeRawData(decompressed.constData(), decompressed.length());
-        }
-        else
-            qDebug() << "-----> gzipDecompress failed !";
-    }
-
     qDebug() << "fileinfo.filepath = " << fileinfo.filePath();
-    qDebug() << "outfilename = " << outfilename;
+
+    DecodeBuffer decodebuffer;
 
     QString DatasetName;
 
 
     if(kindofimage == "VIS_IR")
     {
-        imageptrs->ptrRed[0] = new quint16[2288 * 2288];
-        memset(imageptrs->ptrRed[0], 0, 2288 * 2288 * sizeof(quint16));
+        imageptrs->NewGeostationaryBuffer(imageptrs->ptrRed, imageptrs->sizeRed, 0, 2288 * 2288);
         DatasetName = "/NOMChannel" + spectrumvector.at(0);
     }
     else if(kindofimage == "VIS_IR Color")
     {
         if(channelindex == 0)
         {
-            imageptrs->ptrRed[0] = new quint16[2288 * 2288];
-            memset(imageptrs->ptrRed[0], 0, 2288 * 2288 * sizeof(quint16));
+            imageptrs->NewGeostationaryBuffer(imageptrs->ptrRed, imageptrs->sizeRed, 0, 2288 * 2288);
             DatasetName = "/NOMChannel" + spectrumvector.at(0);
         }
         else if(channelindex == 1)
         {
-            imageptrs->ptrGreen[0] = new quint16[2288 * 2288];
-            memset(imageptrs->ptrGreen[0], 0, 2288 * 2288 * sizeof(quint16));
+            imageptrs->NewGeostationaryBuffer(imageptrs->ptrGreen, imageptrs->sizeGreen, 0, 2288 * 2288);
             DatasetName = "/NOMChannel" + spectrumvector.at(1);
         }
         else if(channelindex == 2)
         {
-            imageptrs->ptrBlue[0] = new quint16[2288 * 2288];
-            memset(imageptrs->ptrBlue[0], 0, 2288 * 2288 * sizeof(quint16));
+            imageptrs->NewGeostationaryBuffer(imageptrs->ptrBlue, imageptrs->sizeBlue, 0, 2288 * 2288);
             DatasetName = "/NOMChannel" + spectrumvector.at(2);
         }
     } else if(kindofimage == "HRV")
     {
-        imageptrs->ptrRed[0] = new quint16[9152 * 9152];
-        memset(imageptrs->ptrRed[0], 0, 9152 * 9152 * sizeof(quint16));
+        imageptrs->NewGeostationaryBuffer(imageptrs->ptrRed, imageptrs->sizeRed, 0, 9152 * 9152);
         DatasetName = "/NOMChannelVIS1KM";
     }
 
@@ -1211,8 +1510,8 @@ void SegmentListGeostationary::ComposeSegmentImageHDF( QFileInfo fileinfo, int c
     hid_t   h5_file_id, nomfileinfo_id, nomchannel_id;
     herr_t  h5_status;
 
-    if( (h5_file_id = H5Fopen(outfilename.toLatin1(), H5F_ACC_RDONLY, H5P_DEFAULT)) < 0)
-        qDebug() << "File " << outfilename << " not open !!";
+    if( (h5_file_id = OpenHDFImage(fileinfo.filePath(), channelindex)) < 0)
+        qDebug() << "File " << fileinfo.filePath() << " not open !!";
 
 
     if( (nomfileinfo_id = H5Dopen2(h5_file_id, "/NomFileInfo", H5P_DEFAULT)) < 0)
@@ -1225,34 +1524,33 @@ void SegmentListGeostationary::ComposeSegmentImageHDF( QFileInfo fileinfo, int c
     else
         qDebug() << "Dataset '" << DatasetName << "' is open";
 
+    int nomsize = (kindofimage == "HRV" ? 9152 : 2288);
+    ProjectionExtent extent;
+    ArrayRegion region = extent.geostationaryRegion(geosatlon, COFF, LOFF, CFAC, LFAC, nomsize, nomsize);
+
     if(kindofimage == "VIS_IR")
     {
-        if((h5_status = H5Dread (nomchannel_id, H5T_NATIVE_INT16_g, H5S_ALL, H5S_ALL,
-                                 H5P_DEFAULT, imageptrs->ptrRed[0])) < 0)
+        if((h5_status = ProjectionExtent::readRegion(nomchannel_id, H5T_NATIVE_INT16_g, nomsize, nomsize, region, imageptrs->ptrRed[0])) < 0)
             qDebug() << "Unable to read NOMChannel" << spectrumvector.at(0) << " dataset";
     }
     else if(kindofimage == "VIS_IR Color")
     {
         if(channelindex == 0)
         {
-            if((h5_status = H5Dread (nomchannel_id, H5T_NATIVE_INT16_g, H5S_ALL, H5S_ALL,
-                                     H5P_DEFAULT, imageptrs->ptrRed[0])) < 0)
+            if((h5_status = ProjectionExtent::readRegion(nomchannel_id, H5T_NATIVE_INT16_g, nomsize, nomsize, region, imageptrs->ptrRed[0])) < 0)
                 qDebug() << "Unable to read NOMChannel" << spectrumvector.at(0) << " dataset";
         } else if(channelindex == 1)
         {
-            if((h5_status = H5Dread (nomchannel_id, H5T_NATIVE_INT16_g, H5S_ALL, H5S_ALL,
-                                     H5P_DEFAULT, imageptrs->ptrGreen[0])) < 0)
+            if((h5_status = ProjectionExtent::readRegion(nomchannel_id, H5T_NATIVE_INT16_g, nomsize, nomsize, region, imageptrs->ptrGreen[0])) < 0)
                 qDebug() << "Unable to read NOMChannel" << spectrumvector.at(1) << " dataset";
         } else if(channelindex == 2)
         {
-            if((h5_status = H5Dread (nomchannel_id, H5T_NATIVE_INT16_g, H5S_ALL, H5S_ALL,
-                                     H5P_DEFAULT, imageptrs->ptrBlue[0])) < 0)
+            if((h5_status = ProjectionExtent::readRegion(nomchannel_id, H5T_NATIVE_INT16_g, nomsize, nomsize, region, imageptrs->ptrBlue[0])) < 0)
                 qDebug() << "Unable to read NOMChannel" << spectrumvector.at(2) << " dataset";
         }
     } else if(kindofimage == "HRV")
     {
-        if((h5_status = H5Dread (nomchannel_id, H5T_NATIVE_INT16_g, H5S_ALL, H5S_ALL,
-                                 H5P_DEFAULT, imageptrs->ptrRed[0])) < 0)
+        if((h5_status = ProjectionExtent::readRegion(nomchannel_id, H5T_NATIVE_INT16_g, nomsize, nomsize, region, imageptrs->ptrRed[0])) < 0)
             qDebug() << "Unable to read NOMChannel" << spectrumvector.at(0) << " dataset";
     }
 
@@ -1375,6 +1673,8 @@ void SegmentListGeostationary::ComposeSegmentImageHDF( QFileInfo fileinfo, int c
         this->issegmentcomposedMono[0] = true;
     }
 
+    imageptrs->geostationarygeneration.ref();
+
     g_mutex.unlock();
 
     H5Dclose(nomfileinfo_id);
@@ -1387,6 +1687,7 @@ void SegmentListGeostationary::ComposeSegmentImageHDF( QFileInfo fileinfo, int c
 
 void SegmentListGeostationary::ComposeSegmentImageHDFInThread(QStringList filelist, QVector<QString> spectrumvector, QVector<bool> inversevector )
 {
+    TraceSpan span("compose", "SegmentListGeostationary::ComposeSegmentImageHDFInThread", filelist);
 
     quint8 valcontrastred, valcontrastgreen, valcontrastblue;
     QRgb *row_col;
@@ -1395,56 +1696,28 @@ void SegmentListGeostationary::ComposeSegmentImageHDFInThread(QStringList fileli
     int r,g, b;
 
     QImage *im;
-    QStringList outfilename;
 
     im = imageptrs->ptrimageGeostationary;
 
-    for(int j = 0; j < filelist.size(); j++)
-    {
-        QFile inFile(this->getImagePath() + "/" + filelist.at(j));
-        inFile.open(QIODevice::ReadOnly);
-        QByteArray compressed = inFile.readAll();
-
-        QByteArray decompressed;
-        outfilename.append(filelist.at(j).mid(0, filelist.at(j).length()-3));
-
-        QFile outfile(filelist.at(j).mid(0, filelist.at(j).length()-3));
-        if(QCompressor::gzipDecompress(compressed, decompressed))
-        {
-            outfile.open(QIODevice::WriteOnly);
-            QDataStream out(&outfile);
-            out.writeRawData(decompressed.constData(), decompressed.length());
-            qDebug() << "writing decompressed file " << outfilename.at(j);
-        }
-        else
-            qDebug() << "-----> gzipDecompress failed !";
-
-    }
-
     QStringList DatasetName;
 
     if(kindofimage == "VIS_IR")
     {
-        imageptrs->ptrRed[0] = new quint16[2288 * 2288];
-        memset(imageptrs->ptrRed[0], 0, 2288 * 2288 * sizeof(quint16));
+        imageptrs->NewGeostationaryBuffer(imageptrs->ptrRed, imageptrs->sizeRed, 0, 2288 * 2288);
         DatasetName.append("/NOMChannel" + filelist.at(0).mid(40, 3));
     }
     else if(kindofimage == "VIS_IR Color")
     {
-        imageptrs->ptrRed[0] = new quint16[2288 * 2288];
-        memset(imageptrs->ptrRed[0], 0, 2288 * 2288 * sizeof(quint16));
+        imageptrs->NewGeostationaryBuffer(imageptrs->ptrRed, imageptrs->sizeRed, 0, 2288 * 2288);
         DatasetName.append("/NOMChannel" + filelist.at(0).mid(40, 3));
-        imageptrs->ptrGreen[0] = new quint16[2288 * 2288];
-        memset(imageptrs->ptrGreen[0], 0, 2288 * 2288 * sizeof(quint16));
+        imageptrs->NewGeostationaryBuffer(imageptrs->ptrGreen, imageptrs->sizeGreen, 0, 2288 * 2288);
         DatasetName.append("/NOMChannel" + filelist.at(1).mid(40, 3));
-        imageptrs->ptrBlue[0] = new quint16[2288 * 2288];
-        memset(imageptrs->ptrBlue[0], 0, 2288 * 2288 * sizeof(quint16));
+        imageptrs->NewGeostationaryBuffer(imageptrs->ptrBlue, imageptrs->sizeBlue, 0, 2288 * 2288);
         DatasetName.append("/NOMChannel" + filelist.at(2).mid(40, 3));
     }
     else if(kindofimage == "HRV")
     {
-        imageptrs->ptrRed[0] = new quint16[9152 * 9152];
-        memset(imageptrs->ptrRed[0], 0, 9152 * 9152 * sizeof(quint16));
+        imageptrs->NewGeostationaryBuffer(imageptrs->ptrRed, imageptrs->sizeRed, 0, 9152 * 9152);
         DatasetName.append("/NOMChannelVIS1KM");
     }
 
@@ -1457,8 +1730,8 @@ void SegmentListGeostationary::ComposeSegmentImageHDFInThread(QStringList fileli
     for(int j = 0; j < filelist.size(); j++)
     {
 
-        if( (h5_file_id[j] = H5Fopen(outfilename.at(j).toLatin1(), H5F_ACC_RDONLY, H5P_DEFAULT)) < 0)
-            qDebug() << "File " << outfilename.at(j) << " not open !!";
+        if( (h5_file_id[j] = OpenHDFImage(this->getImagePath() + "/" + filelist.at(j), j)) < 0)
+            qDebug() << "File " << filelist.at(j) << " not open !!";
 
 
         if( (nomfileinfo_id[j] = H5Dopen2(h5_file_id[j], "/NomFileInfo", H5P_DEFAULT)) < 0)
@@ -1472,27 +1745,27 @@ void SegmentListGeostationary::ComposeSegmentImageHDFInThread(QStringList fileli
             qDebug() << "Dataset '" << DatasetName.at(j) << "' is open";
     }
 
+    int nomsize = (kindofimage == "HRV" ? 9152 : 2288);
+    ProjectionExtent extent;
+    ArrayRegion region = extent.geostationaryRegion(geosatlon, COFF, LOFF, CFAC, LFAC, nomsize, nomsize);
+    hdfregion = region;
+
     if(kindofimage == "VIS_IR")
     {
-        if((h5_status[0] = H5Dread (nomchannel_id[0], H5T_NATIVE_INT16_g, H5S_ALL, H5S_ALL,
-                                    H5P_DEFAULT, imageptrs->ptrRed[0])) < 0)
+        if((h5_status[0] = ProjectionExtent::readRegion(nomchannel_id[0], H5T_NATIVE_INT16_g, nomsize, nomsize, region, imageptrs->ptrRed[0])) < 0)
             qDebug() << "Unable to read NOMChannel" << filelist.at(0).mid(40, 3) << " dataset";
     }
     else if(kindofimage == "VIS_IR Color")
     {
-        if((h5_status[0] = H5Dread (nomchannel_id[0], H5T_NATIVE_INT16_g, H5S_ALL, H5S_ALL,
-                                   H5P_DEFAULT, imageptrs->ptrRed[0])) < 0)
+        if((h5_status[0] = ProjectionExtent::readRegion(nomchannel_id[0], H5T_NATIVE_INT16_g, nomsize, nomsize, region, imageptrs->ptrRed[0])) < 0)
             qDebug() << "Unable to read NOMChannel" << filelist.at(0).mid(40, 3) << " dataset";
-        if((h5_status[1] = H5Dread (nomchannel_id[1], H5T_NATIVE_INT16_g, H5S_ALL, H5S_ALL,
-                                 H5P_DEFAULT, imageptrs->ptrGreen[0])) < 0)
+        if((h5_status[1] = ProjectionExtent::readRegion(nomchannel_id[1], H5T_NATIVE_INT16_g, nomsize, nomsize, region, imageptrs->ptrGreen[0])) < 0)
             qDebug() << "Unable to read NOMChannel" << filelist.at(1).mid(40, 3) << " dataset";
-        if((h5_status[2] = H5Dread (nomchannel_id[2], H5T_NATIVE_INT16_g, H5S_ALL, H5S_ALL,
-                                 H5P_DEFAULT, imageptrs->ptrBlue[0])) < 0)
+        if((h5_status[2] = ProjectionExtent::readRegion(nomchannel_id[2], H5T_NATIVE_INT16_g, nomsize, nomsize, region, imageptrs->ptrBlue[0])) < 0)
             qDebug() << "Unable to read NOMChannel" << filelist.at(2).mid(40, 3) << " dataset";
     } else if(kindofimage == "HRV")
     {
-        if((h5_status[0] = H5Dread (nomchannel_id[0], H5T_NATIVE_INT16_g, H5S_ALL, H5S_ALL,
-                                 H5P_DEFAULT, imageptrs->ptrRed[0])) < 0)
+        if((h5_status[0] = ProjectionExtent::readRegion(nomchannel_id[0], H5T_NATIVE_INT16_g, nomsize, nomsize, region, imageptrs->ptrRed[0])) < 0)
             qDebug() << "Unable to read NOMChannelVIS1KM dataset";
     }
 
@@ -1632,6 +1905,7 @@ void SegmentListGeostationary::ComposeSegmentImageHDFInThread(QStringList fileli
     qDebug() << "==============================end";
 
     this->issegmentcomposedMono[0] = true;
+    imageptrs->geostationarygeneration.ref();
 
     emit this->progressCounter(100);
 
@@ -1650,180 +1924,176 @@ void SegmentListGeostationary::ComposeSegmentImageHDFInThread(QStringList fileli
 
 }
 
-void SegmentListGeostationary::ComposeColorHRV()
+void doComposeColorHRVTile(HRVColorTile &tile)
 {
-    QRgb *row_col;
-    quint16 cred, cgreen, cblue, c, clum;
-    quint16 r,g, b;
+    tile.sl->ComposeColorHRVTile(*tile.rowsHRV, tile.clahe, tile.lut, tile.firstline, tile.lastline);
+}
 
+void SegmentListGeostationary::ComposeColorHRV()
+{
+    TraceSpan span("compose", "SegmentListGeostationary::ComposeColorHRV");
     double gamma = opts.meteosatgamma;
     double gammafactor = 1023 / pow(1023, gamma);
     quint16 valgamma;
-    quint8 valcontrast;
 
+    int nbrofsegments = (m_GeoSatellite == MET_9 ? 5 : (this->areatype == 1 ? 24 : 5));
+    int firstsegment = (nbrofsegments == 24 ? 0 : 19);
+    int nbroflines = nbrofsegments * 464;
 
-    size_t npix = 3712*3712;
-    size_t npixHRV;
+    // CLAHE and the low resolution channels read straight from the segment buffers
+    QVector<quint16> zerorow(5568, 0);
+    QVector<const quint16 *> rowsHRV(nbroflines);
 
-    if(m_GeoSatellite == MET_10 || m_GeoSatellite == MET_8)
-    {
-        if (this->areatype == 1)
-            npixHRV = 5568*11136;
-        else
-            npixHRV = 5568*5*464;
-    }
-    else if(m_GeoSatellite == MET_9)
+    for( int i = 0; i < nbrofsegments; i++)
     {
-        npixHRV = 5568*5*464;
-    }
-/*    else if(m_GeoSatellite == ELECTRO_N1)
-    {
-        npixHRV = 5568*5*464;
+        int k = firstsegment + i;
+        for( int line = 0; line < 464; line++)
+        {
+            if(isPresentHRV[k] && imageptrs->ptrHRV[k] != NULL)
+                rowsHRV[i * 464 + line] = imageptrs->ptrHRV[k] + line * 5568;
+            else
+                rowsHRV[i * 464 + line] = zerorow.constData();
+        }
     }
-*/
-
-    quint16 *pixelsRed;
-    quint16 *pixelsGreen;
-    quint16 *pixelsBlue;
-    quint16 *pixelsHRV;
-
-
-    pixelsRed = new quint16[npix];
-    pixelsGreen = new quint16[npix];
-    pixelsBlue = new quint16[npix];
-    pixelsHRV = new quint16[npixHRV];
 
+    CLAHEEngine clahe;
+    if(clahe.makeHistograms(rowsHRV, 5568, 0, 1023, 16, 16, 256) != 0)
+        return;
+    clahe.makeMappings(4);
 
-    for( int i = (m_GeoSatellite == MET_9 ? 5 : 0); i < 8; i++)
+    // gamma and contrast stretch of c*channel/luminance, everything from 1024 up ends at 1023
+    quint8 lut[1024];
+    for(int val = 0; val < 1024; val++)
     {
-        if(isPresentRed[i])
-            memcpy(pixelsRed + i * 464 * 3712, imageptrs->ptrRed[i], 464 * 3712 * sizeof(quint16));
-    }
-    for( int i = (m_GeoSatellite == MET_9 ? 5 : 0); i < 8; i++)
-    {
-        if(isPresentGreen[i])
-            memcpy(pixelsGreen + i * 464 * 3712, imageptrs->ptrGreen[i], 464 * 3712 * sizeof(quint16));
-    }
-    for( int i = (m_GeoSatellite == MET_9 ? 5 : 0); i < 8; i++)
-    {
-        if(isPresentBlue[i])
-            memcpy(pixelsBlue + i * 464 * 3712, imageptrs->ptrBlue[i], 464 * 3712 * sizeof(quint16));
+        valgamma = pow( val, gamma) * gammafactor;
+        if (valgamma >= 1024)
+            valgamma = 1023;
+        lut[val] = quint8(ContrastStretch(valgamma));
     }
 
-    for( int i = 0, k = 0; i < (m_GeoSatellite == MET_9 ? 5 : ( this->areatype == 1 ? 24 : 5)); i++)
+    QVector<HRVColorTile> tiles;
+    for(int line = 0; line < nbroflines; line += 116)
     {
-        k = (m_GeoSatellite == MET_9 ? 19 + i : (this->areatype == 1 ? i : 19 + i));
-        if(isPresentHRV[k])
-            memcpy(pixelsHRV + i * 464 * 5568, imageptrs->ptrHRV[k], 464 * 5568 * sizeof(quint16));
+        HRVColorTile tile;
+        tile.sl = this;
+        tile.rowsHRV = &rowsHRV;
+        tile.clahe = &clahe;
+        tile.lut = lut;
+        tile.firstline = line;
+        tile.lastline = qMin(line + 116, nbroflines);
+        tiles.append(tile);
     }
 
-    //imageptrs->CLAHE(pixelsRed, 3712, 3712, 0, 1023, 16, 16, 256, 15);
-    //imageptrs->CLAHE(pixelsGreen, 3712, 3712, 0, 1023, 16, 16, 256, 15);
-    //imageptrs->CLAHE(pixelsBlue, 3712, 3712, 0, 1023, 16, 16, 256, 15);
+    QtConcurrent::blockingMap(tiles, doComposeColorHRVTile);
 
-    if(m_GeoSatellite == MET_9)
-        imageptrs->CLAHE(pixelsHRV, 5568, 5*464, 0, 1023, 16, 16, 256, 4);
-    else
-    {
-        if(this->areatype == 1)
-            imageptrs->CLAHE(pixelsHRV, 5568, 11136, 0, 1023, 16, 16, 256, 4);
-        else
-            imageptrs->CLAHE(pixelsHRV, 5568, 5*464, 0, 1023, 16, 16, 256, 4);
-    }
+}
 
-    for (int line = (m_GeoSatellite == MET_9 ? 5 : (this->areatype == 1 ? 24 : 5))*464 - 1; line >= 0; line--)
-    {
-        row_col = (QRgb*)imageptrs->ptrimageGeostationary->scanLine((m_GeoSatellite == MET_9 ? 5 : (this->areatype == 1 ? 24 : 5))*464 - 1 - line);
+// Row of a low resolution channel (3712 wide) in the segment buffers, NULL when the segment is missing
+const quint16 *SegmentListGeostationary::lowResRow(quint16 **ptrsegments, bool *present, int line)
+{
+    int segment = line / 464;
+    if(segment < 0 || segment > 7 || !present[segment] || ptrsegments[segment] == NULL)
+        return NULL;
+    return ptrsegments[segment] + (line % 464) * 3712;
+}
 
-        for (int pixelx = 5568 - 1 ; pixelx >= 0; pixelx--)
-        {
-            c = *(pixelsHRV + line * 5568 + pixelx);
+void SegmentListGeostationary::ComposeColorHRVTile(const QVector<const quint16 *> &rowsHRV, const CLAHEEngine *clahe, const quint8 *lut, int firstline, int lastline)
+{
+    QRgb *row_col;
+    quint32 cred, cgreen, cblue, clum;
 
-            if(m_GeoSatellite == MET_9)
-            {
-                cred = *(pixelsRed + (19*464 + line)/3 * 3712 + LowerEastColumnActual/3 + pixelx/3);
-                cgreen = *(pixelsGreen + (19*464 + line)/3 * 3712 + LowerEastColumnActual/3 + pixelx/3);
-                cblue = *(pixelsBlue + (19*464 + line)/3 * 3712 + LowerEastColumnActual/3 + pixelx/3);
-                clum = (cred+cgreen+cblue)/3;
-                if( clum == 0)
-                    clum = 1;
+    int nbrofsegments = (m_GeoSatellite == MET_9 ? 5 : (this->areatype == 1 ? 24 : 5));
+    int firstsegment = (nbrofsegments == 24 ? 0 : 19);
+    int nbroflines = nbrofsegments * 464;
 
+    QVector<quint16> zerorow(3712, 0);
+    QVector<quint16> rowclahe(5568);
+    // colour of a low resolution pixel over its luminance in 16.16 fixed point, one entry per HRV pixel
+    QVector<quint32> factorred(5568), factorgreen(5568), factorblue(5568);
+    QVector<quint32> valred(5568), valgreen(5568), valblue(5568);
 
-            }
-            else
-            {
-            if(this->areatype == 0)
+    for (int line = firstline; line < lastline; line++)
+    {
+        row_col = (QRgb*)imageptrs->ptrimageGeostationary->scanLine(nbroflines - 1 - line);
+
+        int eastcolumn;
+        if(m_GeoSatellite == MET_9)
+            eastcolumn = LowerEastColumnActual;
+        else if(this->areatype == 0)
+            eastcolumn = UpperEastColumnActual;
+        else
+            eastcolumn = (line > UpperSouthLineActual ? UpperEastColumnActual : LowerEastColumnActual);
+        eastcolumn /= 3;
+
+        int lowresline = (firstsegment * 464 + line) / 3;
+        const quint16 *rowred = lowResRow(imageptrs->ptrRed, isPresentRed, lowresline);
+        const quint16 *rowgreen = lowResRow(imageptrs->ptrGreen, isPresentGreen, lowresline);
+        const quint16 *rowblue = lowResRow(imageptrs->ptrBlue, isPresentBlue, lowresline);
+        if(rowred == NULL)
+            rowred = zerorow.constData();
+        if(rowgreen == NULL)
+            rowgreen = zerorow.constData();
+        if(rowblue == NULL)
+            rowblue = zerorow.constData();
+
+        clahe->mapRow(line, rowsHRV.at(line), rowclahe.data());
+        const quint16 *rowhrv = rowclahe.constData();
+
+        // one low resolution pixel covers three HRV pixels, for 10 bit counts cred/clum <= 5 so c * factor fits in 32 bit
+        for (int col = 0; col < 5568/3; col++)
+        {
+            int lowrescol = qMin(eastcolumn + col, 3711);
+            cred = rowred[lowrescol];
+            cgreen = rowgreen[lowrescol];
+            cblue = rowblue[lowrescol];
+            clum = (cred + cgreen + cblue)/3;
+            if( clum == 0)
+                clum = 1;
+
+            quint32 fred = (cred << 16)/clum;
+            quint32 fgreen = (cgreen << 16)/clum;
+            quint32 fblue = (cblue << 16)/clum;
+            for (int pixelx = col * 3; pixelx < col * 3 + 3; pixelx++)
             {
-                cred = *(pixelsRed + (19*464 + line)/3 * 3712 + UpperEastColumnActual/3 + pixelx/3);
-                cgreen = *(pixelsGreen + (19*464 + line)/3 * 3712 + UpperEastColumnActual/3 + pixelx/3);
-                cblue = *(pixelsBlue + (19*464 + line)/3 * 3712 + UpperEastColumnActual/3 + pixelx/3);
-                clum = (cred+cgreen+cblue)/3;
-                if( clum == 0)
-                    clum = 1;
+                factorred[pixelx] = fred;
+                factorgreen[pixelx] = fgreen;
+                factorblue[pixelx] = fblue;
             }
-            else
-            {
-                if(line > UpperSouthLineActual)
-                {
-                    cred = *(pixelsRed + line/3 * 3712 + UpperEastColumnActual/3 + pixelx/3);
-                    cgreen = *(pixelsGreen + line/3 * 3712 + UpperEastColumnActual/3 + pixelx/3);
-                    cblue = *(pixelsBlue + line/3 * 3712 + UpperEastColumnActual/3 + pixelx/3);
-                    clum = (cred+cgreen+cblue)/3;
-                    if( clum == 0)
-                        clum = 1;
-                }
-                else
-                {
-                    cred = *(pixelsRed + line/3 * 3712 + LowerEastColumnActual/3 + pixelx/3);
-                    cgreen = *(pixelsGreen + line/3 * 3712 + LowerEastColumnActual/3 + pixelx/3);
-                    cblue = *(pixelsBlue + line/3 * 3712 + LowerEastColumnActual/3 + pixelx/3);
-                    clum = (cred+cgreen+cblue)/3;
-                    if( clum == 0)
-                        clum = 1;
-                }
-            }
-            }
-
-            valgamma = pow( c*cred/clum, gamma) * gammafactor;
-            if (valgamma >= 1024)
-                valgamma = 1023;
-
-            valcontrast = ContrastStretch(valgamma);
-            r = quint8(valcontrast);
-            if (r > 255)
-                r = 255;
-
-            valgamma = pow( c*cgreen/clum, gamma) * gammafactor;
-            if (valgamma >= 1024)
-                valgamma = 1023;
-
-            valcontrast = ContrastStretch(valgamma);
-            g = quint8(valcontrast);
-            if (g > 255)
-                g = 255;
-
-            valgamma = pow( c*cblue/clum, gamma) * gammafactor;
-            if (valgamma >= 1024)
-                valgamma = 1023;
-
-            valcontrast = ContrastStretch(valgamma);
-            b = quint8(valcontrast);
-            if (b > 255)
-                b = 255;
-            row_col[5568 - 1 - pixelx] = qRgb(r,g,b);
         }
-    }
 
+        // no division left, this loop is vectorised
+        const quint32 *fr = factorred.constData();
+        const quint32 *fg = factorgreen.constData();
+        const quint32 *fb = factorblue.constData();
+        quint32 *vr = valred.data();
+        quint32 *vg = valgreen.data();
+        quint32 *vb = valblue.data();
+        for (int pixelx = 0; pixelx < 5568; pixelx++)
+        {
+            quint32 c = rowhrv[pixelx];
+            vr[pixelx] = qMin((c * fr[pixelx]) >> 16, 1023u);
+            vg[pixelx] = qMin((c * fg[pixelx]) >> 16, 1023u);
+            vb[pixelx] = qMin((c * fb[pixelx]) >> 16, 1023u);
+        }
 
+        for (int pixelx = 0; pixelx < 5568; pixelx++)
+            row_col[5568 - 1 - pixelx] = qRgb(lut[vr[pixelx]], lut[vg[pixelx]], lut[vb[pixelx]]);
+    }
+}
 
-    delete [] pixelsRed;
-    delete [] pixelsGreen;
-    delete [] pixelsBlue;
-    delete [] pixelsHRV;
 
+// all channels present for this segment are composed, call with g_mutex locked
+bool SegmentListGeostationary::isSegmentComposedRGB(int filesequence)
+{
+    if (isPresentRed[filesequence] && issegmentcomposedRed[filesequence] == false)
+        return false;
+    if (isPresentGreen[filesequence] && issegmentcomposedGreen[filesequence] == false)
+        return false;
+    if (isPresentBlue[filesequence] && issegmentcomposedBlue[filesequence] == false)
+        return false;
+    return true;
 }
 
-
 bool SegmentListGeostationary::allHRVColorSegmentsReceived()
 {
     qDebug() << QString("SegmentListGeostationary::allHRVColorSegmentsReceived()");
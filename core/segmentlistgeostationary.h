@@ -4,8 +4,30 @@
 #include <QObject>
 #include <QFutureWatcher>
 #include <QFileInfo>
+#include <QVector>
+#include <hdf5/serial/hdf5.h>
+#include "projectionextent.h"
+#include "memorybudget.h"
+
+// largest inflated FY2 file, a 9152 x 9152 VIS1KM product with its other datasets
+#define FY2_MAX_HDF_IMAGE (512 * 1024 * 1024)
+
+class SegmentListGeostationary;
+class CLAHEEngine;
+
+struct HRVColorTile {
+    SegmentListGeostationary *sl;
+    const QVector<const quint16 *> *rowsHRV;
+    const CLAHEEngine *clahe;
+    const quint8 *lut;
+    int firstline;
+    int lastline;
+};
 
-class SegmentListGeostationary : public QObject
+// The channel buffers ptrRed/Green/Blue/HRV of imageptrs belong to the active list, they are counted in the
+// memory budget. When they are released the image on screen stays, the segments are decoded again by
+// ReloadReleasedBuffers() before CLAHE or a projection reads the buffers.
+class SegmentListGeostationary : public QObject, public MemoryOwner
 {
     Q_OBJECT
 
@@ -25,6 +47,13 @@ public:
     };
 
     explicit SegmentListGeostationary(QObject *parent = 0);
+    ~SegmentListGeostationary();
+
+    qint64 memoryInUse();
+    bool releaseMemory();
+    QString memoryOwnerName();
+    void ReloadReleasedBuffers();
+
     bool ComposeImageXRIT(QFileInfo fileinfo, QVector<QString> spectrumvector, QVector<bool> inversevector);
     bool ComposeImageHDFSerial(QFileInfo fileinfo, QVector<QString> spectrumvector, QVector<bool> inversevector);
     bool ComposeImageHDFInThread(QStringList strlist, QVector<QString> spectrumvector, QVector<bool> inversevector);
@@ -42,11 +71,17 @@ public:
 
     void ComposeSegmentImageHDF(QFileInfo fileinfo, int channelindex, QVector<QString> spectrumvector, QVector<bool> inversevector );
     void ComposeSegmentImageHDFInThread(QStringList filelist, QVector<QString> spectrumvector, QVector<bool> inversevector );
+    void ComposeColorHRVTile(const QVector<const quint16 *> &rowsHRV, const CLAHEEngine *clahe, const quint8 *lut, int firstline, int lastline);
     void SetupContrastStretch(quint16 x1, quint16 y1, quint16 x2, quint16 y2); //, quint16 x3, quint16 y3, quint16 x4, quint16 y4);
     quint16 ContrastStretch(quint16 val);
     void InsertPresent( QVector<QString> spectrumvector, QString filespectrum, int filesequence);
+    void SetupProjectionRegion(QVector<QString> spectrumvector, QVector<bool> inversevector);
+    bool isSegmentInProjection(int filesequence);
+    void DeferSegment(QString filepath);
+    void ComposeForProjection();
     bool allHRVColorSegmentsReceived();
     bool allSegmentsReceived();
+    bool isSegmentComposedRGB(int filesequence);
     bool bActiveSegmentList;
     bool bisRSS;
     eGeoSatellite getGeoSatellite() { return m_GeoSatellite; }
@@ -98,6 +133,9 @@ public:
 private:
 
     void ComposeColorHRV();
+    QFuture<void> DecodeSegmentXRIT(const QFileInfo &fileinfo, const QVector<QString> &spectrumvector, const QVector<bool> &inversevector, QFutureWatcher<void> **watcher);
+    const quint16 *lowResRow(quint16 **ptrsegments, bool *present, int line);
+    hid_t OpenHDFImage(QString filepath, int index);
 
     quint16 maxvalueRed[10];
     quint16 minvalueRed[10];
@@ -116,11 +154,30 @@ private:
     int number_of_columns;
     int number_of_lines;
 
+    ArrayRegion projectionregion;   // lines of ptrimageGeostationary that can reach the projection
+    int projectionsegmentlines;     // lines per segment, 0 when every segment is decoded
+    QStringList projectiondeferred; // segment files left out by CreateGeoImageXRIT
+    QVector<QString> projectionspectrum;
+    QVector<bool> projectioninverse;
+
+    QStringList hdffilelist;        // FY2 files of the last ComposeImageHDFInThread
+    QVector<QString> hdfspectrum;
+    QVector<bool> hdfinverse;
+    ArrayRegion hdfregion;          // part of the FY2 datasets in ptrRed/Green/Blue[0]
+
+    QStringList composedfiles;      // XRIT and serial FY2 files in the channel buffers
+    QVector<QString> composedspectrum;
+    QVector<bool> composedinverse;
+    bool memoryreleased;
+
+    QByteArray hdfimage[3];     // inflated FY2 files, one per channel, reused from cycle to cycle
+
 
 signals:
 
     void progressCounter(int val);
     void imagefinished();
+    void segmentcomposed(int firstline, int nbroflines, bool complete);
     
 public slots:
 
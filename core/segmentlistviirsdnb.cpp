@@ -39,6 +39,7 @@ bool SegmentListVIIRSDNB::ComposeVIIRSImage(QList<bool> bandlist, QList<int> col
 
 
     QApplication::setOverrideCursor(( Qt::WaitCursor));
+    memorybusy = true;
     watcherviirs = new QFutureWatcher<void>(this);
     connect(watcherviirs, SIGNAL(finished()), this, SLOT(finishedviirs()));
 
@@ -71,6 +72,7 @@ bool SegmentListVIIRSDNB::ComposeVIIRSImageInThread()
         ++segsel;
     }
     segsselected.clear();
+    memoryreleased = false;
 
     int startlinenbr = 0;
     int totalnbroflines = 0;
@@ -364,9 +366,33 @@ void SegmentListVIIRSDNB::finishedviirs()
     QApplication::restoreOverrideCursor();
     delete watcherviirs;
 
+    memorybusy = false;
+    MemoryBudget::instance()->update(this);
+
     emit segmentprojectionfinished(true);
 }
 
+// The HDF5 library is not thread safe, the segments are read one after the other
+void SegmentListVIIRSDNB::ReloadReleasedSegments()
+{
+    if(!memoryreleased)
+        return;
+
+    qDebug() << QString("SegmentListVIIRSDNB::ReloadReleasedSegments %1").arg(memoryOwnerName());
+
+    QList<Segment*>::iterator segsel = segsselected.begin();
+    while ( segsel != segsselected.end() )
+    {
+        SegmentVIIRSDNB *segm = (SegmentVIIRSDNB *)(*segsel);
+        segm->initializeMemory();
+        segm->ReadSegmentInMemory();
+        ++segsel;
+    }
+
+    memoryreleased = false;
+    MemoryBudget::instance()->update(this);
+}
+
 void SegmentListVIIRSDNB::progressreadvalue(int progress)
 {
     int totalcount = segsselected.count();
@@ -532,6 +558,8 @@ void SegmentListVIIRSDNB::sliderCentreBandChanged(int val)
     qDebug() << QString("lowerlimit = %1").arg(lowerlimit, 0, 'E', 2);
     qDebug() << QString("upperlimit = %1").arg(upperlimit, 0, 'E', 2);
 
+    ReloadReleasedSegments();
+
     QList<Segment*>::iterator segsel = segsselected.begin();
     while ( segsel != segsselected.end() )
     {
@@ -557,6 +585,7 @@ void SegmentListVIIRSDNB::spbWindowValueChanged(int spbwindowval, int slcentreba
     qDebug() << QString("lowerlimit = %1").arg(lowerlimit);
     qDebug() << QString("upperlimit = %1").arg(upperlimit);
 
+    ReloadReleasedSegments();
 
     QList<Segment*>::iterator segsel = segsselected.begin();
     while ( segsel != segsselected.end() )
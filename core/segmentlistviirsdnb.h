@@ -20,6 +20,7 @@ public:
     void sliderCentreBandChanged(int val);
     void spbWindowValueChanged(int spbwindowval, int slcentreband);
     float getMoonIllumination() { return moonillumination; }
+    void ReloadReleasedSegments();
 
     QScopedArrayPointer<long> graphvalues;
     QVector<double> xDNBcurve;
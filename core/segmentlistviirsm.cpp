@@ -43,6 +43,7 @@ bool SegmentListVIIRSM::ComposeVIIRSImage(QList<bool> bandlist, QList<int> color
     this->inverselist = invertlist;
 
     QApplication::setOverrideCursor(( Qt::WaitCursor));
+    memorybusy = true;
     watcherviirs = new QFutureWatcher<void>(this);
     connect(watcherviirs, SIGNAL(finished()), this, SLOT(finishedviirs()));
 
@@ -92,6 +93,7 @@ bool SegmentListVIIRSM::ComposeVIIRSImageInThread(QList<bool> bandlist, QList<in
         ++segsel;
     }
     segsselected.clear();
+    memoryreleased = false;
 
 
     int startlinenbr = 0;
@@ -231,6 +233,8 @@ void SegmentListVIIRSM::ComposeGVProjection(int inputchannel)
 {
 
     qDebug() << "SegmentListVIIRSM::ComposeGVProjection()";
+    ReloadReleasedSegments();
+    ReadMissingRegions();
     QList<Segment *>::iterator segit = segsselected.begin();
     while ( segit != segsselected.end() )
     {
@@ -258,6 +262,8 @@ void SegmentListVIIRSM::ComposeLCCProjection(int inputchannel)
 {
 
     qDebug() << "SegmentListVIIRSM::ComposeLCCProjection()";
+    ReloadReleasedSegments();
+    ReadMissingRegions();
     QList<Segment *>::iterator segit = segsselected.begin();
     while ( segit != segsselected.end() )
     {
@@ -273,6 +279,8 @@ void SegmentListVIIRSM::ComposeSGProjection(int inputchannel)
 {
 
     qDebug() << "SegmentListVIIRSM::ComposeSGProjection()";
+    ReloadReleasedSegments();
+    ReadMissingRegions();
     QList<Segment *>::iterator segit = segsselected.begin();
     while ( segit != segsselected.end() )
     {
@@ -398,7 +406,8 @@ void SegmentListVIIRSM::CalculateProjectionLUT()
                 {
                     x = segm->getProjectionX(line, pixelx);
                     y = segm->getProjectionY(line, pixelx);
-                    if(x >= 0 && x < imageptrs->ptrimageProjection->width() && y >= 0 && y < imageptrs->ptrimageProjection->height())
+                    if(x >= 0 && x < imageptrs->ptrimageProjection->width() && y >= 0 && y < imageptrs->ptrimageProjection->height() &&
+                            segm->isPixelRead(line, pixelx))
                     {
                         int pixel = *(segm->ptrbaVIIRS[k].data() + line * segm->earth_views_per_scanline + pixelx);
                         int pixcalc = 256 * (pixel - imageptrs->stat_min_ch[k]) / (imageptrs->stat_max_ch[k] - imageptrs->stat_min_ch[k]);
@@ -444,9 +453,56 @@ void SegmentListVIIRSM::finishedviirs()
     delete watcherviirs;
     QApplication::restoreOverrideCursor();
 
+    memorybusy = false;
+    MemoryBudget::instance()->update(this);
+
     emit segmentlistfinished(true);
 }
 
+// The HDF5 library is not thread safe, the segments are read one after the other
+void SegmentListVIIRSM::ReloadReleasedSegments()
+{
+    if(!memoryreleased)
+        return;
+
+    qDebug() << QString("SegmentListVIIRSM::ReloadReleasedSegments %1").arg(memoryOwnerName());
+
+    QList<Segment*>::iterator segsel = segsselected.begin();
+    while ( segsel != segsselected.end() )
+    {
+        SegmentVIIRSM *segm = (SegmentVIIRSM *)(*segsel);
+        segm->initializeMemory();
+        segm->ReadSegmentInMemory();
+        ++segsel;
+    }
+
+    memoryreleased = false;
+    MemoryBudget::instance()->update(this);
+}
+
+// ComposeVIIRSImage reads the radiances for the projection of the time. A segment that misses
+// a part of the current projection is read again.
+void SegmentListVIIRSM::ReadMissingRegions()
+{
+    bool reread = false;
+
+    QList<Segment*>::iterator segsel = segsselected.begin();
+    while ( segsel != segsselected.end() )
+    {
+        SegmentVIIRSM *segm = (SegmentVIIRSM *)(*segsel);
+        if(!segm->isRegionRead())
+        {
+            qDebug() << QString("SegmentListVIIRSM::ReadMissingRegions %1").arg(segm->fileInfo.fileName());
+            segm->ReadSegmentInMemory();
+            reread = true;
+        }
+        ++segsel;
+    }
+
+    if(reread)
+        MemoryBudget::instance()->update(this);
+}
+
 void SegmentListVIIRSM::progressreadvalue(int progress)
 {
     int totalcount = segsselected.count();
@@ -596,6 +652,8 @@ void SegmentListVIIRSM::CalculateLUT()
             {
                 for (int pixelx = 0; pixelx < segm->earth_views_per_scanline; pixelx++)
                 {
+                    if(!segm->isPixelRead(line, pixelx))
+                        continue;
                     int pixel = *(segm->ptrbaVIIRS[k].data() + line * segm->earth_views_per_scanline + pixelx);
                     int pixcalc = 256 * (pixel - imageptrs->stat_min_ch[k]) / (imageptrs->stat_max_ch[k] - imageptrs->stat_min_ch[k]);
                     pixcalc = ( pixcalc < 0 ? 0 : pixcalc);
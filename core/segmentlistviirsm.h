@@ -26,8 +26,10 @@ public:
     void ComposeGVProjection(int inputchannel);
     void ComposeLCCProjection(int inputchannel);
     void ComposeSGProjection(int inputchannel);
+    void ReloadReleasedSegments();
 
 private:
+    void ReadMissingRegions();
     void CalculateLUT();
     void CalculateProjectionLUT();
     bool PixelOK(int pix);
@@ -1,4 +1,5 @@
 #include "segmentmetop.h"
+#include "tracer.h"
 
 #include "sgp4sdp4.h"
 #include "globals.h"
@@ -719,6 +720,7 @@ void SegmentMetop::RenderSegmentlineInTexture( int channel, int nbrLine, int nbr
 
 Segment *SegmentMetop::ReadSegmentInMemory()
 {
+    TraceSpan span("decode", "SegmentMetop::ReadSegmentInMemory", fileInfo);
     FILE*   f;
     BZFILE* b;
     int     nBuf;
@@ -759,6 +761,7 @@ Segment *SegmentMetop::ReadSegmentInMemory()
 
     bzerror = BZ_OK;
 
+    earthloc_size = 1080*103;
     earthloc_lon.reset(new float[1080*103]);
     earthloc_lat.reset(new float[1080*103]);
     solar_zenith_angle.reset(new float[1080*103]);
@@ -958,20 +961,13 @@ void SegmentMetop::RenderSegmentlineInGVP( int channel, int nbrLine, int heighti
     double dtot;
 
     QRgb *row_col;
+    QVector<QRgb> row_buffer;
     QRgb rgbvalue1 = qRgba(0,0,0,255);
 
     if (channel == 6)
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(heightintotalimage);
-    else if (channel == 1)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(heightintotalimage);
-    else if (channel == 2)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(heightintotalimage);
-    else if (channel == 3)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(heightintotalimage);
-    else if (channel == 4)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(heightintotalimage);
-    else if (channel == 5)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(heightintotalimage);
+    else if (channel >= 1 && channel <= 5)
+        row_col = imageptrs->ChannelLine(channel - 1, heightintotalimage, row_buffer);
 
     g_mutex.lock();
 
@@ -1098,22 +1094,15 @@ void SegmentMetop::RenderSegmentlineInSG( int channel, int nbrLine, int heightin
     double dtot;
 
     QRgb *row_col;
+    QVector<QRgb> row_buffer;
     QRgb rgbvalue = qRgb(0,0,0);
 
 
 
     if (channel == 6)
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(heightintotalimage);
-    else if (channel == 1)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(heightintotalimage);
-    else if (channel == 2)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(heightintotalimage);
-    else if (channel == 3)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(heightintotalimage);
-    else if (channel == 4)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(heightintotalimage);
-    else if (channel == 5)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(heightintotalimage);
+    else if (channel >= 1 && channel <= 5)
+        row_col = imageptrs->ChannelLine(channel - 1, heightintotalimage, row_buffer);
 
     g_mutex.lock();
 
@@ -1179,20 +1168,13 @@ void SegmentMetop::RenderSegmentlineInLCC( int channel, int nbrLine, int heighti
     double map_x, map_y;
 
     QRgb *row_col;
+    QVector<QRgb> row_buffer;
     QRgb rgbvalue = qRgb(0,0,0);
 
     if (channel == 6)
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(heightintotalimage);
-    else if (channel == 1)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(heightintotalimage);
-    else if (channel == 2)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(heightintotalimage);
-    else if (channel == 3)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(heightintotalimage);
-    else if (channel == 4)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(heightintotalimage);
-    else if (channel == 5)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(heightintotalimage);
+    else if (channel >= 1 && channel <= 5)
+        row_col = imageptrs->ChannelLine(channel - 1, heightintotalimage, row_buffer);
 
     g_mutex.lock();
 
@@ -1265,6 +1247,7 @@ void SegmentMetop::RenderSegmentlineInGVPRad(int channel, double lat_first, doub
 {
 
     QRgb *row_col;
+    QVector<QRgb> row_buffer;
 
     double latdiff = sin((lat_first-lat_last)/2);
     double londiff = sin((lon_first-lon_last)/2);
@@ -1295,16 +1278,8 @@ void SegmentMetop::RenderSegmentlineInGVPRad(int channel, double lat_first, doub
 
     if (channel == 6)
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(heightintotalimage);
-    else if (channel == 1)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(heightintotalimage);
-    else if (channel == 2)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(heightintotalimage);
-    else if (channel == 3)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(heightintotalimage);
-    else if (channel == 4)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(heightintotalimage);
-    else if (channel == 5)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(heightintotalimage);
+    else if (channel >= 1 && channel <= 5)
+        row_col = imageptrs->ChannelLine(channel - 1, heightintotalimage, row_buffer);
 
 
     QColor rgb;
@@ -1,4 +1,5 @@
 #include "segmentnoaa.h"
+#include "tracer.h"
 #include "segmentlistnoaa.h"
 #include "segmentimage.h"
 
@@ -167,6 +168,7 @@ void SegmentNoaa::initializeProjectionCoord()
 
 Segment *SegmentNoaa::ReadSegmentInMemory()
 {
+    TraceSpan span("decode", "SegmentNoaa::ReadSegmentInMemory", fileInfo);
     FILE*   f;
     BZFILE* b;
     int     nBuf;
@@ -290,19 +292,12 @@ void SegmentNoaa::RenderSegmentlineInProjection( int channel, int nbrLine, int h
 {
 
     QRgb *row_col;
+    QVector<QRgb> row_buffer;
 
     if (channel == 6)
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(heightintotalimage);
-    else if (channel == 1)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(heightintotalimage);
-    else if (channel == 2)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(heightintotalimage);
-    else if (channel == 3)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(heightintotalimage);
-    else if (channel == 4)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(heightintotalimage);
-    else if (channel == 5)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(heightintotalimage);
+    else if (channel >= 1 && channel <= 5)
+        row_col = imageptrs->ChannelLine(channel - 1, heightintotalimage, row_buffer);
 
     QSgp4Date dateref = eciref.GetDate();
     Vector3 posref = eciref.GetPos();
@@ -738,22 +733,15 @@ void SegmentNoaa::RenderSegmentlineInProjectionAlternative( int channel, int nbr
 {
 
     QRgb *row_col;
+    QVector<QRgb> row_buffer;
     double map_x, map_y;
     QRgb rgbvalue = qRgb(0,0,0);
 
 
     if (channel == 6)
         row_col = (QRgb*)imageptrs->ptrimagecomp_col->scanLine(heightintotalimage);
-    else if (channel == 1)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[0]->scanLine(heightintotalimage);
-    else if (channel == 2)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[1]->scanLine(heightintotalimage);
-    else if (channel == 3)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[2]->scanLine(heightintotalimage);
-    else if (channel == 4)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[3]->scanLine(heightintotalimage);
-    else if (channel == 5)
-        row_col = (QRgb*)imageptrs->ptrimagecomp_ch[4]->scanLine(heightintotalimage);
+    else if (channel >= 1 && channel <= 5)
+        row_col = imageptrs->ChannelLine(channel - 1, heightintotalimage, row_buffer);
 
     QSgp4Date dateref = eciref.GetDate();
     Vector3 posref = eciref.GetPos();
@@ -1,4 +1,5 @@
 #include "segmentviirsdnb.h"
+#include "tracer.h"
 #include "segmentimage.h"
 
 #include <hdf5/serial/hdf5.h>
@@ -125,6 +126,31 @@ void SegmentVIIRSDNB::initializeMemory()
     }
 }
 
+void SegmentVIIRSDNB::resetMemory()
+{
+    Segment::resetMemory();
+
+    geolatitude.reset();
+    geolongitude.reset();
+    lunar_zenith.reset();
+    solar_zenith.reset();
+    lunar_azimuth.reset();
+    solar_azimuth.reset();
+}
+
+qint64 SegmentVIIRSDNB::memoryInUse()
+{
+    qint64 swath = (qint64)earth_views_per_scanline * NbrOfLines;
+    qint64 bytes = Segment::memoryInUse();
+
+    if(!geolatitude.isNull())
+        bytes += swath * sizeof(float) * 2;
+    if(!lunar_zenith.isNull())
+        bytes += swath * sizeof(float) * 4;
+
+    return bytes;
+}
+
 // 0  1  2  3  4  5  6  7  8  9  10 11 12 13 14 15 ..............................303            308   310            315
 // |                 |     |              |         TPZGroupLocationScanCompact   |              |     |              |
 // *--+--+--+--+--*--*--*--*--+--+--+--*--*--+--+.................................*--+--+--+--*--*--*--*--+--+--+--+--*
@@ -137,6 +163,7 @@ void SegmentVIIRSDNB::initializeMemory()
 //
 Segment *SegmentVIIRSDNB::ReadSegmentInMemory()
 {
+    TraceSpan span("decode", "SegmentVIIRSDNB::ReadSegmentInMemory", fileInfo);
 
     FILE*   f = NULL;
     BZFILE* b;
@@ -165,7 +192,7 @@ Segment *SegmentVIIRSDNB::ReadSegmentInMemory()
     fileout.open(QIODevice::WriteOnly);
     QDataStream streamout(&fileout);
 
-
+    TraceSpan bz2span("bz2", "BZ2_bzRead", fileInfo);
     if((b = BZ2_bzopen(this->fileInfo.absoluteFilePath().toLatin1(),"rb"))==NULL)
     {
         qDebug() << "error in BZ2_bzopen";
@@ -184,6 +211,7 @@ Segment *SegmentVIIRSDNB::ReadSegmentInMemory()
     BZ2_bzclose ( b );
 
     fileout.close();
+    bz2span.finish();
 
     tiepoints_lat.reset(new float[96 * 316]);
     tiepoints_lon.reset(new float[96 * 316]);
@@ -967,6 +995,7 @@ int SegmentVIIRSDNB::ReadNbrOfLines()
 
 void SegmentVIIRSDNB::ComposeSegmentImageWindow(float lowerlimit, float upperlimit)
 {
+    TraceSpan span("compose", "SegmentVIIRSDNB::ComposeSegmentImageWindow", fileInfo);
 
     QRgb *row;
     long indexout;
@@ -1016,6 +1045,7 @@ void SegmentVIIRSDNB::ComposeSegmentImageWindow(float lowerlimit, float upperlim
 
 void SegmentVIIRSDNB::ComposeSegmentImageWindowFromCurve(QVector<double> *x, QVector<double> *y)
 {
+    TraceSpan span("compose", "SegmentVIIRSDNB::ComposeSegmentImageWindowFromCurve", fileInfo);
 
     QRgb *row;
     long indexout;
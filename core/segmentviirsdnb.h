@@ -14,6 +14,8 @@ public:
     ~SegmentVIIRSDNB();
 
     void initializeMemory();
+    void resetMemory();
+    qint64 memoryInUse();
 
     Segment *ReadSegmentInMemory();
     Segment *ReadDatasetsInMemory();
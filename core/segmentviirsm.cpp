@@ -1,5 +1,7 @@
 #include "segmentviirsm.h"
+#include "tracer.h"
 #include "segmentimage.h"
+#include "projectionextent.h"
 
 
 
@@ -95,6 +97,7 @@ SegmentVIIRSM::SegmentVIIRSM(QFile *filesegment, SatelliteList *satl, QObject *p
     invertthissegment[0] = false;
     invertthissegment[1] = false;
     invertthissegment[2] = false;
+    readregion = ProjectionExtent::fullRegion(768, 3200);
 
 }
 
@@ -117,6 +120,30 @@ void SegmentVIIRSM::initializeMemory()
     }
 }
 
+void SegmentVIIRSM::resetMemory()
+{
+    Segment::resetMemory();
+
+    tiepoints_lat.reset();
+    tiepoints_lon.reset();
+    aligncoef.reset();
+    expanscoef.reset();
+    geolatitude.reset();
+    geolongitude.reset();
+}
+
+qint64 SegmentVIIRSM::memoryInUse()
+{
+    qint64 bytes = Segment::memoryInUse();
+
+    if(!geolatitude.isNull())
+        bytes += 768 * 3200 * sizeof(float);
+    if(!geolongitude.isNull())
+        bytes += 768 * 3200 * sizeof(float);
+
+    return bytes;
+}
+
 void SegmentVIIRSM::setBandandColor(QList<bool> band, QList<int> color, QList<bool> invert)
 {
     bandlist = band;
@@ -126,6 +153,7 @@ void SegmentVIIRSM::setBandandColor(QList<bool> band, QList<int> color, QList<bo
 
 Segment *SegmentVIIRSM::ReadSegmentInMemory()
 {
+    TraceSpan span("decode", "SegmentVIIRSM::ReadSegmentInMemory", fileInfo);
 
     FILE*   f = NULL;
     BZFILE* b;
@@ -150,7 +178,7 @@ Segment *SegmentVIIRSM::ReadSegmentInMemory()
     fileout.open(QIODevice::WriteOnly);
     QDataStream streamout(&fileout);
 
-
+    TraceSpan bz2span("bz2", "BZ2_bzRead", fileInfo);
     if((b = BZ2_bzopen(this->fileInfo.absoluteFilePath().toLatin1(),"rb"))==NULL)
     {
         qDebug() << "error in BZ2_bzopen";
@@ -169,14 +197,16 @@ Segment *SegmentVIIRSM::ReadSegmentInMemory()
     BZ2_bzclose ( b );
 
     fileout.close();
+    bz2span.finish();
 
 
     if( (h5_file_id = H5Fopen(basename.toLatin1(), H5F_ACC_RDONLY, H5P_DEFAULT)) < 0)
         qDebug() << "File " << basename << " not open !!";
 
 
-    ReadVIIRSM_SDR_All(h5_file_id);
+    // the tie points come first, they decide which part of the radiances is read
     ReadVIIRSM_GEO_All(h5_file_id);
+    ReadVIIRSM_SDR_All(h5_file_id);
 
 
     int i, j;
@@ -286,6 +316,11 @@ void SegmentVIIRSM::ReadVIIRSM_SDR_All(hid_t h5_file_id)
 
     bool iscolorimage = this->bandlist.at(0);
 
+    ProjectionExtent extent;
+    ArrayRegion region = extent.swathRegion(tiepoints_lat.data(), tiepoints_lon.data(), 48, 200, 16, 16);
+    bool fullregion = ProjectionExtent::isFullRegion(region, 768, 3200);
+    readregion = region;
+
     for(int k = 0; k < (iscolorimage ? 3 : 1) ; k++)
     {
         if((radiance_id[k] = H5Dopen2(h5_file_id, (iscolorimage ? getDatasetNameFromColor(k).toLatin1() : getDatasetNameFromBand().toLatin1() ), H5P_DEFAULT)) < 0)
@@ -293,8 +328,10 @@ void SegmentVIIRSM::ReadVIIRSM_SDR_All(hid_t h5_file_id)
         else
             qDebug() << "Dataset " << (iscolorimage ? getDatasetNameFromColor(k) : getDatasetNameFromBand() ) << " is open !!  ok ok ok ";
 
-        if((h5_status = H5Dread (radiance_id[k], H5T_NATIVE_USHORT, H5S_ALL, H5S_ALL,
-                                 H5P_DEFAULT, ptrbaVIIRS[k].data())) < 0)
+        if(!fullregion)
+            memset(ptrbaVIIRS[k].data(), 0, 768 * 3200 * sizeof(unsigned short));
+
+        if((h5_status = ProjectionExtent::readRegion(radiance_id[k], H5T_NATIVE_USHORT, 768, 3200, region, ptrbaVIIRS[k].data())) < 0)
             qDebug() << "Unable to read radiance dataset";
 
     }
@@ -364,6 +401,17 @@ void SegmentVIIRSM::ReadVIIRSM_SDR_All(hid_t h5_file_id)
         h5_status = H5Dclose (radiance_id[0]);
 }
 
+// false when the current projection needs radiances outside the part read for an earlier one
+bool SegmentVIIRSM::isRegionRead()
+{
+    if(tiepoints_lat.isNull() || tiepoints_lon.isNull())
+        return false;
+
+    ProjectionExtent extent;
+    ArrayRegion region = extent.swathRegion(tiepoints_lat.data(), tiepoints_lon.data(), 48, 200, 16, 16);
+    return ProjectionExtent::containsRegion(readregion, region);
+}
+
 void SegmentVIIRSM::ReadVIIRSM_GEO_All(hid_t h5_file_id)
 {
     hid_t   tiepoints_lat_id, tiepoints_lon_id;
@@ -854,6 +902,7 @@ bool SegmentVIIRSM::composeColorImage()
 
 void SegmentVIIRSM::ComposeSegmentImage()
 {
+    TraceSpan span("compose", "SegmentVIIRSM::ComposeSegmentImage", fileInfo);
 
     QRgb *row;
     int indexout[3];
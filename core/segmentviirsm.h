@@ -4,6 +4,7 @@
 #include "satellite.h"
 #include "segment.h"
 #include <hdf5/serial/hdf5.h>
+#include "projectionextent.h"
 
 class SegmentVIIRSM : public Segment
 {
@@ -14,6 +15,8 @@ public:
     ~SegmentVIIRSM();
 
     void initializeMemory();
+    void resetMemory();
+    qint64 memoryInUse();
 
     Segment *ReadSegmentInMemory();
     Segment *ReadDatasetsInMemory();
@@ -29,6 +32,8 @@ public:
     void RecalculateProjection();
 
     void recalculateStatsInProjection();
+    bool isRegionRead();
+    bool isPixelRead(int line, int pixelx) { return ProjectionExtent::isInRegion(readregion, line, pixelx); }
     QString getDatasetNameFromBand();
     QString getDatasetNameFromColor(int colorindex);
     bool composeColorImage();
@@ -74,6 +79,7 @@ private:
 
     QScopedArrayPointer<float> geolatitude;
     QScopedArrayPointer<float> geolongitude;
+    ArrayRegion readregion;     // part of ptrbaVIIRS read by ReadVIIRSM_SDR_All, the rest is 0
 
 
     QList<bool> bandlist;
@@ -1,8 +1,10 @@
 #include "stereographic.h"
+#include "tracer.h"
 #include "globals.h"
 #include "options.h"
 #include "pixgeoconversion.h"
 #include "segmentimage.h"
+#include "projectionexport.h"
 
 
 #include <QDebug>
@@ -89,6 +91,7 @@ void StereoGraphic::Initialize(double center_lon, double center_lat, double insc
 
 void StereoGraphic::CreateMapFromGeostationary()
 {
+    TraceSpan span("projection", "StereoGraphic::CreateMapFromGeostationary");
     QApplication::setOverrideCursor( Qt::WaitCursor ); // this might take time
 
     QRgb *scanl;
@@ -115,6 +118,8 @@ void StereoGraphic::CreateMapFromGeostationary()
     if(sl == NULL)
         return;
 
+    sl->ComposeForProjection();
+
     double sub_lon = sl->geosatlon;
 
     if(sl->getKindofImage() == "HRV" || sl->getKindofImage() == "HRV Color")
@@ -155,6 +160,11 @@ void StereoGraphic::CreateMapFromGeostationary()
 
 
 
+    // brightness temperatures of a calibrated MSG infrared image
+    int projwidth = imageptrs->ptrimageProjection->width();
+    int geowidth = imageptrs->ptrimageGeostationary->width();
+    const float *btgeo = (imageptrs->InitializeProjectionBrightnessTemp() && hrvmap == 0 ? imageptrs->ptrBrightnessTempGeostationary.data() : NULL);
+
     for (int j = 0; j < imageptrs->ptrimageProjection->height(); j++)
     {
         for (int i = 0; i < imageptrs->ptrimageProjection->width(); i++)
@@ -174,6 +184,8 @@ void StereoGraphic::CreateMapFromGeostationary()
                                 rgbval = scanl[col];
                                 fb_painter.setPen(rgbval);
                                 fb_painter.drawPoint(i,j);
+                                if(btgeo != NULL)
+                                    imageptrs->ptrProjectionBrightnessTemp[j * projwidth + i] = btgeo[picrow * geowidth + col];
                             }
                         }
                         else
@@ -241,6 +253,8 @@ void StereoGraphic::CreateMapFromGeostationary()
                             rgbval = scanl[col];
                             fb_painter.setPen(rgbval);
                             fb_painter.drawPoint(i,j);
+                            if(btgeo != NULL)
+                                imageptrs->ptrProjectionBrightnessTemp[j * projwidth + i] = btgeo[picrow * geowidth + col];
                         }
                     }
                 }
@@ -255,6 +269,7 @@ void StereoGraphic::CreateMapFromGeostationary()
 
 void StereoGraphic::CreateMapFromAVHRR(int inputchannel, eSegmentType type)
 {
+    TraceSpan span("projection", "StereoGraphic::CreateMapFromAVHRR");
 
     if (type == SEG_NOAA)
         segs->seglnoaa->ComposeSGProjection(inputchannel);
@@ -284,6 +299,7 @@ void StereoGraphic::CreateMapFromAVHRR(int inputchannel, eSegmentType type)
 
 void StereoGraphic::CreateMapFromVIIRS(eSegmentType type, bool combine)
 {
+    TraceSpan span("projection", "StereoGraphic::CreateMapFromVIIRS");
     if (type == SEG_VIIRSM)
         segs->seglviirsm->ComposeSGProjection(0);
     else if( type == SEG_VIIRSDNB)
@@ -385,6 +401,26 @@ bool StereoGraphic::map_inverse(double map_x, double map_y, double &lon_rad, dou
     return ret;
 }
 
+// false_easting and false_northing of this class are in pixels, they only move the tie point
+void StereoGraphic::georeference(ProjectionGeoreference &geo)
+{
+    geo.pixelx = 2 * map_radius * scale / map_width;
+    geo.pixely = 2 * map_radius * scale / map_height;
+    geo.originx = - map_radius * scale * (2*(mapdeltax+false_easting) + map_width) / map_width;
+    geo.originy = map_radius * scale * (2*(mapdeltay+false_northing) + map_height) / map_height;
+    geo.semimajor = r_major;
+    geo.semiminor = r_major;
+    geo.lon0 = lon_center * 180.0/PI;
+    geo.lat0 = lat_origin * 180.0/PI;
+    geo.stdlat1 = 0.0;
+    geo.stdlat2 = 0.0;
+    geo.height = 0.0;
+    geo.falseeasting = 0.0;
+    geo.falsenorthing = 0.0;
+    geo.proj4 = QString("+proj=stere +lat_0=%1 +lon_0=%2 +k=1 +x_0=0 +y_0=0 +R=%3 +units=m +no_defs")
+            .arg(geo.lat0, 0, 'f', 6).arg(geo.lon0, 0, 'f', 6).arg(geo.semimajor, 0, 'f', 3);
+}
+
 bool StereoGraphic::inverse(double x, double y, double &lon_rad, double &lat_rad)
 {
     double rh;  		/* height above ellipsoid			*/
@@ -6,6 +6,7 @@
 
 //! This is the object used for the Polar Stereographic projection.
 class PolarStereo;
+struct ProjectionGeoreference;
 
 class StereoGraphic : public QObject
 {
@@ -23,6 +24,7 @@ public:
     void CreateMapFromAVHRR(int inputchannel, eSegmentType type);
     void CreateMapFromVIIRS(eSegmentType type, bool combine);
     void CreateMapFromGeostationary();
+    void georeference(ProjectionGeoreference &geo);
 
 protected:
 
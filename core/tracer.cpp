@@ -0,0 +1,144 @@
+#include "tracer.h"
+#include "options.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+
+extern Options opts;
+
+static const int maxevents = 500000;   // about 25 MB, the later spans are counted and dropped
+
+QAtomicInt Tracer::active(0);
+
+static QString jsonEscape(const QString &text)
+{
+    QString escaped;
+    for(int i = 0; i < text.length(); i++)
+    {
+        QChar c = text.at(i);
+        if(c == '"' || c == '\\')
+            escaped += QString("\\") + c;
+        else if(c.unicode() < 0x20)
+            escaped += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+        else
+            escaped += c;
+    }
+    return escaped;
+}
+
+Tracer::Tracer()
+{
+    dropped = 0;
+    clock.start();
+    setup();
+}
+
+Tracer *Tracer::instance()
+{
+    static Tracer tracer;
+    return &tracer;
+}
+
+// Takes over opts.tracing and opts.tracefile, switching tracing off writes the spans so far
+void Tracer::setup()
+{
+    mutex.lock();
+    filename = opts.tracefile;
+    bool wasactive = enabled();
+    if(opts.tracing && !wasactive)
+    {
+        events.clear();
+        threadids.clear();
+        threadnames.clear();
+        dropped = 0;
+        clock.restart();
+        active.store(1);
+    }
+    else if(!opts.tracing)
+        active.store(0);
+    mutex.unlock();
+
+    qDebug() << QString("Tracer::setup tracing = %1 file = %2").arg(opts.tracing).arg(filename);
+
+    if(wasactive && !opts.tracing)
+        write();
+}
+
+void Tracer::add(const char *category, const char *name, const QString &segment, qint64 start)
+{
+    qint64 end = now();
+    quint64 threadid = (quint64)(quintptr)QThread::currentThreadId();
+
+    QMutexLocker locker(&mutex);
+    if(events.count() >= maxevents)
+    {
+        dropped++;
+        return;
+    }
+
+    if(!threadids.contains(threadid))
+    {
+        QThread *current = QThread::currentThread();
+        QString threadname;
+        if(QCoreApplication::instance() != NULL && current == QCoreApplication::instance()->thread())
+            threadname = "GUI";
+        else
+            threadname = QString("%1 %2").arg(current->objectName().isEmpty() ? QString("Worker") : current->objectName()).arg(threadnames.count());
+        threadids.insert(threadid, threadnames.count());
+        threadnames.append(threadname);
+    }
+
+    TraceEvent event;
+    event.category = category;
+    event.name = name;
+    event.segment = segment;
+    event.start = start;
+    event.duration = end - start;
+    event.thread = threadids.value(threadid);
+    events.append(event);
+}
+
+// Complete events ("ph" : "X") with the thread names as metadata, the spans are cleared afterwards
+bool Tracer::write()
+{
+    QMutexLocker locker(&mutex);
+    if(events.isEmpty())
+        return true;
+
+    QFile file(filename);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qWarning() << QString("Tracer::write can not open %1").arg(filename);
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"EUMETCastView\"}}";
+
+    for(int i = 0; i < threadnames.count(); i++)
+        out << QString(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%1,\"args\":{\"name\":\"%2\"}}")
+               .arg(i + 1).arg(jsonEscape(threadnames.at(i)));
+
+    for(int i = 0; i < events.count(); i++)
+    {
+        const TraceEvent &event = events.at(i);
+        out << QString(",\n{\"name\":\"%1\",\"cat\":\"%2\",\"ph\":\"X\",\"ts\":%3,\"dur\":%4,\"pid\":1,\"tid\":%5")
+               .arg(jsonEscape(event.name)).arg(jsonEscape(event.category)).arg(event.start).arg(event.duration).arg(event.thread + 1);
+        if(!event.segment.isEmpty())
+            out << QString(",\"args\":{\"segment\":\"%1\"}").arg(jsonEscape(event.segment));
+        out << "}";
+    }
+
+    out << "\n]}\n";
+    out.flush();
+
+    qInfo() << QString("Tracer::write %1 spans to %2, %3 dropped").arg(events.count()).arg(filename).arg(dropped);
+
+    events.clear();
+    dropped = 0;
+    return true;
+}
@@ -0,0 +1,90 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+struct TraceEvent
+{
+    const char *category;
+    const char *name;
+    QString segment;
+    qint64 start;       // microseconds since the trace started
+    qint64 duration;
+    int thread;         // index in Tracer::threadnames
+};
+
+// Spans of the decode, compose, CLAHE, projection and overlay stages, written as a Chrome trace
+// (chrome://tracing or ui.perfetto.dev) to opts.tracefile when opts.tracing is on. The spans are kept
+// in memory until the trace is written : when tracing is switched off and when the program ends.
+class Tracer
+{
+public:
+    static Tracer *instance();
+    static bool enabled() { return active.load() != 0; }
+    void setup();
+
+    qint64 now() const { return clock.nsecsElapsed() / 1000; }
+    void add(const char *category, const char *name, const QString &segment, qint64 start);
+    bool write();
+
+private:
+    Tracer();
+
+    static QAtomicInt active;
+
+    QMutex mutex;
+    QElapsedTimer clock;
+    QVector<TraceEvent> events;
+    QHash<quint64, int> threadids;
+    QStringList threadnames;
+    QString filename;
+    int dropped;
+};
+
+// A span from its construction to the end of the scope, or to finish(). When tracing is off
+// only the flag is read, the file names are only formatted for a span that is kept.
+class TraceSpan
+{
+public:
+    TraceSpan(const char *category, const char *name, const QString &segment = QString()) :
+        category(category), name(name), start(Tracer::enabled() ? Tracer::instance()->now() : -1)
+    {
+        if(start >= 0)
+            this->segment = segment;
+    }
+    TraceSpan(const char *category, const char *name, const QFileInfo &fileinfo) :
+        category(category), name(name), start(Tracer::enabled() ? Tracer::instance()->now() : -1)
+    {
+        if(start >= 0)
+            this->segment = fileinfo.fileName();
+    }
+    TraceSpan(const char *category, const char *name, const QStringList &filelist) :
+        category(category), name(name), start(Tracer::enabled() ? Tracer::instance()->now() : -1)
+    {
+        if(start >= 0)
+            this->segment = filelist.join(" ");
+    }
+    ~TraceSpan() { finish(); }
+
+    void finish()
+    {
+        if(start >= 0)
+            Tracer::instance()->add(category, name, segment, start);
+        start = -1;
+    }
+
+private:
+    const char *category;
+    const char *name;
+    QString segment;
+    qint64 start;
+};
+
+#endif // TRACER_H